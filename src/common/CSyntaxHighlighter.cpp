@@ -3,8 +3,25 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 
 #include "CSyntaxHighlighter.h"
+#include "highlightstatecache.h"
+
+#include <KSyntaxHighlighting/State>
+
+#include <QTextDocument>
+#include <QTextBlockUserData>
 #include <QDebug>
 
+namespace {
+
+// 文本块高亮后记录的结束状态，同时用于判断文本块是否已高亮
+class HighlightBlockData : public QTextBlockUserData
+{
+public:
+    KSyntaxHighlighting::State state;
+};
+
+}
+
 CSyntaxHighlighter::CSyntaxHighlighter(QObject *parent):
     SyntaxHighlighter (parent),
     m_bHighlight(false)
@@ -13,9 +30,15 @@ CSyntaxHighlighter::CSyntaxHighlighter(QObject *parent):
 }
 
 CSyntaxHighlighter::CSyntaxHighlighter(QTextDocument *pDocument):
-    SyntaxHighlighter (pDocument),m_bHighlight(false)
+    SyntaxHighlighter (static_cast<QObject *>(pDocument)),m_bHighlight(false)
 {
-
+    // 状态缓存需先于 QSyntaxHighlighter 处理文档变更，因此在设置文档前连接
+    m_pStateCache = new HighlightStateCache(pDocument, this);
+    connect(pDocument, &QTextDocument::contentsChange, this, &CSyntaxHighlighter::onContentsChange);
+    connect(m_pStateCache, &HighlightStateCache::sigStatesAdvanced, this, &CSyntaxHighlighter::onStatesAdvanced);
+    // 状态缓存分析的文本块同样上报折叠区域，未高亮的文本块无需设置格式即可折叠
+    connect(m_pStateCache, &HighlightStateCache::sigBlockFoldingRegions, this, &CSyntaxHighlighter::sigBlockFoldingRegions);
+    setDocument(pDocument);
 }
 
 void CSyntaxHighlighter::setEnableHighlight(bool isEnable)
@@ -23,11 +46,105 @@ void CSyntaxHighlighter::setEnableHighlight(bool isEnable)
     m_bHighlight = isEnable;
 }
 
+void CSyntaxHighlighter::setDefinition(const KSyntaxHighlighting::Definition &def)
+{
+    // 先重置状态缓存，设置语法定义时可能重新高亮
+    m_approximateBlock = -1;
+    if (m_pStateCache) {
+        m_pStateCache->setDefinition(def);
+    }
+    KSyntaxHighlighting::SyntaxHighlighter::setDefinition(def);
+}
+
+void CSyntaxHighlighter::setBackgroundHighlight(bool enable)
+{
+    if (m_pStateCache) {
+        m_pStateCache->setBackgroundEnabled(enable);
+    }
+}
+
+bool CSyntaxHighlighter::hasExactState(int blockNumber) const
+{
+    return m_pStateCache && m_pStateCache->hasState(blockNumber);
+}
+
+HighlightStateCache *CSyntaxHighlighter::stateCache() const
+{
+    return m_pStateCache;
+}
+
+/**
+ * @brief 高亮当前文本块。起始状态可由状态缓存取得时使用准确状态，并将结束状态回写缓存，
+ *      顺序高亮时后续文本块无需重复分析；否则使用上一文本块记录的状态。
+ */
 void CSyntaxHighlighter::highlightBlock(const QString &text)
 {
     if (!m_bHighlight) {
         return;
     }
 
-    KSyntaxHighlighting::SyntaxHighlighter::highlightBlock(text);
+    const QTextBlock block = currentBlock();
+    const int blockNumber = block.blockNumber();
+    KSyntaxHighlighting::State state;
+    const bool exact = m_pStateCache && m_pStateCache->stateForBlock(blockNumber, state);
+    if (!exact) {
+        HighlightBlockData *prevData = dynamic_cast<HighlightBlockData *>(block.previous().userData());
+        if (prevData) {
+            state = prevData->state;
+        }
+        if (blockNumber >= 0 && (m_approximateBlock < 0 || blockNumber < m_approximateBlock)) {
+            m_approximateBlock = blockNumber;
+        }
+    }
+
+    m_foldingRegions.clear();
+    state = highlightLine(text, state);
+    if (exact) {
+        m_pStateCache->setBlockEndState(blockNumber, state);
+    }
+
+    HighlightBlockData *data = dynamic_cast<HighlightBlockData *>(currentBlockUserData());
+    if (!data && block.isValid()) {
+        data = new HighlightBlockData;
+        setCurrentBlockUserData(data);
+    }
+    if (data) {
+        data->state = state;
+    }
+
+    emit sigBlockFoldingRegions(blockNumber, m_foldingRegions);
+}
+
+/**
+ * @brief 记录语法定义中的折叠区域起止标记，按出现顺序保存，高亮文本块完成后统一通知
+ */
+void CSyntaxHighlighter::applyFolding(int offset, int length, KSyntaxHighlighting::FoldingRegion region)
+{
+    // 不再调用基类高亮，折叠区域仅在此记录
+    Q_UNUSED(offset)
+    Q_UNUSED(length)
+
+    if (region.type() == KSyntaxHighlighting::FoldingRegion::Begin) {
+        m_foldingRegions.append(region.id() + 1);
+    } else if (region.type() == KSyntaxHighlighting::FoldingRegion::End) {
+        m_foldingRegions.append(-(region.id() + 1));
+    }
+}
+
+void CSyntaxHighlighter::onContentsChange(int from, int charsRemoved, int charsAdded)
+{
+    // 高亮时 QSyntaxHighlighter 设置格式同样触发内容变更，文本未变化
+    if (m_bHighlight || !m_pStateCache) {
+        return;
+    }
+
+    m_pStateCache->contentsChange(from, charsRemoved, charsAdded);
+}
+
+void CSyntaxHighlighter::onStatesAdvanced(int frontierBlock)
+{
+    if (m_approximateBlock >= 0 && frontierBlock >= m_approximateBlock) {
+        m_approximateBlock = -1;
+        emit sigExactStatesReady();
+    }
 }
@@ -6,8 +6,18 @@
 #include <KSyntaxHighlighting/Repository>
 #include <KSyntaxHighlighting/Definition>
 #include <KSyntaxHighlighting/SyntaxHighlighter>
+#include <KSyntaxHighlighting/FoldingRegion>
+
+#include <QVector>
+
+class HighlightStateCache;
 
 using namespace KSyntaxHighlighting;
+/**
+ * @brief 编辑器语法高亮，仅在 setEnableHighlight(true) 时高亮文本块。
+ *      文本块的起始状态优先取自高亮状态缓存(HighlightStateCache)，跳转至文档任意位置时无需从文档开头高亮，
+ *      缓存尚未分析到的文本块使用上一文本块记录的状态，缓存分析到后通知重新高亮。
+ */
 class CSyntaxHighlighter : public SyntaxHighlighter
 {
     Q_OBJECT
@@ -15,10 +25,32 @@ public:
     explicit CSyntaxHighlighter(QObject *parent = nullptr);
     explicit CSyntaxHighlighter(QTextDocument *pDocument);
     void setEnableHighlight(bool isEnable);
+    void setDefinition(const KSyntaxHighlighting::Definition &def) override;
+
+    // 是否在界面空闲时分析文档的高亮状态
+    void setBackgroundHighlight(bool enable);
+    // 文本块 blockNumber 的起始状态是否准确
+    bool hasExactState(int blockNumber) const;
+    HighlightStateCache *stateCache() const;
+
+signals:
+    // 文本块 blockNumber 高亮或由状态缓存分析完成，regions 为块内的折叠区域标记，正数为区域起始，负数为区域结束，绝对值为区域标识加 1
+    void sigBlockFoldingRegions(int blockNumber, const QVector<int> &regions);
+    // 以不准确起始状态高亮的文本块已可取得准确状态，需要重新高亮
+    void sigExactStatesReady();
 
 protected:
     virtual void highlightBlock(const QString & text) override;
+    virtual void applyFolding(int offset, int length, KSyntaxHighlighting::FoldingRegion region) override;
+
+private slots:
+    // 文档内容变更，高亮格式变更(仅在高亮时触发)不影响状态
+    void onContentsChange(int from, int charsRemoved, int charsAdded);
+    void onStatesAdvanced(int frontierBlock);
 
 private:
     bool m_bHighlight = false;
+    QVector<int> m_foldingRegions;  // 当前高亮文本块的折叠区域标记
+    HighlightStateCache *m_pStateCache = nullptr;   // 高亮状态缓存
+    int m_approximateBlock = -1;    // 以不准确起始状态高亮的最小文本块
 };
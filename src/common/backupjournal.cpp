@@ -0,0 +1,390 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "backupjournal.h"
+#include "utils.h"
+#include "../encodes/detectcode.h"
+
+#include <QDataStream>
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QTextDocument>
+#include <QTextBlock>
+
+static const quint32 s_journalMagic = 0x444A524E;   // "DJRN"
+static const quint32 s_journalVersion = 1;
+
+// 日志记录类型
+enum JournalRecord {
+    ERecordReplace = 1,     // 替换文本
+    ERecordCommit = 2,      // 提交
+};
+
+BackupJournal::BackupJournal(QTextDocument *document, QObject *parent)
+    : QObject(parent)
+    , m_document(document)
+{
+}
+
+BackupJournal::~BackupJournal()
+{
+}
+
+/**
+ * @brief 基准文件 \a basePath 将以当前文档内容全量写入，清空变更区域并重新开始记录。
+ *      基准文件及日志头部由调用方(备份线程)写入，见 writeHeader()
+ * @param basePath          基准文件路径
+ * @param encode            基准文件编码
+ * @param windowsEndline    基准文件是否使用Windows换行符
+ */
+void BackupJournal::checkpoint(const QString &basePath, const QString &encode, bool windowsEndline)
+{
+    m_ranges.clear();
+    m_basePath = basePath;
+    m_encode = encode;
+    m_windowsEndline = windowsEndline;
+    m_length = m_document->characterCount() - 1;
+    m_journalSize = 0;
+    m_valid = true;
+}
+
+/**
+ * @brief 判断是否可以追加日志：编码及换行符未变更，且日志大小及变更区域未超出限制(否则全量备份可压缩日志)。
+ *      基准文件及日志文件是否被其它方式修改在追加时校验，见 appendRecords()
+ */
+bool BackupJournal::canAppend(const QString &basePath, const QString &encode, bool windowsEndline) const
+{
+    if (!m_valid || m_basePath != basePath || m_encode != encode || m_windowsEndline != windowsEndline) {
+        return false;
+    }
+
+    // 日志文本按 UTF-16 存储，超过基准文本的数据量时压缩
+    if (m_journalSize > qMax<qint64>(EMinCompactSize, m_length * 2)) {
+        return false;
+    }
+
+    if (m_ranges.size() > EMaxDirtyRanges) {
+        return false;
+    }
+    qint64 dirtyLength = 0;
+    for (const DirtyRange &range : m_ranges) {
+        dirtyLength += range.length;
+    }
+    return dirtyLength <= m_length / 2;
+}
+
+bool BackupJournal::hasPendingChanges() const
+{
+    return !m_ranges.isEmpty();
+}
+
+/**
+ * @brief 读取变更区域的文本生成替换记录，按位置顺序应用时之前的区域已替换为当前文本，
+ *      因此直接使用当前文档中的位置
+ */
+QVector<BackupJournal::Record> BackupJournal::takeRecords()
+{
+    QVector<Record> records;
+    records.reserve(m_ranges.size());
+    for (const DirtyRange &range : m_ranges) {
+        Record record;
+        record.start = range.start;
+        record.baseLength = range.baseLength;
+        record.text = Utils::documentText(m_document, static_cast<int>(range.start), static_cast<int>(range.length));
+        m_journalSize += record.text.size() * 2 + static_cast<int>(sizeof(qint64)) * 3;
+        records.append(record);
+    }
+    m_ranges.clear();
+    return records;
+}
+
+qint64 BackupJournal::length() const
+{
+    return m_length;
+}
+
+QString BackupJournal::basePath() const
+{
+    return m_basePath;
+}
+
+/**
+ * @brief 基准文件 \a basePath 被全量写入等其它方式修改时，删除对应的日志并停止记录
+ */
+void BackupJournal::discard(const QString &basePath)
+{
+    if (m_basePath == basePath) {
+        invalidate();
+    }
+    QFile::remove(journalPath(basePath));
+}
+
+void BackupJournal::invalidate()
+{
+    m_valid = false;
+    m_ranges.clear();
+}
+
+bool BackupJournal::isValid() const
+{
+    return m_valid;
+}
+
+/**
+ * @brief 日志文件为基准文件同目录下的隐藏文件，不会被按文件列表处理备份目录的逻辑获取
+ */
+QString BackupJournal::journalPath(const QString &basePath)
+{
+    QFileInfo info(basePath);
+    return info.absolutePath() + "/." + info.fileName() + ".journal";
+}
+
+/**
+ * @brief 基准文件 \a basePath 全量写入后，重新写入日志文件头部，记录基准文件的编码、文本长度及文件大小
+ * @param basePath          基准文件路径
+ * @param encode            基准文件编码
+ * @param windowsEndline    基准文件是否使用Windows换行符
+ * @param baseLength        基准文本长度
+ * @return 是否写入成功
+ */
+bool BackupJournal::writeHeader(const QString &basePath, const QString &encode, bool windowsEndline, qint64 baseLength)
+{
+    QFile file(journalPath(basePath));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << Q_FUNC_INFO << "Open backup journal failed, " << file.errorString();
+        return false;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_6);
+    out << s_journalMagic << s_journalVersion << encode << windowsEndline << baseLength << QFileInfo(basePath).size();
+    bool ok = (QDataStream::Ok == out.status()) && file.flush();
+    file.close();
+    return ok;
+}
+
+/**
+ * @brief 校验日志头部记录的基准文件大小与当前基准文件一致后，追加替换记录 \a records ，最后写入提交记录
+ * @param basePath  基准文件路径
+ * @param records   替换记录
+ * @param length    应用替换记录后的文本长度
+ * @return 是否写入成功，失败时需全量备份
+ */
+bool BackupJournal::appendRecords(const QString &basePath, const QVector<Record> &records, qint64 length)
+{
+    QFile file(journalPath(basePath));
+    if (!file.open(QIODevice::ReadWrite)) {
+        qWarning() << Q_FUNC_INFO << "Open backup journal failed, " << file.errorString();
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_6);
+
+    // 基准文件被其它方式修改时，日志中的位置无法对应
+    quint32 magic = 0;
+    quint32 version = 0;
+    QString encode;
+    bool windowsEndline = false;
+    qint64 baseLength = 0;
+    qint64 baseFileSize = 0;
+    stream >> magic >> version >> encode >> windowsEndline >> baseLength >> baseFileSize;
+    if (QDataStream::Ok != stream.status() || s_journalMagic != magic || s_journalVersion != version
+            || QFileInfo(basePath).size() != baseFileSize) {
+        return false;
+    }
+
+    file.seek(file.size());
+    for (const Record &record : records) {
+        stream << static_cast<quint8>(ERecordReplace) << record.start << record.baseLength << record.text;
+    }
+    stream << static_cast<quint8>(ERecordCommit) << length;
+
+    bool ok = (QDataStream::Ok == stream.status()) && file.flush();
+    if (!ok) {
+        qWarning() << Q_FUNC_INFO << "Write backup journal failed, " << file.errorString();
+    }
+    file.close();
+    return ok;
+}
+
+/**
+ * @brief 将日志中已提交的变更应用到基准文件 \a basePath ，完成后删除日志。
+ *      基准文件与日志记录的信息不一致时丢弃日志，保留基准文件(上次全量备份的内容)。
+ * @return 是否应用了日志
+ */
+bool BackupJournal::replay(const QString &basePath)
+{
+    QFile journalFile(journalPath(basePath));
+    if (!journalFile.exists()) {
+        return false;
+    }
+
+    bool applied = false;
+    QFile baseFile(basePath);
+    if (journalFile.open(QIODevice::ReadOnly) && baseFile.open(QIODevice::ReadOnly)) {
+        QDataStream in(&journalFile);
+        in.setVersion(QDataStream::Qt_5_6);
+
+        quint32 magic = 0;
+        quint32 version = 0;
+        QString encode;
+        bool windowsEndline = false;
+        qint64 baseLength = 0;
+        qint64 baseFileSize = 0;
+        in >> magic >> version >> encode >> windowsEndline >> baseLength >> baseFileSize;
+
+        if (QDataStream::Ok == in.status() && s_journalMagic == magic && s_journalVersion == version
+                && baseFile.size() == baseFileSize) {
+            QByteArray baseData = baseFile.readAll();
+            QByteArray utf8Data;
+            DetectCode::ChangeFileEncodingFormat(baseData, utf8Data, encode, QString("UTF-8"));
+            baseData.clear();
+
+            QString text = QString::fromUtf8(utf8Data);
+            utf8Data.clear();
+            if (windowsEndline) {
+                text.replace("\r\n", "\n");
+            }
+
+            // 编码转换后长度不一致时，日志中的位置无法对应
+            if (text.length() == baseLength) {
+                QString working = text;
+                bool committed = false;
+                while (!in.atEnd()) {
+                    quint8 type = 0;
+                    in >> type;
+                    if (ERecordReplace == type) {
+                        qint64 start = 0;
+                        qint64 length = 0;
+                        QString replaceText;
+                        in >> start >> length >> replaceText;
+                        if (QDataStream::Ok != in.status() || start < 0 || length < 0
+                                || start + length > working.length()) {
+                            break;
+                        }
+                        working.replace(static_cast<int>(start), static_cast<int>(length), replaceText);
+                    } else if (ERecordCommit == type) {
+                        qint64 length = 0;
+                        in >> length;
+                        if (QDataStream::Ok != in.status() || length != working.length()) {
+                            break;
+                        }
+                        text = working;
+                        committed = true;
+                    } else {
+                        break;
+                    }
+                }
+
+                if (committed) {
+                    if (windowsEndline) {
+                        text.replace("\n", "\r\n");
+                    }
+                    QByteArray outData;
+                    utf8Data = text.toUtf8();
+                    text.clear();
+                    DetectCode::ChangeFileEncodingFormat(utf8Data, outData, QString("UTF-8"), encode);
+
+                    baseFile.close();
+                    QSaveFile saveFile(basePath);
+                    if (saveFile.open(QIODevice::WriteOnly)) {
+                        saveFile.write(outData);
+                        applied = saveFile.commit();
+                    }
+                    if (!applied) {
+                        qWarning() << Q_FUNC_INFO << "Write backup file failed, " << saveFile.errorString();
+                    }
+                }
+            } else {
+                qWarning() << Q_FUNC_INFO << "Backup journal does not match the backup file, " << basePath;
+            }
+        }
+    }
+
+    journalFile.close();
+    baseFile.close();
+    journalFile.remove();
+    return applied;
+}
+
+/**
+ * @brief 记录文档变更，将变更位置与相交或相邻的变更区域合并，之后的区域按长度变化平移。
+ *      变更信息与文档长度不一致时(如重新加载文件)停止记录，下次备份时全量写入。
+ *      长度不变且文本未修改的变更(如高亮格式变更)不记录。
+ * @param from          变更位置
+ * @param charsRemoved  删除的字符数
+ * @param charsAdded    添加的字符数
+ */
+void BackupJournal::recordChange(int from, int charsRemoved, int charsAdded)
+{
+    if (!m_valid) {
+        return;
+    }
+
+    const qint64 newLength = m_document->characterCount() - 1;
+    const qint64 removeEnd = static_cast<qint64>(from) + charsRemoved;
+    if (from < 0 || removeEnd > m_length || from + charsAdded > newLength
+            || m_length - charsRemoved + charsAdded != newLength) {
+        invalidate();
+        return;
+    }
+    m_length = newLength;
+
+    if (charsRemoved == charsAdded && !isTextChanged(from, charsAdded)) {
+        return;
+    }
+
+    const qint64 delta = static_cast<qint64>(charsAdded) - charsRemoved;
+    qint64 mergeStart = from;
+    qint64 mergeEnd = removeEnd;
+    qint64 lengthDelta = 0;     // 合并区域中已有变更区域的长度变化之和
+
+    QVector<DirtyRange> ranges;
+    ranges.reserve(m_ranges.size() + 1);
+    bool inserted = false;
+    for (const DirtyRange &range : m_ranges) {
+        const qint64 rangeEnd = range.start + range.length;
+        if (rangeEnd < from) {
+            ranges.append(range);
+        } else if (range.start > removeEnd) {
+            if (!inserted) {
+                ranges.append({mergeStart, mergeEnd - mergeStart + delta, mergeEnd - mergeStart - lengthDelta});
+                inserted = true;
+            }
+            ranges.append({range.start + delta, range.length, range.baseLength});
+        } else {
+            mergeStart = qMin(mergeStart, range.start);
+            mergeEnd = qMax(mergeEnd, rangeEnd);
+            lengthDelta += range.length - range.baseLength;
+        }
+    }
+    if (!inserted) {
+        ranges.append({mergeStart, mergeEnd - mergeStart + delta, mergeEnd - mergeStart - lengthDelta});
+    }
+
+    m_ranges.swap(ranges);
+}
+
+/**
+ * @brief 插入或删除文本时，修改的文本块记录当前的文档修订号；仅变更格式时文本块的修订号不变。
+ *      在文档变更通知中调用，修订号与文档当前修订号一致的文本块即为本次编辑修改了文本的文本块。
+ */
+bool BackupJournal::isTextChanged(int from, int length) const
+{
+    const int revision = m_document->revision();
+    const QTextBlock lastBlock = m_document->findBlock(from + length);
+    for (QTextBlock block = m_document->findBlock(from); block.isValid(); block = block.next()) {
+        if (block.revision() == revision) {
+            return true;
+        }
+        if (block == lastBlock) {
+            break;
+        }
+    }
+
+    return false;
+}
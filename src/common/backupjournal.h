@@ -0,0 +1,97 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef BACKUPJOURNAL_H
+#define BACKUPJOURNAL_H
+
+#include <QObject>
+#include <QString>
+#include <QVector>
+
+class QTextDocument;
+
+/**
+ * @brief 增量备份日志。备份文件(基准文件)全量写入后作为检查点，此后仅记录文档变更区域，
+ *      自动备份时将变更区域的文本追加到日志文件，日志过大或变更区域过多时重新全量写入基准文件(压缩)。
+ *      界面线程通过 takeRecords() 取得变更文本，文件读写由静态函数完成，可在备份线程中执行。
+ *      恢复时 replay() 将日志中已提交的变更应用到基准文件，生成完整的备份文件。
+ *
+ *      日志文件为基准文件同目录下的隐藏文件，格式如下:
+ *          头部: 标识 版本 编码 是否使用Windows换行符 基准文本长度 基准文件大小
+ *          记录: ERecordReplace 起始位置 替换长度 替换文本 ... ERecordCommit 提交后文本长度
+ *      仅应用到最后一个完整的提交记录，追加过程中断时不会应用不完整的数据。
+ */
+class BackupJournal : public QObject
+{
+    Q_OBJECT
+public:
+    enum JournalParam {
+        EMinCompactSize = 4 * 1024 * 1024,  // 日志文件超过此大小且超过基准文本长度时压缩
+        EMaxDirtyRanges = 1024,             // 变更区域超过此数量时全量备份
+    };
+
+    // 替换记录，按位置顺序应用
+    struct Record {
+        qint64 start;           // 替换位置
+        qint64 baseLength;      // 替换长度
+        QString text;           // 替换文本
+    };
+
+    explicit BackupJournal(QTextDocument *document, QObject *parent = nullptr);
+    ~BackupJournal() override;
+
+    // 基准文件 basePath 将全量写入，重新开始记录变更
+    void checkpoint(const QString &basePath, const QString &encode, bool windowsEndline);
+    // 是否可向基准文件 basePath 的日志追加变更，否则需全量备份
+    bool canAppend(const QString &basePath, const QString &encode, bool windowsEndline) const;
+    // 是否存在未写入日志的变更
+    bool hasPendingChanges() const;
+    // 取得变更区域的替换记录并清空变更区域
+    QVector<Record> takeRecords();
+    // 当前文档文本长度
+    qint64 length() const;
+    // 基准文件路径
+    QString basePath() const;
+    // 基准文件 basePath 被其它方式写入时，丢弃对应的日志
+    void discard(const QString &basePath);
+    // 停止记录变更，下次备份时需全量写入
+    void invalidate();
+    bool isValid() const;
+
+    // 日志文件路径
+    static QString journalPath(const QString &basePath);
+    // 基准文件 basePath 全量写入后，重新写入日志文件头部，可在其它线程调用
+    static bool writeHeader(const QString &basePath, const QString &encode, bool windowsEndline, qint64 baseLength);
+    // 校验日志头部与基准文件一致后追加替换记录，可在其它线程调用
+    static bool appendRecords(const QString &basePath, const QVector<Record> &records, qint64 length);
+    // 将日志应用到基准文件 basePath 并删除日志，返回是否存在并应用了日志
+    static bool replay(const QString &basePath);
+
+public slots:
+    // 记录文档变更
+    void recordChange(int from, int charsRemoved, int charsAdded);
+
+private:
+    // 文档 [from, from + length] 范围内的文本块是否在本次编辑中修改了文本
+    bool isTextChanged(int from, int length) const;
+
+private:
+    // 变更区域，start / length 为当前文档中的位置，baseLength 为上次写入日志时对应区域的长度
+    struct DirtyRange {
+        qint64 start;
+        qint64 length;
+        qint64 baseLength;
+    };
+
+    QTextDocument *m_document = nullptr;    // 记录变更的文档
+    QVector<DirtyRange> m_ranges;           // 按位置排序且互不相邻的变更区域
+    QString m_basePath;                     // 基准文件路径
+    QString m_encode;                       // 基准文件编码
+    bool m_windowsEndline = false;          // 基准文件是否使用Windows换行符
+    bool m_valid = false;                   // 变更记录是否有效
+    qint64 m_length = 0;                    // 当前文档文本长度
+    qint64 m_journalSize = 0;               // 已追加到日志的数据量(估算)
+};
+
+#endif // BACKUPJOURNAL_H
@@ -0,0 +1,167 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "backupworker.h"
+#include "textfilewriter.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QMutexLocker>
+
+BackupWorker *BackupWorker::instance()
+{
+    static BackupWorker *s_instance = nullptr;
+    if (nullptr == s_instance) {
+        s_instance = new BackupWorker;
+        // 程序退出前写入剩余的备份数据
+        if (qApp) {
+            connect(qApp, &QCoreApplication::aboutToQuit, s_instance, &BackupWorker::stop, Qt::DirectConnection);
+        }
+        s_instance->start(QThread::LowPriority);
+    }
+
+    return s_instance;
+}
+
+BackupWorker::BackupWorker(QObject *parent)
+    : QThread(parent)
+{
+}
+
+BackupWorker::~BackupWorker()
+{
+    stop();
+}
+
+/**
+ * @brief 添加备份任务 \a task 。全量备份包含完整的文档内容，替换同一备份文件所有未执行的任务；
+ *      日志追加紧跟在同一备份文件的另一日志追加任务后时，合并替换记录，按顺序应用的结果不变。
+ */
+void BackupWorker::enqueue(const Task &task)
+{
+    QMutexLocker locker(&m_mutex);
+    if (FullBackup == task.type) {
+        for (auto it = m_tasks.begin(); it != m_tasks.end();) {
+            if (it->basePath == task.basePath) {
+                it = m_tasks.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    } else {
+        for (int i = m_tasks.size() - 1; i >= 0; --i) {
+            Task &pending = m_tasks[i];
+            if (pending.basePath != task.basePath) {
+                continue;
+            }
+
+            if (JournalAppend == pending.type) {
+                pending.records += task.records;
+                pending.length = task.length;
+                return;
+            }
+            break;
+        }
+    }
+
+    m_tasks.append(task);
+    m_taskCondition.wakeOne();
+}
+
+/**
+ * @brief 备份文件 \a basePath 将被删除时，丢弃其未执行的全量备份及日志追加任务；
+ *      正在执行同一文件的任务时等待其完成，返回后删除的备份文件不会再被写入
+ */
+void BackupWorker::cancel(const QString &basePath)
+{
+    QMutexLocker locker(&m_mutex);
+    for (auto it = m_tasks.begin(); it != m_tasks.end();) {
+        if (it->basePath == basePath) {
+            it = m_tasks.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    while (isRunning() && m_busy && m_currentPath == basePath) {
+        m_idleCondition.wait(&m_mutex);
+    }
+}
+
+int BackupWorker::pendingCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_tasks.size();
+}
+
+void BackupWorker::waitForIdle()
+{
+    QMutexLocker locker(&m_mutex);
+    while (isRunning() && (m_busy || !m_tasks.isEmpty())) {
+        m_idleCondition.wait(&m_mutex);
+    }
+}
+
+void BackupWorker::stop()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stop = true;
+        m_taskCondition.wakeAll();
+    }
+    wait();
+}
+
+void BackupWorker::run()
+{
+    forever {
+        Task task;
+        {
+            QMutexLocker locker(&m_mutex);
+            while (!m_stop && m_tasks.isEmpty()) {
+                m_taskCondition.wait(&m_mutex);
+            }
+            if (m_tasks.isEmpty()) {
+                m_idleCondition.wakeAll();
+                break;
+            }
+            task = m_tasks.takeFirst();
+            m_busy = true;
+            m_currentPath = task.basePath;
+        }
+
+        bool ok = process(task);
+        emit sigBackupFinished(task.basePath, ok);
+
+        QMutexLocker locker(&m_mutex);
+        m_busy = false;
+        m_currentPath.clear();
+        m_idleCondition.wakeAll();
+    }
+}
+
+/**
+ * @brief 执行备份任务，全量备份先写入备份文件再重新写入日志头部，
+ *      写入过程中断时日志头部记录的文件大小与备份文件不一致，恢复时丢弃日志
+ */
+bool BackupWorker::process(const Task &task)
+{
+    // 捕获可能出现的 std::bad_alloc() 异常，防止闪退。
+    try {
+        if (FullBackup == task.type) {
+            TextFileWriter writer(task.snapshot, task.encode, task.windowsEndline);
+            if (!writer.save(task.basePath)) {
+                qWarning() << Q_FUNC_INFO << "Save backup file failed, " << writer.errorString();
+                return false;
+            }
+            return BackupJournal::writeHeader(task.basePath, task.encode, task.windowsEndline, task.length);
+        }
+
+        return BackupJournal::appendRecords(task.basePath, task.records, task.length);
+    } catch (const std::exception &e) {
+        qWarning() << Q_FUNC_INFO << "Backup file error, " << QString(e.what());
+    }
+
+    return false;
+}
@@ -0,0 +1,76 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef BACKUPWORKER_H
+#define BACKUPWORKER_H
+
+#include "backupjournal.h"
+#include "textfilewriter.h"
+
+#include <QThread>
+#include <QList>
+#include <QMutex>
+#include <QWaitCondition>
+
+/**
+ * @brief 自动备份线程，界面线程仅取得文档快照或增量日志记录，编码转换及文件写入在备份线程中执行。
+ *      同一备份文件的任务会合并：新的全量备份替换尚未执行的任务，连续的日志追加合并为一次写入。
+ *      程序退出时处理完剩余的任务后结束线程。
+ */
+class BackupWorker : public QThread
+{
+    Q_OBJECT
+public:
+    enum TaskType {
+        FullBackup,         // 全量写入备份文件并重新写入日志头部
+        JournalAppend,      // 追加增量日志
+    };
+
+    struct Task {
+        TaskType type = FullBackup;
+        QString basePath;                           // 备份文件路径
+        QString encode;                             // 备份文件编码
+        bool windowsEndline = false;                // 是否使用Windows换行符
+        TextFileWriter::BlockSnapshot snapshot;     // 全量备份的文档快照
+        QVector<BackupJournal::Record> records;     // 增量日志记录
+        qint64 length = 0;                          // 备份后的文本长度
+    };
+
+    static BackupWorker *instance();
+    ~BackupWorker() override;
+
+    // 添加备份任务，与未执行的同一备份文件的任务合并
+    void enqueue(const Task &task);
+    // 取消备份文件 basePath 未执行的任务，并等待正在执行的同一文件的任务完成
+    void cancel(const QString &basePath);
+    // 未执行的任务数量
+    int pendingCount() const;
+    // 等待已添加的任务执行完成
+    void waitForIdle();
+    // 处理完剩余任务后结束线程
+    void stop();
+
+signals:
+    // 备份任务执行完成，失败时需重新全量备份
+    void sigBackupFinished(const QString &basePath, bool success);
+
+protected:
+    void run() override;
+
+private:
+    explicit BackupWorker(QObject *parent = nullptr);
+    // 执行备份任务
+    bool process(const Task &task);
+
+private:
+    mutable QMutex m_mutex;
+    QWaitCondition m_taskCondition;     // 有新任务或结束线程
+    QWaitCondition m_idleCondition;     // 单个任务执行完成
+    QList<Task> m_tasks;                // 未执行的任务
+    bool m_busy = false;                // 是否正在执行任务
+    QString m_currentPath;              // 正在执行的任务的备份文件路径
+    bool m_stop = false;                // 是否结束线程
+};
+
+#endif // BACKUPWORKER_H
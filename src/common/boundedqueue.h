@@ -0,0 +1,114 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef BOUNDEDQUEUE_H
+#define BOUNDEDQUEUE_H
+
+#include <QQueue>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QWaitCondition>
+
+/**
+ * @brief 有界阻塞队列，用于连接文件加载流水线中的各个处理阶段。
+ *      队列满时 push() 阻塞生产者，队列空时 pop() 阻塞消费者，以此实现背压；
+ *      close() 后所有等待的线程被唤醒，push() 返回 false ，pop() 在取完剩余数据后返回 false 。
+ */
+template <typename T>
+class BoundedQueue
+{
+public:
+    explicit BoundedQueue(int capacity)
+        : m_capacity(qMax(1, capacity))
+    {
+    }
+
+    // 阻塞追加数据，队列已关闭时返回 false
+    bool push(const T &item)
+    {
+        QMutexLocker locker(&m_mutex);
+        while (!m_closed && m_queue.size() >= m_capacity) {
+            m_notFull.wait(&m_mutex);
+        }
+        if (m_closed) {
+            return false;
+        }
+
+        m_queue.enqueue(item);
+        m_notEmpty.wakeOne();
+        return true;
+    }
+
+    // 阻塞取出数据，队列已关闭且为空时返回 false
+    bool pop(T &item)
+    {
+        QMutexLocker locker(&m_mutex);
+        while (!m_closed && m_queue.isEmpty()) {
+            m_notEmpty.wait(&m_mutex);
+        }
+        if (m_queue.isEmpty()) {
+            return false;
+        }
+
+        item = m_queue.dequeue();
+        m_notFull.wakeOne();
+        return true;
+    }
+
+    // 非阻塞取出数据，无数据时返回 false ，用于界面线程
+    bool tryPop(T &item)
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_queue.isEmpty()) {
+            return false;
+        }
+
+        item = m_queue.dequeue();
+        m_notFull.wakeOne();
+        return true;
+    }
+
+    // 关闭队列，唤醒所有等待的线程
+    void close()
+    {
+        QMutexLocker locker(&m_mutex);
+        m_closed = true;
+        m_notFull.wakeAll();
+        m_notEmpty.wakeAll();
+    }
+
+    // 关闭队列并丢弃未处理的数据
+    void abort()
+    {
+        QMutexLocker locker(&m_mutex);
+        m_closed = true;
+        m_queue.clear();
+        m_notFull.wakeAll();
+        m_notEmpty.wakeAll();
+    }
+
+    bool isClosed() const
+    {
+        QMutexLocker locker(&m_mutex);
+        return m_closed;
+    }
+
+    int size() const
+    {
+        QMutexLocker locker(&m_mutex);
+        return m_queue.size();
+    }
+
+private:
+    Q_DISABLE_COPY(BoundedQueue)
+
+    const int m_capacity;
+    bool m_closed = false;
+    QQueue<T> m_queue;
+    mutable QMutex m_mutex;
+    QWaitCondition m_notFull;
+    QWaitCondition m_notEmpty;
+};
+
+#endif // BOUNDEDQUEUE_H
@@ -14,6 +14,7 @@
 const QString g_keyDisableImproveGB18030 = "disableImproveGB18030";
 const QString g_keyDefaultEncoding = "defaultEncoding";
 const QString g_keyEnablePatchedIconv = "enablePatchedIconv";
+const QString g_keyLargeFileViewSize = "largeFileViewSize";
 #endif
 
 /**
@@ -77,6 +78,9 @@ Config::Config(QObject *parent)
         encoding = dconfig->value(g_keyDefaultEncoding).toByteArray().toUpper();
         qInfo() << qPrintable("DConfig::defaultEncoding") << encoding;
 
+        largeFileViewSize = dconfig->value(g_keyLargeFileViewSize, largeFileViewSize).toInt();
+        qInfo() << qPrintable("DConfig::largeFileViewSize") << largeFileViewSize;
+
         connect(dconfig, &DConfig::valueChanged, this, [this](const QString &key) {
             if (key == g_keyDisableImproveGB18030) {
                 this->improveGB18030 = !this->dconfig->value(g_keyDisableImproveGB18030).toBool();
@@ -87,6 +91,9 @@ Config::Config(QObject *parent)
             } else if (key == g_keyDefaultEncoding) {
                 this->encoding = dconfig->value(g_keyDefaultEncoding).toByteArray().toUpper();
                 qInfo() << qPrintable("DConfig::defaultEncoding changed:") << encoding;
+            } else if (key == g_keyLargeFileViewSize) {
+                this->largeFileViewSize = dconfig->value(g_keyLargeFileViewSize).toInt();
+                qInfo() << qPrintable("DConfig::largeFileViewSize changed:") << largeFileViewSize;
             }
         });
 
@@ -140,3 +147,12 @@ QByteArray Config::defaultEncoding() const
 {
     return encoding.isEmpty() ? QByteArray("UTF-8") : encoding;
 }
+
+/**
+   @return 返回使用只读大文件视图打开的文件大小阈值(字节)，超过此大小的 UTF-8 文件不加载到文档，
+    仅映射文件并显示可见的行，默认512MB，返回0表示不使用
+ */
+qint64 Config::largeFileViewThreshold() const
+{
+    return qMax(0, largeFileViewSize) * Q_INT64_C(1024) * 1024;
+}
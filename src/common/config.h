@@ -24,6 +24,7 @@ public:
     bool enableImproveGB18030() const;
     bool enablePatchedIconv() const;
     QByteArray defaultEncoding() const;
+    qint64 largeFileViewThreshold() const;
 
 private:
 #ifdef DTKCORE_CLASS_DConfigFile
@@ -33,6 +34,7 @@ private:
     bool patchedIconv = false;   ///< 默认不再使用上层修改的iconv
     bool iocnvUse2005Standard = false;  ///< 检测当前iconv使用的GB18030编码是否为2005标准(2005标准强制使用上层补丁版本)
     QByteArray encoding;  ///< 缺省编码设置
+    int largeFileViewSize = 512;  ///< 超过此大小(MB)的文件使用只读的大文件视图打开，0表示不使用
 };
 
 #endif  // CONFIG_H
@@ -4,19 +4,66 @@
 
 #include "fileloadthread.h"
 #include "utils.h"
+#include "config.h"
+#include "piecetable.h"
 #include "../encodes/detectcode.h"
+#include "../encodes/streamtranscoder.h"
 #include <QFile>
 #include <QDebug>
+#include <QTextCodec>
+#include <QtConcurrent>
+
+enum StreamLoadParam {
+    EMaxDirectReadLen = 40 * DATA_SIZE_1024 * DATA_SIZE_1024,  // 超过40MB的文件使用流式加载
+    EMapPageSize = DATA_SIZE_1024 * DATA_SIZE_1024,            // 单次映射的文件数据长度
+    EMaxPendingChunks = 4,                                     // 各阶段间最多缓存的数据块数量
+};
 
 FileLoadThread::FileLoadThread(const QString &filepath, QObject *parent)
     : QThread(parent),
-      m_strFilePath(filepath)
+      m_strFilePath(filepath),
+      m_bCancel(0),
+      m_rawQueue(EMaxPendingChunks),
+      m_textQueue(EMaxPendingChunks)
 {
 
 }
 
 FileLoadThread::~FileLoadThread()
 {
+    // 释放未被取出的片段表
+    delete m_pPieceTable;
+}
+
+/**
+ * @brief 取消流式加载，读取及解码阶段将在处理完当前数据块后退出
+ */
+void FileLoadThread::cancel()
+{
+    m_bCancel.storeRelease(1);
+    m_detector.cancel();
+    // 丢弃未处理的数据并唤醒等待中的线程
+    m_rawQueue.abort();
+    m_textQueue.abort();
+}
+
+/**
+ * @brief 界面线程取出解码完成的数据块 \a chunk ，取出后解码阶段可继续处理下一块数据
+ * @return 是否取得数据块
+ */
+bool FileLoadThread::takeChunk(StreamChunk &chunk)
+{
+    return m_textQueue.tryPop(chunk);
+}
+
+/**
+ * @brief 界面线程在 sigPieceTableReady() 后取出片段表，调用方取得所有权
+ */
+PieceTable *FileLoadThread::takePieceTable()
+{
+    PieceTable *table = m_pPieceTable;
+    m_pPieceTable = nullptr;
+    return table;
 }
 
 void FileLoadThread::run()
@@ -28,14 +75,38 @@ void FileLoadThread::run()
         QByteArray indata;
 
         // 判断文件大小是否超过40MB, 超过40MB的文件过大，需要调整读取策略，优先加载头部文件
-        static const int s_maxDirectReadLen = 40 * DATA_SIZE_1024 * DATA_SIZE_1024;
-        if (file.size() > s_maxDirectReadLen) {
+        if (file.size() > EMaxDirectReadLen) {
             // 先读取1MB数据
             indata = file.read(DATA_SIZE_1024 * DATA_SIZE_1024);
-            encode = DetectCode::GetFileEncodingFormat(m_strFilePath, indata);
+            encode = detectEncoding(indata);
+            if (m_bCancel.loadAcquire()) {
+                file.close();
+                this->quit();
+                this->deleteLater();
+                return;
+            }
 
-            // 发送文件头信息，用于预先加载数据
+            // 超大的 UTF-8 文件使用只读的大文件视图，文件数据不加载到文档
+            if (loadPieceTable(file.size(), encode)) {
+                file.close();
+                this->quit();
+                this->deleteLater();
+                return;
+            }
+
+            // 兼容 ASCII 的编码(换行符不会出现在多字节字符中)使用内存映射流式加载，
+            // 文件数据不再整体读入内存，UTF-16/UTF-32 编码仍使用整体读取
             QString textEncode = QString::fromLocal8Bit(encode);
+            if (!textEncode.startsWith("UTF-16", Qt::CaseInsensitive)
+                    && !textEncode.startsWith("UTF-32", Qt::CaseInsensitive)
+                    && loadByMapping(file, encode)) {
+                file.close();
+                this->quit();
+                this->deleteLater();
+                return;
+            }
+
+            // 发送文件头信息，用于预先加载数据
             if (textEncode.contains("ASCII", Qt::CaseInsensitive) || textEncode.contains("UTF-8", Qt::CaseInsensitive)) {
                 emit sigPreProcess(encode, indata);
             } else {
@@ -59,14 +130,13 @@ void FileLoadThread::run()
         }
 
         if (encode.isEmpty()) {
-            //编码识别，如果文件数据大于1M，则只裁剪出1M文件数据去做编码探测
-            QByteArray dateUsedForCodeIdentify;
-            if (indata.length() > DATA_SIZE_1024 * DATA_SIZE_1024) {
-                dateUsedForCodeIdentify = indata.mid(0, DATA_SIZE_1024 * DATA_SIZE_1024);
-            } else {
-                dateUsedForCodeIdentify = indata;
+            //编码识别，最多使用1M文件数据去做编码探测
+            encode = detectEncoding(indata);
+            if (m_bCancel.loadAcquire()) {
+                this->quit();
+                this->deleteLater();
+                return;
             }
-            encode = DetectCode::GetFileEncodingFormat(m_strFilePath, dateUsedForCodeIdentify);
         }
 
         QString textEncode = QString::fromLocal8Bit(encode);
@@ -82,3 +152,241 @@ void FileLoadThread::run()
     this->quit();
     this->deleteLater();
 }
+
+/**
+ * @brief 增量识别数据 \a content 的编码，识别结果确定后不再处理剩余数据，取消加载时中止识别
+ * @return 识别的编码，取消时返回空
+ */
+QByteArray FileLoadThread::detectEncoding(const QByteArray &content)
+{
+    static const int s_feedStep = 64 * DATA_SIZE_1024;
+    int length = qMin(content.size(), DATA_SIZE_1024 * DATA_SIZE_1024);
+
+    m_detector.reset();
+    for (int offset = 0; offset < length && !m_bCancel.loadAcquire(); offset += s_feedStep) {
+        if (m_detector.feed(content.constData() + offset, qMin(s_feedStep, length - offset))) {
+            break;
+        }
+    }
+
+    return m_detector.finish();
+}
+
+/**
+ * @brief 文件大小 \a fileSize 超过大文件视图阈值且为 UTF-8 (或 ASCII)编码时，将文件只读映射到片段表，
+ *      由界面线程使用大文件视图仅显示可见的行，内存占用与文件大小无关。
+ *      其它编码的文件需转码后才能按行显示，仍加载到文档。
+ * @return 是否已使用片段表打开文件，取消加载时同样返回 true
+ */
+bool FileLoadThread::loadPieceTable(qint64 fileSize, const QByteArray &encode)
+{
+    const qint64 threshold = Config::instance()->largeFileViewThreshold();
+    const QString textEncode = QString::fromLocal8Bit(encode);
+    if (threshold <= 0 || fileSize < threshold
+            || !(textEncode.contains("ASCII", Qt::CaseInsensitive) || textEncode.contains("UTF-8", Qt::CaseInsensitive))) {
+        return false;
+    }
+
+    PieceTable *table = new PieceTable;
+    if (!table->openFile(m_strFilePath)) {
+        delete table;
+        return false;
+    }
+
+    if (m_bCancel.loadAcquire()) {
+        delete table;
+        return true;
+    }
+
+    m_pPieceTable = table;
+    emit sigPieceTableReady(encode);
+    return true;
+}
+
+/**
+ * @brief 使用内存映射逐页读取文件 \a file ，加载过程分为三个阶段：
+ *      1. 读取：当前线程逐页映射文件，在换行符处截断后放入解码队列；
+ *      2. 解码：线程池中将数据块转换为文本后放入插入队列，并通知界面线程；
+ *      3. 插入：界面线程取出文本追加到文档末尾。
+ *      各阶段通过有界队列连接，队列满时上游阶段阻塞等待，内存中仅保留少量待处理的数据块，
+ *      解码下一块数据的同时界面线程可插入当前数据块。
+ * @param file      已打开的文件
+ * @param encode    文件编码
+ * @return 是否使用流式加载，首次映射失败时返回 false
+ */
+bool FileLoadThread::loadByMapping(QFile &file, const QByteArray &encode)
+{
+    const qint64 fileSize = file.size();
+    const QString textEncode = QString::fromLocal8Bit(encode);
+    const bool isUtf8 = textEncode.contains("ASCII", Qt::CaseInsensitive) || textEncode.contains("UTF-8", Qt::CaseInsensitive);
+
+    qint64 offset = 0;
+    bool error = false;
+    bool streamBegin = false;
+    QFuture<bool> decodeFuture;
+
+    while (offset < fileSize && !m_bCancel.loadAcquire()) {
+        qint64 mapLen = qMin<qint64>(EMapPageSize, fileSize - offset);
+        uchar *mapData = file.map(offset, mapLen);
+        if (!mapData) {
+            if (!streamBegin) {
+                qWarning() << Q_FUNC_INFO << "Map file data failed, " << file.errorString();
+                return false;
+            }
+
+            error = true;
+            break;
+        }
+
+        if (!streamBegin) {
+            streamBegin = true;
+            emit sigStreamBegin(encode);
+            // 启动解码阶段
+            decodeFuture = QtConcurrent::run(this, &FileLoadThread::decodeStage, textEncode, fileSize);
+        }
+
+        // 非末尾数据块在最后一个换行符处截断
+        qint64 chunkLen = mapLen;
+        if (offset + mapLen < fileSize) {
+            chunkLen = findChunkBoundary(mapData, mapLen, isUtf8);
+        }
+
+        StreamChunk chunk;
+        // 捕获可能出现的 std::bad_alloc() 异常，防止闪退。
+        try {
+            chunk.data = QByteArray(reinterpret_cast<const char *>(mapData), static_cast<int>(chunkLen));
+        } catch (const std::exception &e) {
+            qWarning() << Q_FUNC_INFO << "Read file data error, " << QString(e.what());
+            error = true;
+        }
+
+        file.unmap(mapData);
+        if (error) {
+            break;
+        }
+        offset += chunkLen;
+        chunk.readSize = offset;
+
+        // 交由解码阶段处理，队列已满时等待，队列关闭(取消加载)时退出
+        if (!m_rawQueue.push(chunk)) {
+            break;
+        }
+    }
+
+    // 通知解码阶段数据已读取完成，等待剩余数据处理结束
+    m_rawQueue.close();
+    decodeFuture.waitForFinished();
+    if (streamBegin && !decodeFuture.result()) {
+        error = true;
+    }
+
+    emit sigStreamFinished(encode, error);
+    return true;
+}
+
+/**
+ * @brief 解码阶段，从解码队列中取出文件数据，按编码 \a textEncode 转换为文本后放入插入队列。
+ *      使用带状态的解码器，跨数据块的多字节字符也可以正确解码。
+ * @param textEncode    文件编码
+ * @param totalSize     文件总长度
+ * @return 是否解码成功
+ */
+bool FileLoadThread::decodeStage(const QString &textEncode, qint64 totalSize)
+{
+    const bool isUtf8 = textEncode.contains("ASCII", Qt::CaseInsensitive) || textEncode.contains("UTF-8", Qt::CaseInsensitive);
+    QTextCodec *codec = QTextCodec::codecForName("UTF-8");
+    if (!codec) {
+        qInfo() << "QTextCodec::codecForName \"UTF-8\" return nullptr";
+        m_rawQueue.abort();
+        m_textQueue.close();
+        return false;
+    }
+    QScopedPointer<QTextDecoder> decoder(codec->makeDecoder());
+    // 非 UTF-8 编码使用流式转换，跨数据块的多字节字符保留到下一数据块转换
+    QScopedPointer<StreamTranscoder> transcoder;
+    if (!isUtf8) {
+        transcoder.reset(new StreamTranscoder(textEncode, QString("UTF-8")));
+    }
+
+    StreamChunk chunk;
+    while (m_rawQueue.pop(chunk)) {
+        // 捕获可能出现的 std::bad_alloc() 异常，防止闪退。
+        try {
+            if (!isUtf8) {
+                QByteArray outData;
+                if (transcoder->isValid()) {
+                    transcoder->convert(chunk.data, outData);
+                } else {
+                    DetectCode::ChangeFileEncodingFormat(chunk.data, outData, textEncode, QString("UTF-8"));
+                }
+                chunk.data = outData;
+            }
+            chunk.text = decoder->toUnicode(chunk.data);
+            chunk.data.clear();
+        } catch (const std::exception &e) {
+            qWarning() << Q_FUNC_INFO << "Decode file data error, " << QString(e.what());
+            m_rawQueue.abort();
+            m_textQueue.close();
+            return false;
+        }
+
+        // 队列已满时等待界面线程插入，队列关闭(取消加载)时退出
+        if (!m_textQueue.push(chunk)) {
+            break;
+        }
+        emit sigStreamChunkReady(totalSize);
+    }
+
+    // 文件末尾存在不完整的字符时，替换后作为最后的数据块
+    if (transcoder && transcoder->pendingSize() > 0 && !m_bCancel.loadAcquire()) {
+        QByteArray outData;
+        transcoder->finish(outData);
+
+        StreamChunk tailChunk;
+        tailChunk.text = decoder->toUnicode(outData);
+        tailChunk.readSize = totalSize;
+        if (m_textQueue.push(tailChunk)) {
+            emit sigStreamChunkReady(totalSize);
+        }
+    }
+
+    m_textQueue.close();
+    return true;
+}
+
+/**
+ * @brief 查找数据块 \a data 的截断位置，优先在最后一个换行符后截断；
+ *      若数据块内不存在换行符且为 UTF-8 编码，回退到完整的字符边界。
+ * @param data      数据块
+ * @param len       数据块长度
+ * @param isUtf8    是否为 UTF-8 编码
+ * @return 截断后的数据长度
+ */
+qint64 FileLoadThread::findChunkBoundary(const uchar *data, qint64 len, bool isUtf8)
+{
+    for (qint64 i = len - 1; i >= 0; --i) {
+        if ('\n' == data[i]) {
+            return i + 1;
+        }
+    }
+
+    if (!isUtf8 || len <= 0) {
+        return len;
+    }
+
+    // 向前查找最后一个字符的首字节(至多回退3个后续字节)
+    qint64 pos = len - 1;
+    int backCount = 0;
+    while (pos > 0 && backCount < 3 && 0x80 == (data[pos] & 0xC0)) {
+        --pos;
+        ++backCount;
+    }
+
+    uchar lead = data[pos];
+    qint64 charLen = lead >= 0xF0 ? 4 : (lead >= 0xE0 ? 3 : (lead >= 0xC0 ? 2 : 1));
+    if (pos + charLen > len && pos > 0) {
+        return pos;
+    }
+
+    return len;
+}
@@ -5,24 +5,69 @@
 #ifndef FILELOADTHREAD_H
 #define FILELOADTHREAD_H
 
+#include "boundedqueue.h"
+#include "../encodes/encodingdetector.h"
+
 #include <QThread>
+#include <QAtomicInt>
 
+class QFile;
+class PieceTable;
 class FileLoadThread : public QThread
 {
     Q_OBJECT
 public:
+    // 流式加载的数据块
+    struct StreamChunk {
+        QByteArray data;        // 文件原始数据
+        QString text;           // 解码后的文本
+        qint64 readSize = 0;    // 读取到当前数据块为止的文件数据长度
+    };
+
     FileLoadThread(const QString &filepath, QObject *QObject = nullptr);
     ~FileLoadThread();
 
     void run();
 
+    // 取消流式加载，标签页关闭时提前退出读取及解码阶段
+    void cancel();
+    // 界面线程取出解码完成的数据块，无数据时返回 false
+    bool takeChunk(StreamChunk &chunk);
+    // 界面线程取出大文件视图使用的片段表，调用方取得所有权
+    PieceTable *takePieceTable();
+
 signals:
     // 预处理信号，优先处理文件头，防止出现加载时间过长的情况
     void sigPreProcess(const QByteArray &encode, const QByteArray &content);
     void sigLoadFinished(const QByteArray &encode, const QByteArray &content, bool error = false);
 
+    // 流式加载信号，大文件通过内存映射分块读取，在解码阶段转换为文本后通知界面线程插入
+    void sigStreamBegin(const QByteArray &encode);
+    // 解码完成的数据块已放入队列，界面线程通过 takeChunk() 取出
+    void sigStreamChunkReady(qint64 totalSize);
+    void sigStreamFinished(const QByteArray &encode, bool error = false);
+    // 超大文件已映射到片段表，使用只读的大文件视图显示，界面线程通过 takePieceTable() 取出
+    void sigPieceTableReady(const QByteArray &encode);
+
+private:
+    // 增量识别文件编码，取消加载时返回空
+    QByteArray detectEncoding(const QByteArray &content);
+    // 使用内存映射分块读取文件，映射失败时返回 false ，由调用方回退到整体读取
+    bool loadByMapping(QFile &file, const QByteArray &encode);
+    // 超过大文件视图阈值的文件映射到片段表，不加载到文档，返回是否已处理
+    bool loadPieceTable(qint64 fileSize, const QByteArray &encode);
+    // 解码阶段，在线程池中将读取的数据块转换为文本
+    bool decodeStage(const QString &textEncode, qint64 totalSize);
+    // 查找数据块的截断位置，保证不会分割多字节字符
+    static qint64 findChunkBoundary(const uchar *data, qint64 len, bool isUtf8);
+
 private:
     QString m_strFilePath;
+    QAtomicInt m_bCancel;                       // 取消标识
+    EncodingDetector m_detector;                // 编码识别
+    BoundedQueue<StreamChunk> m_rawQueue;       // 读取阶段 -> 解码阶段
+    BoundedQueue<StreamChunk> m_textQueue;      // 解码阶段 -> 界面插入阶段
+    PieceTable *m_pPieceTable = nullptr;        // 大文件视图使用的片段表
 };
 
 #endif
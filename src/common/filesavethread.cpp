@@ -0,0 +1,59 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "filesavethread.h"
+#include "textfilewriter.h"
+
+#include <QDebug>
+
+FileSaveThread::FileSaveThread(const QString &filePath, const TextFileWriter::BlockSnapshot &snapshot, const QString &encode,
+                               bool windowsEndline, QObject *parent)
+    : QThread(parent)
+    , m_filePath(filePath)
+    , m_snapshot(snapshot)
+    , m_encode(encode)
+    , m_windowsEndline(windowsEndline)
+{
+}
+
+FileSaveThread::~FileSaveThread()
+{
+}
+
+void FileSaveThread::run()
+{
+    TextFileWriter writer(m_snapshot, m_encode, m_windowsEndline);
+    // 快照仅由写入器持有，写入时逐块释放
+    m_snapshot.clear();
+
+    int lastProgress = -1;
+    writer.setProgressCallback([this, &lastProgress](qint64 written, qint64 total) {
+        int progress = total > 0 ? static_cast<int>(written * 100 / total) : 100;
+        // 进度变化时才通知界面线程
+        if (progress != lastProgress) {
+            lastProgress = progress;
+            emit sigSaveProgress(progress);
+        }
+    });
+
+    // 捕获可能出现的 std::bad_alloc() 异常，防止闪退。
+    bool ok = false;
+    try {
+        ok = writer.save(m_filePath);
+    } catch (const std::exception &e) {
+        qWarning() << Q_FUNC_INFO << "Save file error, " << QString(e.what());
+    }
+
+    emit sigSaveFinished(ok, TextFileWriter::OpenError == writer.error(), writer.errorString());
+}
+
+QString FileSaveThread::filePath() const
+{
+    return m_filePath;
+}
+
+QString FileSaveThread::encode() const
+{
+    return m_encode;
+}
@@ -0,0 +1,43 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef FILESAVETHREAD_H
+#define FILESAVETHREAD_H
+
+#include "textfilewriter.h"
+
+#include <QThread>
+#include <QString>
+
+/**
+ * @brief 后台保存文件线程，使用文档内容快照进行编码转换及写入，保存期间界面线程可继续编辑。
+ *      文件通过 QSaveFile 原子写入并在提交前同步到磁盘。
+ */
+class FileSaveThread : public QThread
+{
+    Q_OBJECT
+public:
+    FileSaveThread(const QString &filePath, const TextFileWriter::BlockSnapshot &snapshot, const QString &encode,
+                   bool windowsEndline, QObject *parent = nullptr);
+    ~FileSaveThread() override;
+
+    void run() override;
+
+    QString filePath() const;
+    QString encode() const;
+
+signals:
+    // 保存进度(0~100)
+    void sigSaveProgress(int progress);
+    // 保存完成，openFailed 标识文件是否打开失败(无权限等)
+    void sigSaveFinished(bool success, bool openFailed, const QString &errorString);
+
+private:
+    QString m_filePath;         // 保存的文件路径
+    TextFileWriter::BlockSnapshot m_snapshot;   // 按文本块取得的文档内容快照
+    QString m_encode;           // 文件编码
+    bool m_windowsEndline;      // 是否使用 Windows 换行符
+};
+
+#endif // FILESAVETHREAD_H
@@ -0,0 +1,314 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "foldersearch.h"
+#include "boundedqueue.h"
+#include "utils.h"
+#include "../encodes/encodingdetector.h"
+#include "../encodes/streamtranscoder.h"
+#include "../encodes/utf8scanner.h"
+
+#include <QDirIterator>
+#include <QFile>
+#include <QByteArrayMatcher>
+#include <QThread>
+#include <QtConcurrent>
+
+#include <cstring>
+#include <limits>
+
+/**
+ * @return 数据 \a data 是否以 UTF-16/UTF-32 的 BOM 头开始，此类文件包含 NUL 字节但不是二进制文件
+ */
+static bool hasWideByteOrderMark(const char *data, qint64 size)
+{
+    const uchar *head = reinterpret_cast<const uchar *>(data);
+    return size >= 2 && ((0xFF == head[0] && 0xFE == head[1]) || (0xFE == head[0] && 0xFF == head[1])
+                         || (size >= 4 && 0x00 == head[0] && 0x00 == head[1] && 0xFE == head[2] && 0xFF == head[3]));
+}
+
+// 单次查找的共享状态，遍历线程与各工作线程共同持有，查找被取消后由最后结束的线程释放
+struct FolderSearchContext {
+    explicit FolderSearchContext(int capacity)
+        : queue(capacity)
+    {
+    }
+
+    QString folder;
+    QString keyword;
+    TextSearchEngine::SearchFlags flags;
+    qint64 maxFileSize = 0;
+    int generation = 0;
+    BoundedQueue<QString> queue;        // 待查找的文件路径
+    QAtomicInt canceled;                // 取消标识
+    QAtomicInt activeWorkers;           // 未结束的工作线程数量
+    QAtomicInt scannedCount;            // 已查找的文件数量
+    QAtomicInt skippedCount;            // 编码无法识别或转换而跳过的文件数量
+};
+
+FolderSearch::FolderSearch(QObject *parent)
+    : QObject(parent)
+{
+    qRegisterMetaType<MultiDocumentSearch::FileResult>("MultiDocumentSearch::FileResult");
+    // 遍历线程及工作线程，单个文件不再分块并行查找
+    m_pool.setMaxThreadCount(qMax(1, QThread::idealThreadCount()) + 1);
+}
+
+FolderSearch::~FolderSearch()
+{
+    cancel();
+    m_pool.waitForDone();
+}
+
+/**
+ * @brief 在后台递归查找文件夹 \a folder 中的关键字 \a keyword 。遍历目录与查找文件同时进行，
+ *      路径队列有界，遍历较快时等待工作线程，大目录下内存占用可控。
+ */
+void FolderSearch::start(const QString &folder, const QString &keyword, TextSearchEngine::SearchFlags flags)
+{
+    cancel();
+
+    ++m_generation;
+    m_folder = folder;
+    m_keyword = keyword;
+    m_scannedCount = 0;
+    m_skippedCount = 0;
+    m_matchedFileCount = 0;
+    if (keyword.isEmpty() || folder.isEmpty()) {
+        return;
+    }
+
+    const int workerCount = qMax(1, m_pool.maxThreadCount() - 1);
+    m_context.reset(new FolderSearchContext(EQueueCapacity));
+    m_context->folder = folder;
+    m_context->keyword = keyword;
+    m_context->flags = flags;
+    m_context->maxFileSize = m_maxFileSize;
+    m_context->generation = m_generation;
+    m_context->activeWorkers.storeRelease(workerCount);
+    m_running = true;
+
+    QtConcurrent::run(&m_pool, &FolderSearch::walkFolder, m_context);
+    for (int i = 0; i < workerCount; ++i) {
+        QtConcurrent::run(&m_pool, this, &FolderSearch::searchWorker, m_context);
+    }
+}
+
+/**
+ * @brief 取消查找，丢弃队列中未查找的文件，正在查找的文件在下一次检查取消标识时中止
+ */
+void FolderSearch::cancel()
+{
+    if (m_context) {
+        m_context->canceled.storeRelease(1);
+        m_context->queue.abort();
+        m_context.clear();
+    }
+    m_running = false;
+}
+
+bool FolderSearch::isRunning() const
+{
+    return m_running;
+}
+
+QString FolderSearch::folder() const
+{
+    return m_folder;
+}
+
+QString FolderSearch::keyword() const
+{
+    return m_keyword;
+}
+
+void FolderSearch::setMaxFileSize(qint64 size)
+{
+    m_maxFileSize = size;
+}
+
+qint64 FolderSearch::maxFileSize() const
+{
+    return m_maxFileSize;
+}
+
+int FolderSearch::scannedCount() const
+{
+    return m_context ? m_context->scannedCount.loadAcquire() : m_scannedCount;
+}
+
+int FolderSearch::matchedFileCount() const
+{
+    return m_matchedFileCount;
+}
+
+int FolderSearch::skippedCount() const
+{
+    return m_context ? m_context->skippedCount.loadAcquire() : m_skippedCount;
+}
+
+/**
+ * @brief 查找文件 \a filePath 中的关键字 \a keyword 。文件内容通过 QFile::map() 映射，
+ *      开头 EBinaryCheckLength 字节内包含 NUL 字节且无 UTF-16/UTF-32 BOM 头的文件视为二进制文件跳过。
+ *      合法的 UTF-8 文件逐字区分大小写查找时，先在原始字节中查找 UTF-8 编码的关键字，未找到则无需解码；
+ *      其它编码的文件与打开文件时相同，使用 EncodingDetector 识别编码后通过 StreamTranscoder 转换，
+ *      行号及列号与编辑器打开后的位置一致。编码无法识别或转换的文件跳过，通过 \a skipped 返回。
+ */
+MultiDocumentSearch::FileResult FolderSearch::searchFile(const QString &filePath, const QString &keyword,
+                                                         TextSearchEngine::SearchFlags flags, const QAtomicInt *canceled,
+                                                         bool *skipped)
+{
+    MultiDocumentSearch::FileResult result;
+    result.filePath = filePath;
+    if (skipped) {
+        *skipped = false;
+    }
+    if (keyword.isEmpty() || !Utils::isMimeTypeSupport(filePath)) {
+        return result;
+    }
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return result;
+    }
+
+    const qint64 size = file.size();
+    if (size <= 0 || size > std::numeric_limits<int>::max()) {
+        return result;
+    }
+
+    // 部分文件系统不支持映射，回退为读取全部内容；映射的内存在 file 析构时释放
+    QByteArray buffer;
+    const char *data = reinterpret_cast<const char *>(file.map(0, size));
+    if (data == nullptr) {
+        buffer = file.readAll();
+        data = buffer.constData();
+        if (buffer.size() != size) {
+            return result;
+        }
+    }
+
+    if (!hasWideByteOrderMark(data, size)
+            && std::memchr(data, 0, static_cast<size_t>(qMin<qint64>(size, EBinaryCheckLength))) != nullptr) {
+        return result;
+    }
+
+    QByteArray encoding("UTF-8");
+    if (!Utf8Scanner::isValidUtf8(data, size)) {
+        encoding = EncodingDetector::detect(QByteArray::fromRawData(data, static_cast<int>(size)), EDetectLength);
+    }
+
+    QString text;
+    if ("UTF-8" == encoding) {
+        if (!flags.testFlag(TextSearchEngine::ECaseInsensitive) && !flags.testFlag(TextSearchEngine::ERegularExpression)) {
+            const QByteArrayMatcher matcher(keyword.toUtf8());
+            if (matcher.indexIn(data, static_cast<int>(size)) < 0) {
+                return result;
+            }
+        }
+
+        int start = 0;
+        if (size >= 3 && 0 == std::memcmp(data, "\xEF\xBB\xBF", 3)) {
+            start = 3;
+        }
+        text = QString::fromUtf8(data + start, static_cast<int>(size) - start);
+    } else {
+        StreamTranscoder transcoder(QString::fromLatin1(encoding), "UTF-8");
+        QByteArray utf8Data;
+        if (encoding.isEmpty() || !transcoder.convert(data, size, utf8Data) || !transcoder.finish(utf8Data)) {
+            if (skipped) {
+                *skipped = true;
+            }
+            return result;
+        }
+
+        text = QString::fromUtf8(utf8Data);
+        // 与打开文件时一致，不显示 BOM 头
+        if (text.startsWith(QChar(0xFEFF))) {
+            text.remove(0, 1);
+        }
+    }
+    if (canceled && canceled->loadAcquire()) {
+        return result;
+    }
+
+    const SearchResult searchResult = TextSearchEngine::search(text, keyword, flags, canceled, std::numeric_limits<int>::max());
+    if (canceled && canceled->loadAcquire()) {
+        return result;
+    }
+
+    result.matches = MultiDocumentSearch::createMatches(text, searchResult, EMaxFileMatches);
+    result.matchCount = searchResult.count();
+    return result;
+}
+
+/**
+ * @brief 递归遍历目录，跳过隐藏文件、隐藏目录、符号链接及超过大小限制的文件，遍历完成后关闭队列
+ */
+void FolderSearch::walkFolder(const QSharedPointer<FolderSearchContext> &context)
+{
+    QDirIterator it(context->folder, QDir::Files | QDir::NoDotAndDotDot | QDir::NoSymLinks, QDirIterator::Subdirectories);
+    while (it.hasNext() && !context->canceled.loadAcquire()) {
+        it.next();
+        const QFileInfo info = it.fileInfo();
+        if (info.size() > context->maxFileSize) {
+            continue;
+        }
+        if (!context->queue.push(info.absoluteFilePath())) {
+            break;
+        }
+    }
+
+    context->queue.close();
+}
+
+/**
+ * @brief 从队列中取出文件查找直至队列关闭，存在匹配项的文件通过队列连接通知界面线程
+ */
+void FolderSearch::searchWorker(const QSharedPointer<FolderSearchContext> &context)
+{
+    QString filePath;
+    while (!context->canceled.loadAcquire() && context->queue.pop(filePath)) {
+        bool skipped = false;
+        const MultiDocumentSearch::FileResult result = searchFile(filePath, context->keyword, context->flags, &context->canceled, &skipped);
+        context->scannedCount.fetchAndAddOrdered(1);
+        if (skipped) {
+            context->skippedCount.fetchAndAddOrdered(1);
+        }
+        if (!result.matches.isEmpty()) {
+            QMetaObject::invokeMethod(this, "onFileSearched", Qt::QueuedConnection, Q_ARG(int, context->generation),
+                                      Q_ARG(MultiDocumentSearch::FileResult, result));
+        }
+    }
+
+    if (!context->activeWorkers.deref()) {
+        QMetaObject::invokeMethod(this, "onSearchFinished", Qt::QueuedConnection, Q_ARG(int, context->generation),
+                                  Q_ARG(int, context->scannedCount.loadAcquire()), Q_ARG(int, context->skippedCount.loadAcquire()));
+    }
+}
+
+void FolderSearch::onFileSearched(int generation, const MultiDocumentSearch::FileResult &result)
+{
+    if (generation != m_generation || !m_running) {
+        return;
+    }
+
+    // 各文件按查找完成的顺序排列
+    MultiDocumentSearch::FileResult fileResult = result;
+    fileResult.index = m_matchedFileCount++;
+    emit sigFileResult(fileResult);
+}
+
+void FolderSearch::onSearchFinished(int generation, int scannedCount, int skippedCount)
+{
+    if (generation != m_generation || !m_running) {
+        return;
+    }
+
+    m_scannedCount = scannedCount;
+    m_skippedCount = skippedCount;
+    m_running = false;
+    m_context.clear();
+    emit sigFinished();
+}
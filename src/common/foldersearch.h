@@ -0,0 +1,93 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef FOLDERSEARCH_H
+#define FOLDERSEARCH_H
+
+#include "multidocumentsearch.h"
+
+#include <QObject>
+#include <QString>
+#include <QAtomicInt>
+#include <QSharedPointer>
+#include <QThreadPool>
+
+struct FolderSearchContext;
+
+/**
+ * @brief 在文件夹中查找。遍历线程递归遍历目录，将符合大小限制的文件路径放入有界队列，
+ *      多个工作线程从队列中取出文件，映射(mmap)文件内容后查找，存在匹配项的文件逐个通知结果。
+ *      跳过隐藏文件及目录、不支持的文件类型(Utils::isMimeTypeSupport())以及开头包含 NUL 字节的二进制文件。
+ *      UTF-8 文件逐字区分大小写查找时先在原始字节中查找 UTF-8 编码的关键字，未找到的文件无需解码；
+ *      其它编码的文件识别编码后转换查找，编码无法识别或转换的文件跳过并计数。
+ */
+class FolderSearch : public QObject
+{
+    Q_OBJECT
+public:
+    enum SearchParam {
+        EMaxFileSize = 64 * 1024 * 1024,    // 默认跳过超过此大小的文件
+        EMaxFileMatches = 1000,             // 单个文件最多记录行号及预览文本的匹配项数量
+        EBinaryCheckLength = 8 * 1024,      // 检测二进制文件时检查的开头字节数
+        EQueueCapacity = 4096,              // 等待查找的文件路径队列容量
+        EDetectLength = 64 * 1024,          // 识别非 UTF-8 文件编码时使用的最大数据长度
+    };
+
+    explicit FolderSearch(QObject *parent = nullptr);
+    ~FolderSearch() override;
+
+    // 在后台查找文件夹 folder 中所有文件的关键字 keyword ，之前未完成的查找将被取消
+    void start(const QString &folder, const QString &keyword, TextSearchEngine::SearchFlags flags);
+    // 取消查找
+    void cancel();
+    bool isRunning() const;
+
+    QString folder() const;
+    QString keyword() const;
+    // 跳过超过 size 字节的文件
+    void setMaxFileSize(qint64 size);
+    qint64 maxFileSize() const;
+    // 已查找的文件数量
+    int scannedCount() const;
+    // 存在匹配项的文件数量
+    int matchedFileCount() const;
+    // 编码无法识别或转换而跳过的文件数量
+    int skippedCount() const;
+
+    // 查找文件 filePath ，不支持的文件类型或二进制文件返回空结果，编码无法识别或转换时 skipped 返回 true
+    static MultiDocumentSearch::FileResult searchFile(const QString &filePath, const QString &keyword,
+                                                      TextSearchEngine::SearchFlags flags, const QAtomicInt *canceled = nullptr,
+                                                      bool *skipped = nullptr);
+
+signals:
+    // 文件 result.filePath 中存在匹配项
+    void sigFileResult(const MultiDocumentSearch::FileResult &result);
+    // 全部文件查找完成
+    void sigFinished();
+
+private slots:
+    // 工作线程通过队列连接调用，generation 用于丢弃已取消的查找的结果
+    void onFileSearched(int generation, const MultiDocumentSearch::FileResult &result);
+    void onSearchFinished(int generation, int scannedCount, int skippedCount);
+
+private:
+    // 遍历目录，将待查找的文件路径放入队列
+    static void walkFolder(const QSharedPointer<FolderSearchContext> &context);
+    // 从队列中取出文件查找，最后结束的工作线程通知查找完成
+    void searchWorker(const QSharedPointer<FolderSearchContext> &context);
+
+private:
+    QThreadPool m_pool;                                 // 遍历及查找线程池
+    QSharedPointer<FolderSearchContext> m_context;      // 当前查找的状态
+    QString m_folder;                                   // 查找的文件夹
+    QString m_keyword;                                  // 查找的关键字
+    qint64 m_maxFileSize = EMaxFileSize;                // 文件大小限制
+    int m_generation = 0;                               // 查找序号
+    bool m_running = false;                             // 是否正在查找
+    int m_scannedCount = 0;                             // 已查找的文件数量
+    int m_matchedFileCount = 0;                         // 存在匹配项的文件数量
+    int m_skippedCount = 0;                             // 跳过的文件数量
+};
+
+#endif // FOLDERSEARCH_H
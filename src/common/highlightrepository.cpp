@@ -0,0 +1,68 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "highlightrepository.h"
+
+#include <QFileInfo>
+
+HighlightRepository *HighlightRepository::s_pInstance = nullptr;
+
+HighlightRepository *HighlightRepository::instance()
+{
+    if (s_pInstance == nullptr) {
+        s_pInstance = new HighlightRepository;
+    }
+    return s_pInstance;
+}
+
+HighlightRepository::~HighlightRepository()
+{
+    delete m_pRepository;
+}
+
+KSyntaxHighlighting::Repository &HighlightRepository::repository()
+{
+    if (m_pRepository == nullptr) {
+        m_pRepository = new KSyntaxHighlighting::Repository;
+        // 更新单独添加的高亮格式文件
+        m_pRepository->addCustomSearchPath(KF5_HIGHLIGHT_PATH);
+    }
+    return *m_pRepository;
+}
+
+bool HighlightRepository::isLoaded() const
+{
+    return m_pRepository != nullptr;
+}
+
+KSyntaxHighlighting::Definition HighlightRepository::definitionForName(const QString &defName)
+{
+    return repository().definitionForName(defName);
+}
+
+/**
+ * @brief 语法定义仅按文件名(不含路径)匹配，以文件名为键缓存匹配结果，未匹配的无效定义同样缓存
+ */
+KSyntaxHighlighting::Definition HighlightRepository::definitionForFileName(const QString &fileName)
+{
+    const QString name = QFileInfo(fileName).fileName();
+    auto itr = m_fileNameDefinitions.constFind(name);
+    if (itr != m_fileNameDefinitions.constEnd()) {
+        return itr.value();
+    }
+
+    const KSyntaxHighlighting::Definition def = repository().definitionForFileName(name);
+    m_fileNameDefinitions.insert(name, def);
+    return def;
+}
+
+QVector<KSyntaxHighlighting::Definition> HighlightRepository::definitions()
+{
+    return repository().definitions();
+}
+
+KSyntaxHighlighting::Theme HighlightRepository::defaultTheme(KSyntaxHighlighting::Repository::DefaultTheme theme)
+{
+    return repository().defaultTheme(theme);
+}
@@ -0,0 +1,49 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef HIGHLIGHTREPOSITORY_H
+#define HIGHLIGHTREPOSITORY_H
+
+#include <KSyntaxHighlighting/Repository>
+#include <KSyntaxHighlighting/Definition>
+#include <KSyntaxHighlighting/Theme>
+
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+/**
+ * @brief 进程内共享的语法高亮定义仓库。创建 KSyntaxHighlighting::Repository 需要解析全部语法定义文件，
+ *      各标签页、窗口及控件共用同一仓库，在首次使用时创建，语法定义及主题仅加载一次。
+ *      按文件名匹配语法定义需遍历全部定义的通配符，匹配结果按文件名缓存。
+ *      仅在界面线程使用。
+ */
+class HighlightRepository
+{
+public:
+    static HighlightRepository *instance();
+
+    // 共享的语法定义仓库，首次调用时创建并添加单独安装的高亮格式文件路径
+    KSyntaxHighlighting::Repository &repository();
+    // 仓库是否已创建
+    bool isLoaded() const;
+
+    KSyntaxHighlighting::Definition definitionForName(const QString &defName);
+    // 按文件 fileName 的文件名匹配语法定义，结果缓存
+    KSyntaxHighlighting::Definition definitionForFileName(const QString &fileName);
+    QVector<KSyntaxHighlighting::Definition> definitions();
+    KSyntaxHighlighting::Theme defaultTheme(KSyntaxHighlighting::Repository::DefaultTheme theme);
+
+private:
+    HighlightRepository() = default;
+    ~HighlightRepository();
+    Q_DISABLE_COPY(HighlightRepository)
+
+private:
+    static HighlightRepository *s_pInstance;
+    KSyntaxHighlighting::Repository *m_pRepository = nullptr;          // 延迟创建的语法定义仓库
+    QHash<QString, KSyntaxHighlighting::Definition> m_fileNameDefinitions;  // 文件名匹配的语法定义
+};
+
+#endif // HIGHLIGHTREPOSITORY_H
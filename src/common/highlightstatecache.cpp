@@ -0,0 +1,240 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "highlightstatecache.h"
+#include "performancemonitor.h"
+
+#include <QTextDocument>
+#include <QTextBlock>
+#include <QElapsedTimer>
+
+HighlightStateCache::HighlightStateCache(QTextDocument *document, QObject *parent)
+    : QObject(parent)
+    , m_document(document)
+{
+    m_blockCount = document ? document->blockCount() : 0;
+    m_timer.setSingleShot(true);
+    m_timer.setInterval(0);
+    connect(&m_timer, &QTimer::timeout, this, &HighlightStateCache::analyzeSlice);
+}
+
+/**
+ * @brief 设置语法定义 \a def ，丢弃全部已分析的状态
+ */
+void HighlightStateCache::setDefinition(const KSyntaxHighlighting::Definition &def)
+{
+    KSyntaxHighlighting::AbstractHighlighter::setDefinition(def);
+
+    m_endStates.clear();
+    m_blockCount = m_document ? m_document->blockCount() : 0;
+    scheduleAnalyze();
+}
+
+void HighlightStateCache::setBackgroundEnabled(bool enable)
+{
+    m_backgroundEnabled = enable;
+    if (enable) {
+        scheduleAnalyze();
+    } else {
+        m_timer.stop();
+    }
+}
+
+bool HighlightStateCache::isBackgroundEnabled() const
+{
+    return m_backgroundEnabled;
+}
+
+bool HighlightStateCache::hasState(int blockNumber) const
+{
+    return definition().isValid() && blockNumber >= 0 && blockNumber <= m_endStates.size();
+}
+
+/**
+ * @brief 取得文本块 \a blockNumber 的起始状态，即上一文本块记录的结束状态
+ */
+bool HighlightStateCache::stateForBlock(int blockNumber, KSyntaxHighlighting::State &state)
+{
+    if (!m_document || !hasState(blockNumber)) {
+        return false;
+    }
+
+    state = blockNumber > 0 ? m_endStates.at(blockNumber - 1) : KSyntaxHighlighting::State();
+    return true;
+}
+
+void HighlightStateCache::setBlockEndState(int blockNumber, const KSyntaxHighlighting::State &state)
+{
+    if (!hasState(blockNumber)) {
+        return;
+    }
+
+    if (blockNumber == m_endStates.size()) {
+        m_endStates.append(state);
+    } else {
+        m_endStates[blockNumber] = state;
+    }
+}
+
+int HighlightStateCache::frontierBlock() const
+{
+    return m_endStates.size();
+}
+
+/**
+ * @brief 从已分析的位置同步分析至文本块 \a blockNumber ，如折叠全部区域时需取得全部文本块的折叠区域
+ */
+void HighlightStateCache::analyzeTo(int blockNumber)
+{
+    if (!m_document || !definition().isValid() || blockNumber < m_endStates.size()) {
+        return;
+    }
+
+    KSyntaxHighlighting::State state = m_endStates.isEmpty() ? KSyntaxHighlighting::State() : m_endStates.last();
+    QTextBlock block = m_document->findBlockByNumber(m_endStates.size());
+    while (block.isValid() && m_endStates.size() <= blockNumber) {
+        state = analyzeBlock(block, state);
+        m_endStates.append(state);
+        block = block.next();
+    }
+
+    emit sigStatesAdvanced(m_endStates.size());
+}
+
+/**
+ * @brief 文档内容变更时，以变更前后的文本块数量差替换变更范围内记录的结束状态，
+ *      并从变更的文本块开始重新分析，直至结束状态与变更前一致。
+ *      变更范围超出已分析的文本块时，丢弃变更文本块之后的状态。
+ */
+void HighlightStateCache::contentsChange(int from, int charsRemoved, int charsAdded)
+{
+    Q_UNUSED(charsRemoved)
+
+    if (!m_document) {
+        return;
+    }
+
+    const int blockDelta = m_document->blockCount() - m_blockCount;
+    m_blockCount = m_document->blockCount();
+
+    const QTextBlock firstBlock = m_document->findBlock(from);
+    const QTextBlock lastBlock = m_document->findBlock(qMin(from + charsAdded, m_document->characterCount() - 1));
+    if (!firstBlock.isValid() || !lastBlock.isValid()) {
+        m_endStates.clear();
+        scheduleAnalyze();
+        return;
+    }
+
+    // 变更位于已分析范围之后，已记录的状态不受影响
+    const int first = firstBlock.blockNumber();
+    if (first >= m_endStates.size()) {
+        scheduleAnalyze();
+        return;
+    }
+
+    const int last = lastBlock.blockNumber();
+    const int oldLast = last - blockDelta;
+    if (oldLast < first || oldLast >= m_endStates.size() || !definition().isValid()) {
+        m_endStates.resize(first);
+        scheduleAnalyze();
+        return;
+    }
+
+    const KSyntaxHighlighting::State lastEndState = m_endStates.at(oldLast);
+    m_endStates.remove(first, oldLast - first + 1);
+    m_endStates.insert(first, last - first + 1, KSyntaxHighlighting::State());
+
+    PerformanceMonitor::highlightBlocksRelexed(relex(firstBlock, last, lastEndState));
+    scheduleAnalyze();
+}
+
+void HighlightStateCache::applyFormat(int offset, int length, const KSyntaxHighlighting::Format &format)
+{
+    Q_UNUSED(offset)
+    Q_UNUSED(length)
+    Q_UNUSED(format)
+}
+
+void HighlightStateCache::applyFolding(int offset, int length, KSyntaxHighlighting::FoldingRegion region)
+{
+    Q_UNUSED(offset)
+    Q_UNUSED(length)
+
+    if (region.type() == KSyntaxHighlighting::FoldingRegion::Begin) {
+        m_foldingRegions.append(region.id() + 1);
+    } else if (region.type() == KSyntaxHighlighting::FoldingRegion::End) {
+        m_foldingRegions.append(-(region.id() + 1));
+    }
+}
+
+/**
+ * @brief 在 ESliceMilliseconds 时间内向后分析文本块，未分析完成时等待下次空闲继续
+ */
+void HighlightStateCache::analyzeSlice()
+{
+    if (!m_document || !definition().isValid()) {
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    KSyntaxHighlighting::State state = m_endStates.isEmpty() ? KSyntaxHighlighting::State() : m_endStates.last();
+    QTextBlock block = m_document->findBlockByNumber(m_endStates.size());
+    while (block.isValid() && timer.elapsed() < ESliceMilliseconds) {
+        state = analyzeBlock(block, state);
+        m_endStates.append(state);
+        block = block.next();
+    }
+
+    if (block.isValid()) {
+        scheduleAnalyze();
+    }
+    emit sigStatesAdvanced(m_endStates.size());
+}
+
+/**
+ * @brief 变更范围 [\a firstBlock, \a last] 内的文本块均重新分析，之后的文本块结束状态与记录一致时
+ *      后续状态均不变；文本块 \a last 与变更前最后一个文本块的结束状态 \a lastEndState 比较。
+ */
+int HighlightStateCache::relex(const QTextBlock &firstBlock, int last, const KSyntaxHighlighting::State &lastEndState)
+{
+    int number = firstBlock.blockNumber();
+    KSyntaxHighlighting::State state = number > 0 ? m_endStates.at(number - 1) : KSyntaxHighlighting::State();
+    int relexed = 0;
+    for (QTextBlock block = firstBlock; block.isValid() && number < m_endStates.size(); block = block.next(), ++number) {
+        if (relexed >= ERelexLimit) {
+            m_endStates.resize(number);
+            break;
+        }
+
+        state = analyzeBlock(block, state);
+        ++relexed;
+
+        const bool converged = (number == last && state == lastEndState)
+                               || (number > last && state == m_endStates.at(number));
+        m_endStates[number] = state;
+        if (converged) {
+            break;
+        }
+    }
+
+    return relexed;
+}
+
+void HighlightStateCache::scheduleAnalyze()
+{
+    if (m_backgroundEnabled && m_document && definition().isValid()
+            && m_endStates.size() < m_document->blockCount() && !m_timer.isActive()) {
+        m_timer.start();
+    }
+}
+
+KSyntaxHighlighting::State HighlightStateCache::analyzeBlock(const QTextBlock &block, const KSyntaxHighlighting::State &state)
+{
+    m_foldingRegions.clear();
+    const KSyntaxHighlighting::State endState = highlightLine(block.text(), state);
+    emit sigBlockFoldingRegions(block.blockNumber(), m_foldingRegions);
+    return endState;
+}
@@ -0,0 +1,89 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef HIGHLIGHTSTATECACHE_H
+#define HIGHLIGHTSTATECACHE_H
+
+#include <KSyntaxHighlighting/AbstractHighlighter>
+#include <KSyntaxHighlighting/Definition>
+#include <KSyntaxHighlighting/FoldingRegion>
+#include <KSyntaxHighlighting/State>
+
+#include <QObject>
+#include <QPointer>
+#include <QTimer>
+#include <QVector>
+
+class QTextDocument;
+class QTextBlock;
+
+/**
+ * @brief 语法高亮状态缓存。在界面空闲时分片对文档逐文本块执行词法分析(不设置格式)，
+ *      记录每个文本块结束时的状态，高亮任意已分析的文本块时可直接取得准确的起始状态。
+ *      文档内容变更后从变更的文本块开始重新分析，直至文本块新的结束状态与记录的一致，
+ *      通常输入时仅需重新分析 O(1) 个文本块；超过 ERelexLimit 个文本块仍未一致时，
+ *      丢弃之后的状态，由空闲分析继续。分析的同时上报各文本块的折叠区域标记。
+ */
+class HighlightStateCache : public QObject, public KSyntaxHighlighting::AbstractHighlighter
+{
+    Q_OBJECT
+public:
+    enum CacheParam {
+        ERelexLimit = 256,              // 内容变更时同步重新分析的文本块数量上限
+        ESliceMilliseconds = 8,         // 单次空闲分析的时间上限
+    };
+
+    explicit HighlightStateCache(QTextDocument *document, QObject *parent = nullptr);
+
+    void setDefinition(const KSyntaxHighlighting::Definition &def) override;
+    // 是否在空闲时分析文档，默认不分析，仅按高亮顺序推进
+    void setBackgroundEnabled(bool enable);
+    bool isBackgroundEnabled() const;
+
+    // 文本块 blockNumber 起始状态是否已知
+    bool hasState(int blockNumber) const;
+    // 取得文本块 blockNumber 的起始状态 state ，起始状态未知时返回 false
+    bool stateForBlock(int blockNumber, KSyntaxHighlighting::State &state);
+    // 以准确起始状态高亮文本块 blockNumber 后，记录其结束状态 state
+    void setBlockEndState(int blockNumber, const KSyntaxHighlighting::State &state);
+    // 起始状态已知的最大文本块序号
+    int frontierBlock() const;
+    // 同步分析至文本块 blockNumber ，不设置格式
+    void analyzeTo(int blockNumber);
+
+    // 文档内容变更，参数同 QTextDocument::contentsChange
+    void contentsChange(int from, int charsRemoved, int charsAdded);
+
+signals:
+    // 起始状态已知的文本块推进至 frontierBlock
+    void sigStatesAdvanced(int frontierBlock);
+    // 文本块 blockNumber 分析完成，regions 为块内的折叠区域标记，格式同 CSyntaxHighlighter::sigBlockFoldingRegions
+    void sigBlockFoldingRegions(int blockNumber, const QVector<int> &regions);
+
+protected:
+    // 仅分析状态，不设置格式
+    void applyFormat(int offset, int length, const KSyntaxHighlighting::Format &format) override;
+    void applyFolding(int offset, int length, KSyntaxHighlighting::FoldingRegion region) override;
+
+private slots:
+    // 空闲时分析一段文本块
+    void analyzeSlice();
+
+private:
+    // 从文本块 firstBlock 开始重新分析，至文本块 last 及之后结束状态与记录一致时停止，返回分析的文本块数量
+    int relex(const QTextBlock &firstBlock, int last, const KSyntaxHighlighting::State &lastEndState);
+    void scheduleAnalyze();
+    // 以起始状态 state 分析文本块 block 并上报折叠区域，返回结束状态
+    KSyntaxHighlighting::State analyzeBlock(const QTextBlock &block, const KSyntaxHighlighting::State &state);
+
+private:
+    QPointer<QTextDocument> m_document;             // 分析的文档
+    QTimer m_timer;                                 // 空闲分析定时器
+    bool m_backgroundEnabled = false;               // 是否在空闲时分析
+    QVector<KSyntaxHighlighting::State> m_endStates;    // 已分析文本块的结束状态，数量即起始状态已知的最大文本块
+    int m_blockCount = 0;                           // 上次变更后文档的文本块数量
+    QVector<int> m_foldingRegions;                  // 当前分析文本块的折叠区域标记
+};
+
+#endif // HIGHLIGHTSTATECACHE_H
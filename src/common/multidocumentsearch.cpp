@@ -0,0 +1,254 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "multidocumentsearch.h"
+
+#include <QtConcurrent>
+
+namespace {
+
+// 查找单个文档的任务，各文档共享文档列表及取消标识
+struct DocumentSearchTask {
+    typedef MultiDocumentSearch::FileResult result_type;
+
+    QSharedPointer<const QVector<MultiDocumentSearch::Document>> documents;
+    QString keyword;
+    TextSearchEngine::SearchFlags flags;
+    bool replace = false;
+    QString withText;
+    QSharedPointer<QAtomicInt> canceled;
+
+    MultiDocumentSearch::FileResult operator()(int index) const
+    {
+        MultiDocumentSearch::FileResult result = replace
+                                                 ? MultiDocumentSearch::replaceDocument(documents->at(index), keyword, flags, withText, canceled.data())
+                                                 : MultiDocumentSearch::searchDocument(documents->at(index), keyword, flags, canceled.data());
+        result.index = index;
+        return result;
+    }
+};
+
+}
+
+MultiDocumentSearch::MultiDocumentSearch(QObject *parent)
+    : QObject(parent)
+{
+    qRegisterMetaType<MultiDocumentSearch::FileResult>("MultiDocumentSearch::FileResult");
+    connect(&m_watcher, &QFutureWatcher<FileResult>::resultReadyAt, this, &MultiDocumentSearch::onResultReadyAt);
+    connect(&m_watcher, &QFutureWatcher<FileResult>::finished, this, &MultiDocumentSearch::onFinished);
+}
+
+MultiDocumentSearch::~MultiDocumentSearch()
+{
+    cancel();
+    m_watcher.waitForFinished();
+}
+
+/**
+ * @brief 在线程池中并行查找文档列表 \a documents ，各文档使用调用时复制的文本快照，查找期间可继续编辑。
+ *      单个文档较大时 TextSearchEngine::search() 继续分块并行查找。
+ */
+void MultiDocumentSearch::start(const QVector<Document> &documents, const QString &keyword, TextSearchEngine::SearchFlags flags)
+{
+    startTask(documents, keyword, flags, false, QString());
+}
+
+/**
+ * @brief 与 start() 相同，各文档的结果额外记录全部匹配项及替换文本，文档在查找后未被编辑时可直接按结果替换，无需重新查找
+ */
+void MultiDocumentSearch::startReplace(const QVector<Document> &documents, const QString &keyword, TextSearchEngine::SearchFlags flags,
+                                       const QString &withText)
+{
+    startTask(documents, keyword, flags, true, withText);
+}
+
+void MultiDocumentSearch::startTask(const QVector<Document> &documents, const QString &keyword, TextSearchEngine::SearchFlags flags,
+                                    bool replace, const QString &withText)
+{
+    cancel();
+
+    m_keyword = keyword;
+    m_flags = flags;
+    m_finishedCount = 0;
+    m_matchCount = 0;
+    if (keyword.isEmpty() || documents.isEmpty()) {
+        return;
+    }
+
+    m_canceled.reset(new QAtomicInt(0));
+    DocumentSearchTask task;
+    task.documents.reset(new QVector<Document>(documents));
+    task.keyword = keyword;
+    task.flags = flags;
+    task.replace = replace;
+    task.withText = withText;
+    task.canceled = m_canceled;
+
+    QVector<int> indexes(documents.size());
+    for (int i = 0; i < indexes.size(); ++i) {
+        indexes[i] = i;
+    }
+    m_watcher.setFuture(QtConcurrent::mapped(indexes, task));
+}
+
+void MultiDocumentSearch::cancel()
+{
+    if (m_canceled) {
+        m_canceled->storeRelease(1);
+    }
+    m_watcher.cancel();
+}
+
+bool MultiDocumentSearch::isRunning() const
+{
+    return m_watcher.isRunning();
+}
+
+QString MultiDocumentSearch::keyword() const
+{
+    return m_keyword;
+}
+
+TextSearchEngine::SearchFlags MultiDocumentSearch::searchFlags() const
+{
+    return m_flags;
+}
+
+int MultiDocumentSearch::finishedCount() const
+{
+    return m_finishedCount;
+}
+
+int MultiDocumentSearch::matchCount() const
+{
+    return m_matchCount;
+}
+
+/**
+ * @brief 按查找模式 \a flags 查找文档 \a document 中的关键字 \a keyword ，并计算前 EMaxFileMatches 个匹配项的
+ *      行号及预览文本，匹配项总数不受限制
+ */
+MultiDocumentSearch::FileResult MultiDocumentSearch::searchDocument(const Document &document, const QString &keyword,
+                                                                    TextSearchEngine::SearchFlags flags, const QAtomicInt *canceled)
+{
+    FileResult result;
+    result.filePath = document.filePath;
+
+    const SearchResult searchResult = TextSearchEngine::search(document.text, keyword, flags, canceled);
+    if (canceled && canceled->loadAcquire()) {
+        return result;
+    }
+
+    result.matches = createMatches(document.text, searchResult, EMaxFileMatches);
+    result.matchCount = searchResult.count();
+    return result;
+}
+
+/**
+ * @brief 查找文档 \a document 并记录全部匹配项。正则表达式模式下按各匹配项的捕获组计算替换文本，
+ *      忽略大小写或正则表达式模式下匹配项文本可能与关键字不同，记录各匹配项的文本用于撤销
+ */
+MultiDocumentSearch::FileResult MultiDocumentSearch::replaceDocument(const Document &document, const QString &keyword,
+                                                                     TextSearchEngine::SearchFlags flags, const QString &withText,
+                                                                     const QAtomicInt *canceled)
+{
+    FileResult result;
+    result.filePath = document.filePath;
+
+    const SearchResult searchResult = TextSearchEngine::search(document.text, keyword, flags, canceled);
+    if (canceled && canceled->loadAcquire()) {
+        return result;
+    }
+
+    result.matches = createMatches(document.text, searchResult, EMaxFileMatches);
+    result.matchCount = searchResult.count();
+    result.searchResult = searchResult;
+    if (searchResult.isEmpty()) {
+        return result;
+    }
+
+    if (flags.testFlag(TextSearchEngine::ERegularExpression)) {
+        result.newTexts = TextSearchEngine::replacements(document.text, searchResult, 0, keyword, flags, withText);
+    }
+    if (flags.testFlag(TextSearchEngine::ERegularExpression) || flags.testFlag(TextSearchEngine::ECaseInsensitive)) {
+        result.oldTexts.reserve(searchResult.count());
+        for (int i = 0; i < searchResult.count(); ++i) {
+            result.oldTexts.append(document.text.mid(searchResult.offsetAt(i), searchResult.lengthAt(i)));
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief 按查找结果 \a result 计算各匹配项的行号、列号及所在行的预览文本。
+ *      匹配项按位置升序排列，行号从上一个匹配项处继续统计，整体仅遍历一次文本。
+ *      行过长时预览文本截取匹配项附近 EPreviewLength 个字符。
+ */
+QVector<MultiDocumentSearch::Match> MultiDocumentSearch::createMatches(const QString &text, const SearchResult &result, int maxCount)
+{
+    const int count = maxCount < 0 ? result.count() : qMin(maxCount, result.count());
+    QVector<Match> matches;
+    matches.reserve(count);
+
+    int line = 0;
+    int lineStart = 0;
+    int scanned = 0;
+    for (int i = 0; i < count; ++i) {
+        Match match;
+        match.offset = result.offsetAt(i);
+        match.length = result.lengthAt(i);
+
+        for (; scanned < match.offset; ++scanned) {
+            if (text.at(scanned) == QLatin1Char('\n')) {
+                ++line;
+                lineStart = scanned + 1;
+            }
+        }
+
+        int lineEnd = text.indexOf(QLatin1Char('\n'), match.offset);
+        if (lineEnd < 0) {
+            lineEnd = text.length();
+        }
+
+        int previewStart = lineStart;
+        if (lineEnd - lineStart > EPreviewLength) {
+            previewStart = qMax(lineStart, match.offset - EPreviewLength / 3);
+        }
+        const int previewEnd = qMin(lineEnd, previewStart + EPreviewLength);
+
+        match.line = line;
+        match.column = match.offset - lineStart;
+        match.preview = text.mid(previewStart, previewEnd - previewStart);
+        match.previewOffset = match.offset - previewStart;
+        matches.append(match);
+    }
+
+    return matches;
+}
+
+/**
+ * @brief 单个文档查找完成，存在匹配项时通知，已取消的查找不再通知
+ */
+void MultiDocumentSearch::onResultReadyAt(int index)
+{
+    if (!m_canceled || m_canceled->loadAcquire()) {
+        return;
+    }
+
+    const FileResult result = m_watcher.resultAt(index);
+    ++m_finishedCount;
+    if (!result.matches.isEmpty()) {
+        m_matchCount += result.matchCount;
+        emit sigFileResult(result);
+    }
+}
+
+void MultiDocumentSearch::onFinished()
+{
+    if (!m_canceled || m_canceled->loadAcquire()) {
+        return;
+    }
+
+    emit sigFinished();
+}
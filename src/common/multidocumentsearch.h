@@ -0,0 +1,111 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef MULTIDOCUMENTSEARCH_H
+#define MULTIDOCUMENTSEARCH_H
+
+#include "textsearchengine.h"
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QAtomicInt>
+#include <QSharedPointer>
+#include <QFutureWatcher>
+
+/**
+ * @brief 多文档查找，在线程池中并行查找多个文档的文本快照，各文档查找完成后逐个通知结果。
+ *      用于在所有打开的标签页中查找，匹配项附带行号及所在行的预览文本，便于按文件分组展示。
+ */
+class MultiDocumentSearch : public QObject
+{
+    Q_OBJECT
+public:
+    enum SearchParam {
+        EPreviewLength = 120,       // 预览文本最大长度
+        EMaxFileMatches = 1000,     // 单个文档最多记录行号及预览文本的匹配项数量
+    };
+
+    // 待查找的文档
+    struct Document {
+        QString filePath;           // 文件路径，用于定位标签页
+        QString text;               // 文本快照
+    };
+
+    // 单个匹配项
+    struct Match {
+        int offset = 0;             // 匹配项在文档中的起始位置
+        int length = 0;             // 匹配项长度
+        int line = 0;               // 所在行号，从 0 开始
+        int column = 0;             // 所在列号，从 0 开始
+        QString preview;            // 所在行的预览文本
+        int previewOffset = 0;      // 匹配项在预览文本中的起始位置
+    };
+
+    // 单个文档的查找结果
+    struct FileResult {
+        int index = -1;             // 文档在查找列表中的序号
+        QString filePath;
+        QVector<Match> matches;     // 匹配项，数量可能受限仅包含前面的部分
+        int matchCount = 0;         // 匹配项总数
+        SearchResult searchResult;  // 全部匹配项的位置及长度，仅替换时记录
+        QStringList oldTexts;       // 各匹配项的文本，仅替换时匹配项文本可能与关键字不同时记录
+        QStringList newTexts;       // 各匹配项的替换文本，仅正则表达式替换时记录
+    };
+
+    explicit MultiDocumentSearch(QObject *parent = nullptr);
+    ~MultiDocumentSearch() override;
+
+    // 在后台查找文档列表 documents 中的关键字 keyword ，之前未完成的查找将被取消
+    void start(const QVector<Document> &documents, const QString &keyword, TextSearchEngine::SearchFlags flags);
+    // 在后台查找文档列表 documents 中的关键字 keyword ，结果附带将匹配项替换为 withText 所需的全部匹配信息
+    void startReplace(const QVector<Document> &documents, const QString &keyword, TextSearchEngine::SearchFlags flags,
+                      const QString &withText);
+    // 取消查找
+    void cancel();
+    bool isRunning() const;
+
+    QString keyword() const;
+    TextSearchEngine::SearchFlags searchFlags() const;
+    // 已完成查找的文档数量
+    int finishedCount() const;
+    // 已找到的匹配项总数
+    int matchCount() const;
+
+    // 查找单个文档，最多记录 EMaxFileMatches 个匹配项，canceled 被置位时中止查找并返回空结果
+    static FileResult searchDocument(const Document &document, const QString &keyword,
+                                     TextSearchEngine::SearchFlags flags, const QAtomicInt *canceled = nullptr);
+    // 查找单个文档并记录全部匹配项，正则表达式模式下计算各匹配项替换为 withText 后的文本
+    static FileResult replaceDocument(const Document &document, const QString &keyword, TextSearchEngine::SearchFlags flags,
+                                      const QString &withText, const QAtomicInt *canceled = nullptr);
+    // 按查找结果 result 计算前 maxCount 个(小于 0 时为全部)匹配项的行号及预览文本
+    static QVector<Match> createMatches(const QString &text, const SearchResult &result, int maxCount = -1);
+
+signals:
+    // 文档 result.filePath 查找完成，仅在存在匹配项时通知
+    void sigFileResult(const MultiDocumentSearch::FileResult &result);
+    // 全部文档查找完成
+    void sigFinished();
+
+private slots:
+    void onResultReadyAt(int index);
+    void onFinished();
+
+private:
+    void startTask(const QVector<Document> &documents, const QString &keyword, TextSearchEngine::SearchFlags flags,
+                   bool replace, const QString &withText);
+
+private:
+    QString m_keyword;                              // 查找的关键字
+    TextSearchEngine::SearchFlags m_flags;          // 查找模式
+    QFutureWatcher<FileResult> m_watcher;           // 后台查找任务，按文档返回结果
+    QSharedPointer<QAtomicInt> m_canceled;          // 后台查找任务取消标识
+    int m_finishedCount = 0;                        // 已完成查找的文档数量
+    int m_matchCount = 0;                           // 已找到的匹配项总数
+};
+
+Q_DECLARE_METATYPE(MultiDocumentSearch::FileResult)
+
+#endif // MULTIDOCUMENTSEARCH_H
@@ -9,6 +9,14 @@ const QString LOG_FLAG = "[PerformanceMonitor]";
 const QString GRAB_POINT_INIT_APP_TIME  = "[GRABPOINT] POINT-01";
 const QString GRAB_POINT_CLOSE_APP_TIME = "[GRABPOINT] POINT-02";
 const QString GRAB_POINT_OPEN_FILE_TIME = "[GRABPOINT] POINT-04";
+const QString GRAB_POINT_AUTO_BACKUP_TIME = "[GRABPOINT] POINT-05";
+const QString GRAB_POINT_RENDER_SELECTIONS = "[GRABPOINT] POINT-06";
+const QString GRAB_POINT_RELEX_BLOCKS = "[GRABPOINT] POINT-07";
+
+// 单次渲染的扩展选区数量超过此值时输出日志
+const int RENDER_SELECTIONS_WARNING_COUNT = 2000;
+// 单次编辑后重新词法分析的文本块数量超过此值时输出日志
+const int RELEX_BLOCKS_WARNING_COUNT = 64;
 
 qint64 PerformanceMonitor::initializeAppStartMs  = 0;
 qint64 PerformanceMonitor::inittalizeApoFinishMs = 0;
@@ -16,6 +24,13 @@ qint64 PerformanceMonitor::closeAppStartMs       = 0;
 qint64 PerformanceMonitor::closeAppFinishMs      = 0;
 qint64 PerformanceMonitor::openFileStartMs       = 0;
 qint64 PerformanceMonitor::openFileFinishMs      = 0;
+QElapsedTimer PerformanceMonitor::autoBackupTimer;
+qint64 PerformanceMonitor::autoBackupNsecs       = 0;
+int PerformanceMonitor::renderedSelections       = 0;
+int PerformanceMonitor::totalSelections          = 0;
+int PerformanceMonitor::renderedSelectionsMax    = 0;
+int PerformanceMonitor::relexedBlocks            = 0;
+int PerformanceMonitor::relexedBlocksMax         = 0;
 
 PerformanceMonitor::PerformanceMonitor()
 {
@@ -82,3 +97,79 @@ void PerformanceMonitor::openFileFinish(const QString &strFileName, qint64 iFile
     float fFilesize = iFileSize;
     qInfo() << qPrintable(QString("%1 filename=%2 filezise=%3M opentime=%4ms #(Open file time)").arg(GRAB_POINT_OPEN_FILE_TIME).arg(strFileName).arg(QString::number(fFilesize/(1024*1024), 'f', 6)).arg(time));
 }
+
+void PerformanceMonitor::autoBackupStart()
+{
+    autoBackupTimer.start();
+}
+
+/**
+ * @brief 记录单次自动备份在界面线程中的耗时，文件写入在备份线程中执行，不计入此耗时
+ * @param iBackupCount 添加备份任务的文件数量
+ */
+void PerformanceMonitor::autoBackupFinish(int iBackupCount)
+{
+    autoBackupNsecs = autoBackupTimer.isValid() ? autoBackupTimer.nsecsElapsed() : 0;
+    qInfo() << qPrintable(QString("%1 files=%2 backupduration=%3ms #(Auto backup GUI thread time)")
+                          .arg(GRAB_POINT_AUTO_BACKUP_TIME).arg(iBackupCount)
+                          .arg(QString::number(autoBackupNsecs / 1000000.0, 'f', 3)));
+}
+
+qint64 PerformanceMonitor::lastAutoBackupNsecs()
+{
+    return autoBackupNsecs;
+}
+
+/**
+ * @brief 记录单次渲染传给编辑器的扩展选区数量，仅可见区域内的装饰参与渲染，
+ *      数量异常增长时输出日志，便于发现渲染全部装饰的性能回退
+ * @param renderedCount 传给编辑器的扩展选区数量
+ * @param totalCount 全部装饰(查找高亮、颜色标记、括号等)的数量
+ */
+void PerformanceMonitor::extraSelectionsRendered(int renderedCount, int totalCount)
+{
+    renderedSelections = renderedCount;
+    totalSelections = totalCount;
+    renderedSelectionsMax = qMax(renderedSelectionsMax, renderedCount);
+
+    if (renderedCount > RENDER_SELECTIONS_WARNING_COUNT) {
+        qWarning() << qPrintable(QString("%1 rendered=%2 total=%3 #(Extra selections per frame)")
+                                 .arg(GRAB_POINT_RENDER_SELECTIONS).arg(renderedCount).arg(totalCount));
+    }
+}
+
+int PerformanceMonitor::lastRenderedSelections()
+{
+    return renderedSelections;
+}
+
+int PerformanceMonitor::lastTotalSelections()
+{
+    return totalSelections;
+}
+
+int PerformanceMonitor::maxRenderedSelections()
+{
+    return renderedSelectionsMax;
+}
+
+void PerformanceMonitor::highlightBlocksRelexed(int count)
+{
+    relexedBlocks = count;
+    relexedBlocksMax = qMax(relexedBlocksMax, count);
+
+    if (count > RELEX_BLOCKS_WARNING_COUNT) {
+        qWarning() << qPrintable(QString("%1 relexed=%2 #(Blocks re-lexed per edit)")
+                                 .arg(GRAB_POINT_RELEX_BLOCKS).arg(count));
+    }
+}
+
+int PerformanceMonitor::lastRelexedBlocks()
+{
+    return relexedBlocks;
+}
+
+int PerformanceMonitor::maxRelexedBlocks()
+{
+    return relexedBlocksMax;
+}
@@ -9,6 +9,7 @@
 #include <QTime>
 #include <QDateTime>
 #include <QDebug>
+#include <QElapsedTimer>
 
 class PerformanceMonitor
 {
@@ -22,6 +23,20 @@ public:
     static void closeAPPFinish();
     static void openFileStart();
     static void openFileFinish(const QString &strFileName, qint64 iFileSize);
+    static void autoBackupStart();
+    static void autoBackupFinish(int iBackupCount);
+    static qint64 lastAutoBackupNsecs();
+    // 记录单次渲染传给编辑器的扩展选区数量 renderedCount 及全部装饰数量 totalCount
+    static void extraSelectionsRendered(int renderedCount, int totalCount);
+    static int lastRenderedSelections();
+    static int lastTotalSelections();
+    // 单次渲染传给编辑器的扩展选区数量的最大值
+    static int maxRenderedSelections();
+    // 记录单次编辑后重新词法分析的文本块数量 count
+    static void highlightBlocksRelexed(int count);
+    static int lastRelexedBlocks();
+    // 单次编辑后重新词法分析的文本块数量的最大值
+    static int maxRelexedBlocks();
 
 private:
     Q_DISABLE_COPY(PerformanceMonitor)
@@ -32,6 +47,13 @@ private:
     static qint64 closeAppFinishMs;
     static qint64 openFileStartMs;
     static qint64 openFileFinishMs;
+    static QElapsedTimer autoBackupTimer;
+    static qint64 autoBackupNsecs;
+    static int renderedSelections;
+    static int totalSelections;
+    static int renderedSelectionsMax;
+    static int relexedBlocks;
+    static int relexedBlocksMax;
 };
 
 #endif // PERFORMANCEMONITOR_H
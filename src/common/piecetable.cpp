@@ -0,0 +1,487 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "piecetable.h"
+#include "../encodes/streamtranscoder.h"
+
+#include <QSaveFile>
+#include <QDebug>
+
+#include <algorithm>
+#include <cstring>
+
+#include <unistd.h>
+
+enum PieceTableParam {
+    EIndexBlockSize = 64 * 1024,            // 原始数据换行符索引块大小
+    EWriteChunkSize = 4 * 1024 * 1024,      // 流式写入时单次写入的最大长度
+};
+
+/**
+ * @brief 统计数据 \a data 中的换行符数量
+ */
+static qint64 countNewLine(const char *data, qint64 len)
+{
+    qint64 count = 0;
+    const char *end = data + len;
+    while (data < end) {
+        const void *found = ::memchr(data, '\n', static_cast<size_t>(end - data));
+        if (!found) {
+            break;
+        }
+        ++count;
+        data = static_cast<const char *>(found) + 1;
+    }
+    return count;
+}
+
+PieceTable::PieceTable()
+{
+}
+
+PieceTable::~PieceTable()
+{
+    clear();
+}
+
+/**
+ * @brief 以只读内存映射方式打开文件 \a filePath 作为原始数据，文件数据需为 UTF-8 编码
+ * @return 是否打开成功
+ */
+bool PieceTable::openFile(const QString &filePath)
+{
+    clear();
+
+    m_file.setFileName(filePath);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        qWarning() << Q_FUNC_INFO << "Open file failed, " << m_file.errorString();
+        return false;
+    }
+
+    qint64 fileSize = m_file.size();
+    if (fileSize > 0) {
+        uchar *mapData = m_file.map(0, fileSize);
+        if (!mapData) {
+            qWarning() << Q_FUNC_INFO << "Map file failed, " << m_file.errorString();
+            m_file.close();
+            return false;
+        }
+
+        m_original = reinterpret_cast<const char *>(mapData);
+        m_originalLength = fileSize;
+    }
+
+    buildOriginalIndex();
+    return true;
+}
+
+/**
+ * @brief 设置原始数据 \a data ，用于已转换为 UTF-8 编码的文本
+ */
+void PieceTable::setData(const QByteArray &data)
+{
+    clear();
+
+    m_originalData = data;
+    m_original = m_originalData.constData();
+    m_originalLength = m_originalData.size();
+    buildOriginalIndex();
+}
+
+/**
+ * @brief 清空文档，释放映射的文件及缓冲区
+ */
+void PieceTable::clear()
+{
+    if (m_file.isOpen()) {
+        if (m_original) {
+            m_file.unmap(reinterpret_cast<uchar *>(const_cast<char *>(m_original)));
+        }
+        m_file.close();
+    }
+
+    m_original = nullptr;
+    m_originalLength = 0;
+    m_originalData.clear();
+    m_originalIndex.clear();
+    m_addBuffer.clear();
+    m_pieces.clear();
+    m_length = 0;
+}
+
+qint64 PieceTable::length() const
+{
+    return m_length;
+}
+
+qint64 PieceTable::lineCount() const
+{
+    qint64 lineBreaks = 0;
+    for (const Piece &piece : m_pieces) {
+        lineBreaks += piece.lineBreaks;
+    }
+    return lineBreaks + 1;
+}
+
+int PieceTable::pieceCount() const
+{
+    return m_pieces.size();
+}
+
+/**
+ * @brief 在偏移位置 \a pos 插入数据 \a data ，数据追加到追加缓冲区，仅调整片段信息
+ */
+void PieceTable::insert(qint64 pos, const QByteArray &data)
+{
+    if (data.isEmpty()) {
+        return;
+    }
+    pos = qBound<qint64>(0, pos, m_length);
+
+    Piece newPiece;
+    newPiece.buffer = Add;
+    newPiece.start = m_addBuffer.size();
+    newPiece.length = data.size();
+    newPiece.lineBreaks = countNewLine(data.constData(), data.size());
+    m_addBuffer.append(data);
+
+    int index = splitAt(pos);
+    // 连续输入时直接扩展上一个追加片段，避免片段数量增长
+    if (index > 0) {
+        Piece &prevPiece = m_pieces[index - 1];
+        if (Add == prevPiece.buffer && prevPiece.start + prevPiece.length == newPiece.start) {
+            prevPiece.length += newPiece.length;
+            prevPiece.lineBreaks += newPiece.lineBreaks;
+            m_length += newPiece.length;
+            return;
+        }
+    }
+
+    m_pieces.insert(index, newPiece);
+    m_length += newPiece.length;
+}
+
+/**
+ * @brief 移除偏移位置 \a pos 开始的 \a len 长度数据，缓冲区数据不会被修改
+ */
+void PieceTable::remove(qint64 pos, qint64 len)
+{
+    pos = qBound<qint64>(0, pos, m_length);
+    len = qMin(len, m_length - pos);
+    if (len <= 0) {
+        return;
+    }
+
+    int first = splitAt(pos);
+    int last = splitAt(pos + len);
+    m_pieces.remove(first, last - first);
+    m_length -= len;
+}
+
+/**
+ * @brief 取得偏移位置 \a pos 开始的 \a len 长度数据
+ */
+QByteArray PieceTable::mid(qint64 pos, qint64 len) const
+{
+    QByteArray result;
+    pos = qBound<qint64>(0, pos, m_length);
+    len = qMin(len, m_length - pos);
+    if (len <= 0) {
+        return result;
+    }
+    result.reserve(static_cast<int>(len));
+
+    qint64 pieceOffset = 0;
+    int index = findPiece(pos, pieceOffset);
+    qint64 end = pos + len;
+    for (; index < m_pieces.size() && pieceOffset < end; ++index) {
+        const Piece &piece = m_pieces.at(index);
+        qint64 copyBegin = qMax(pos, pieceOffset);
+        qint64 copyEnd = qMin(end, pieceOffset + piece.length);
+        result.append(bufferData(piece.buffer) + piece.start + (copyBegin - pieceOffset),
+                      static_cast<int>(copyEnd - copyBegin));
+        pieceOffset += piece.length;
+    }
+
+    return result;
+}
+
+/**
+ * @brief 取得行号 \a line (从0开始)的起始偏移，通过片段换行符计数跳过无关片段，
+ *      原始数据通过换行符索引定位，不会扫描整个文档。
+ * @return 行起始偏移，行号越界时返回文档长度
+ */
+qint64 PieceTable::lineStart(qint64 line) const
+{
+    if (line <= 0) {
+        return 0;
+    }
+
+    qint64 lineBreaks = 0;
+    qint64 pieceOffset = 0;
+    for (const Piece &piece : m_pieces) {
+        if (lineBreaks + piece.lineBreaks >= line) {
+            qint64 breakPos = findLineBreak(piece.buffer, piece.start, piece.length, line - lineBreaks);
+            return pieceOffset + (breakPos - piece.start);
+        }
+
+        lineBreaks += piece.lineBreaks;
+        pieceOffset += piece.length;
+    }
+
+    return m_length;
+}
+
+/**
+ * @brief 取得从行号 \a firstLine 开始的 \a count 行数据，仅读取可见区域所需的数据
+ */
+QByteArray PieceTable::lines(qint64 firstLine, qint64 count) const
+{
+    qint64 begin = lineStart(firstLine);
+    qint64 end = lineStart(firstLine + count);
+    return mid(begin, end - begin);
+}
+
+/**
+ * @brief 按片段顺序将文档数据流式写入设备 \a device ，不会构造完整的文档拷贝。
+ *      \a transcoder 不为空时，按数据块将 UTF-8 数据转换为目标编码后写入，
+ *      数据块末尾被截断的多字节字符由 \a transcoder 保留到下一数据块
+ * @return 是否写入成功
+ */
+bool PieceTable::writeTo(QIODevice *device, StreamTranscoder *transcoder) const
+{
+    if (!device || !device->isWritable()) {
+        return false;
+    }
+
+    QByteArray outData;
+    auto writeData = [device](const char *data, qint64 len) -> bool {
+        if (device->write(data, len) != len) {
+            qWarning() << Q_FUNC_INFO << "Write data failed, " << device->errorString();
+            return false;
+        }
+        return true;
+    };
+
+    for (const Piece &piece : m_pieces) {
+        const char *data = bufferData(piece.buffer) + piece.start;
+        qint64 left = piece.length;
+        while (left > 0) {
+            qint64 writeLen = qMin<qint64>(left, EWriteChunkSize);
+            if (transcoder) {
+                outData.resize(0);
+                transcoder->convert(data, writeLen, outData);
+                if (!writeData(outData.constData(), outData.size())) {
+                    return false;
+                }
+            } else if (!writeData(data, writeLen)) {
+                return false;
+            }
+            data += writeLen;
+            left -= writeLen;
+        }
+    }
+
+    if (transcoder) {
+        outData.resize(0);
+        transcoder->finish(outData);
+        if (transcoder->errorCount() > 0) {
+            qWarning() << qPrintable("iconv() convert text encoding error, invalid sequence count:") << transcoder->errorCount();
+        }
+        return writeData(outData.constData(), outData.size());
+    }
+
+    return true;
+}
+
+/**
+ * @brief 将文档按编码 \a encode 保存到文件 \a filePath ，使用 QSaveFile 保证写入的原子性，
+ *      写入失败时原文件内容不变。保存到当前映射的文件时，写入的是新文件，映射的数据不受影响
+ * @param filePath      保存的文件路径
+ * @param encode        文件编码，非 UTF-8 编码时流式转换
+ * @param openFailed    返回文件是否打开失败(无权限等)
+ * @return 是否保存成功
+ */
+bool PieceTable::saveToFile(const QString &filePath, const QString &encode, bool *openFailed) const
+{
+    if (openFailed) {
+        *openFailed = false;
+    }
+
+    StreamTranscoder *transcoder = nullptr;
+    if (0 != encode.compare(QString("UTF-8"), Qt::CaseInsensitive)) {
+        transcoder = new StreamTranscoder(QString("UTF-8"), encode);
+        if (!transcoder->isValid()) {
+            qWarning() << Q_FUNC_INFO << "Unsupported encode: " << encode;
+            delete transcoder;
+            return false;
+        }
+    }
+
+    // 不允许直接写入原文件，保存到映射的文件时截断原文件会导致映射的数据失效
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << Q_FUNC_INFO << "Open file failed, " << file.errorString();
+        if (openFailed) {
+            *openFailed = true;
+        }
+        delete transcoder;
+        return false;
+    }
+
+    bool ok = writeTo(&file, transcoder) && file.flush();
+    delete transcoder;
+    if (!ok) {
+        file.cancelWriting();
+        return false;
+    }
+    // ensure that the file is written to disk
+    fsync(file.handle());
+
+    if (!file.commit()) {
+        qWarning() << Q_FUNC_INFO << "Commit file failed, " << file.errorString();
+        return false;
+    }
+    return true;
+}
+
+const char *PieceTable::bufferData(BufferType buffer) const
+{
+    return Original == buffer ? m_original : m_addBuffer.constData();
+}
+
+/**
+ * @brief 查找偏移位置 \a pos 所在的片段
+ * @param pos           文档偏移
+ * @param pieceOffset   返回片段的起始偏移
+ * @return 片段索引，偏移位于文档末尾时返回片段数量
+ */
+int PieceTable::findPiece(qint64 pos, qint64 &pieceOffset) const
+{
+    pieceOffset = 0;
+    for (int index = 0; index < m_pieces.size(); ++index) {
+        qint64 pieceLength = m_pieces.at(index).length;
+        if (pos < pieceOffset + pieceLength) {
+            return index;
+        }
+        pieceOffset += pieceLength;
+    }
+
+    return m_pieces.size();
+}
+
+/**
+ * @brief 统计缓冲区 \a buffer 中 [\a start, \a start + \a length) 范围内的换行符数量，
+ *      原始数据通过索引块计数，仅需扫描范围两端不足一个索引块的数据
+ */
+qint64 PieceTable::countLineBreaks(BufferType buffer, qint64 start, qint64 length) const
+{
+    if (Add == buffer || m_originalIndex.isEmpty()) {
+        return countNewLine(bufferData(buffer) + start, length);
+    }
+
+    auto prefixCount = [this](qint64 pos) -> qint64 {
+        qint64 block = pos / EIndexBlockSize;
+        qint64 blockBegin = block * EIndexBlockSize;
+        return m_originalIndex.at(static_cast<int>(block)) + countNewLine(m_original + blockBegin, pos - blockBegin);
+    };
+    return prefixCount(start + length) - prefixCount(start);
+}
+
+/**
+ * @brief 查找缓冲区 \a buffer 中 [\a start, \a start + \a length) 范围内第 \a n 个换行符，
+ *      返回换行符之后的缓冲区偏移；调用方需保证范围内存在足够的换行符
+ */
+qint64 PieceTable::findLineBreak(BufferType buffer, qint64 start, qint64 length, qint64 n) const
+{
+    const char *data = bufferData(buffer);
+    qint64 scanPos = start;
+
+    // 原始数据通过索引跳过不包含目标换行符的索引块
+    if (Original == buffer && !m_originalIndex.isEmpty()) {
+        qint64 startBlock = start / EIndexBlockSize;
+        qint64 target = m_originalIndex.at(static_cast<int>(startBlock))
+                        + countNewLine(m_original + startBlock * EIndexBlockSize, start - startBlock * EIndexBlockSize)
+                        + n;
+        // 查找首个换行符累计数量不小于目标的索引位置，目标换行符位于其前一个索引块中
+        auto itr = std::lower_bound(m_originalIndex.constBegin(), m_originalIndex.constEnd(), target);
+        qint64 block = qMax<qint64>(startBlock, (itr - m_originalIndex.constBegin()) - 1);
+        if (block > startBlock) {
+            scanPos = block * EIndexBlockSize;
+            n = target - m_originalIndex.at(static_cast<int>(block));
+        }
+    }
+
+    const char *end = data + start + length;
+    const char *cur = data + scanPos;
+    while (cur < end) {
+        const void *found = ::memchr(cur, '\n', static_cast<size_t>(end - cur));
+        if (!found) {
+            break;
+        }
+        cur = static_cast<const char *>(found) + 1;
+        if (--n <= 0) {
+            return cur - data;
+        }
+    }
+
+    return start + length;
+}
+
+/**
+ * @brief 构建原始数据的换行符索引，第 i 项为第 i 个索引块起始位置之前的换行符数量，
+ *      并以完整的原始数据初始化片段表
+ */
+void PieceTable::buildOriginalIndex()
+{
+    qint64 blockCount = (m_originalLength + EIndexBlockSize - 1) / EIndexBlockSize;
+    m_originalIndex.resize(static_cast<int>(blockCount + 1));
+    m_originalIndex[0] = 0;
+    for (qint64 block = 0; block < blockCount; ++block) {
+        qint64 blockBegin = block * EIndexBlockSize;
+        qint64 blockLength = qMin<qint64>(EIndexBlockSize, m_originalLength - blockBegin);
+        m_originalIndex[static_cast<int>(block + 1)] = m_originalIndex.at(static_cast<int>(block))
+                                                        + countNewLine(m_original + blockBegin, blockLength);
+    }
+
+    m_pieces.clear();
+    if (m_originalLength > 0) {
+        Piece piece;
+        piece.buffer = Original;
+        piece.start = 0;
+        piece.length = m_originalLength;
+        piece.lineBreaks = m_originalIndex.last();
+        m_pieces.append(piece);
+    }
+    m_length = m_originalLength;
+}
+
+/**
+ * @brief 在偏移位置 \a pos 处分割片段
+ * @return 以 \a pos 开始的片段索引，偏移位于文档末尾时返回片段数量
+ */
+int PieceTable::splitAt(qint64 pos)
+{
+    qint64 pieceOffset = 0;
+    int index = findPiece(pos, pieceOffset);
+    if (index >= m_pieces.size() || pos == pieceOffset) {
+        return index;
+    }
+
+    Piece &piece = m_pieces[index];
+    qint64 splitOffset = pos - pieceOffset;
+
+    Piece backPiece;
+    backPiece.buffer = piece.buffer;
+    backPiece.start = piece.start + splitOffset;
+    backPiece.length = piece.length - splitOffset;
+
+    qint64 frontBreaks = countLineBreaks(piece.buffer, piece.start, splitOffset);
+    backPiece.lineBreaks = piece.lineBreaks - frontBreaks;
+    piece.length = splitOffset;
+    piece.lineBreaks = frontBreaks;
+
+    m_pieces.insert(index + 1, backPiece);
+    return index + 1;
+}
@@ -0,0 +1,101 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef PIECETABLE_H
+#define PIECETABLE_H
+
+#include <QFile>
+#include <QVector>
+#include <QByteArray>
+
+class QIODevice;
+class StreamTranscoder;
+
+/**
+ * @brief 片段表(Piece Table)文本模型，用于超大文件的只读映射与编辑。
+ *      原始文件数据通过内存映射只读访问，编辑插入的数据追加到追加缓冲区，文档内容由按顺序排列的
+ *      片段(Piece)描述，每个片段引用原始缓冲区或追加缓冲区中的一段数据。
+ *      内存占用与编辑量及访问的数据范围相关，与文件大小无关；保存时按片段顺序流式写入磁盘。
+ *
+ * @note 偏移量均为 UTF-8 编码的字节偏移，非 UTF-8 编码的文件需转换后通过 setData() 设置。
+ */
+class PieceTable
+{
+public:
+    // 片段引用的缓冲区
+    enum BufferType {
+        Original,   // 原始数据(只读)
+        Add,        // 追加缓冲区
+    };
+
+    // 文档片段
+    struct Piece {
+        BufferType buffer = Original;
+        qint64 start = 0;           // 在缓冲区中的起始偏移
+        qint64 length = 0;          // 片段长度
+        qint64 lineBreaks = 0;      // 片段包含的换行符数量
+    };
+
+    PieceTable();
+    ~PieceTable();
+
+    // 以只读内存映射方式打开文件作为原始数据
+    bool openFile(const QString &filePath);
+    // 设置原始数据，用于已转码的文本
+    void setData(const QByteArray &data);
+    // 清空文档
+    void clear();
+
+    // 文档长度
+    qint64 length() const;
+    // 文档行数
+    qint64 lineCount() const;
+    // 片段数量
+    int pieceCount() const;
+
+    // 在偏移位置 pos 插入数据
+    void insert(qint64 pos, const QByteArray &data);
+    // 移除偏移位置 pos 开始的 len 长度数据
+    void remove(qint64 pos, qint64 len);
+
+    // 取得偏移位置 pos 开始的 len 长度数据
+    QByteArray mid(qint64 pos, qint64 len) const;
+    // 取得行号 line (从0开始)的起始偏移，行号越界时返回文档长度
+    qint64 lineStart(qint64 line) const;
+    // 取得从 firstLine 开始的 count 行数据，用于仅渲染可见区域
+    QByteArray lines(qint64 firstLine, qint64 count) const;
+
+    // 按片段顺序流式写入设备，transcoder 不为空时转换编码后写入
+    bool writeTo(QIODevice *device, StreamTranscoder *transcoder = nullptr) const;
+    // 按编码 encode 原子保存到文件，openFailed 返回文件是否打开失败(无权限等)
+    bool saveToFile(const QString &filePath, const QString &encode = QString("UTF-8"), bool *openFailed = nullptr) const;
+
+private:
+    // 取得缓冲区数据
+    const char *bufferData(BufferType buffer) const;
+    // 查找偏移位置 pos 所在的片段，返回片段索引及片段起始偏移
+    int findPiece(qint64 pos, qint64 &pieceOffset) const;
+    // 统计缓冲区指定范围内的换行符数量
+    qint64 countLineBreaks(BufferType buffer, qint64 start, qint64 length) const;
+    // 查找缓冲区指定范围内第 n 个(从1开始)换行符后的偏移
+    qint64 findLineBreak(BufferType buffer, qint64 start, qint64 length, qint64 n) const;
+    // 构建原始数据的换行符索引
+    void buildOriginalIndex();
+    // 在偏移位置 pos 处分割片段，返回以 pos 开始的片段索引
+    int splitAt(qint64 pos);
+
+private:
+    Q_DISABLE_COPY(PieceTable)
+
+    QFile m_file;                       // 映射的文件
+    const char *m_original = nullptr;   // 原始数据
+    qint64 m_originalLength = 0;        // 原始数据长度
+    QByteArray m_originalData;          // 通过 setData() 设置的原始数据
+    QVector<qint64> m_originalIndex;    // 原始数据每个索引块起始位置之前的换行符数量
+    QByteArray m_addBuffer;             // 追加缓冲区
+    QVector<Piece> m_pieces;            // 文档片段
+    qint64 m_length = 0;                // 文档长度
+};
+
+#endif // PIECETABLE_H
@@ -0,0 +1,84 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "searchcontroller.h"
+
+SearchController::SearchController(QObject *parent)
+    : QObject(parent)
+{
+    m_timer.setSingleShot(true);
+    m_timer.setInterval(EDebounceInterval);
+    connect(&m_timer, &QTimer::timeout, this, &SearchController::onTimeout);
+}
+
+/**
+ * @brief 输入关键字 \a keyword 。关键字变更时发送 sigKeywordChanged() 信号并重新计时，
+ *      输入停顿 interval() 后发送 sigSearchRequested() 信号；关键字为空时立即发送，用于清除高亮。
+ *      同一关键字(如切换查找模式)同样重新查找。
+ */
+void SearchController::setKeyword(QWidget *widget, const QString &file, const QString &keyword)
+{
+    if (keyword != m_lastKeyword) {
+        m_lastKeyword = keyword;
+        emit sigKeywordChanged(file, keyword);
+    }
+
+    m_widget = widget;
+    m_file = file;
+    m_keyword = keyword;
+    m_pending = true;
+
+    if (keyword.isEmpty()) {
+        flush();
+    } else {
+        m_timer.start();
+    }
+}
+
+/**
+ * @brief 立即执行等待中的查找，没有等待中的查找时无操作
+ */
+void SearchController::flush()
+{
+    m_timer.stop();
+    if (!m_pending) {
+        return;
+    }
+
+    m_pending = false;
+    if (m_widget) {
+        emit sigSearchRequested(m_widget, m_file, m_keyword);
+    }
+}
+
+void SearchController::cancel()
+{
+    m_timer.stop();
+    m_pending = false;
+}
+
+bool SearchController::isPending() const
+{
+    return m_pending;
+}
+
+QString SearchController::pendingKeyword() const
+{
+    return m_pending ? m_keyword : QString();
+}
+
+int SearchController::interval() const
+{
+    return m_timer.interval();
+}
+
+void SearchController::setInterval(int msec)
+{
+    m_timer.setInterval(msec);
+}
+
+void SearchController::onTimeout()
+{
+    flush();
+}
@@ -0,0 +1,61 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef SEARCHCONTROLLER_H
+#define SEARCHCONTROLLER_H
+
+#include <QObject>
+#include <QPointer>
+#include <QString>
+#include <QTimer>
+#include <QWidget>
+
+/**
+ * @brief 查找栏、替换栏输入关键字时的查找调度。连续输入时延迟到输入停顿后才查找，
+ *      期间仅发送 sigKeywordChanged() 信号以便取消进行中的查找；清空关键字时立即查找。
+ *      查找、替换等操作前调用 flush() 立即执行等待中的查找，保证使用最新的关键字。
+ */
+class SearchController : public QObject
+{
+    Q_OBJECT
+public:
+    enum ControllerParam {
+        EDebounceInterval = 150,        // 输入停顿多长时间(ms)后开始查找
+    };
+
+    explicit SearchController(QObject *parent = nullptr);
+
+    // 输入关键字 keyword ，重新开始计时，停顿后发送 sigSearchRequested() 信号
+    void setKeyword(QWidget *widget, const QString &file, const QString &keyword);
+    // 立即执行等待中的查找
+    void flush();
+    // 丢弃等待中的查找
+    void cancel();
+    // 是否有等待执行的查找
+    bool isPending() const;
+    // 等待中的查找关键字
+    QString pendingKeyword() const;
+
+    int interval() const;
+    void setInterval(int msec);
+
+signals:
+    // 输入的关键字变更，之前关键字的查找结果已不再需要
+    void sigKeywordChanged(const QString &file, const QString &keyword);
+    // 输入停顿，按关键字 keyword 查找文件 file
+    void sigSearchRequested(QWidget *widget, const QString &file, const QString &keyword);
+
+private slots:
+    void onTimeout();
+
+private:
+    QTimer m_timer;                 // 输入停顿计时
+    QPointer<QWidget> m_widget;     // 输入关键字的查找栏或替换栏
+    QString m_file;                 // 查找的文件
+    QString m_keyword;              // 等待查找的关键字
+    QString m_lastKeyword;          // 上次输入的关键字
+    bool m_pending = false;         // 是否有等待执行的查找
+};
+
+#endif // SEARCHCONTROLLER_H
@@ -0,0 +1,302 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "textfilewriter.h"
+#include "../encodes/streamtranscoder.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QTextBlock>
+#include <QTextCodec>
+#include <QTextDocument>
+#include <QDebug>
+
+#include <unistd.h>
+
+TextFileWriter::TextFileWriter(QTextDocument *document, const QString &encode, bool windowsEndline)
+    : m_document(document)
+    , m_encode(encode)
+    , m_windowsEndline(windowsEndline)
+{
+}
+
+/**
+ * @brief 使用文档内容快照 \a blocks 构造，\a blocks 由 snapshot() 取得，
+ *      快照不受界面线程后续编辑的影响，可在后台线程中写入
+ */
+TextFileWriter::TextFileWriter(const BlockSnapshot &blocks, const QString &encode, bool windowsEndline)
+    : m_blocks(blocks)
+    , m_encode(encode)
+    , m_windowsEndline(windowsEndline)
+{
+}
+
+TextFileWriter::~TextFileWriter()
+{
+    delete m_transcoder;
+    delete m_encoder;
+}
+
+void TextFileWriter::setProgressCallback(const TextFileWriter::ProgressCallback &callback)
+{
+    m_progressCallback = callback;
+}
+
+/**
+ * @brief 文档 \a document 是否需要使用流式保存，超大文档整体转换时内存占用约为文档大小的数倍
+ */
+bool TextFileWriter::isStreamSaveRequired(QTextDocument *document)
+{
+    return document && document->characterCount() > EStreamSaveThreshold;
+}
+
+/**
+ * @brief 按文本块取得文档 \a document 的内容快照，用于后台线程写入。快照不需要 toPlainText()
+ *      所需的整块连续内存，写入时逐块释放，内存占用随写入进度减少
+ */
+TextFileWriter::BlockSnapshot TextFileWriter::snapshot(QTextDocument *document)
+{
+    BlockSnapshot blocks;
+    if (!document) {
+        return blocks;
+    }
+
+    blocks.reserve(document->blockCount());
+    for (QTextBlock block = document->begin(); block.isValid(); block = block.next()) {
+        blocks.append(block.text());
+    }
+    return blocks;
+}
+
+/**
+ * @brief 按文本块遍历文档，转换换行符及文本编码后流式写入设备 \a device
+ * @return 是否写入成功
+ */
+bool TextFileWriter::write(QIODevice *device)
+{
+    setError(NoError, QString());
+    if (!device) {
+        setError(WriteDataError, QString("Invalid device"));
+        return false;
+    }
+
+    delete m_transcoder;
+    m_transcoder = nullptr;
+    delete m_encoder;
+    m_encoder = nullptr;
+
+    // 文档内容为 UTF-8 编码，其它编码使用流式转换
+    if (0 != m_encode.compare(QString("UTF-8"), Qt::CaseInsensitive)) {
+        m_transcoder = new StreamTranscoder(QString("UTF-8"), m_encode);
+        if (!m_transcoder->isValid()) {
+            delete m_transcoder;
+            m_transcoder = nullptr;
+
+            // 使用 QTextCodec 进行转换尝试
+            QTextCodec *codec = QTextCodec::codecForName(m_encode.toUtf8());
+            if (!codec) {
+                setError(EncodeError, QString("Unsupported encode: %1").arg(m_encode));
+                return false;
+            }
+            m_encoder = codec->makeEncoder();
+        }
+    }
+
+    m_chunk.clear();
+    m_chunk.reserve(EChunkSize);
+    m_writtenSize = 0;
+    if (m_document) {
+        m_totalSize = m_document->characterCount();
+    } else {
+        // 文本块之间以换行符分隔
+        m_totalSize = qMax(0, m_blocks.size() - 1);
+        for (const QString &blockText : qAsConst(m_blocks)) {
+            m_totalSize += blockText.size();
+        }
+    }
+
+    bool ok = m_document ? writeDocument(device) : writeBlocks(device);
+    return ok && finishWrite(device);
+}
+
+/**
+ * @brief 通过 QSaveFile 将文档原子保存到文件 \a filePath ，写入失败时放弃写入，原文件内容不变
+ * @return 是否保存成功
+ */
+bool TextFileWriter::save(const QString &filePath)
+{
+    // 过长的文件名创建临时文件时可能超过长度限制，不使用 QSaveFile ，见 EditWrapper::saveAsFile()
+    const int limitFileNameLength = 245;
+    if (QFileInfo(filePath).fileName().length() > limitFileNameLength) {
+        QFile file(filePath);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            setError(OpenError, file.errorString());
+            return false;
+        }
+
+        bool ok = write(&file);
+        file.close();
+        return ok && QFileDevice::NoError == file.error();
+    }
+
+    QSaveFile file(filePath);
+    file.setDirectWriteFallback(true);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        setError(OpenError, file.errorString());
+        return false;
+    }
+
+    if (!write(&file)) {
+        file.cancelWriting();
+        return false;
+    }
+
+    if (!file.flush()) {
+        setError(WriteDataError, file.errorString());
+        file.cancelWriting();
+        return false;
+    }
+    // ensure that the file is written to disk
+    fsync(file.handle());
+
+    if (!file.commit()) {
+        setError(WriteDataError, file.errorString());
+        return false;
+    }
+
+    return true;
+}
+
+TextFileWriter::WriteError TextFileWriter::error() const
+{
+    return m_error;
+}
+
+QString TextFileWriter::errorString() const
+{
+    return m_errorString;
+}
+
+bool TextFileWriter::writeDocument(QIODevice *device)
+{
+    for (QTextBlock block = m_document->begin(); block.isValid(); block = block.next()) {
+        if (!appendBlock(block.text(), !block.next().isValid(), device)) {
+            return false;
+        }
+    }
+
+    return flushChunk(device);
+}
+
+bool TextFileWriter::writeBlocks(QIODevice *device)
+{
+    const int count = m_blocks.size();
+    for (int i = 0; i < count; ++i) {
+        // 取出文本块内容，追加后即释放，快照占用的内存随写入进度减少
+        QString blockText;
+        blockText.swap(m_blocks[i]);
+        if (!appendBlock(blockText, i + 1 == count, device)) {
+            return false;
+        }
+    }
+
+    return flushChunk(device);
+}
+
+bool TextFileWriter::appendBlock(const QString &blockText, bool lastBlock, QIODevice *device)
+{
+    m_chunk.append(blockText);
+    if (!lastBlock) {
+        m_chunk.append(QLatin1Char('\n'));
+    }
+
+    // 数据块按文本块边界分割，不会截断 UTF-16 代理对
+    if (m_chunk.size() >= EChunkSize) {
+        return flushChunk(device);
+    }
+    return true;
+}
+
+bool TextFileWriter::flushChunk(QIODevice *device)
+{
+    if (m_chunk.isEmpty()) {
+        return true;
+    }
+    const int chunkLength = m_chunk.size();
+
+    // 与 QTextDocument::toPlainText() 的处理保持一致
+    QChar *uc = m_chunk.data();
+    QChar *end = uc + m_chunk.size();
+    for (; uc != end; ++uc) {
+        switch (uc->unicode()) {
+            case 0xfdd0: // QTextBeginningOfFrame
+            case 0xfdd1: // QTextEndOfFrame
+            case QChar::ParagraphSeparator:
+            case QChar::LineSeparator:
+                *uc = QLatin1Char('\n');
+                break;
+            case QChar::Nbsp:
+                *uc = QLatin1Char(' ');
+                break;
+            default:
+                break;
+        }
+    }
+
+    if (m_windowsEndline) {
+        m_chunk.replace(QLatin1Char('\n'), QLatin1String("\r\n"));
+    }
+
+    bool ok = false;
+    if (m_encoder) {
+        ok = writeData(device, m_encoder->fromUnicode(m_chunk));
+    } else if (m_transcoder) {
+        m_outData.resize(0);
+        m_transcoder->convert(m_chunk.toUtf8(), m_outData);
+        ok = writeData(device, m_outData);
+    } else {
+        ok = writeData(device, m_chunk.toUtf8());
+    }
+
+    m_writtenSize += chunkLength;
+    m_chunk.resize(0);
+    if (ok && m_progressCallback) {
+        m_progressCallback(m_writtenSize, m_totalSize);
+    }
+    return ok;
+}
+
+bool TextFileWriter::finishWrite(QIODevice *device)
+{
+    if (!m_transcoder) {
+        return true;
+    }
+
+    m_outData.resize(0);
+    m_transcoder->finish(m_outData);
+    if (m_transcoder->errorCount() > 0) {
+        qWarning() << qPrintable("iconv() convert text encoding error, invalid sequence count:") << m_transcoder->errorCount();
+    }
+    return writeData(device, m_outData);
+}
+
+bool TextFileWriter::writeData(QIODevice *device, const QByteArray &data)
+{
+    if (data.isEmpty()) {
+        return true;
+    }
+
+    if (device->write(data) != data.size()) {
+        setError(WriteDataError, device->errorString());
+        return false;
+    }
+    return true;
+}
+
+void TextFileWriter::setError(WriteError error, const QString &errorString)
+{
+    m_error = error;
+    m_errorString = errorString;
+}
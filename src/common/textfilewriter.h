@@ -0,0 +1,100 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef TEXTFILEWRITER_H
+#define TEXTFILEWRITER_H
+
+#include <QString>
+#include <QVector>
+#include <QByteArray>
+
+#include <functional>
+
+class QIODevice;
+class QTextDocument;
+class QTextEncoder;
+class StreamTranscoder;
+
+/**
+ * @brief 文本文件流式写入，按文本块(QTextBlock)遍历文档，每累积一个数据块即转换换行符及文本编码并写入设备，
+ *      无需构造完整的文件数据，峰值内存与数据块大小相关。
+ *      输出内容与 QTextDocument::toPlainText() 转换后的结果一致。
+ *      也可使用按文本块取得的文档内容快照构造，在后台线程中写入。
+ */
+class TextFileWriter
+{
+public:
+    enum WriterParam {
+        EChunkSize = 1024 * 1024,               // 单次转换写入的字符数
+        EStreamSaveThreshold = 32 * 1024 * 1024 // 超过此字符数的文档使用流式保存
+    };
+
+    // 写入错误类型
+    enum WriteError {
+        NoError,
+        OpenError,      // 文件打开失败(无权限等)
+        EncodeError,    // 不支持的文本编码
+        WriteDataError, // 写入数据失败
+    };
+
+    // 写入进度回调，参数为已写入及总的字符数
+    typedef std::function<void (qint64 written, qint64 total)> ProgressCallback;
+    // 文档内容快照，每个元素为一个文本块的内容
+    typedef QVector<QString> BlockSnapshot;
+
+    TextFileWriter(QTextDocument *document, const QString &encode, bool windowsEndline);
+    // 使用文档内容快照 blocks 构造，可在非界面线程中写入，写入时逐块释放快照数据，仅能写入一次
+    TextFileWriter(const BlockSnapshot &blocks, const QString &encode, bool windowsEndline);
+    ~TextFileWriter();
+
+    // 设置写入进度回调，在写入线程中调用
+    void setProgressCallback(const ProgressCallback &callback);
+
+    // 文档是否需要使用流式保存
+    static bool isStreamSaveRequired(QTextDocument *document);
+    // 按文本块取得文档内容快照
+    static BlockSnapshot snapshot(QTextDocument *document);
+
+    // 流式写入设备
+    bool write(QIODevice *device);
+    // 通过 QSaveFile 原子保存到文件，写入失败时不修改原文件
+    bool save(const QString &filePath);
+
+    WriteError error() const;
+    QString errorString() const;
+
+private:
+    // 按文本块写入文档
+    bool writeDocument(QIODevice *device);
+    // 按文本块写入文档内容快照
+    bool writeBlocks(QIODevice *device);
+    // 追加文本块内容，数据块已满时写入设备
+    bool appendBlock(const QString &blockText, bool lastBlock, QIODevice *device);
+    // 转换当前数据块并写入设备
+    bool flushChunk(QIODevice *device);
+    // 转换结束，写入转换器中剩余的数据
+    bool finishWrite(QIODevice *device);
+    // 写入编码后的数据
+    bool writeData(QIODevice *device, const QByteArray &data);
+    void setError(WriteError error, const QString &errorString);
+
+private:
+    Q_DISABLE_COPY(TextFileWriter)
+
+    QTextDocument *m_document = nullptr;    // 写入的文档
+    BlockSnapshot m_blocks;                 // 文档内容快照，m_document 为空时使用
+    QString m_encode;                       // 文件编码
+    bool m_windowsEndline = false;          // 是否使用 Windows 换行符
+    StreamTranscoder *m_transcoder = nullptr;   // iconv 流式转换
+    QTextEncoder *m_encoder = nullptr;      // iconv 不支持时使用 QTextCodec 转换
+    QString m_chunk;                        // 当前数据块
+    QByteArray m_outData;                   // 编码转换后的数据
+    ProgressCallback m_progressCallback;    // 写入进度回调
+    qint64 m_totalSize = 0;                 // 总的字符数
+    qint64 m_writtenSize = 0;               // 已写入的字符数
+    WriteError m_error = NoError;
+    QString m_errorString;
+};
+
+#endif // TEXTFILEWRITER_H
@@ -0,0 +1,988 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "textsearchengine.h"
+#include "textsearchkernel.h"
+#include "utils.h"
+
+#include <QTextDocument>
+#include <QTextBlock>
+#include <QtConcurrent>
+
+#include <algorithm>
+
+namespace {
+
+// 查找条件及文本快照，各分块只读访问，后台查找时由各分块共同持有
+struct ScanContext {
+    QString text;                               // 文本快照
+    QString keyword;                            // 查找的关键字
+    TextSearchEngine::SearchFlags flags;        // 查找模式
+    QRegularExpression regex;                   // 正则表达式模式下预先编译的表达式
+    bool overlapped = false;                    // 逐字查找时匹配项之间是否可能重叠
+    bool refine = false;                        // 是否仅校验候选位置
+    QVector<int> candidates;                    // 缩小查找范围时的候选位置(之前关键字的匹配项)
+    const QAtomicInt *canceled = nullptr;       // 取消标识
+    QSharedPointer<QAtomicInt> cancelHolder;    // 后台查找时持有取消标识
+};
+
+// 并行查找的分块
+struct ScanChunk {
+    QSharedPointer<const ScanContext> context;
+    int begin;
+    int end;
+};
+
+/**
+ * @brief 正则表达式及全词匹配模式按行查找，匹配项不跨行
+ */
+inline bool isLineMode(TextSearchEngine::SearchFlags flags)
+{
+    return flags & (TextSearchEngine::EWholeWord | TextSearchEngine::ERegularExpression);
+}
+
+inline Qt::CaseSensitivity caseSensitivity(TextSearchEngine::SearchFlags flags)
+{
+    return flags.testFlag(TextSearchEngine::ECaseInsensitive) ? Qt::CaseInsensitive : Qt::CaseSensitive;
+}
+
+/**
+ * @brief 关键字 \a keyword 是否存在相同的前缀和后缀(如 "aa" "abab")，不存在时匹配项之间不会重叠
+ */
+bool hasBorder(const QString &keyword, Qt::CaseSensitivity cs)
+{
+    const QString pattern = Qt::CaseSensitive == cs ? keyword : keyword.toCaseFolded();
+    const int length = pattern.length();
+    if (length < 2) {
+        return false;
+    }
+
+    // KMP 前缀函数，prefix[i] 为 pattern[0, i] 最长的相同前后缀长度
+    QVector<int> prefix(length, 0);
+    int matched = 0;
+    for (int i = 1; i < length; ++i) {
+        while (matched > 0 && pattern.at(i) != pattern.at(matched)) {
+            matched = prefix.at(matched - 1);
+        }
+        if (pattern.at(i) == pattern.at(matched)) {
+            ++matched;
+        }
+        prefix[i] = matched;
+    }
+
+    return prefix.at(length - 1) > 0;
+}
+
+/**
+ * @brief 查找文本 \a text 中起始位置位于 [ \a begin, \a end) 的匹配项，匹配项可延伸到 \a end 之后
+ * @param step 找到匹配项后跳过的字符数，为 1 时返回所有(允许重叠)的匹配项
+ * @return 匹配项起始位置，取消时返回已找到的部分
+ */
+QVector<int> scanRange(const QString &text, const QString &keyword, Qt::CaseSensitivity cs,
+                       int begin, int end, int step, const QAtomicInt *canceled)
+{
+    QVector<int> offsets;
+    const int limit = qMin(text.length(), end + keyword.length() - 1);
+
+    int pos = TextSearchKernel::indexOf(text.constData(), limit, keyword.constData(), keyword.length(), begin, cs);
+    while (pos >= 0 && pos < end) {
+        offsets.append(pos);
+        if (canceled && canceled->loadAcquire()) {
+            break;
+        }
+        pos = TextSearchKernel::indexOf(text.constData(), limit, keyword.constData(), keyword.length(), pos + step, cs);
+    }
+
+    return offsets;
+}
+
+/**
+ * @brief 全词匹配查找 [ \a begin, \a end) 内互不重叠的匹配项，匹配项前后的字符不能是字母或数字，
+ *      与 QTextDocument::FindWholeWords 的判断一致。 \a end 须位于行首或文本末尾
+ */
+QVector<int> scanWords(const QString &text, const QString &keyword, Qt::CaseSensitivity cs,
+                       int begin, int end, const QAtomicInt *canceled)
+{
+    QVector<int> offsets;
+    const int length = keyword.length();
+    // 按行查找，包含换行符的关键字不会匹配
+    if (0 == length || keyword.contains(QLatin1Char('\n'))) {
+        return offsets;
+    }
+
+    const QChar *data = text.constData();
+    int pos = TextSearchKernel::indexOf(data, end, keyword.constData(), length, begin, cs);
+    while (pos >= 0) {
+        const bool wordBegin = (0 == pos || !data[pos - 1].isLetterOrNumber());
+        const bool wordEnd = (pos + length >= text.length() || !data[pos + length].isLetterOrNumber());
+        if (wordBegin && wordEnd) {
+            offsets.append(pos);
+            pos += length;
+        } else {
+            ++pos;
+        }
+
+        if (canceled && canceled->loadAcquire()) {
+            break;
+        }
+        pos = TextSearchKernel::indexOf(data, end, keyword.constData(), length, pos, cs);
+    }
+
+    return offsets;
+}
+
+/**
+ * @brief 逐行匹配正则表达式 \a regex ，查找 [ \a begin, \a end) 内长度不为 0 的匹配项。
+ *      \a begin 和 \a end 须位于行首或文本末尾，各行直接引用文本快照的数据，不复制行文本
+ */
+void scanRegex(const QString &text, const QRegularExpression &regex, int begin, int end,
+               const QAtomicInt *canceled, QVector<int> &offsets, QVector<int> &lengths)
+{
+    if (!regex.isValid()) {
+        return;
+    }
+
+    int lineStart = begin;
+    while (lineStart < end) {
+        int lineEnd = text.indexOf(QLatin1Char('\n'), lineStart);
+        if (lineEnd < 0 || lineEnd > end) {
+            lineEnd = end;
+        }
+
+        const QString line = QString::fromRawData(text.constData() + lineStart, lineEnd - lineStart);
+        QRegularExpressionMatchIterator itr = regex.globalMatch(line);
+        while (itr.hasNext()) {
+            const QRegularExpressionMatch match = itr.next();
+            // 跳过长度为 0 的匹配项(如 "^" "a*")
+            if (match.capturedLength() > 0) {
+                offsets.append(lineStart + match.capturedStart());
+                lengths.append(match.capturedLength());
+            }
+
+            if (canceled && canceled->loadAcquire()) {
+                return;
+            }
+        }
+
+        if (canceled && canceled->loadAcquire()) {
+            return;
+        }
+        lineStart = lineEnd + 1;
+    }
+}
+
+/**
+ * @brief 按行查找文本 \a text 中 [ \a begin, \a end) 内的匹配项，用于正则表达式及全词匹配模式
+ */
+SearchResult scanLines(const QString &text, const QString &keyword, TextSearchEngine::SearchFlags flags,
+                       const QRegularExpression &regex, int begin, int end, const QAtomicInt *canceled)
+{
+    if (flags.testFlag(TextSearchEngine::ERegularExpression)) {
+        QVector<int> offsets;
+        QVector<int> lengths;
+        scanRegex(text, regex, begin, end, canceled, offsets, lengths);
+        return SearchResult(offsets, lengths);
+    }
+
+    return SearchResult(scanWords(text, keyword, caseSensitivity(flags), begin, end, canceled), keyword.length());
+}
+
+/**
+ * @brief 校验起始位置位于 [ \a begin, \a end) 的候选位置 \a candidates 处是否为关键字，匹配项可延伸到 \a end 之后
+ * @return 匹配关键字的候选位置，取消时返回已找到的部分
+ */
+QVector<int> refineRange(const QString &text, const QString &keyword, Qt::CaseSensitivity cs,
+                         const QVector<int> &candidates, int begin, int end, const QAtomicInt *canceled)
+{
+    QVector<int> offsets;
+    const int length = keyword.length();
+    auto itr = std::lower_bound(candidates.constBegin(), candidates.constEnd(), begin);
+    for (int count = 0; itr != candidates.constEnd() && *itr < end; ++itr, ++count) {
+        if (canceled && 0 == (count & 0x3ff) && canceled->loadAcquire()) {
+            break;
+        }
+
+        const int pos = *itr;
+        if (pos + length <= text.length() && 0 == QStringRef(&text, pos, length).compare(keyword, cs)) {
+            offsets.append(pos);
+        }
+    }
+
+    return offsets;
+}
+
+SearchResult scanChunk(const ScanChunk &chunk)
+{
+    const ScanContext &context = *chunk.context;
+    if (context.refine) {
+        return SearchResult(refineRange(context.text, context.keyword, caseSensitivity(context.flags),
+                                        context.candidates, chunk.begin, chunk.end, context.canceled),
+                            context.keyword.length());
+    }
+    if (isLineMode(context.flags)) {
+        return scanLines(context.text, context.keyword, context.flags, context.regex, chunk.begin, chunk.end, context.canceled);
+    }
+
+    const int step = context.overlapped ? 1 : context.keyword.length();
+    return SearchResult(scanRange(context.text, context.keyword, caseSensitivity(context.flags),
+                                  chunk.begin, chunk.end, step, context.canceled),
+                        context.keyword.length());
+}
+
+QSharedPointer<ScanContext> createContext(const QString &text, const QString &keyword,
+                                          TextSearchEngine::SearchFlags flags, const QRegularExpression &regex)
+{
+    QSharedPointer<ScanContext> context(new ScanContext);
+    context->text = text;
+    context->keyword = keyword;
+    context->flags = flags;
+    context->regex = regex;
+    context->overlapped = !isLineMode(flags) && hasBorder(keyword, caseSensitivity(flags));
+    return context;
+}
+
+/**
+ * @brief 按 \a chunkSize 将文本快照分块，按行查找时分块边界对齐到行首，各分块之间没有跨越边界的匹配项
+ */
+QVector<ScanChunk> splitChunks(const QSharedPointer<const ScanContext> &context, int chunkSize)
+{
+    QVector<ScanChunk> chunks;
+    const QString &text = context->text;
+    const bool lineMode = isLineMode(context->flags);
+
+    int begin = 0;
+    while (begin < text.length()) {
+        int end = begin + qMin(chunkSize, text.length() - begin);
+        if (lineMode && end < text.length()) {
+            const int lineEnd = text.indexOf(QLatin1Char('\n'), end - 1);
+            end = lineEnd < 0 ? text.length() : lineEnd + 1;
+        }
+
+        chunks.append({context, begin, end});
+        begin = end;
+    }
+
+    return chunks;
+}
+
+SearchResult emptyResult(const QString &keyword, TextSearchEngine::SearchFlags flags)
+{
+    if (flags.testFlag(TextSearchEngine::ERegularExpression)) {
+        return SearchResult(QVector<int>(), QVector<int>());
+    }
+    return SearchResult(QVector<int>(), keyword.length());
+}
+
+/**
+ * @brief 将替换文本 \a withText 中的 \\0 ~ \\99 替换为匹配项 \a match 对应捕获组的文本，
+ *      与 QString::replace(const QRegularExpression &, const QString &) 的规则一致
+ */
+QString expandReplacement(const QRegularExpressionMatch &match, const QString &withText)
+{
+    auto digitAt = [&withText](int index) {
+        if (index < withText.length()) {
+            const ushort ch = withText.at(index).unicode();
+            if (ch >= '0' && ch <= '9') {
+                return static_cast<int>(ch - '0');
+            }
+        }
+        return -1;
+    };
+
+    QString text;
+    const int lastGroup = match.lastCapturedIndex();
+    for (int i = 0; i < withText.length(); ++i) {
+        if (QLatin1Char('\\') == withText.at(i)) {
+            int group = digitAt(i + 1);
+            int used = 1;
+            if (group >= 0 && digitAt(i + 2) >= 0 && group * 10 + digitAt(i + 2) <= lastGroup) {
+                group = group * 10 + digitAt(i + 2);
+                used = 2;
+            }
+
+            if (group >= 0 && group <= lastGroup) {
+                text.append(match.captured(group));
+                i += used;
+                continue;
+            }
+        }
+
+        text.append(withText.at(i));
+    }
+
+    return text;
+}
+
+}
+
+SearchResult::SearchResult()
+{
+}
+
+SearchResult::SearchResult(const QVector<int> &offsets, int matchLength)
+    : m_offsets(offsets)
+    , m_matchLength(matchLength)
+{
+}
+
+SearchResult::SearchResult(const QVector<int> &offsets, const QVector<int> &lengths)
+    : m_offsets(offsets)
+    , m_lengths(lengths)
+{
+}
+
+bool SearchResult::isEmpty() const
+{
+    return m_offsets.isEmpty();
+}
+
+int SearchResult::count() const
+{
+    return m_offsets.size();
+}
+
+int SearchResult::matchLength() const
+{
+    return m_matchLength;
+}
+
+int SearchResult::offsetAt(int index) const
+{
+    return m_offsets.at(index);
+}
+
+int SearchResult::lengthAt(int index) const
+{
+    return m_lengths.isEmpty() ? m_matchLength : m_lengths.at(index);
+}
+
+const QVector<int> &SearchResult::offsets() const
+{
+    return m_offsets;
+}
+
+int SearchResult::indexOf(int position) const
+{
+    auto itr = std::lower_bound(m_offsets.constBegin(), m_offsets.constEnd(), position);
+    if (itr != m_offsets.constEnd() && *itr == position) {
+        return static_cast<int>(itr - m_offsets.constBegin());
+    }
+    return -1;
+}
+
+int SearchResult::nextIndex(int position) const
+{
+    auto itr = std::lower_bound(m_offsets.constBegin(), m_offsets.constEnd(), position);
+    if (itr != m_offsets.constEnd()) {
+        return static_cast<int>(itr - m_offsets.constBegin());
+    }
+    return -1;
+}
+
+int SearchResult::previousIndex(int position) const
+{
+    auto itr = std::lower_bound(m_offsets.constBegin(), m_offsets.constEnd(), position);
+    return static_cast<int>(itr - m_offsets.constBegin()) - 1;
+}
+
+QPair<int, int> SearchResult::indexRange(int begin, int end) const
+{
+    auto first = std::lower_bound(m_offsets.constBegin(), m_offsets.constEnd(), begin);
+    auto last = std::upper_bound(first, m_offsets.constEnd(), end);
+    return qMakePair(static_cast<int>(first - m_offsets.constBegin()), static_cast<int>(last - m_offsets.constBegin()));
+}
+
+TextSearchEngine::TextSearchEngine(QTextDocument *document, QObject *parent)
+    : QObject(parent)
+    , m_document(document)
+{
+    connect(m_document, &QTextDocument::contentsChange, this, &TextSearchEngine::onContentsChange);
+    connect(&m_watcher, &QFutureWatcher<SearchResult>::resultReadyAt, this, &TextSearchEngine::onResultReadyAt);
+    connect(&m_watcher, &QFutureWatcher<SearchResult>::finished, this, &TextSearchEngine::onSearchFinished);
+
+    m_restartTimer.setSingleShot(true);
+    m_restartTimer.setInterval(ERestartDelay);
+    connect(&m_restartTimer, &QTimer::timeout, this, [this]() {
+        start(m_keyword, m_flags);
+    });
+}
+
+TextSearchEngine::~TextSearchEngine()
+{
+    if (m_canceled) {
+        m_canceled->storeRelease(1);
+    }
+    m_watcher.cancel();
+    m_watcher.waitForFinished();
+}
+
+/**
+ * @brief 复制文档文本快照，按查找模式 \a flags 在后台线程池中分块查找关键字 \a keyword 。
+ *      新关键字为之前关键字的扩展时(如 "ab" 扩展为 "abc")，仅校验之前的匹配项位置，无需查找全文。
+ *      正则表达式仅在此处编译一次，各分块共享；分块按顺序完成时发送 sigPartialResult() 信号，
+ *      全部完成后发送 sigResultChanged() 信号。之前未完成的查找将被取消，其结果不会再通知。
+ */
+void TextSearchEngine::start(const QString &keyword, SearchFlags flags)
+{
+    // 新关键字为之前关键字的扩展时，匹配项必然位于之前的匹配项处，仅需校验这些位置
+    const bool refine = canRefine(keyword, flags);
+    QVector<int> candidates;
+    if (refine) {
+        candidates = m_result.offsets();
+    }
+
+    if (m_canceled) {
+        m_canceled->storeRelease(1);
+    }
+    m_watcher.cancel();
+
+    m_keyword = keyword;
+    m_flags = flags;
+    m_regex = flags.testFlag(ERegularExpression) ? regularExpression(keyword, flags) : QRegularExpression();
+    m_keywordHasBorder = !isLineMode(flags) && hasBorder(keyword, caseSensitivity(flags));
+    m_result = emptyResult(keyword, flags);
+    m_valid = false;
+    m_readyChunks = 0;
+    m_chunkEnds.clear();
+    m_restartPending = false;
+    m_pendingStart = -1;
+    m_pendingFrom = -1;
+    m_pendingChanges.clear();
+    m_restartTimer.stop();
+    if (keyword.isEmpty()) {
+        return;
+    }
+
+    m_canceled.reset(new QAtomicInt(0));
+    QSharedPointer<ScanContext> context = createContext(m_document->toPlainText(), keyword, flags, m_regex);
+    context->cancelHolder = m_canceled;
+    context->canceled = m_canceled.data();
+    context->refine = refine;
+    context->candidates = candidates;
+    m_length = context->text.length();
+
+    const QVector<ScanChunk> chunks = splitChunks(context, EChunkSize);
+    m_chunkEnds.reserve(chunks.size());
+    for (const ScanChunk &chunk : chunks) {
+        m_chunkEnds.append(chunk.end);
+    }
+    m_watcher.setFuture(QtConcurrent::mapped(chunks, scanChunk));
+}
+
+/**
+ * @brief 按关键字 \a keyword 查找时能否复用当前的查找结果。逐字查找时，之前的关键字是新关键字的前缀，
+ *      则新关键字的每个匹配项起始位置都是之前关键字的出现位置；之前的关键字不存在相同的前后缀时，
+ *      查找结果包含其所有出现位置，只需校验这些位置。全词匹配及正则表达式模式不满足此关系。
+ */
+bool TextSearchEngine::canRefine(const QString &keyword, SearchFlags flags) const
+{
+    return m_valid && !m_keyword.isEmpty() && flags == m_flags && !isLineMode(flags) && !m_keywordHasBorder
+           && keyword.length() > m_keyword.length() && keyword.startsWith(m_keyword, caseSensitivity(flags))
+           && m_length == m_document->characterCount() - 1;
+}
+
+void TextSearchEngine::clear()
+{
+    if (m_canceled) {
+        m_canceled->storeRelease(1);
+    }
+    m_watcher.cancel();
+
+    m_keyword.clear();
+    m_result = SearchResult();
+    m_valid = false;
+    m_readyChunks = 0;
+    m_chunkEnds.clear();
+    m_restartPending = false;
+    m_pendingStart = -1;
+    m_pendingFrom = -1;
+    m_pendingChanges.clear();
+    m_restartTimer.stop();
+}
+
+/**
+ * @return 是否正在查找，等待延迟重新查找全文时同样视为查找中
+ */
+bool TextSearchEngine::isRunning() const
+{
+    return !m_keyword.isEmpty() && (m_watcher.isRunning() || m_restartTimer.isActive());
+}
+
+bool TextSearchEngine::isValid() const
+{
+    return m_valid;
+}
+
+QString TextSearchEngine::keyword() const
+{
+    return m_keyword;
+}
+
+TextSearchEngine::SearchFlags TextSearchEngine::searchFlags() const
+{
+    return m_flags;
+}
+
+const SearchResult &TextSearchEngine::result() const
+{
+    return m_result;
+}
+
+/**
+ * @brief 查找文本 \a text 中所有互不重叠的关键字 \a keyword 的起始位置
+ * @return 按位置升序排列的匹配项起始位置
+ * @see search()
+ */
+QVector<int> TextSearchEngine::findAll(const QString &text, const QString &keyword, Qt::CaseSensitivity cs,
+                                       const QAtomicInt *canceled, int chunkSize)
+{
+    SearchFlags flags = ENoSearchFlags;
+    if (Qt::CaseInsensitive == cs) {
+        flags |= ECaseInsensitive;
+    }
+
+    return search(text, keyword, flags, canceled, chunkSize).offsets();
+}
+
+/**
+ * @brief 按查找模式 \a flags 查找文本 \a text 中所有互不重叠的匹配项。
+ *      文本超过 \a chunkSize 时分块并行查找，逐字查找时各分块查找起始位置位于分块内的所有匹配项，
+ *      合并后从前向后筛选互不重叠的匹配项。关键字不存在相同的前后缀时匹配项不会重叠，
+ *      分块查找时直接跳过已匹配的文本，无需再筛选。按行查找时分块对齐到行首，各分块结果直接合并。
+ * @param canceled 取消标识，被置位时中止查找并返回空结果
+ * @return 按位置升序排列的匹配项，正则表达式查找时包含各匹配项长度
+ */
+SearchResult TextSearchEngine::search(const QString &text, const QString &keyword, SearchFlags flags,
+                                      const QAtomicInt *canceled, int chunkSize)
+{
+    SearchResult result = emptyResult(keyword, flags);
+    if (keyword.isEmpty() || chunkSize <= 0 || (!isLineMode(flags) && text.length() < keyword.length())) {
+        return result;
+    }
+
+    const QRegularExpression regex = flags.testFlag(ERegularExpression) ? regularExpression(keyword, flags) : QRegularExpression();
+    QSharedPointer<ScanContext> context = createContext(text, keyword, flags, regex);
+    context->canceled = canceled;
+
+    const QVector<ScanChunk> chunks = splitChunks(context, chunkSize);
+    if (1 == chunks.size()) {
+        mergeResult(result, scanChunk(chunks.first()), context->overlapped);
+    } else if (chunks.size() > 1) {
+        // 阻塞等待时当前线程同样参与分块查找，在线程池中调用不会因线程耗尽而死锁
+        const QList<SearchResult> parts = QtConcurrent::blockingMapped<QList<SearchResult>>(chunks, scanChunk);
+        for (const SearchResult &part : parts) {
+            mergeResult(result, part, context->overlapped);
+        }
+    }
+
+    if (canceled && canceled->loadAcquire()) {
+        return emptyResult(keyword, flags);
+    }
+
+    return result;
+}
+
+/**
+ * @brief 返回查找模式 \a flags 对应的已编译正则表达式，非正则表达式模式时转义关键字 \a keyword 。
+ *      全词匹配时要求匹配项前后不是字母或数字，与 QTextDocument::FindWholeWords 的判断一致。
+ */
+QRegularExpression TextSearchEngine::regularExpression(const QString &keyword, SearchFlags flags)
+{
+    QString pattern = flags.testFlag(ERegularExpression) ? keyword : QRegularExpression::escape(keyword);
+    if (flags.testFlag(EWholeWord)) {
+        pattern = QString("(?<![\\p{L}\\p{N}])(?:%1)(?![\\p{L}\\p{N}])").arg(pattern);
+    }
+
+    QRegularExpression::PatternOptions options = QRegularExpression::UseUnicodePropertiesOption;
+    if (flags.testFlag(ECaseInsensitive)) {
+        options |= QRegularExpression::CaseInsensitiveOption;
+    }
+
+    QRegularExpression regex(pattern, options);
+    if (regex.isValid()) {
+        // 立即编译并启用 JIT ，之后各线程查找时不再重复编译
+        regex.optimize();
+    }
+    return regex;
+}
+
+/**
+ * @brief 计算查找结果 \a result 中自第 \a first 项开始的各匹配项的替换文本。
+ *      在匹配项所在行的原位置重新匹配以取得捕获组，替换文本 \a withText 中的 \1 等引用替换为捕获组文本。
+ * @param text 查找结果对应的文本
+ */
+QStringList TextSearchEngine::replacements(const QString &text, const SearchResult &result, int first,
+                                           const QString &keyword, SearchFlags flags, const QString &withText)
+{
+    QStringList texts;
+    const QRegularExpression regex = regularExpression(keyword, flags);
+
+    int lineStart = 0;
+    int lineEnd = -1;
+    QString line;
+    for (int i = first; i < result.count(); ++i) {
+        const int offset = result.offsetAt(i);
+        if (offset > lineEnd) {
+            lineStart = offset > 0 ? text.lastIndexOf(QLatin1Char('\n'), offset - 1) + 1 : 0;
+            lineEnd = text.indexOf(QLatin1Char('\n'), offset);
+            if (lineEnd < 0) {
+                lineEnd = text.length();
+            }
+            line = QString::fromRawData(text.constData() + lineStart, lineEnd - lineStart);
+        }
+
+        const QRegularExpressionMatch match = regex.match(line, offset - lineStart, QRegularExpression::NormalMatch,
+                                                          QRegularExpression::AnchoredMatchOption);
+        if (match.hasMatch() && match.capturedLength() == result.lengthAt(i)) {
+            texts.append(expandReplacement(match, withText));
+        } else {
+            texts.append(withText);
+        }
+    }
+
+    return texts;
+}
+
+/**
+ * @brief 文档内容变更，查找期间记录变更区域，查找完成后更新结果，否则直接更新查找结果
+ */
+void TextSearchEngine::onContentsChange(int from, int charsRemoved, int charsAdded)
+{
+    if (m_keyword.isEmpty()) {
+        return;
+    }
+
+    // 等待重新查找全文时推迟查找，连续编辑时只重新查找一次
+    if (m_restartTimer.isActive()) {
+        m_restartTimer.start();
+        return;
+    }
+
+    // 查找未完成(包括已完成但未处理完成通知)时文本快照已过期，记录变更区域，完成后平移结果并仅重新查找变更区域
+    if (!m_valid && m_canceled && !m_canceled->loadAcquire()) {
+        recordPendingChange(from, charsRemoved, charsAdded);
+        return;
+    }
+
+    if (!m_valid) {
+        return;
+    }
+
+    bool changed = false;
+    if (!updateRange(from, charsRemoved, charsAdded, changed)) {
+        invalidate();
+    } else if (changed) {
+        emit sigResultChanged();
+    }
+}
+
+/**
+ * @brief 分块查找完成，按分块顺序合并已完成的结果，查找期间文档已变更时仅合并变更区域之前的分块
+ */
+void TextSearchEngine::onResultReadyAt(int index)
+{
+    Q_UNUSED(index)
+    if (m_keyword.isEmpty() || !m_canceled || m_canceled->loadAcquire()) {
+        return;
+    }
+
+    if (mergeReadyResults()) {
+        emit sigPartialResult();
+    }
+}
+
+void TextSearchEngine::onSearchFinished()
+{
+    // 已取消的查找(被清空或重新查找)不更新结果
+    if (m_keyword.isEmpty() || !m_canceled || m_canceled->loadAcquire()) {
+        return;
+    }
+
+    // 变更区域过大，保留变更区域之前的部分结果，延迟重新查找全文
+    if (m_restartPending) {
+        if (mergeReadyResults()) {
+            emit sigPartialResult();
+        }
+        scheduleRestart();
+        return;
+    }
+
+    mergeReadyResults(true);
+    m_valid = true;
+
+    // 查找结果对应查找开始时的文本快照，先按改变长度的变更区域平移并重新查找该区域，
+    // 之后结果与当前文档位置一致，再重新查找不改变长度的变更区域
+    bool changed = false;
+    const int pendingFrom = m_pendingFrom;
+    m_pendingStart = -1;
+    m_pendingFrom = -1;
+    if (pendingFrom >= 0 && !updateRange(pendingFrom, m_pendingRemoved, m_pendingAdded, changed)) {
+        invalidate();
+        return;
+    }
+
+    const QVector<QPair<int, int>> pendingChanges = m_pendingChanges;
+    m_pendingChanges.clear();
+    for (const QPair<int, int> &range : pendingChanges) {
+        if (!updateRange(range.first, range.second, range.second, changed)) {
+            invalidate();
+            return;
+        }
+    }
+
+    emit sigResultChanged();
+}
+
+/**
+ * @brief 记录查找期间的文档变更 [ \a from, \a from + \a charsRemoved) 。改变长度的变更与之前记录的变更合并为
+ *      一个区域：区域起始位置在快照及当前文档中相同，区域之后的文本仅平移。区域超过 EMaxPendingChange 时，
+ *      重新查找该区域的开销接近重新查找全文，完成后改为重新查找全文。
+ *      不改变长度的变更单独记录，之后改变长度的变更发生时按当前文档位置平移
+ */
+void TextSearchEngine::recordPendingChange(int from, int charsRemoved, int charsAdded)
+{
+    if (m_restartPending) {
+        return;
+    }
+
+    m_pendingStart = m_pendingStart < 0 ? from : qMin(m_pendingStart, from);
+    const int delta = charsAdded - charsRemoved;
+    if (0 == delta) {
+        m_pendingChanges.append(qMakePair(from, charsAdded));
+        return;
+    }
+
+    // 之前记录的不改变长度的变更区域按本次变更平移，与本次变更相交的区域扩展到本次变更之后
+    for (QPair<int, int> &range : m_pendingChanges) {
+        if (range.first >= from + charsRemoved) {
+            range.first += delta;
+        } else if (range.first + range.second > from) {
+            const int end = qMax(range.first + range.second, from + charsRemoved) + delta;
+            range.first = qMin(range.first, from);
+            range.second = end - range.first;
+        }
+    }
+
+    if (m_pendingFrom < 0) {
+        m_pendingFrom = from;
+        m_pendingRemoved = charsRemoved;
+        m_pendingAdded = charsAdded;
+    } else {
+        // 合并后的区域在本次变更前的文档中的范围 [start, end)
+        const int start = qMin(m_pendingFrom, from);
+        const int end = qMax(m_pendingFrom + m_pendingAdded, from + charsRemoved);
+        m_pendingRemoved = end - (m_pendingAdded - m_pendingRemoved) - start;
+        m_pendingAdded = end - charsRemoved + charsAdded - start;
+        m_pendingFrom = start;
+    }
+
+    if (m_pendingRemoved > EMaxPendingChange || m_pendingAdded > EMaxPendingChange) {
+        m_restartPending = true;
+    }
+}
+
+/**
+ * @brief 延迟重新查找全文，延迟期间的编辑将推迟重新查找，避免每次编辑都在界面线程中复制全文快照
+ */
+void TextSearchEngine::scheduleRestart()
+{
+    if (m_canceled) {
+        m_canceled->storeRelease(1);
+    }
+    m_valid = false;
+    m_restartTimer.start();
+}
+
+/**
+ * @brief 更新文档变更区域的查找结果。移除与变更区域 [ \a from, \a from + \a charsRemoved) 相交的匹配项，
+ *      之后的匹配项按长度变化平移，重新查找变更后区域前后 关键字长度 - 1 范围内的文本。
+ *      关键字的匹配项可能重叠时，变更区域内的匹配项变化可能影响之后匹配项的筛选结果，此时无法维护。
+ * @param changed 返回查找结果是否变化
+ * @return 是否可维护查找结果，变更信息与文档长度不一致时返回 false
+ */
+bool TextSearchEngine::updateRange(int from, int charsRemoved, int charsAdded, bool &changed)
+{
+    changed = false;
+
+    // 整体替换文档内容时，变更长度包含文档末尾的段落分隔符
+    const int newLength = m_document->characterCount() - 1;
+    if (from < 0 || from > m_length) {
+        return false;
+    }
+    charsRemoved = qMin(charsRemoved, m_length - from);
+    charsAdded = qMin(charsAdded, newLength - from);
+    if (m_length - charsRemoved + charsAdded != newLength) {
+        return false;
+    }
+
+    if (isLineMode(m_flags)) {
+        return updateLines(from, charsAdded, charsAdded - charsRemoved, newLength, changed);
+    }
+
+    const int length = m_keyword.length();
+    QVector<int> &offsets = m_result.m_offsets;
+    // 与变更区域相交的匹配项 [first, last)
+    const int first = static_cast<int>(std::lower_bound(offsets.constBegin(), offsets.constEnd(), from - length + 1) - offsets.constBegin());
+    const int last = static_cast<int>(std::lower_bound(offsets.constBegin(), offsets.constEnd(), from + charsRemoved) - offsets.constBegin());
+
+    QVector<int> matches;
+    const int windowStart = qMax(0, from - length + 1);
+    const int windowEnd = qMin(newLength, from + charsAdded + length - 1);
+    if (windowEnd - windowStart >= length) {
+        const QString text = Utils::documentText(m_document, windowStart, windowEnd - windowStart);
+        const QVector<int> candidates = scanRange(text, m_keyword, caseSensitivity(m_flags), 0, from + charsAdded - windowStart, 1, nullptr);
+
+        int lastEnd = first > 0 ? offsets.at(first - 1) + length : 0;
+        for (int pos : candidates) {
+            pos += windowStart;
+            if (pos >= lastEnd) {
+                matches.append(pos);
+                lastEnd = pos + length;
+            }
+        }
+    }
+
+    const int delta = charsAdded - charsRemoved;
+    bool same = (0 == delta && matches.size() == last - first);
+    for (int i = 0; same && i < matches.size(); ++i) {
+        same = (matches.at(i) == offsets.at(first + i));
+    }
+    if (same) {
+        m_length = newLength;
+        return true;
+    }
+
+    if (m_keywordHasBorder) {
+        // 变更区域之后的匹配项筛选只取决于之前最后一个匹配项延伸到变更区域之后的长度，长度一致时筛选结果不变
+        const int oldEnd = last > 0 ? offsets.at(last - 1) + length : 0;
+        const int newEnd = !matches.isEmpty() ? matches.last() + length : (first > 0 ? offsets.at(first - 1) + length : 0);
+        if (qMax(0, oldEnd - from - charsRemoved) != qMax(0, newEnd - from - charsAdded)) {
+            return false;
+        }
+    }
+
+    m_length = newLength;
+    offsets.remove(first, last - first);
+    for (int i = first; i < offsets.size(); ++i) {
+        offsets[i] += delta;
+    }
+    if (!matches.isEmpty()) {
+        offsets.insert(first, matches.size(), 0);
+        std::copy(matches.constBegin(), matches.constEnd(), offsets.begin() + first);
+    }
+
+    changed = true;
+    return true;
+}
+
+/**
+ * @brief 按行查找时更新文档变更涉及的行的查找结果。匹配项不跨行，移除变更前这些行中的匹配项，
+ *      之后的匹配项按长度变化 \a delta 平移，重新查找变更后这些行的文本。
+ * @param changed 返回查找结果是否变化
+ */
+bool TextSearchEngine::updateLines(int from, int charsAdded, int delta, int newLength, bool &changed)
+{
+    // 变更涉及的行在变更后文档中的范围 [windowStart, windowEnd) ，变更前的范围为 [windowStart, windowEnd - delta)
+    const QTextBlock startBlock = m_document->findBlock(from);
+    const QTextBlock endBlock = m_document->findBlock(from + charsAdded);
+    if (!startBlock.isValid() || !endBlock.isValid()) {
+        return false;
+    }
+    const int windowStart = startBlock.position();
+    const int windowEnd = qMin(newLength, endBlock.position() + endBlock.length() - 1);
+
+    QVector<int> &offsets = m_result.m_offsets;
+    QVector<int> &lengths = m_result.m_lengths;
+    const bool variable = m_flags.testFlag(ERegularExpression);
+    auto firstItr = std::lower_bound(offsets.constBegin(), offsets.constEnd(), windowStart);
+    const int first = static_cast<int>(firstItr - offsets.constBegin());
+    const int last = static_cast<int>(std::lower_bound(firstItr, offsets.constEnd(), windowEnd - delta) - offsets.constBegin());
+
+    const QString text = Utils::documentText(m_document, windowStart, windowEnd - windowStart);
+    const SearchResult part = scanLines(text, m_keyword, m_flags, m_regex, 0, text.length(), nullptr);
+
+    m_length = newLength;
+    bool same = (0 == delta && part.count() == last - first);
+    for (int i = 0; same && i < part.count(); ++i) {
+        same = (part.offsetAt(i) + windowStart == offsets.at(first + i))
+               && (!variable || part.lengthAt(i) == lengths.at(first + i));
+    }
+    if (same) {
+        return true;
+    }
+
+    offsets.remove(first, last - first);
+    for (int i = first; i < offsets.size(); ++i) {
+        offsets[i] += delta;
+    }
+    if (!part.isEmpty()) {
+        offsets.insert(first, part.count(), 0);
+        for (int i = 0; i < part.count(); ++i) {
+            offsets[first + i] = part.offsetAt(i) + windowStart;
+        }
+    }
+
+    if (variable) {
+        lengths.remove(first, last - first);
+        if (!part.isEmpty()) {
+            lengths.insert(first, part.count(), 0);
+            std::copy(part.m_lengths.constBegin(), part.m_lengths.constEnd(), lengths.begin() + first);
+        }
+    }
+
+    changed = true;
+    return true;
+}
+
+/**
+ * @brief 按分块顺序将已完成的分块结果合并到查找结果中
+ * @return 查找结果是否新增了匹配项
+ */
+bool TextSearchEngine::mergeReadyResults(bool all)
+{
+    const QFuture<SearchResult> future = m_watcher.future();
+    const int count = m_result.count();
+    // 起始位置位于分块内的匹配项最多延伸到分块结束位置之后 margin 个字符
+    const int margin = isLineMode(m_flags) ? 0 : m_keyword.length() - 1;
+    while (future.isResultReadyAt(m_readyChunks)) {
+        // 查找期间文档已变更时，变更区域之后的分块结果位置已过期，查找完成后统一平移
+        if (!all && m_pendingStart >= 0 && m_chunkEnds.value(m_readyChunks) + margin > m_pendingStart) {
+            break;
+        }
+
+        mergeResult(m_result, future.resultAt(m_readyChunks), m_keywordHasBorder);
+        ++m_readyChunks;
+    }
+
+    return m_result.count() != count;
+}
+
+/**
+ * @brief 查找结果失效，延迟重新查找全文
+ */
+void TextSearchEngine::invalidate()
+{
+    m_result = SearchResult();
+    scheduleRestart();
+    emit sigInvalidated();
+}
+
+void TextSearchEngine::mergeResult(SearchResult &result, const SearchResult &part, bool overlapped)
+{
+    if (!overlapped) {
+        result.m_offsets += part.m_offsets;
+        result.m_lengths += part.m_lengths;
+        return;
+    }
+
+    // 从前向后筛选互不重叠的匹配项
+    const int length = result.m_matchLength;
+    int lastEnd = result.m_offsets.isEmpty() ? 0 : result.m_offsets.last() + length;
+    for (int pos : part.m_offsets) {
+        if (pos >= lastEnd) {
+            result.m_offsets.append(pos);
+            lastEnd = pos + length;
+        }
+    }
+}
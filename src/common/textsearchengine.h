@@ -0,0 +1,177 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef TEXTSEARCHENGINE_H
+#define TEXTSEARCHENGINE_H
+
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include <QPair>
+#include <QAtomicInt>
+#include <QSharedPointer>
+#include <QFutureWatcher>
+#include <QRegularExpression>
+#include <QTimer>
+
+class QTextDocument;
+
+/**
+ * @brief 查找结果索引，按位置升序保存互不重叠的匹配项起始位置，
+ *      匹配数量、按位置定位匹配项均为常数或对数时间复杂度。
+ *      正则表达式查找时各匹配项长度不同，额外保存各匹配项的长度。
+ */
+class SearchResult
+{
+public:
+    SearchResult();
+    SearchResult(const QVector<int> &offsets, int matchLength);
+    SearchResult(const QVector<int> &offsets, const QVector<int> &lengths);
+
+    bool isEmpty() const;
+    // 匹配项数量
+    int count() const;
+    // 匹配文本长度，各匹配项长度不同时返回 0
+    int matchLength() const;
+    // 第 index 个匹配项的起始位置
+    int offsetAt(int index) const;
+    // 第 index 个匹配项的长度
+    int lengthAt(int index) const;
+    const QVector<int> &offsets() const;
+
+    // 起始位置为 position 的匹配项序号，不存在时返回 -1
+    int indexOf(int position) const;
+    // 起始位置不小于 position 的第一个匹配项序号，不存在时返回 -1
+    int nextIndex(int position) const;
+    // 起始位置小于 position 的最后一个匹配项序号，不存在时返回 -1
+    int previousIndex(int position) const;
+    // 起始位置位于 [begin, end] 的匹配项序号范围 [first, last)
+    QPair<int, int> indexRange(int begin, int end) const;
+
+private:
+    QVector<int> m_offsets;     // 匹配项起始位置
+    QVector<int> m_lengths;     // 各匹配项长度，仅匹配项长度不同时使用
+    int m_matchLength = 0;      // 匹配文本长度
+
+    friend class TextSearchEngine;
+};
+
+/**
+ * @brief 全文查找引擎。查找时复制文档文本快照，按固定长度分块后在线程池中并行查找，
+ *      相邻分块重叠 关键字长度 - 1 个字符，跨越分块边界的匹配项不会遗漏；
+ *      合并后按从前向后、互不重叠的规则筛选，与 QTextDocument::find() 逐个查找的结果一致。
+ *
+ *      查找完成后跟随文档变更维护结果：移除与变更区域相交的匹配项，之后的匹配项按长度变化平移，
+ *      仅重新查找变更区域附近的文本，无需重新查找全文。输入时关键字逐字扩展，新关键字的匹配项
+ *      必然位于之前关键字的匹配项处，此时仅校验这些位置。
+ *
+ *      正则表达式及全词匹配模式按行查找，匹配项不跨行：分块边界对齐到行首，表达式仅在开始查找时编译一次；
+ *      各分块按顺序完成后即合并到结果中并通知，无需等待全文查找完成；文档变更时仅重新查找变更涉及的行。
+ *
+ *      查找期间改变长度的文档变更合并为一个变更区域，变更之前的分块结果仍按顺序通知，查找完成后按变更区域
+ *      平移并更新结果；仅变更区域过大或结果无法维护时延迟重新查找全文，连续编辑时只重新查找一次。
+ */
+class TextSearchEngine : public QObject
+{
+    Q_OBJECT
+public:
+    enum SearchParam {
+        EChunkSize = 1024 * 1024,           // 分块长度，文本长度超过此值时并行查找
+        EMaxPendingChange = 1024 * 1024,    // 查找期间变更区域超过此长度时，完成后重新查找全文
+        ERestartDelay = 300,                // 重新查找全文的延迟(毫秒)，期间的编辑将推迟重新查找
+    };
+
+    // 查找模式
+    enum SearchFlag {
+        ENoSearchFlags = 0x0,
+        ECaseInsensitive = 0x1,             // 忽略大小写
+        EWholeWord = 0x2,                   // 全词匹配，匹配项前后不能是字母或数字
+        ERegularExpression = 0x4,           // 关键字为正则表达式
+    };
+    Q_DECLARE_FLAGS(SearchFlags, SearchFlag)
+
+    explicit TextSearchEngine(QTextDocument *document, QObject *parent = nullptr);
+    ~TextSearchEngine() override;
+
+    // 在后台查找文档中的关键字 keyword ，之前未完成的查找将被取消
+    void start(const QString &keyword, SearchFlags flags = ENoSearchFlags);
+    // 取消查找并清空结果
+    void clear();
+    bool isRunning() const;
+    // 查找结果是否与当前文档内容一致
+    bool isValid() const;
+    QString keyword() const;
+    SearchFlags searchFlags() const;
+    // 查找结果，查找过程中为已按顺序完成的部分结果
+    const SearchResult &result() const;
+
+    // 查找文本 text 中所有互不重叠的关键字 keyword 的起始位置，canceled 被置位时中止查找
+    static QVector<int> findAll(const QString &text, const QString &keyword, Qt::CaseSensitivity cs = Qt::CaseSensitive,
+                                const QAtomicInt *canceled = nullptr, int chunkSize = EChunkSize);
+    // 按查找模式 flags 查找文本 text 中所有互不重叠的匹配项
+    static SearchResult search(const QString &text, const QString &keyword, SearchFlags flags,
+                               const QAtomicInt *canceled = nullptr, int chunkSize = EChunkSize);
+    // 查找模式 flags 对应的正则表达式，全词匹配时在表达式前后添加单词边界判断
+    static QRegularExpression regularExpression(const QString &keyword, SearchFlags flags);
+    // 正则表达式替换时各匹配项的替换文本，withText 中的 \1 等引用替换为对应捕获组的文本
+    static QStringList replacements(const QString &text, const SearchResult &result, int first,
+                                    const QString &keyword, SearchFlags flags, const QString &withText);
+
+signals:
+    // 查找完成或结果跟随文档变更更新
+    void sigResultChanged();
+    // 查找过程中按顺序完成了新的分块，部分结果已更新
+    void sigPartialResult();
+    // 文档变更后无法维护查找结果，将重新查找全文
+    void sigInvalidated();
+
+private slots:
+    void onContentsChange(int from, int charsRemoved, int charsAdded);
+    void onResultReadyAt(int index);
+    void onSearchFinished();
+
+private:
+    // 按关键字 keyword 查找时能否仅校验当前查找结果中的位置
+    bool canRefine(const QString &keyword, SearchFlags flags) const;
+    // 更新变更区域的查找结果，返回是否可维护
+    bool updateRange(int from, int charsRemoved, int charsAdded, bool &changed);
+    // 按行查找时更新变更涉及的行的查找结果
+    bool updateLines(int from, int charsAdded, int delta, int newLength, bool &changed);
+    // 按顺序合并已完成的分块结果，all 为 false 时不合并查找期间变更区域之后的分块，返回结果是否变化
+    bool mergeReadyResults(bool all = false);
+    // 记录查找期间的文档变更，改变长度的变更与之前的变更合并为一个区域
+    void recordPendingChange(int from, int charsRemoved, int charsAdded);
+    // 延迟重新查找全文
+    void scheduleRestart();
+    void invalidate();
+
+    // 将分块结果 part 追加到 result ，overlapped 为 true 时筛选与之前匹配项不重叠的匹配项
+    static void mergeResult(SearchResult &result, const SearchResult &part, bool overlapped);
+
+private:
+    QTextDocument *m_document = nullptr;        // 查找的文档
+    QString m_keyword;                          // 查找的关键字
+    SearchFlags m_flags = ENoSearchFlags;       // 查找模式
+    QRegularExpression m_regex;                 // 正则表达式模式下预先编译的表达式
+    bool m_keywordHasBorder = false;            // 关键字匹配项之间是否可能重叠
+    SearchResult m_result;                      // 查找结果
+    bool m_valid = false;                       // 查找结果是否有效
+    int m_length = 0;                           // 查找结果对应的文档文本长度
+
+    QFutureWatcher<SearchResult> m_watcher;     // 后台查找任务，按分块返回结果
+    int m_readyChunks = 0;                      // 已按顺序合并到结果中的分块数量
+    QVector<int> m_chunkEnds;                   // 各分块在文本快照中的结束位置
+    QSharedPointer<QAtomicInt> m_canceled;      // 后台查找任务取消标识
+    bool m_restartPending = false;              // 查找期间的变更区域过大，完成后重新查找全文
+    int m_pendingStart = -1;                    // 查找期间所有变更的最小位置，之前的文本未变更，-1 表示未变更
+    int m_pendingFrom = -1;                     // 查找期间改变长度的变更区域起始位置，-1 表示不存在
+    int m_pendingRemoved = 0;                   // 变更区域在文本快照中的长度
+    int m_pendingAdded = 0;                     // 变更区域在当前文档中的长度
+    QVector<QPair<int, int>> m_pendingChanges;  // 查找期间不改变长度的变更区域(如高亮格式变更)，按当前文档位置记录
+    QTimer m_restartTimer;                      // 延迟重新查找全文
+};
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(TextSearchEngine::SearchFlags)
+
+#endif // TEXTSEARCHENGINE_H
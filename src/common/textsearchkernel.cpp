@@ -0,0 +1,367 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "textsearchkernel.h"
+
+#include <QHash>
+#include <QVarLengthArray>
+#include <QVector>
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define TEXTSEARCHKERNEL_X86
+#include <immintrin.h>
+#endif
+
+namespace {
+
+/**
+ * @brief 大小写折叠表，与 QString 忽略大小写比较时使用的折叠规则一致(QChar::toCaseFolded())
+ */
+struct CaseFoldTable {
+    CaseFoldTable()
+        : fold(0x10000)
+    {
+        QHash<ushort, QVector<ushort>> others;
+        for (int ch = 0; ch < 0x10000; ++ch) {
+            const ushort folded = QChar(static_cast<ushort>(ch)).toCaseFolded().unicode();
+            fold[ch] = folded;
+            if (folded != ch) {
+                others[folded].append(static_cast<ushort>(ch));
+            }
+        }
+
+        for (auto itr = others.constBegin(); itr != others.constEnd(); ++itr) {
+            QVector<ushort> values(TextSearchKernel::EMaxCaseVariants, itr.key());
+            if (itr.value().size() + 1 > TextSearchKernel::EMaxCaseVariants) {
+                values.clear();
+            } else {
+                std::copy(itr.value().constBegin(), itr.value().constEnd(), values.begin() + 1);
+            }
+            variants.insert(itr.key(), values);
+        }
+
+        // ASCII 字符的变体直接查表
+        for (ushort ch = 0; ch < 0x80; ++ch) {
+            const QVector<ushort> values = variants.value(ch, QVector<ushort>(TextSearchKernel::EMaxCaseVariants, ch));
+            asciiValid[ch] = !values.isEmpty();
+            if (asciiValid[ch]) {
+                std::copy(values.constBegin(), values.constEnd(), asciiVariants[ch]);
+            }
+        }
+    }
+
+    QVector<ushort> fold;                           // 字符折叠后的值
+    QHash<ushort, QVector<ushort>> variants;        // 折叠后与键值相同的所有字符，数量超过 EMaxCaseVariants 时为空
+    ushort asciiVariants[0x80][TextSearchKernel::EMaxCaseVariants];
+    bool asciiValid[0x80];
+};
+
+const CaseFoldTable &caseFoldTable()
+{
+    static const CaseFoldTable s_table;
+    return s_table;
+}
+
+/**
+ * @brief 取得折叠后为 \a folded 的所有字符，不足 EMaxCaseVariants 个时重复填充
+ * @return 是否可使用向量化过滤，变体数量超过 EMaxCaseVariants 时返回 false
+ */
+bool caseVariants(ushort folded, ushort *variants)
+{
+    const CaseFoldTable &table = caseFoldTable();
+    if (folded < 0x80) {
+        std::copy(table.asciiVariants[folded], table.asciiVariants[folded] + TextSearchKernel::EMaxCaseVariants, variants);
+        return table.asciiValid[folded];
+    }
+
+    auto itr = table.variants.constFind(folded);
+    if (itr == table.variants.constEnd()) {
+        std::fill(variants, variants + TextSearchKernel::EMaxCaseVariants, folded);
+        return true;
+    }
+    std::copy(itr.value().constBegin(), itr.value().constEnd(), variants);
+    return !itr.value().isEmpty();
+}
+
+/**
+ * @brief 比较文本 \a text 与关键字 \a keyword 的前 \a length 个字符，\a foldTable 不为空时忽略大小写
+ */
+inline bool matchAt(const ushort *text, const ushort *keyword, int length, const ushort *foldTable)
+{
+    if (!foldTable) {
+        return 0 == ::memcmp(text, keyword, static_cast<size_t>(length) * sizeof(ushort));
+    }
+
+    for (int i = 0; i < length; ++i) {
+        if (foldTable[text[i]] != keyword[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+#ifdef TEXTSEARCHKERNEL_X86
+
+enum SimdLevel {
+    LevelScalar = TextSearchKernel::Scalar,
+    LevelSse = TextSearchKernel::SSE,
+    LevelAvx2 = TextSearchKernel::AVX2,
+};
+
+/**
+ * @brief 运行时检测 CPU 支持的指令集
+ */
+int detectSimdLevel()
+{
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return LevelAvx2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return LevelSse;
+    }
+    return LevelScalar;
+}
+
+int simdLevel()
+{
+    static const int s_level = detectSimdLevel();
+    return s_level;
+}
+
+/**
+ * @brief SSE2 查找，每次读取8个字符，同时比较关键字首字符及尾字符(及其大小写变体)，
+ *      两者均相同的位置为候选位置，再逐个校验完整的关键字
+ * @param first     首字符的变体
+ * @param last      尾字符的变体
+ * @param checked   返回已处理的起始位置，剩余不足一个向量长度的部分由调用方处理
+ * @return 匹配位置，未找到返回 -1
+ */
+template <int Variants>
+__attribute__((target("sse2")))
+int searchSse2(const ushort *text, int length, const ushort *keyword, int keywordLength, int from,
+               const ushort *first, const ushort *last, const ushort *foldTable, int *checked)
+{
+    __m128i firstVec[Variants];
+    __m128i lastVec[Variants];
+    for (int k = 0; k < Variants; ++k) {
+        firstVec[k] = _mm_set1_epi16(static_cast<short>(first[k]));
+        lastVec[k] = _mm_set1_epi16(static_cast<short>(last[k]));
+    }
+
+    int i = from;
+    for (; i + 8 + keywordLength - 1 <= length; i += 8) {
+        const __m128i blockFirst = _mm_loadu_si128(reinterpret_cast<const __m128i *>(text + i));
+        const __m128i blockLast = _mm_loadu_si128(reinterpret_cast<const __m128i *>(text + i + keywordLength - 1));
+        __m128i eqFirst = _mm_cmpeq_epi16(blockFirst, firstVec[0]);
+        __m128i eqLast = _mm_cmpeq_epi16(blockLast, lastVec[0]);
+        for (int k = 1; k < Variants; ++k) {
+            eqFirst = _mm_or_si128(eqFirst, _mm_cmpeq_epi16(blockFirst, firstVec[k]));
+            eqLast = _mm_or_si128(eqLast, _mm_cmpeq_epi16(blockLast, lastVec[k]));
+        }
+
+        // 每个字符对应掩码中的2位
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_and_si128(eqFirst, eqLast)));
+        while (mask) {
+            const int bit = __builtin_ctz(mask);
+            const int pos = i + bit / 2;
+            if (matchAt(text + pos, keyword, keywordLength, foldTable)) {
+                return pos;
+            }
+            mask &= ~(3u << bit);
+        }
+    }
+
+    *checked = i;
+    return -1;
+}
+
+/**
+ * @brief AVX2 查找，处理方式同 searchSse2() ，每次读取16个字符
+ */
+template <int Variants>
+__attribute__((target("avx2")))
+int searchAvx2(const ushort *text, int length, const ushort *keyword, int keywordLength, int from,
+               const ushort *first, const ushort *last, const ushort *foldTable, int *checked)
+{
+    __m256i firstVec[Variants];
+    __m256i lastVec[Variants];
+    for (int k = 0; k < Variants; ++k) {
+        firstVec[k] = _mm256_set1_epi16(static_cast<short>(first[k]));
+        lastVec[k] = _mm256_set1_epi16(static_cast<short>(last[k]));
+    }
+
+    int i = from;
+    for (; i + 16 + keywordLength - 1 <= length; i += 16) {
+        const __m256i blockFirst = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(text + i));
+        const __m256i blockLast = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(text + i + keywordLength - 1));
+        __m256i eqFirst = _mm256_cmpeq_epi16(blockFirst, firstVec[0]);
+        __m256i eqLast = _mm256_cmpeq_epi16(blockLast, lastVec[0]);
+        for (int k = 1; k < Variants; ++k) {
+            eqFirst = _mm256_or_si256(eqFirst, _mm256_cmpeq_epi16(blockFirst, firstVec[k]));
+            eqLast = _mm256_or_si256(eqLast, _mm256_cmpeq_epi16(blockLast, lastVec[k]));
+        }
+
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_and_si256(eqFirst, eqLast)));
+        while (mask) {
+            const int bit = __builtin_ctz(mask);
+            const int pos = i + bit / 2;
+            if (matchAt(text + pos, keyword, keywordLength, foldTable)) {
+                return pos;
+            }
+            mask &= ~(3u << bit);
+        }
+    }
+
+    *checked = i;
+    return -1;
+}
+
+#endif // TEXTSEARCHKERNEL_X86
+
+} // namespace
+
+int TextSearchKernel::indexOf(const QString &text, const QString &keyword, int from, Qt::CaseSensitivity cs)
+{
+    return indexOf(text.constData(), text.length(), keyword.constData(), keyword.length(), from, cs);
+}
+
+/**
+ * @brief 查找文本 \a text 中从 \a from 开始第一次出现关键字 \a keyword 的位置
+ * @param text          文本
+ * @param length        文本长度
+ * @param keyword       关键字
+ * @param keywordLength 关键字长度
+ * @param from          起始位置，小于0时从文本末尾向前计算
+ * @param cs            是否区分大小写
+ * @return 匹配位置，未找到返回 -1
+ */
+int TextSearchKernel::indexOf(const QChar *text, int length, const QChar *keyword, int keywordLength, int from, Qt::CaseSensitivity cs)
+{
+    if (from < 0) {
+        from = qMax(0, from + length);
+    }
+    if (keywordLength <= 0) {
+        return from <= length ? from : -1;
+    }
+    if (!text || !keyword || length - from < keywordLength) {
+        return -1;
+    }
+
+    const ushort *source = reinterpret_cast<const ushort *>(text);
+    const ushort *pattern = reinterpret_cast<const ushort *>(keyword);
+    const ushort *foldTable = nullptr;
+    QVarLengthArray<ushort, 64> folded;
+    if (Qt::CaseInsensitive == cs) {
+        // 代理对字符需按完整字符折叠，使用 QString 的实现
+        for (int i = 0; i < keywordLength; ++i) {
+            if (QChar::isSurrogate(pattern[i])) {
+                return QString::fromRawData(text, length).indexOf(QString::fromRawData(keyword, keywordLength), from, cs);
+            }
+        }
+
+        foldTable = caseFoldTable().fold.constData();
+        folded.resize(keywordLength);
+        for (int i = 0; i < keywordLength; ++i) {
+            folded[i] = foldTable[pattern[i]];
+        }
+        pattern = folded.constData();
+    }
+
+    if (keywordLength >= EHorspoolMinLength) {
+        return indexOfHorspool(source, length, pattern, keywordLength, from, foldTable);
+    }
+
+#ifdef TEXTSEARCHKERNEL_X86
+    const int level = simdLevel();
+    if (LevelScalar != level) {
+        int checked = from;
+        int pos = -1;
+        if (!foldTable) {
+            const ushort first = pattern[0];
+            const ushort last = pattern[keywordLength - 1];
+            pos = LevelAvx2 == level ? searchAvx2<1>(source, length, pattern, keywordLength, from, &first, &last, nullptr, &checked)
+                                     : searchSse2<1>(source, length, pattern, keywordLength, from, &first, &last, nullptr, &checked);
+        } else {
+            ushort first[EMaxCaseVariants];
+            ushort last[EMaxCaseVariants];
+            if (!caseVariants(pattern[0], first) || !caseVariants(pattern[keywordLength - 1], last)) {
+                return indexOfScalar(source, length, pattern, keywordLength, from, foldTable);
+            }
+            pos = LevelAvx2 == level ? searchAvx2<EMaxCaseVariants>(source, length, pattern, keywordLength, from, first, last, foldTable, &checked)
+                                     : searchSse2<EMaxCaseVariants>(source, length, pattern, keywordLength, from, first, last, foldTable, &checked);
+        }
+        if (pos >= 0) {
+            return pos;
+        }
+        return indexOfScalar(source, length, pattern, keywordLength, checked, foldTable);
+    }
+#else
+    // 无向量化实现时，较短的关键字同样使用 Horspool 算法跳跃查找
+    if (keywordLength > 2) {
+        return indexOfHorspool(source, length, pattern, keywordLength, from, foldTable);
+    }
+#endif
+
+    return indexOfScalar(source, length, pattern, keywordLength, from, foldTable);
+}
+
+TextSearchKernel::Implementation TextSearchKernel::implementation()
+{
+#ifdef TEXTSEARCHKERNEL_X86
+    return static_cast<Implementation>(simdLevel());
+#else
+    return Scalar;
+#endif
+}
+
+/**
+ * @brief 标量查找，逐个比较首字符，相同时校验完整的关键字
+ * @param keyword   关键字，\a foldTable 不为空时为折叠后的关键字
+ * @param foldTable 大小写折叠表，为空时区分大小写
+ */
+int TextSearchKernel::indexOfScalar(const ushort *text, int length, const ushort *keyword, int keywordLength, int from, const ushort *foldTable)
+{
+    const ushort first = keyword[0];
+    const int end = length - keywordLength;
+    for (int i = from; i <= end; ++i) {
+        const ushort ch = foldTable ? foldTable[text[i]] : text[i];
+        if (ch == first && matchAt(text + i, keyword, keywordLength, foldTable)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Boyer-Moore-Horspool 查找，比较窗口尾字符，不匹配时按尾字符在关键字中最后出现的位置跳跃。
+ *      跳跃表以字符低8位为索引，低8位相同的字符取最小跳跃距离。
+ * @param keyword   关键字，\a foldTable 不为空时为折叠后的关键字
+ * @param foldTable 大小写折叠表，为空时区分大小写
+ */
+int TextSearchKernel::indexOfHorspool(const ushort *text, int length, const ushort *keyword, int keywordLength, int from, const ushort *foldTable)
+{
+    int shift[256];
+    for (int &value : shift) {
+        value = keywordLength;
+    }
+    for (int i = 0; i < keywordLength - 1; ++i) {
+        shift[keyword[i] & 0xFF] = keywordLength - 1 - i;
+    }
+
+    const ushort last = keyword[keywordLength - 1];
+    const int end = length - keywordLength;
+    int i = from;
+    while (i <= end) {
+        const ushort ch = foldTable ? foldTable[text[i + keywordLength - 1]] : text[i + keywordLength - 1];
+        if (ch == last && matchAt(text + i, keyword, keywordLength - 1, foldTable)) {
+            return i;
+        }
+        i += shift[ch & 0xFF];
+    }
+    return -1;
+}
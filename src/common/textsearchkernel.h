@@ -0,0 +1,45 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef TEXTSEARCHKERNEL_H
+#define TEXTSEARCHKERNEL_H
+
+#include <QString>
+
+/**
+ * @brief UTF-16 文本子串查找，查找结果与 QString::indexOf() 一致。
+ *      x86 平台运行时选择 AVX2 / SSE2 向量化实现：同时比较关键字首、尾字符过滤候选位置后逐个校验；
+ *      较长的关键字使用 Boyer-Moore-Horspool 算法按尾字符跳跃查找。
+ *      忽略大小写时通过大小写折叠表比较，向量化过滤时比较首、尾字符的所有大小写变体。
+ */
+class TextSearchKernel
+{
+public:
+    enum Implementation {
+        Scalar,     // 标量实现
+        SSE,        // SSE2 实现
+        AVX2,       // AVX2 实现
+    };
+
+    enum KernelParam {
+        EHorspoolMinLength = 32,    // 关键字长度不小于此值时使用 Horspool 算法
+        EMaxCaseVariants = 4,       // 向量化过滤时单个字符最多比较的大小写变体数量
+    };
+
+    // 查找文本 text 中从 from 开始第一次出现关键字 keyword 的位置，未找到返回 -1
+    static int indexOf(const QString &text, const QString &keyword, int from = 0, Qt::CaseSensitivity cs = Qt::CaseSensitive);
+    static int indexOf(const QChar *text, int length, const QChar *keyword, int keywordLength,
+                       int from = 0, Qt::CaseSensitivity cs = Qt::CaseSensitive);
+
+    // 当前平台使用的实现
+    static Implementation implementation();
+
+private:
+    // 标量实现，逐个比较首字符后校验
+    static int indexOfScalar(const ushort *text, int length, const ushort *keyword, int keywordLength, int from, const ushort *foldTable);
+    // Boyer-Moore-Horspool 实现
+    static int indexOfHorspool(const ushort *text, int length, const ushort *keyword, int keywordLength, int from, const ushort *foldTable);
+};
+
+#endif // TEXTSEARCHKERNEL_H
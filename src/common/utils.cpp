@@ -25,6 +25,8 @@
 #include <QStandardPaths>
 #include <KEncodingProber>
 #include <QTextCodec>
+#include <QTextDocument>
+#include <QTextBlock>
 #include <QImageReader>
 #include <QCryptographicHash>
 #include "qprocess.h"
@@ -1104,3 +1106,46 @@ void Utils::sendFloatMessageFixedFont(QWidget *par, const QIcon &icon, const QSt
 
     DMessageManager::instance()->sendMessage(par, floMsg);
 }
+
+/**
+ * @brief 读取文档 \a document 中 [ \a start, \a start + \a length) 范围的文本，仅访问范围内的文本块，
+ *      段落分隔符及特殊字符的转换规则与 QTextDocument::toPlainText() 一致
+ * @return 范围内的文本
+ */
+QString Utils::documentText(const QTextDocument *document, int start, int length)
+{
+    QString text;
+    text.reserve(length);
+
+    QTextBlock block = document->findBlock(start);
+    while (block.isValid() && text.length() < length) {
+        const QString blockText = block.text();
+        const int offset = start + text.length() - block.position();
+        text.append(blockText.midRef(offset, length - text.length()));
+        // 文本块之间的段落分隔符
+        if (text.length() < length) {
+            text.append(QLatin1Char('\n'));
+        }
+        block = block.next();
+    }
+
+    QChar *uc = text.data();
+    QChar *end = uc + text.length();
+    for (; uc != end; ++uc) {
+        switch (uc->unicode()) {
+        case 0xfdd0:
+        case 0xfdd1:
+        case QChar::ParagraphSeparator:
+        case QChar::LineSeparator:
+            *uc = QLatin1Char('\n');
+            break;
+        case QChar::Nbsp:
+            *uc = QLatin1Char(' ');
+            break;
+        default:
+            break;
+        }
+    }
+
+    return text;
+}
@@ -26,6 +26,8 @@
 #define COPY_CONSUME_MEMORY_MULTIPLE 9      //复制文本时内存占用系数
 #define PASTE_CONSUME_MEMORY_MULTIPLE 7     //粘贴文本时内存占用系数
 
+class QTextDocument;
+
 class Utils
 {
 public:
@@ -139,6 +141,9 @@ public:
     // 发送浮动提示信息，并且字体大小跟随 qApp 应用默认字体而不是父窗口字体
     static void sendFloatMessageFixedFont(QWidget *par, const QIcon &icon, const QString &message);
 
+    // 读取文档 [start, start + length) 范围的文本，与 QTextDocument::toPlainText() 转换规则一致
+    static QString documentText(const QTextDocument *document, int start, int length);
+
 private:
     static QString m_systemLanguage;
 };
@@ -6,6 +6,7 @@
 #include "../common/utils.h"
 
 #include <QDebug>
+#include <QLocale>
 
 // 不同布局模式下界面参数，不完全对应设计图固定值，调整后实际像素值和设计图对应
 const int s_FBHeight = 60;
@@ -31,6 +32,17 @@ FindBar::FindBar(QWidget *parent)
     m_layout->setAlignment(Qt::AlignVCenter);
     m_findLabel = new QLabel(tr("Find"));
     m_editLine = new LineBar();
+    m_matchCountLabel = new QLabel();
+    m_regexButton = new QPushButton(tr("Regex"));
+    m_regexButton->setCheckable(true);
+    m_regexButton->setToolTip(tr("Use regular expression"));
+    m_wholeWordButton = new QPushButton(tr("Whole Word"));
+    m_wholeWordButton->setCheckable(true);
+    m_wholeWordButton->setToolTip(tr("Match whole word only"));
+    m_findInTabsButton = new QPushButton(tr("All Tabs"));
+    m_findInTabsButton->setToolTip(tr("Find in all open tabs"));
+    m_findInFolderButton = new QPushButton(tr("In Folder"));
+    m_findInFolderButton->setToolTip(tr("Find in all files of a folder"));
     m_findPrevButton = new QPushButton(tr("Previous"));
     m_findNextButton = new QPushButton(tr("Next"));
     m_closeButton = new DIconButton(DStyle::SP_CloseButton);
@@ -49,6 +61,11 @@ FindBar::FindBar(QWidget *parent)
     lineBarLayout->addItem(new QSpacerItem(1, 1, QSizePolicy::Minimum, QSizePolicy::MinimumExpanding));
     m_layout->addLayout(lineBarLayout);
 
+    m_layout->addWidget(m_matchCountLabel);
+    m_layout->addWidget(m_regexButton);
+    m_layout->addWidget(m_wholeWordButton);
+    m_layout->addWidget(m_findInTabsButton);
+    m_layout->addWidget(m_findInFolderButton);
     m_layout->addWidget(m_findPrevButton);
     m_layout->addWidget(m_findNextButton);
     m_layout->addWidget(m_closeButton);
@@ -70,7 +87,16 @@ FindBar::FindBar(QWidget *parent)
     connect(m_findPrevButton, &QPushButton::clicked, this, &FindBar::handleFindPrev, Qt::QueuedConnection);
     //connect(m_findPrevButton, &QPushButton::clicked, this, &FindBar::findPrev, Qt::QueuedConnection);
 
+    connect(m_findInTabsButton, &QPushButton::clicked, this, [this]() {
+        emit findInTabs(m_editLine->lineEdit()->text());
+    });
+    connect(m_findInFolderButton, &QPushButton::clicked, this, [this]() {
+        emit findInFolder(m_editLine->lineEdit()->text());
+    });
     connect(m_closeButton, &DIconButton::clicked, this, &FindBar::findCancel, Qt::QueuedConnection);
+    // 切换查找模式后按新模式重新查找
+    connect(m_regexButton, &QPushButton::toggled, this, &FindBar::handleContentChanged, Qt::QueuedConnection);
+    connect(m_wholeWordButton, &QPushButton::toggled, this, &FindBar::handleContentChanged, Qt::QueuedConnection);
 
 #ifdef DTKWIDGET_CLASS_DSizeMode
     updateSizeMode();
@@ -193,6 +219,28 @@ void FindBar::setMismatchAlert(bool isAlert)
     m_editLine->setAlert(isAlert);
 }
 
+/**
+ * @brief 显示匹配项序号及总数，如 "37 of 12,455" ，后台仍在统计时总数后添加 "+" 表示已统计的部分
+ */
+void FindBar::setMatchCount(int current, int total, bool counting)
+{
+    QString totalText = QLocale().toString(total);
+    if (counting) {
+        totalText.append(QLatin1Char('+'));
+    }
+
+    if (current > 0) {
+        m_matchCountLabel->setText(tr("%1 of %2").arg(QLocale().toString(current)).arg(totalText));
+    } else {
+        m_matchCountLabel->setText(tr("%1 results").arg(totalText));
+    }
+}
+
+void FindBar::clearMatchCount()
+{
+    m_matchCountLabel->clear();
+}
+
 void FindBar::receiveText(QString t)
 {
     searched = false;
@@ -206,6 +254,18 @@ void FindBar::setSearched(bool _)
     searched = _;
 }
 
+TextSearchEngine::SearchFlags FindBar::searchFlags() const
+{
+    TextSearchEngine::SearchFlags flags = TextSearchEngine::ENoSearchFlags;
+    if (m_regexButton->isChecked()) {
+        flags |= TextSearchEngine::ERegularExpression;
+    }
+    if (m_wholeWordButton->isChecked()) {
+        flags |= TextSearchEngine::EWholeWord;
+    }
+    return flags;
+}
+
 void FindBar::findPreClicked()
 {
     if (!searched) {
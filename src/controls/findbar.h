@@ -6,6 +6,7 @@
 #define FINDBAR_H
 
 #include "linebar.h"
+#include "../common/textsearchengine.h"
 
 #include <QHBoxLayout>
 #include <QPushButton>
@@ -41,6 +42,11 @@ public:
     void receiveText(QString t);
     void setSearched(bool _);
     void findPreClicked();
+    // 查找模式(正则表达式、全词匹配)
+    TextSearchEngine::SearchFlags searchFlags() const;
+    // 显示当前匹配项序号 current (从 1 开始，0 表示不在匹配项上)及匹配项总数 total ，counting 表示仍在统计
+    void setMatchCount(int current, int total, bool counting);
+    void clearMatchCount();
 
 Q_SIGNALS:
     void pressEsc();
@@ -49,6 +55,10 @@ Q_SIGNALS:
 
     void removeSearchKeyword();
     void updateSearchKeyword(QString file, QString keyword);
+    // 在所有打开的标签页中查找
+    void findInTabs(const QString &keyword);
+    // 在文件夹的所有文件中查找
+    void findInFolder(const QString &keyword);
 
     //add guoshao
     void sigFindbarClose();
@@ -70,10 +80,15 @@ private:
 private:
     QPushButton *m_findNextButton;
     QPushButton *m_findPrevButton;
+    QPushButton *m_regexButton;         // 正则表达式查找开关
+    QPushButton *m_wholeWordButton;     // 全词匹配开关
+    QPushButton *m_findInTabsButton;    // 在所有标签页中查找
+    QPushButton *m_findInFolderButton;  // 在文件夹中查找
     DIconButton *m_closeButton;
     LineBar *m_editLine;
     QHBoxLayout *m_layout;
     QLabel *m_findLabel;
+    QLabel *m_matchCountLabel;          // 匹配项序号及总数
     QString m_findFile;
     int m_findFileColumn;
     int m_findFileRow;
@@ -32,10 +32,18 @@ ReplaceBar::ReplaceBar(QWidget *parent)
     m_replaceLine = new LineBar();
     m_withLabel = new QLabel(tr("Replace With"));
     m_withLine = new LineBar();
+    m_regexButton = new QPushButton(tr("Regex"));
+    m_regexButton->setCheckable(true);
+    m_regexButton->setToolTip(tr("Use regular expression, \\1 in replacement refers to the first captured group"));
+    m_wholeWordButton = new QPushButton(tr("Whole Word"));
+    m_wholeWordButton->setCheckable(true);
+    m_wholeWordButton->setToolTip(tr("Match whole word only"));
     m_replaceButton = new QPushButton(tr("Replace"));
     m_replaceSkipButton = new QPushButton(tr("Skip"));
     m_replaceRestButton = new QPushButton(tr("Replace Rest"));
     m_replaceAllButton = new QPushButton(tr("Replace All"));
+    m_replaceInTabsButton = new QPushButton(tr("Replace in Tabs"));
+    m_replaceInTabsButton->setToolTip(tr("Replace in all open tabs"));
     m_closeButton = new DIconButton(DStyle::SP_CloseButton);
     m_closeButton->setFlat(true);
     m_closeButton->setFixedSize(30, 30);
@@ -46,10 +54,13 @@ ReplaceBar::ReplaceBar(QWidget *parent)
     m_layout->addLayout(createVerticalLine(m_replaceLine));
     m_layout->addWidget(m_withLabel);
     m_layout->addLayout(createVerticalLine(m_withLine));
+    m_layout->addWidget(m_regexButton);
+    m_layout->addWidget(m_wholeWordButton);
     m_layout->addWidget(m_replaceButton);
     m_layout->addWidget(m_replaceSkipButton);
     m_layout->addWidget(m_replaceRestButton);
     m_layout->addWidget(m_replaceAllButton);
+    m_layout->addWidget(m_replaceInTabsButton);
     m_layout->addWidget(m_closeButton);
     this->setLayout(m_layout);
 
@@ -78,8 +89,12 @@ ReplaceBar::ReplaceBar(QWidget *parent)
     connect(m_replaceSkipButton, &QPushButton::clicked, this, &ReplaceBar::handleSkip,Qt::QueuedConnection);
     connect(m_replaceRestButton, &QPushButton::clicked, this, &ReplaceBar::handleReplaceRest, Qt::QueuedConnection);
     connect(m_replaceAllButton, &QPushButton::clicked, this, &ReplaceBar::handleReplaceAll, Qt::QueuedConnection);
+    connect(m_replaceInTabsButton, &QPushButton::clicked, this, &ReplaceBar::handleReplaceInTabs, Qt::QueuedConnection);
 
     connect(m_closeButton, &DIconButton::clicked, this, &ReplaceBar::replaceClose, Qt::QueuedConnection);
+    // 切换查找模式后按新模式重新查找
+    connect(m_regexButton, &QPushButton::toggled, this, &ReplaceBar::handleContentChanged, Qt::QueuedConnection);
+    connect(m_wholeWordButton, &QPushButton::toggled, this, &ReplaceBar::handleContentChanged, Qt::QueuedConnection);
 
 #ifdef DTKWIDGET_CLASS_DSizeMode
     updateSizeMode();
@@ -155,6 +170,11 @@ void ReplaceBar::handleReplaceAll()
     replaceAll(m_replaceLine->lineEdit()->text(), m_withLine->lineEdit()->text());
 }
 
+void ReplaceBar::handleReplaceInTabs()
+{
+    replaceInTabs(m_replaceLine->lineEdit()->text(), m_withLine->lineEdit()->text());
+}
+
 void ReplaceBar::hideEvent(QHideEvent *)
 {
     searched = false;
@@ -256,6 +276,18 @@ void ReplaceBar::setsearched(bool _)
     searched = _;
 }
 
+TextSearchEngine::SearchFlags ReplaceBar::searchFlags() const
+{
+    TextSearchEngine::SearchFlags flags = TextSearchEngine::ENoSearchFlags;
+    if (m_regexButton->isChecked()) {
+        flags |= TextSearchEngine::ERegularExpression;
+    }
+    if (m_wholeWordButton->isChecked()) {
+        flags |= TextSearchEngine::EWholeWord;
+    }
+    return flags;
+}
+
 void ReplaceBar::change()
 {
     searched = false;
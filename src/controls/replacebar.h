@@ -7,6 +7,7 @@
 
 #include <QPushButton>
 #include "linebar.h"
+#include "../common/textsearchengine.h"
 #include <QHBoxLayout>
 #include <QLabel>
 #include <QPainter>
@@ -32,6 +33,8 @@ public:
     void activeInput(QString text, QString file, int row, int column, int scrollOffset);
     void setMismatchAlert(bool isAlert);
     void setsearched(bool _);
+    // 查找模式(正则表达式、全词匹配)
+    TextSearchEngine::SearchFlags searchFlags() const;
 
 Q_SIGNALS:
     void pressEsc();
@@ -39,6 +42,8 @@ Q_SIGNALS:
     void replaceSkip(QString file, QString keyword);
     void replaceRest(QString replaceText, QString withText);
     void replaceAll(QString replaceText, QString withText);
+    // 在所有打开的标签页中替换
+    void replaceInTabs(QString replaceText, QString withText);
     void beforeReplace(QString _);
 
     void backToPosition(QString file, int row, int column, int scrollOffset);
@@ -53,6 +58,7 @@ public Q_SLOTS:
     void replaceClose();
     void handleContentChanged();
     void handleReplaceAll();
+    void handleReplaceInTabs();
     void handleReplaceNext();
     void handleReplaceRest();
     void handleSkip();
@@ -71,6 +77,9 @@ private:
     QPushButton *m_replaceButton;
     QPushButton *m_replaceRestButton;
     QPushButton *m_replaceSkipButton;
+    QPushButton *m_regexButton;         // 正则表达式查找开关
+    QPushButton *m_wholeWordButton;     // 全词匹配开关
+    QPushButton *m_replaceInTabsButton; // 在所有标签页中替换
     DIconButton *m_closeButton;
     LineBar *m_replaceLine;
     LineBar *m_withLine;
@@ -4,6 +4,10 @@
 
 
 #include "../common/utils.h"
+#include "../common/textsearchkernel.h"
+#include "../common/performancemonitor.h"
+#include "../common/highlightrepository.h"
+#include "../common/highlightstatecache.h"
 #include "../widgets/window.h"
 #include "../widgets/bottombar.h"
 #include "dtextedit.h"
@@ -52,12 +56,14 @@ TextEdit::TextEdit(QWidget *parent)
     : DPlainTextEdit(parent),
       m_wrapper(nullptr)
 {
-    // 更新单独添加的高亮格式文件
-    m_repository.addCustomSearchPath(KF5_HIGHLIGHT_PATH);
-
     setUndoRedoEnabled(false);
     //撤销重做栈
     m_pUndoStack = new QUndoStack();
+    //全文查找引擎，跟随文档变更维护查找结果
+    m_pSearchEngine = new TextSearchEngine(document(), this);
+    connect(m_pSearchEngine, &TextSearchEngine::sigResultChanged, this, &TextEdit::onSearchResultChanged);
+    connect(m_pSearchEngine, &TextSearchEngine::sigPartialResult, this, &TextEdit::onSearchResultChanged);
+    connect(m_pSearchEngine, &TextSearchEngine::sigInvalidated, this, &TextEdit::sigFindMatchChanged);
 
     m_nLines = 0;
     m_nBookMarkHoverLine = -1;
@@ -107,6 +113,7 @@ TextEdit::TextEdit(QWidget *parent)
     connect(document(), &QTextDocument::contentsChange, this, &TextEdit::updateMark);
     connect(document(), &QTextDocument::contentsChange, this, &TextEdit::checkBookmarkLineMove);
     connect(document(), &QTextDocument::contentsChange, this, &TextEdit::onTextContentChanged);
+    connect(document(), &QTextDocument::contentsChange, this, &TextEdit::updateFoldRegionIndex);
 
     connect(m_pUndoStack, &QUndoStack::canRedoChanged, this, &TextEdit::slotCanRedoChanged);
     connect(m_pUndoStack, &QUndoStack::canUndoChanged, this, &TextEdit::slotCanUndoChanged);
@@ -477,7 +484,7 @@ void TextEdit::popRightMenu(QPoint pos)
     }
 
     // intelligent judge whether to support comments.
-    const auto def = m_repository.definitionForFileName(QFileInfo(m_sFilePath).fileName());
+    const auto def = HighlightRepository::instance()->definitionForFileName(m_sFilePath);
     if (characterCount() &&
             (textCursor().hasSelection() || !isBlankLine) &&
             !def.filePath().isEmpty()) {
@@ -1514,6 +1521,11 @@ void TextEdit::slotValueChanged(int iValue)
         this->selectTextInView();
     }
 
+    // 存在可见区域外的装饰时，滚动后重新生成可见区域的扩展选区
+    if (m_hasHiddenSelections) {
+        renderAllSelections();
+    }
+
     this->updateLeftAreaWidget();
 }
 
@@ -1696,19 +1708,23 @@ void TextEdit::updateFont()
     }
 }
 
-void TextEdit::replaceAll(const QString &replaceText, const QString &withText)
+int TextEdit::replaceAll(const QString &replaceText, const QString &withText)
 {
     if (m_readOnlyMode || m_bReadOnlyPermission) {
-        return;
+        return 0;
     }
 
     if (replaceText.isEmpty()) {
-        return;
+        return 0;
+    }
+
+    if (isPatternSearch()) {
+        return replacePatternMatches(replaceText, withText, 0);
     }
 
     // 替换文本相同，返回
     if (replaceText == withText) {
-        return;
+        return 0;
     }
 
     QTextDocument::FindFlags flags;
@@ -1718,22 +1734,24 @@ void TextEdit::replaceAll(const QString &replaceText, const QString &withText)
     QTextCursor startCursor = textCursor();
 
     QString oldText = this->toPlainText();
+    // 仅记录匹配位置，撤销项不保存替换前后的文档内容
+    QVector<int> offsets = ReplaceAllCommand::findOffsets(oldText, replaceText);
 
-    // 保存旧的标记索引光标记录信息，只需要更新其坐标偏移信息即可
-    QList<TextEdit::MarkReplaceInfo> backupMarkList = convertMarkToReplace(m_markOperations);
-    auto replaceList = backupMarkList;
-    // 计算替换颜色标记信息
-    calcMarkReplaceList(replaceList, oldText, replaceText, withText);
-
-    QString newText = oldText;
-    newText.replace(replaceText, withText);
+    if (!offsets.isEmpty()) {
+        // 保存旧的标记索引光标记录信息，只需要更新其坐标偏移信息即可
+        QList<TextEdit::MarkReplaceInfo> backupMarkList = convertMarkToReplace(m_markOperations);
+        auto replaceList = backupMarkList;
+        // 计算替换颜色标记信息
+        calcMarkReplaceList(replaceList, oldText, replaceText, withText);
+        oldText.clear();
 
-    if (oldText != newText) {
         ChangeMarkCommand *pChangeMark = new ChangeMarkCommand(this, backupMarkList, replaceList);
         // 设置替换撤销项为颜色标记变更撤销项的子项
-        new ReplaceAllCommand(oldText, newText, cursor, pChangeMark);
+        new ReplaceAllCommand(offsets, replaceText, withText, cursor, pChangeMark);
         m_pUndoStack->push(pChangeMark);
     }
+
+    return offsets.size();
 }
 
 void TextEdit::replaceNext(const QString &replaceText, const QString &withText)
@@ -1753,6 +1771,12 @@ void TextEdit::replaceNext(const QString &replaceText, const QString &withText)
 
     QTextCursor cursor = textCursor();
 
+    // 正则表达式或全词匹配模式下匹配项长度可能与关键字不同，替换当前高亮的匹配项
+    int matchLength = replaceText.size();
+    if (isPatternSearch()) {
+        matchLength = m_findHighlightSelection.cursor.selectionEnd() - m_findHighlightSelection.cursor.selectionStart();
+    }
+
     if (m_cursorStart != -1) {
         cursor.setPosition(m_cursorStart);
         m_cursorStart = -1;
@@ -1760,10 +1784,25 @@ void TextEdit::replaceNext(const QString &replaceText, const QString &withText)
         cursor.setPosition(m_findHighlightSelection.cursor.selectionStart());
     }
     cursor.movePosition(QTextCursor::NoMove, QTextCursor::MoveAnchor);
-    cursor.movePosition(QTextCursor::NextCharacter, QTextCursor::KeepAnchor, replaceText.size());
+    cursor.movePosition(QTextCursor::NextCharacter, QTextCursor::KeepAnchor, matchLength);
+
+    QString strSelection(cursor.selectedText());
+    QString replacement = withText;
+    bool matched = !strSelection.compare(replaceText) || replaceText.contains("\n");
+    if (isPatternSearch()) {
+        // 选中文本需完整匹配，正则表达式替换文本中的 \1 等引用替换为捕获组文本
+        const QRegularExpression regex = TextSearchEngine::regularExpression(replaceText, m_searchFlags);
+        const QRegularExpressionMatch match = regex.match(strSelection, 0, QRegularExpression::NormalMatch,
+                                                          QRegularExpression::AnchoredMatchOption);
+        matched = match.hasMatch() && match.capturedLength() == strSelection.size();
+        if (matched && m_searchFlags.testFlag(TextSearchEngine::ERegularExpression)) {
+            const SearchResult selection(QVector<int>({0}), QVector<int>({strSelection.size()}));
+            replacement = TextSearchEngine::replacements(strSelection, selection, 0, replaceText, m_searchFlags, withText).value(0, withText);
+        }
+    }
 
     // 文本替换长度变更调整量
-    int adjustlen = withText.size() - replaceText.size();
+    int adjustlen = replacement.size() - matchLength;
     // 保存旧的标记索引光标记录信息，只需要更新其坐标偏移信息即可
     QList<TextEdit::MarkReplaceInfo> backupMarkList = convertMarkToReplace(m_markOperations);
     auto replaceList = backupMarkList;
@@ -1775,7 +1814,7 @@ void TextEdit::replaceNext(const QString &replaceText, const QString &withText)
 
         // 获取替换文本区域和颜色标记区域的交叉关系
         Utils::RegionIntersectType type = Utils::checkRegionIntersect(
-                                              cursor.selectionStart(), cursor.selectionStart() + replaceText.size(), info.start, info.end);
+                                              cursor.selectionStart(), cursor.selectionStart() + matchLength, info.start, info.end);
         // 仅进行单次处理
         switch (type) {
         case Utils::ELeft:
@@ -1789,7 +1828,7 @@ void TextEdit::replaceNext(const QString &replaceText, const QString &withText)
         }
         case Utils::EIntersectLeft: {
             // 交集在替换文本左侧，拓展颜色标记右侧到替换文本右侧
-            info.end = cursor.selectionStart() + withText.size();
+            info.end = cursor.selectionStart() + replacement.size();
             break;
         }
         case Utils::EIntersectRight: {
@@ -1815,11 +1854,10 @@ void TextEdit::replaceNext(const QString &replaceText, const QString &withText)
         }
     }
 
-    QString strSelection(cursor.selectedText());
-    if (!strSelection.compare(replaceText) || replaceText.contains("\n")) {
+    if (matched) {
         ChangeMarkCommand *pChangeMark = new ChangeMarkCommand(this, backupMarkList, replaceList);
         // 设置插入撤销项为颜色标记变更撤销项的子项
-        new InsertTextUndoCommand(cursor, withText, this, pChangeMark);
+        new InsertTextUndoCommand(cursor, replacement, this, pChangeMark);
         m_pUndoStack->push(pChangeMark);
         ensureCursorVisible();
     }
@@ -1840,6 +1878,11 @@ void TextEdit::replaceRest(const QString &replaceText, const QString &withText)
         return;
     }
 
+    if (isPatternSearch()) {
+        replacePatternMatches(replaceText, withText, textCursor().position());
+        return;
+    }
+
     // 替换文本相同，返回
     if (replaceText == withText) {
         return;
@@ -1854,22 +1897,23 @@ void TextEdit::replaceRest(const QString &replaceText, const QString &withText)
 
     int pos = cursor.position();
     QString oldText = this->toPlainText();
-    QString newText = oldText.left(pos);
-    QString right = oldText.right(oldText.size() - pos);
+    // 仅记录光标后的匹配位置，撤销项不保存替换前后的文档内容
+    QVector<int> offsets = ReplaceAllCommand::findOffsets(oldText, replaceText, pos);
 
-    // 保存旧的标记索引光标记录信息，只需要更新其坐标偏移信息即可
-    QList<TextEdit::MarkReplaceInfo> backupMarkList = convertMarkToReplace(m_markOperations);
-    auto replaceList = backupMarkList;
-    // 计算替换颜色标记信息
-    calcMarkReplaceList(replaceList, right, replaceText, withText, pos);
+    if (!offsets.isEmpty()) {
+        QString right = oldText.right(oldText.size() - pos);
+        oldText.clear();
 
-    right.replace(replaceText, withText);
-    newText += right;
+        // 保存旧的标记索引光标记录信息，只需要更新其坐标偏移信息即可
+        QList<TextEdit::MarkReplaceInfo> backupMarkList = convertMarkToReplace(m_markOperations);
+        auto replaceList = backupMarkList;
+        // 计算替换颜色标记信息
+        calcMarkReplaceList(replaceList, right, replaceText, withText, pos);
+        right.clear();
 
-    if (oldText != newText) {
         ChangeMarkCommand *pChangeMark = new ChangeMarkCommand(this, backupMarkList, replaceList);
         // 设置替换撤销项为颜色标记变更撤销项的子项
-        new ReplaceAllCommand(oldText, newText, cursor, pChangeMark);
+        new ReplaceAllCommand(offsets, replaceText, withText, cursor, pChangeMark);
         m_pUndoStack->push(pChangeMark);
     }
 
@@ -1877,6 +1921,93 @@ void TextEdit::replaceRest(const QString &replaceText, const QString &withText)
     setTextCursor(startCursor);
 }
 
+/**
+ * @brief 按正则表达式或全词匹配模式替换 \a from 之后的所有匹配项。
+ *      正则表达式替换时各匹配项长度及替换文本可能不同，撤销项记录各匹配项替换前后的文本。
+ */
+int TextEdit::replacePatternMatches(const QString &replaceText, const QString &withText, int from)
+{
+    QString oldText = this->toPlainText();
+    const SearchResult searchResult = TextSearchEngine::search(oldText, replaceText, m_searchFlags);
+    const int first = searchResult.nextIndex(from);
+    if (first < 0) {
+        return 0;
+    }
+
+    const bool regexMode = m_searchFlags.testFlag(TextSearchEngine::ERegularExpression);
+    // 区分大小写的全词匹配项文本均与关键字相同，仅记录匹配位置
+    const bool sameText = !regexMode && !m_searchFlags.testFlag(TextSearchEngine::ECaseInsensitive);
+    QStringList newTexts;
+    if (regexMode) {
+        newTexts = TextSearchEngine::replacements(oldText, searchResult, first, replaceText, m_searchFlags, withText);
+    }
+
+    QVector<int> offsets;
+    QVector<int> lengths;
+    QStringList oldTexts;
+    for (int i = first; i < searchResult.count(); ++i) {
+        offsets.append(searchResult.offsetAt(i));
+        lengths.append(searchResult.lengthAt(i));
+        if (!sameText) {
+            oldTexts.append(oldText.mid(searchResult.offsetAt(i), searchResult.lengthAt(i)));
+        }
+    }
+    oldText.clear();
+
+    return replaceMatches(SearchResult(offsets, lengths), replaceText, withText, oldTexts, newTexts);
+}
+
+/**
+ * @brief 按查找结果 \a result 替换全部匹配项，结果须与文档当前内容一致。
+ *      在所有标签页中替换时直接使用后台查找的结果，文档未被编辑时无需重新查找全文
+ */
+int TextEdit::replaceMatches(const SearchResult &result, const QString &replaceText, const QString &withText,
+                             const QStringList &oldTexts, const QStringList &newTexts)
+{
+    if (m_readOnlyMode || m_bReadOnlyPermission || result.isEmpty()) {
+        return 0;
+    }
+
+    // 各匹配项文本及替换文本均相同时无需替换
+    if (oldTexts.isEmpty() && newTexts.isEmpty() && replaceText == withText) {
+        return 0;
+    }
+
+    QVector<int> lengths;
+    QVector<int> newLengths;
+    lengths.reserve(result.count());
+    newLengths.reserve(result.count());
+    for (int i = 0; i < result.count(); ++i) {
+        lengths.append(result.lengthAt(i));
+        newLengths.append(newTexts.isEmpty() ? withText.size() : newTexts.at(i).size());
+    }
+
+    // 保存旧的标记索引光标记录信息，只需要更新其坐标偏移信息即可
+    QList<TextEdit::MarkReplaceInfo> backupMarkList = convertMarkToReplace(m_markOperations);
+    auto replaceList = backupMarkList;
+    calcMarkReplaceList(replaceList, result.offsets(), lengths, newLengths);
+
+    QTextCursor cursor = textCursor();
+    ChangeMarkCommand *pChangeMark = new ChangeMarkCommand(this, backupMarkList, replaceList);
+    // 设置替换撤销项为颜色标记变更撤销项的子项
+    if (oldTexts.isEmpty() && newTexts.isEmpty()) {
+        new ReplaceAllCommand(result.offsets(), replaceText, withText, cursor, pChangeMark);
+    } else {
+        QStringList olds = oldTexts;
+        QStringList news = newTexts;
+        for (int i = olds.size(); i < result.count(); ++i) {
+            olds.append(replaceText);
+        }
+        for (int i = news.size(); i < result.count(); ++i) {
+            news.append(withText);
+        }
+        new ReplaceAllCommand(result.offsets(), olds, news, cursor, pChangeMark);
+    }
+    m_pUndoStack->push(pChangeMark);
+
+    return result.count();
+}
+
 void TextEdit::beforeReplace(const QString &strReplaceText)
 {
     if (strReplaceText.isEmpty() || !m_findHighlightSelection.cursor.hasSelection()) {
@@ -1929,6 +2060,8 @@ void TextEdit::removeKeywords()
     m_findHighlightSelection.cursor.clearSelection();
 
     m_findMatchSelections.clear();
+    m_findMatchKeyword.clear();
+    m_pSearchEngine->clear();
 
     updateHighlightLineSelection();
 
@@ -1940,7 +2073,15 @@ void TextEdit::removeKeywords()
 bool TextEdit::highlightKeyword(QString keyword, int position)
 {
     Q_UNUSED(position)
+    // 后台查找全文并建立匹配项位置索引，完成后定位及可见区域高亮直接使用索引
+    if (keyword.isEmpty()) {
+        m_pSearchEngine->clear();
+    } else if (m_pSearchEngine->keyword() != keyword || m_pSearchEngine->searchFlags() != m_searchFlags) {
+        m_pSearchEngine->start(keyword, m_searchFlags);
+    }
+
     m_findMatchSelections.clear();
+    m_findMatchKeyword = keyword;
     updateHighlightLineSelection();
     updateCursorKeywordSelection(keyword, true);
     bool bRet = updateKeywordSelectionsInView(keyword, m_findMatchFormat, &m_findMatchSelections);
@@ -1952,6 +2093,7 @@ bool TextEdit::highlightKeyword(QString keyword, int position)
 bool TextEdit::highlightKeywordInView(QString keyword)
 {
     m_findMatchSelections.clear();
+    m_findMatchKeyword = keyword;
     bool bRet = updateKeywordSelectionsInView(keyword, m_findMatchFormat, &m_findMatchSelections);
     // 直接设置 setExtraSelections 会导致无法显示颜色标记，调用 renderAllSelections 进行显示更新
     // setExtraSelections(m_findMatchSelections);
@@ -1963,6 +2105,7 @@ bool TextEdit::highlightKeywordInView(QString keyword)
 void TextEdit::clearFindMatchSelections()
 {
     m_findMatchSelections.clear();
+    m_findMatchKeyword.clear();
 }
 
 void TextEdit::updateCursorKeywordSelection(QString keyword, bool findNext)
@@ -2037,19 +2180,45 @@ bool TextEdit::updateKeywordSelectionsInView(QString keyword, QTextCharFormat ch
         QTextEdit::ExtraSelection extra;
         extra.format = charFormat;
 
-        QScrollBar *pScrollBar = verticalScrollBar();
-        QPoint startPoint = QPointF(0, 0).toPoint();
-        QTextBlock beginBlock = cursorForPosition(startPoint).block();
-        int beginPos = beginBlock.position();
-        QTextBlock endBlock;
+        const QPair<int, int> visibleRange = visibleTextRange();
+        int beginPos = visibleRange.first;
+        int endPos = visibleRange.second;
+
+        // 已建立全文查找索引时，仅为可见区域内的匹配项构建高亮；
+        // 全文查找进行中时不在界面线程查找，使用已完成的部分结果，其余匹配项在查找结果更新时重新构建
+        const bool pending = isSearchResultPending(keyword);
+        if (pending || isSearchResultReady(keyword)) {
+            const SearchResult &result = m_pSearchEngine->result();
+            const QPair<int, int> range = result.indexRange(beginPos, endPos);
+            const int textLength = document()->characterCount() - 1;
+            for (int i = range.first; i < range.second; ++i) {
+                // 查找期间文档变更时部分结果可能超出文档，查找重新开始后更新
+                if (result.offsetAt(i) + result.lengthAt(i) > textLength) {
+                    break;
+                }
+                extra.cursor = cursor;
+                extra.cursor.setPosition(result.offsetAt(i));
+                extra.cursor.setPosition(result.offsetAt(i) + result.lengthAt(i), QTextCursor::KeepAnchor);
+                listSelection->append(extra);
+            }
 
-        if (pScrollBar->maximum() > 0) {
-            QPoint endPoint = QPointF(0, 1.5 * height()).toPoint();
-            endBlock = cursorForPosition(endPoint).block();
-        } else {
-            endBlock = document()->lastBlock();
+            // 查找完成前不确定是否存在匹配项，视为存在
+            return pending || result.nextIndex(beginPos) >= 0;
+        }
+
+        // 正则表达式或全词匹配模式下全文查找未完成时，逐个查找可见区域内的匹配项
+        if (isPatternSearch()) {
+            const QRegularExpression regex = TextSearchEngine::regularExpression(keyword, m_searchFlags);
+            cursor = findPatternCursor(regex, beginPos, false);
+            bool found = !cursor.isNull();
+            while (!cursor.isNull() && cursor.selectionStart() <= endPos) {
+                extra.cursor = cursor;
+                listSelection->append(extra);
+                cursor = findPatternCursor(regex, cursor.selectionEnd(), false);
+            }
+
+            return found;
         }
-        int endPos = endBlock.position() + endBlock.length() - 1;
 
         // 内部计算时，均视为 \n 结尾
         QLatin1Char endLine('\n');
@@ -2108,6 +2277,38 @@ bool TextEdit::searchKeywordSeletion(QString keyword, QTextCursor cursor, bool f
     bool ret = false;
     int offsetLines = 3;
 
+    // 已建立全文查找索引时，二分查找光标前后的匹配项
+    if (isSearchResultReady(keyword)) {
+        const SearchResult &result = m_pSearchEngine->result();
+        int index = findNext ? result.nextIndex(std::max(cursor.position(), cursor.anchor()))
+                             : result.previousIndex(std::min(cursor.position(), cursor.anchor()));
+        if (index < 0) {
+            return false;
+        }
+
+        QTextCursor match(document());
+        match.setPosition(result.offsetAt(index));
+        match.setPosition(result.offsetAt(index) + result.lengthAt(index), QTextCursor::KeepAnchor);
+        m_findHighlightSelection.cursor = match;
+        jumpToLine(match.blockNumber() + offsetLines, false);
+        setTextCursor(match);
+        return true;
+    }
+
+    if (isPatternSearch()) {
+        const QRegularExpression regex = TextSearchEngine::regularExpression(keyword, m_searchFlags);
+        QTextCursor match = findNext ? findPatternCursor(regex, std::max(cursor.position(), cursor.anchor()), false)
+                                     : findPatternCursor(regex, std::min(cursor.position(), cursor.anchor()), true);
+        if (match.isNull()) {
+            return false;
+        }
+
+        m_findHighlightSelection.cursor = match;
+        jumpToLine(match.blockNumber() + offsetLines, false);
+        setTextCursor(match);
+        return true;
+    }
+
     if (findNext) {
         QTextCursor next = document()->find(keyword, cursor, QTextDocument::FindCaseSensitively);
         if (keyword.contains("\n")) {
@@ -2137,14 +2338,138 @@ bool TextEdit::searchKeywordSeletion(QString keyword, QTextCursor cursor, bool f
     return ret;
 }
 
+/**
+ * @return 返回全文查找引擎，查找完成后保存匹配项位置索引
+ */
+TextSearchEngine *TextEdit::searchEngine() const
+{
+    return m_pSearchEngine;
+}
+
+/**
+ * @return 当前查找高亮的匹配项在全文查找结果中的序号(从 1 开始，不在匹配项上时为 0)及匹配项总数，
+ *      后台查找过程中为已按顺序完成部分的结果
+ */
+QPair<int, int> TextEdit::findMatchPosition() const
+{
+    const SearchResult &result = m_pSearchEngine->result();
+    int current = 0;
+    if (m_findHighlightSelection.cursor.hasSelection()) {
+        current = result.indexOf(m_findHighlightSelection.cursor.selectionStart()) + 1;
+    }
+
+    return qMakePair(current, result.count());
+}
+
+/**
+ * @return 关键字 \a keyword 的全文查找结果是否已完成且与当前文档一致
+ */
+bool TextEdit::isSearchResultReady(const QString &keyword) const
+{
+    return m_pSearchEngine->isValid() && m_pSearchEngine->keyword() == keyword
+           && m_pSearchEngine->searchFlags() == m_searchFlags;
+}
+
+bool TextEdit::isSearchResultPending(const QString &keyword) const
+{
+    return m_pSearchEngine->isRunning() && m_pSearchEngine->keyword() == keyword
+           && m_pSearchEngine->searchFlags() == m_searchFlags;
+}
+
+/**
+ * @brief 全文查找完成、按顺序完成新的分块或结果跟随文档变更更新时，重新构建可见区域的查找高亮，
+ *      查找进行中时可见区域的高亮不依赖界面线程逐个查找
+ */
+void TextEdit::onSearchResultChanged()
+{
+    if (!m_findMatchKeyword.isEmpty() && m_findMatchKeyword == m_pSearchEngine->keyword()) {
+        updateKeywordSelectionsInView(m_findMatchKeyword, m_findMatchFormat, &m_findMatchSelections);
+        renderAllSelections();
+    }
+
+    emit sigFindMatchChanged();
+}
+
+/**
+ * @brief 设置查找模式 \a flags ，模式变更后重新高亮关键字时将重新查找全文
+ */
+void TextEdit::setSearchFlags(TextSearchEngine::SearchFlags flags)
+{
+    m_searchFlags = flags;
+}
+
+TextSearchEngine::SearchFlags TextEdit::searchFlags() const
+{
+    return m_searchFlags;
+}
+
+/**
+ * @return 是否按正则表达式或全词匹配模式查找，此模式下匹配项长度可能与关键字不同
+ */
+bool TextEdit::isPatternSearch() const
+{
+    return m_searchFlags & (TextSearchEngine::EWholeWord | TextSearchEngine::ERegularExpression);
+}
+
+/**
+ * @brief 使用正则表达式 \a regex 从 \a position 开始向前或向后查找，跳过长度为 0 的匹配项(如 "^" "a*")
+ * @return 匹配项光标，未找到或表达式无效时返回空光标
+ */
+QTextCursor TextEdit::findPatternCursor(const QRegularExpression &regex, int position, bool backward) const
+{
+    if (!regex.isValid()) {
+        return QTextCursor();
+    }
+
+    // QTextDocument::find() 按查找标识重新设置表达式是否区分大小写
+    QTextDocument::FindFlags flags;
+    if (backward) {
+        flags |= QTextDocument::FindBackward;
+    }
+    if (!m_searchFlags.testFlag(TextSearchEngine::ECaseInsensitive)) {
+        flags |= QTextDocument::FindCaseSensitively;
+    }
+
+    QTextCursor cursor = document()->find(regex, position, flags);
+    while (!cursor.isNull() && !cursor.hasSelection()) {
+        position = backward ? cursor.position() : cursor.position() + 1;
+        if (position <= 0 || position >= document()->characterCount()) {
+            return QTextCursor();
+        }
+        cursor = document()->find(regex, position, flags);
+    }
+
+    return cursor;
+}
+
+/**
+ * @brief 渲染所有装饰(当前行、颜色标记、括号、代码段、Alt选中区域及查找高亮)。
+ *      各装饰保存在按位置记录的列表中，仅与可见区域相交的部分生成扩展选区传给编辑器，
+ *      存在不可见的装饰时在滚动后重新渲染。
+ */
 void TextEdit::renderAllSelections()
 {
     QList<QTextEdit::ExtraSelection> finalSelections;
     QList<QPair<QTextEdit::ExtraSelection, qint64>> selectionsSortList;
+    const QPair<int, int> visibleRange = visibleTextRange();
+    int totalCount = 0;     ///< 全部装饰数量
+
+    auto isVisible = [&visibleRange](const QTextEdit::ExtraSelection &selection) {
+        return selection.cursor.selectionEnd() >= visibleRange.first
+               && selection.cursor.selectionStart() <= visibleRange.second;
+    };
+    auto appendVisible = [&](const QList<QTextEdit::ExtraSelection> &selections) {
+        totalCount += selections.size();
+        for (const QTextEdit::ExtraSelection &selection : selections) {
+            if (isVisible(selection)) {
+                finalSelections.append(selection);
+            }
+        }
+    };
 
     // 标记当前行的浅灰色
     if (m_HightlightYes) {
-        finalSelections.append(m_currentLineSelection);
+        appendVisible({m_currentLineSelection});
     }
     // 此处代码无作用，去除
     // else {
@@ -2157,7 +2482,14 @@ void TextEdit::renderAllSelections()
 
     // 选中区域的颜色标记，先加入 selectionsSortList
     // 通过时间戳升序排序后，加入到 finalSelections 中
-    selectionsSortList.append(m_wordMarkSelections);
+    // 仅加入与可见区域相交的颜色标记，滚动或缩放视图时重新渲染，标记较多时不必每次处理全部标记
+    totalCount += m_wordMarkSelections.size();
+    if (!m_wordMarkSelections.isEmpty()) {
+        const QVector<int> visibleMarks = wordMarkIndex().intersecting(m_wordMarkSelections, visibleRange.first, visibleRange.second);
+        for (int index : visibleMarks) {
+            selectionsSortList.append(m_wordMarkSelections.at(index));
+        }
+    }
 
     // Find 和 Replace 高亮选中，移动到最后放入到 finalSelections 中
     // 保证此高亮状态，若存在，一定可以被用户看到
@@ -2181,7 +2513,12 @@ void TextEdit::renderAllSelections()
     // 将颜色标记，标记所有的 selections 加入到 selectionsSortList 中， 后边将进行排序
     QMap<QString, QList<QPair<QTextEdit::ExtraSelection, qint64>>>::Iterator it;
     for (it = m_mapKeywordMarkSelections.begin(); it != m_mapKeywordMarkSelections.end(); ++it) {
-        selectionsSortList.append(it.value());
+        totalCount += it.value().size();
+        for (const QPair<QTextEdit::ExtraSelection, qint64> &mark : it.value()) {
+            if (isVisible(mark.first)) {
+                selectionsSortList.append(mark);
+            }
+        }
     }
 
     // 通过时间戳重新排序颜色标记功能的 selections
@@ -2195,25 +2532,63 @@ void TextEdit::renderAllSelections()
     }
 
     // 标记括号
-    finalSelections.append(m_beginBracketSelection);
-    finalSelections.append(m_endBracketSelection);
+    appendVisible({m_beginBracketSelection, m_endBracketSelection});
 
     // 标记代码段
-    finalSelections.append(m_markFoldHighLightSelections);
+    appendVisible(m_markFoldHighLightSelections);
 
     // Alt选中区域的高亮
-    finalSelections.append(m_altModSelections);
+    appendVisible(m_altModSelections);
 
     // 查找替换的高亮需要放在最后
     // Find 高亮
-    finalSelections.append(m_findMatchSelections);
+    appendVisible(m_findMatchSelections);
     // Replace 高亮
-    finalSelections.append(m_findHighlightSelection);
+    appendVisible({m_findHighlightSelection});
+
+    // 记录单次渲染的扩展选区数量
+    m_hasHiddenSelections = finalSelections.size() < totalCount;
+    PerformanceMonitor::extraSelectionsRendered(finalSelections.size(), totalCount);
 
     // 设置到 QPlainText 中进行渲染
     setExtraSelections(finalSelections);
 }
 
+/**
+ * @brief 可见区域的文本位置范围，结束位置向下多延伸半屏，减少滚动时的重新计算
+ */
+QPair<int, int> TextEdit::visibleTextRange()
+{
+    QTextBlock beginBlock = cursorForPosition(QPointF(0, 0).toPoint()).block();
+    QTextBlock endBlock;
+    if (verticalScrollBar()->maximum() > 0) {
+        endBlock = cursorForPosition(QPointF(0, 1.5 * height()).toPoint()).block();
+    } else {
+        endBlock = document()->lastBlock();
+    }
+
+    return qMakePair(beginBlock.position(), endBlock.position() + endBlock.length() - 1);
+}
+
+/**
+ * @brief 颜色标记的位置索引，标记列表增删后重建，编辑文本时标记光标位置由文档维护，索引仍然有效
+ */
+const TextMarkIndex &TextEdit::wordMarkIndex()
+{
+    if (!m_wordMarkIndex.isValid(m_wordMarkSelections)) {
+        m_wordMarkIndex.rebuild(m_wordMarkSelections);
+    }
+    return m_wordMarkIndex;
+}
+
+const FoldRegionIndex &TextEdit::foldRegionIndex()
+{
+    if (!m_foldRegionIndex.isValid(document())) {
+        m_foldRegionIndex.rebuild(document());
+    }
+    return m_foldRegionIndex;
+}
+
 void TextEdit::updateMarkAllSelectColor()
 {
     isMarkAllLine(m_bIsMarkAllLine, m_strMarkAllLineColorName);
@@ -2350,31 +2725,9 @@ void TextEdit::codeFLodAreaPaintEvent(QPaintEvent *event)
 
     for (int iBlockCount = blockNumber ; iBlockCount <= nPageLine; ++iBlockCount) {
         if (block.isVisible()) {
-            //判定是否包含注释代码左括号、是否整行是注释，isNeedShowFoldIcon该函数是为了做判定当前行是否包含成对的括号，如果包括，则不显示折叠标志
-
-            //获取行数文本块 出去字符串判断　梁卫东２０２０年０９月０１日１７：１６：１７
-            QString text = block.text();
-            //若存在字符串行，多个字符串中间的 '{' '}' 同样被忽略
-            QRegExp regExp("\".*\"");
-            QString curText = text.remove(regExp);
-
-            //不同类型文件注释符号不同 梁卫东　２０２０－０９－０３　１７：２８：４５
-            bool bHasCommnent = false;
-            QString multiLineCommentMark;
-            QString singleLineCommentMark;
-
-            if (m_commentDefinition.isValid()) {
-                multiLineCommentMark = m_commentDefinition.multiLineStart.trimmed();
-                singleLineCommentMark = m_commentDefinition.singleLine.trimmed();
-                //判断是否包含单行或多行注释
-                if (!multiLineCommentMark.isEmpty()) bHasCommnent = block.text().trimmed().startsWith(multiLineCommentMark);
-                if (!singleLineCommentMark.isEmpty()) bHasCommnent = block.text().trimmed().startsWith(singleLineCommentMark);
-            } else {
-                bHasCommnent = false;
-            }
-
+            //判定是否包含折叠区域起始、是否整行是注释，isNeedShowFoldIcon该函数是为了做判定当前行是否包含未结束的折叠区域，如果不包括，则不显示折叠标志
             //添加注释判断 存在不显示折叠标志　不存在显示折叠标准　梁卫东　２０２０年０９月０３日１７：２８：５０
-            if (curText.contains("{") && isNeedShowFoldIcon(block) && !bHasCommnent) {
+            if (isNeedShowFoldIcon(block) && !isFoldCommentBlock(block)) {
 
                 cur.setPosition(block.position(), QTextCursor::MoveAnchor);
 
@@ -2472,6 +2825,66 @@ void TextEdit::handleScrollFinish()
 void TextEdit::setSyntaxDefinition(KSyntaxHighlighting::Definition def)
 {
     m_commentDefinition.setComments(def.singleLineCommentMarker(), def.multiLineCommentMarker().first,  def.multiLineCommentMarker().second);
+
+    // 语法定义包含折叠区域时按语法高亮上报的区域折叠，基于缩进的语法按缩进折叠，否则按括号折叠
+    FoldRegionIndex::FoldingMode mode = FoldRegionIndex::EBraceFolding;
+    if (def.isValid() && def.indentationBasedFoldingEnabled()) {
+        mode = FoldRegionIndex::EIndentationFolding;
+    } else if (def.isValid() && def.foldingEnabled()) {
+        mode = FoldRegionIndex::ESyntaxFolding;
+    }
+    if (mode != m_foldRegionIndex.foldingMode()) {
+        m_foldRegionIndex.setFoldingMode(mode, document());
+        m_pLeftAreaWidget->m_pFlodArea->update();
+    }
+}
+
+/**
+ * @brief 语法高亮文本块 \a blockNumber 后更新其折叠区域标记 \a regions
+ */
+void TextEdit::updateSyntaxFoldRegions(int blockNumber, const QVector<int> &regions)
+{
+    if (FoldRegionIndex::ESyntaxFolding != m_foldRegionIndex.foldingMode() || !m_foldRegionIndex.isValid(document())) {
+        return;
+    }
+
+    const FoldRegionIndex::BlockInfo oldInfo = m_foldRegionIndex.blockInfo(blockNumber);
+    m_foldRegionIndex.setBlockRegions(blockNumber, regions);
+    const FoldRegionIndex::BlockInfo newInfo = m_foldRegionIndex.blockInfo(blockNumber);
+    if (oldInfo.endDepth != newInfo.endDepth || oldInfo.minDepth != newInfo.minDepth) {
+        m_pLeftAreaWidget->m_pFlodArea->update();
+    }
+}
+
+/**
+ * @brief 语法折叠时，从区域起始文本块 \a block 向后高亮尚未高亮的文本块，直至区域结束。
+ *      仅高亮区域内的文本块，无需高亮全文。
+ */
+void TextEdit::highlightFoldRegion(const QTextBlock &block)
+{
+    CSyntaxHighlighter *highlighter = m_wrapper ? m_wrapper->getSyntaxHighlighter() : nullptr;
+    if (highlighter == nullptr) {
+        return;
+    }
+
+    // 深度均相对于起始文本块的起始位置
+    const FoldRegionIndex::BlockInfo info = m_foldRegionIndex.blockInfo(block.blockNumber());
+    const int targetDepth = info.endDepth - 1;
+    int depth = info.endDepth;
+    for (QTextBlock next = block.next(); next.isValid(); next = next.next()) {
+        // Kate syntax highlighter 在高亮文本后会设置数据，通过此数据判断是否需要高亮
+        if (!next.userData()) {
+            highlighter->setEnableHighlight(true);
+            highlighter->rehighlightBlock(next);
+            highlighter->setEnableHighlight(false);
+        }
+
+        const FoldRegionIndex::BlockInfo nextInfo = m_foldRegionIndex.blockInfo(next.blockNumber());
+        if (depth + nextInfo.minDepth <= targetDepth) {
+            break;
+        }
+        depth += nextInfo.endDepth;
+    }
 }
 
 bool TextEdit::setCursorKeywordSeletoin(int position, bool findNext)
@@ -3019,7 +3432,7 @@ QTextCursor TextEdit::findCursor(const QString &substr, const QString &text, int
     if (backward) {
         index = text.lastIndexOf(findSubStr, from);
     } else {
-        index = text.indexOf(findSubStr, from);
+        index = TextSearchKernel::indexOf(text, findSubStr, from);
     }
     if (-1 != index) {
         auto cursor = this->textCursor();
@@ -3311,28 +3724,27 @@ bool TextEdit::getNeedControlLine(int line, bool isVisable)
         //遍历最后右括弧文本块 设置块隐藏或显示
         while (beginBlock.isValid()) {
             beginBlock.setVisible(isVisable);
-            viewport()->adjustSize();
             beginBlock = beginBlock.next();
         }
+        viewport()->adjustSize();
         return true;
         //没有找到匹配左右括弧 //如果左右"{" "}"在同一行不折叠
     } else if (!bFoundBrace || endBlock == curBlock) {
         return false;
     } else {
-        //遍历最后右括弧文本块 设置块隐藏或显示
+        //遍历最后右括弧文本块 设置块隐藏或显示，全部设置后统一调整视图
         while (beginBlock != endBlock && beginBlock.isValid()) {
             if (beginBlock.isValid()) {
                 beginBlock.setVisible(isVisable);
             }
-            viewport()->adjustSize();
             beginBlock = beginBlock.next();
         }
 
         //最后一行显示或隐藏,或者下行就包含"}"
         if (beginBlock.isValid() && beginBlock == endBlock && endBlock.text().simplified() == "}") {
             endBlock.setVisible(isVisable);
-            viewport()->adjustSize();
         }
+        viewport()->adjustSize();
 
         return true;
     }
@@ -3831,7 +4243,7 @@ void TextEdit::toggleReadOnlyMode(bool notNotify)
 
 void TextEdit::toggleComment(bool bValue)
 {
-    const auto def = m_repository.definitionForFileName(QFileInfo(m_sFilePath).fileName());
+    const auto def = HighlightRepository::instance()->definitionForFileName(m_sFilePath);
     QTextCursor selectionCursor = textCursor();
     selectionCursor.movePosition(QTextCursor::StartOfBlock);
     selectionCursor.movePosition(QTextCursor::EndOfBlock, QTextCursor::KeepAnchor);
@@ -4283,15 +4695,28 @@ void TextEdit::checkBookmarkLineMove(int from, int charsRemoved, int charsAdded)
     m_nLines = blockCount();
 }
 
+/**
+ * @brief 折叠或展开全部代码区域。各行的折叠区域由折叠区域索引查询，
+ *      折叠时跳过已隐藏的嵌套区域，遍历文本块的复杂度为 O(n) 。
+ *      语法折叠时需先取得全部文本块的折叠区域，由高亮状态缓存分析剩余文本块，不设置高亮格式。
+ */
 void TextEdit::flodOrUnflodAllLevel(bool isFlod)
 {
     m_listMainFlodAllPos.clear();
+    CSyntaxHighlighter *highlighter = m_wrapper ? m_wrapper->getSyntaxHighlighter() : nullptr;
+    if (FoldRegionIndex::ESyntaxFolding == foldRegionIndex().foldingMode() && highlighter && highlighter->stateCache()) {
+        highlighter->stateCache()->analyzeTo(blockCount() - 1);
+    }
+    const FoldRegionIndex &index = foldRegionIndex();
+    // 括号折叠时跳过注释行，语法及缩进折叠的区域已排除注释
+    const bool skipComment = FoldRegionIndex::EBraceFolding == index.foldingMode();
     //折叠
     if (isFlod) {
-        for (int line = 0; line < document()->blockCount(); line++) {
-            if (blockContainStrBrackets(line)
-                    && document()->findBlockByNumber(line).isVisible()
-                    && !document()->findBlockByNumber(line).text().trimmed().startsWith("//")) {
+        for (QTextBlock block = document()->begin(); block.isValid(); block = block.next()) {
+            const int line = block.blockNumber();
+            if (index.hasRegionBegin(line)
+                    && block.isVisible()
+                    && !(skipComment && block.text().trimmed().startsWith("//"))) {
                 if (getNeedControlLine(line, false)) {
                     m_listMainFlodAllPos.append(line);
                 }
@@ -4299,10 +4724,11 @@ void TextEdit::flodOrUnflodAllLevel(bool isFlod)
         }
         //展开
     } else {
-        for (int line = 0; line < document()->blockCount(); line++) {
-            if (blockContainStrBrackets(line)
-                    && !document()->findBlockByNumber(line + 1).isVisible()
-                    && !document()->findBlockByNumber(line).text().trimmed().startsWith("//")) {
+        for (QTextBlock block = document()->begin(); block.isValid(); block = block.next()) {
+            const int line = block.blockNumber();
+            if (index.hasRegionBegin(line)
+                    && !block.next().isVisible()
+                    && !(skipComment && block.text().trimmed().startsWith("//"))) {
                 if (getNeedControlLine(line, true)) {
                     m_listMainFlodAllPos.append(line);
                 }
@@ -4393,26 +4819,30 @@ void TextEdit::getHideRowContent(int iLine)
     }
 }
 
+/**
+ * @brief 文本块 \a block 是否包含未在本行结束的折叠区域，左右括号成对出现时不显示折叠标志。
+ *      由折叠区域索引查询，括号及语法折叠的复杂度为 O(1) 。
+ */
 bool TextEdit::isNeedShowFoldIcon(QTextBlock block)
 {
-    QString blockText = block.text();
-    bool hasFindLeft = false; // 是否已经找到当前行第一个左括号
-    int rightNum = 0, leftNum = 0;//右括号数目、左括号数目
-    for (int i = 0 ; i < blockText.count(); ++i) {
-        if (blockText.at(i) == "}" && hasFindLeft) {
-            rightNum++;
-        } else if (blockText.at(i) == "{") {
-            if (!hasFindLeft)
-                hasFindLeft = true;
-            leftNum++;
-        }
-    }
+    return foldRegionIndex().startsRegion(block.blockNumber());
+}
 
-    if (rightNum == leftNum) {
-        return  false;
-    } else {
-        return  true;
+/**
+ * @brief 括号折叠时，以注释符号起始的文本块 \a block 不显示折叠标志，语法及缩进折叠的区域已排除注释
+ */
+bool TextEdit::isFoldCommentBlock(const QTextBlock &block)
+{
+    if (FoldRegionIndex::EBraceFolding != foldRegionIndex().foldingMode() || !m_commentDefinition.isValid()) {
+        return false;
     }
+
+    //判断是否包含单行或多行注释
+    const QString text = block.text().trimmed();
+    const QString multiLineCommentMark = m_commentDefinition.multiLineStart.trimmed();
+    const QString singleLineCommentMark = m_commentDefinition.singleLine.trimmed();
+    return (!multiLineCommentMark.isEmpty() && text.startsWith(multiLineCommentMark))
+           || (!singleLineCommentMark.isEmpty() && text.startsWith(singleLineCommentMark));
 }
 
 int TextEdit::getHighLightRowContentLineNum(int iLine)
@@ -4710,6 +5140,16 @@ void TextEdit::updateSaveIndex()
     m_lastSaveIndex = m_pUndoStack->index();
 }
 
+void TextEdit::setSaveIndex(int index)
+{
+    m_lastSaveIndex = index;
+}
+
+QUndoStack *TextEdit::getUndoStack() const
+{
+    return m_pUndoStack;
+}
+
 void TextEdit::isMarkCurrentLine(bool isMark, QString strColor,  qint64 timeStamp)
 {
     qint64 operationTimeStamp = timeStamp;
@@ -4751,6 +5191,7 @@ void TextEdit::isMarkCurrentLine(bool isMark, QString strColor,  qint64 timeStam
                 QPair<QTextEdit::ExtraSelection, qint64>
                 (selection, operationTimeStamp));
         }
+        m_wordMarkIndex.invalidate();
     } else {
         clearMarksForTextCursor();
     }
@@ -4908,6 +5349,7 @@ void TextEdit::isMarkAllLine(bool isMark, QString strColor)
     } else {
         m_markOperations.clear();
         m_wordMarkSelections.clear();
+        m_wordMarkIndex.invalidate();
         m_mapKeywordMarkSelections.clear();
 
         QTextEdit::ExtraSelection selection;
@@ -4940,6 +5382,7 @@ void TextEdit::cancelLastMark()
                     i--;
                 }
             }
+            m_wordMarkIndex.invalidate();
         }
         break;
     }
@@ -4983,6 +5426,7 @@ void TextEdit::cancelLastMark()
         qWarning() << __FUNCTION__ << __LINE__ << " cancle mark color operation,"
                    << "find exist remain selections, will clear!";
         m_wordMarkSelections.clear();
+        m_wordMarkIndex.invalidate();
         m_mapKeywordMarkSelections.clear();
     }
 
@@ -5028,6 +5472,9 @@ bool TextEdit::clearMarksForTextCursor()
         }
     }
 
+    if (bFind) {
+        m_wordMarkIndex.invalidate();
+    }
     return bFind;
 }
 
@@ -5178,6 +5625,7 @@ void TextEdit::manualUpdateAllMark(const QList<QPair<MarkOperation, qint64> > &m
     [](const QPair<QTextEdit::ExtraSelection, qint64> &a, const QPair<QTextEdit::ExtraSelection, qint64> &b) {
         return a.second < b.second;
     });
+    m_wordMarkIndex.invalidate();
 
     // 计算全文标记部分并刷新界面颜色标记
     markAllKeywordInView();
@@ -5334,7 +5782,7 @@ void TextEdit::calcMarkReplaceList(QList<TextEdit::MarkReplaceInfo> &replaceList
     QList<int> foundPosList;
 
     // 查找替换位置，遍历查找替换文本出现位置
-    int findPos = oldText.indexOf(replaceText, findOffset);
+    int findPos = TextSearchKernel::indexOf(oldText, replaceText, findOffset);
     // 需要取得左侧所有的变更相对偏移，从文本左侧开始循环遍历
     while (-1 != findPos
             && currentMarkIndex < replaceList.size()) {
@@ -5394,7 +5842,7 @@ void TextEdit::calcMarkReplaceList(QList<TextEdit::MarkReplaceInfo> &replaceList
 
         // 继续查找替换文本位置
         findOffset = findPos + replaceText.size();
-        findPos = oldText.indexOf(replaceText, findOffset);
+        findPos = TextSearchKernel::indexOf(oldText, replaceText, findOffset);
     }
 
     // 继续处理剩余颜色标记偏移
@@ -5407,6 +5855,66 @@ void TextEdit::calcMarkReplaceList(QList<TextEdit::MarkReplaceInfo> &replaceList
     }
 }
 
+/**
+ * @brief 根据替换项位置 \a offsets 、替换前长度 \a lengths 及替换后长度 \a newLengths 计算颜色标记替换后的范围。
+ *      标记被替换项包含时移除标记，与替换项相交时拓展到替换后文本的边界，其它标记按之前替换项的长度变化平移。
+ */
+void TextEdit::calcMarkReplaceList(QList<TextEdit::MarkReplaceInfo> &replaceList, const QVector<int> &offsets,
+                                   const QVector<int> &lengths, const QVector<int> &newLengths) const
+{
+    if (replaceList.isEmpty() || offsets.isEmpty()) {
+        return;
+    }
+
+    // shifts[i] 为前 i 个替换项的长度变化之和
+    QVector<int> shifts(offsets.size() + 1, 0);
+    for (int i = 0; i < offsets.size(); ++i) {
+        shifts[i + 1] = shifts.at(i) + newLengths.at(i) - lengths.at(i);
+    }
+
+    for (auto &info : replaceList) {
+        // 标记类型为标记全文或文本全文标记(使用文本查找而非光标位置)，不进行替换处理
+        if (MarkAllMatch == info.opt.type
+                || MarkAll == info.opt.type) {
+            continue;
+        }
+
+        // 与颜色标记相交(含相邻)的替换项 [first, last]，替换项互不重叠，起止位置均为升序
+        int first = static_cast<int>(std::lower_bound(offsets.constBegin(), offsets.constEnd(), info.start) - offsets.constBegin());
+        if (first > 0 && offsets.at(first - 1) + lengths.at(first - 1) >= info.start) {
+            --first;
+        }
+        int last = static_cast<int>(std::upper_bound(offsets.constBegin(), offsets.constEnd(), info.end) - offsets.constBegin()) - 1;
+
+        if (first > last) {
+            // 和替换文本无交集
+            info.start += shifts.at(first);
+            info.end += shifts.at(first);
+            continue;
+        }
+
+        if (offsets.at(first) <= info.start && offsets.at(first) + lengths.at(first) >= info.end) {
+            // 替换文本内容包含标记信息, 取消当前文本标记, 在 manualUpdateAllMark() 函数处理会移除此标记
+            info.start = 0;
+            info.end = 0;
+            continue;
+        }
+
+        int start = info.start + shifts.at(first);
+        if (offsets.at(first) <= info.start) {
+            // 交集在标记左侧，拓展颜色标记到替换文本起始边界
+            start = offsets.at(first) + shifts.at(first);
+        }
+        int end = info.end + shifts.at(last + 1);
+        if (offsets.at(last) + lengths.at(last) > info.end) {
+            // 交集在标记右侧，拓展颜色标记到替换后文本的结束边界
+            end = offsets.at(last) + shifts.at(last) + newLengths.at(last);
+        }
+        info.start = start;
+        info.end = end;
+    }
+}
+
 void TextEdit::markSelectWord()
 {
     bool isFind  = false;
@@ -5419,6 +5927,7 @@ void TextEdit::markSelectWord()
         if (curson == currentCurson) {
             isFind = true;
             m_wordMarkSelections.removeAt(i);
+            m_wordMarkIndex.invalidate();
             renderAllSelections();
             break;
         }
@@ -5431,6 +5940,10 @@ void TextEdit::markSelectWord()
     }
 }
 
+/**
+ * @brief 文本变更后更新颜色标记。标记光标位置由文档维护，此处仅处理被删除或被插入文本拆分的标记，
+ *      通过标记位置索引查找变更位置附近的标记，不再遍历全部标记
+ */
 void TextEdit::updateMark(int from, int charsRemoved, int charsAdded)
 {
     //只读模式下实现禁止语音输入的效果
@@ -5450,165 +5963,165 @@ void TextEdit::updateMark(int from, int charsRemoved, int charsAdded)
         nCurrentPos = 0;///< 当前光标位置
     QTextEdit::ExtraSelection selection;///< 指定文本格式
     QList<QTextEdit::ExtraSelection> listSelections;///< 指定文本格式列表
-    QList<QPair<QTextEdit::ExtraSelection, qint64>> wordMarkSelections = m_wordMarkSelections;///< 标记列表
     QColor strColor;///< 指定文本颜色格式
     nCurrentPos = textCursor().position();
 
     //如果是删除字符
-    if (charsRemoved > 0) {
-        QList<int> listRemoveItem;///< 要移除标记的indexs
-
-        //寻找要移除标记的index
-        for (int i = 0; i < wordMarkSelections.count(); i++) {
-
-            nEndPos = wordMarkSelections.value(i).first.cursor.selectionEnd();
-            nStartPos = wordMarkSelections.value(i).first.cursor.selectionStart();
-            strColor = wordMarkSelections.value(i).first.format.background().color();
-
-            //如果有文字被选择
-            if (m_nSelectEndLine != -1) {
-
-                //如果删除的内容，完全包含标记内容
-                if (m_nSelectStart <= nStartPos && m_nSelectEnd >= nEndPos) {
-                    listRemoveItem.append(i);
+    if (charsRemoved > 0 && !m_wordMarkSelections.isEmpty()) {
+        QVector<int> listRemoveItem;///< 要移除标记的indexs
+
+        //如果有文字被选择
+        if (m_nSelectEndLine != -1) {
+            //如果删除的内容，完全包含标记内容
+            for (int index : wordMarkIndex().startingIn(m_wordMarkSelections, m_nSelectStart, m_nSelectEnd)) {
+                if (m_wordMarkSelections.at(index).first.cursor.selectionEnd() <= m_nSelectEnd) {
+                    listRemoveItem.append(index);
                 }
-            } else {
-
-                //如果标记内容全部被删除
-                if (wordMarkSelections.value(i).first.cursor.selection().toPlainText().isEmpty()) {
-                    // 此时 remove m_wordMarkSelections中的元素
-                    // 会造成 m_wordMarkSelections 和 wordMarkSelections的长度不一致
-                    // m_wordMarkSelections.removeAt(i);
-                    listRemoveItem.append(i);
+            }
+        } else {
+            //如果标记内容全部被删除，标记收缩到删除位置
+            for (int index : wordMarkIndex().intersecting(m_wordMarkSelections, from, from)) {
+                if (!m_wordMarkSelections.at(index).first.cursor.hasSelection()) {
+                    listRemoveItem.append(index);
                 }
             }
         }
 
-        //从标记列表中移除标记
-        for (int j = 0; j < listRemoveItem.count(); j++) {
-            // 不应该-j
-            // m_wordMarkSelections.removeAt(listRemoveItem.value(j) - j);
+        //从标记列表中移除标记，从后向前移除保证序号有效
+        std::sort(listRemoveItem.begin(), listRemoveItem.end());
+        for (int j = listRemoveItem.count() - 1; j >= 0; j--) {
             m_wordMarkSelections.removeAt(listRemoveItem.value(j));
         }
+        if (!listRemoveItem.isEmpty()) {
+            m_wordMarkIndex.invalidate();
+        }
     }
 
-    //如果是添加字符
-    if (charsAdded > 0) {
-        for (int i = 0; i < wordMarkSelections.count(); i++) {
-            nEndPos = wordMarkSelections.value(i).first.cursor.selectionEnd();
-            nStartPos = wordMarkSelections.value(i).first.cursor.selectionStart();
-            strColor = wordMarkSelections.value(i).first.format.background().color();
-            qint64 timeStamp = wordMarkSelections.value(i).second;
+    //如果是添加字符，查找光标位于其中或末尾的标记，多个标记时取列表中靠前的标记
+    int i = -1;
+    if (charsAdded > 0 && !m_wordMarkSelections.isEmpty()) {
+        for (int index : wordMarkIndex().intersecting(m_wordMarkSelections, nCurrentPos, nCurrentPos)) {
+            const QTextCursor &cursor = m_wordMarkSelections.at(index).first.cursor;
+            if ((nCurrentPos > cursor.selectionStart() || nCurrentPos == cursor.selectionEnd()) && (i < 0 || index < i)) {
+                i = index;
+            }
+        }
+    }
 
-            //如果字符添加在标记中
-            if (nCurrentPos > nStartPos && nCurrentPos < nEndPos) {
+    if (i >= 0) {
+        const QPair<QTextEdit::ExtraSelection, qint64> wordMark = m_wordMarkSelections.at(i);
+        nEndPos = wordMark.first.cursor.selectionEnd();
+        nStartPos = wordMark.first.cursor.selectionStart();
+        strColor = wordMark.first.format.background().color();
+        qint64 timeStamp = wordMark.second;
+        m_wordMarkIndex.invalidate();
 
-                m_wordMarkSelections.removeAt(i);
-                selection.format.setBackground(strColor);
-                selection.cursor = textCursor();
+        //如果字符添加在标记中
+        if (nCurrentPos > nStartPos && nCurrentPos < nEndPos) {
 
-                QTextEdit::ExtraSelection preSelection;
+            m_wordMarkSelections.removeAt(i);
+            selection.format.setBackground(strColor);
+            selection.cursor = textCursor();
 
-                //如果是输入法输入
-                if (m_bIsInputMethod) {
+            QTextEdit::ExtraSelection preSelection;
 
-                    //添加第一段标记
-                    selection.cursor.setPosition(nStartPos, QTextCursor::MoveAnchor);
-                    selection.cursor.setPosition(nCurrentPos - m_qstrCommitString.count(), QTextCursor::KeepAnchor);
-                    m_wordMarkSelections.insert(i, QPair<QTextEdit::ExtraSelection, qint64>
-                                                (selection, timeStamp));
+            //如果是输入法输入
+            if (m_bIsInputMethod) {
 
-                    preSelection.cursor = selection.cursor;
-                    preSelection.format = selection.format;
+                //添加第一段标记
+                selection.cursor.setPosition(nStartPos, QTextCursor::MoveAnchor);
+                selection.cursor.setPosition(nCurrentPos - m_qstrCommitString.count(), QTextCursor::KeepAnchor);
+                m_wordMarkSelections.insert(i, QPair<QTextEdit::ExtraSelection, qint64>
+                                            (selection, timeStamp));
 
-                    //添加第二段标记
-                    selection.cursor.setPosition(nCurrentPos, QTextCursor::MoveAnchor);
-                    selection.cursor.setPosition(nEndPos, QTextCursor::KeepAnchor);
-                    m_wordMarkSelections.insert(i + 1,  QPair<QTextEdit::ExtraSelection, qint64>
-                                                (selection, timeStamp));
+                preSelection.cursor = selection.cursor;
+                preSelection.format = selection.format;
 
-                    m_bIsInputMethod = false;
-                } else {
+                //添加第二段标记
+                selection.cursor.setPosition(nCurrentPos, QTextCursor::MoveAnchor);
+                selection.cursor.setPosition(nEndPos, QTextCursor::KeepAnchor);
+                m_wordMarkSelections.insert(i + 1,  QPair<QTextEdit::ExtraSelection, qint64>
+                                            (selection, timeStamp));
 
-                    //添加第一段标记
-                    selection.cursor.setPosition(nStartPos, QTextCursor::MoveAnchor);
-                    selection.cursor.setPosition(from, QTextCursor::KeepAnchor);
-                    m_wordMarkSelections.insert(i, QPair<QTextEdit::ExtraSelection, qint64>
-                                                (selection, timeStamp));
+                m_bIsInputMethod = false;
+            } else {
 
-                    preSelection.cursor = selection.cursor;
-                    preSelection.format = selection.format;
+                //添加第一段标记
+                selection.cursor.setPosition(nStartPos, QTextCursor::MoveAnchor);
+                selection.cursor.setPosition(from, QTextCursor::KeepAnchor);
+                m_wordMarkSelections.insert(i, QPair<QTextEdit::ExtraSelection, qint64>
+                                            (selection, timeStamp));
 
-                    //添加第二段标记
-                    selection.cursor.setPosition(nCurrentPos, QTextCursor::MoveAnchor);
-                    selection.cursor.setPosition(nEndPos, QTextCursor::KeepAnchor);
-                    m_wordMarkSelections.insert(i + 1, QPair<QTextEdit::ExtraSelection, qint64>
-                                                (selection, timeStamp));
-                }
+                preSelection.cursor = selection.cursor;
+                preSelection.format = selection.format;
 
-                bool bIsFind = false;
-
-                //在记录标记的表中替换（按标记动作记录）
-                for (int j = 0; j < m_mapWordMarkSelections.count(); j++) {
-                    auto list = m_mapWordMarkSelections.value(j);
-                    for (int k = 0; k < list.count(); k++) {
-                        if (list.value(k).cursor == wordMarkSelections.value(i).first.cursor
-                                && list.value(k).format == wordMarkSelections.value(i).first.format) {
-                            list.removeAt(k);
-                            listSelections = list;
-                            listSelections.insert(k, preSelection);
-                            listSelections.insert(k + 1, selection);
-                            bIsFind = true;
-                            break;
-                        }
-                    }
+                //添加第二段标记
+                selection.cursor.setPosition(nCurrentPos, QTextCursor::MoveAnchor);
+                selection.cursor.setPosition(nEndPos, QTextCursor::KeepAnchor);
+                m_wordMarkSelections.insert(i + 1, QPair<QTextEdit::ExtraSelection, qint64>
+                                            (selection, timeStamp));
+            }
 
-                    if (bIsFind) {
-                        m_mapWordMarkSelections.remove(j);
-                        m_mapWordMarkSelections.insert(j, listSelections);
+            bool bIsFind = false;
+
+            //在记录标记的表中替换（按标记动作记录）
+            for (int j = 0; j < m_mapWordMarkSelections.count(); j++) {
+                auto list = m_mapWordMarkSelections.value(j);
+                for (int k = 0; k < list.count(); k++) {
+                    if (list.value(k).cursor == wordMark.first.cursor
+                            && list.value(k).format == wordMark.first.format) {
+                        list.removeAt(k);
+                        listSelections = list;
+                        listSelections.insert(k, preSelection);
+                        listSelections.insert(k + 1, selection);
+                        bIsFind = true;
                         break;
                     }
                 }
-                break;
 
-            } else if (nCurrentPos == nEndPos) { //如果字符添加在标记后
-                m_wordMarkSelections.removeAt(i);
-                selection.format.setBackground(strColor);
-                selection.cursor = textCursor();
-
-                if (m_bIsInputMethod) {
-                    selection.cursor.setPosition(nStartPos, QTextCursor::MoveAnchor);
-                    selection.cursor.setPosition(nEndPos - m_qstrCommitString.count(), QTextCursor::KeepAnchor);
-                    m_bIsInputMethod = false;
-                } else {
-                    selection.cursor.setPosition(nStartPos, QTextCursor::MoveAnchor);
-                    selection.cursor.setPosition(from + charsAdded, QTextCursor::KeepAnchor);
+                if (bIsFind) {
+                    m_mapWordMarkSelections.remove(j);
+                    m_mapWordMarkSelections.insert(j, listSelections);
+                    break;
                 }
+            }
 
-                m_wordMarkSelections.insert(i, QPair<QTextEdit::ExtraSelection, qint64>
-                                            (selection, timeStamp));
+        } else if (nCurrentPos == nEndPos) { //如果字符添加在标记后
+            m_wordMarkSelections.removeAt(i);
+            selection.format.setBackground(strColor);
+            selection.cursor = textCursor();
 
-                bool bIsFind = false;
-                for (int j = 0; j < m_mapWordMarkSelections.count(); j++) {
-                    auto list = m_mapWordMarkSelections.value(j);
-                    for (int k = 0; k < list.count(); k++) {
-                        if (list.value(k).cursor == wordMarkSelections.value(i).first.cursor
-                                && list.value(k).format == wordMarkSelections.value(i).first.format) {
-                            list.removeAt(k);
-                            listSelections = list;
-                            listSelections.insert(k, selection);
-                            bIsFind = true;
-                            break;
-                        }
-                    }
+            if (m_bIsInputMethod) {
+                selection.cursor.setPosition(nStartPos, QTextCursor::MoveAnchor);
+                selection.cursor.setPosition(nEndPos - m_qstrCommitString.count(), QTextCursor::KeepAnchor);
+                m_bIsInputMethod = false;
+            } else {
+                selection.cursor.setPosition(nStartPos, QTextCursor::MoveAnchor);
+                selection.cursor.setPosition(from + charsAdded, QTextCursor::KeepAnchor);
+            }
 
-                    if (bIsFind) {
-                        m_mapWordMarkSelections.remove(j);
-                        m_mapWordMarkSelections.insert(j, listSelections);
+            m_wordMarkSelections.insert(i, QPair<QTextEdit::ExtraSelection, qint64>
+                                        (selection, timeStamp));
+
+            bool bIsFind = false;
+            for (int j = 0; j < m_mapWordMarkSelections.count(); j++) {
+                auto list = m_mapWordMarkSelections.value(j);
+                for (int k = 0; k < list.count(); k++) {
+                    if (list.value(k).cursor == wordMark.first.cursor
+                            && list.value(k).format == wordMark.first.format) {
+                        list.removeAt(k);
+                        listSelections = list;
+                        listSelections.insert(k, selection);
+                        bIsFind = true;
                         break;
                     }
                 }
-                break;
+
+                if (bIsFind) {
+                    m_mapWordMarkSelections.remove(j);
+                    m_mapWordMarkSelections.insert(j, listSelections);
+                    break;
+                }
             }
         }
     }
@@ -5695,23 +6208,12 @@ bool TextEdit::eventFilter(QObject *object, QEvent *event)
                 renderAllSelections();
 
                 //不同类型文件注释符号不同 梁卫东　２０２０－０９－０３　１７：２８：４５
-                bool bHasCommnent = false;
-                QString multiLineCommentMark;
-                QString singleLineCommentMark;
-
-                if (m_commentDefinition.isValid()) {
-                    multiLineCommentMark = m_commentDefinition.multiLineStart.trimmed();
-                    singleLineCommentMark = m_commentDefinition.singleLine.trimmed();
-                    //qDebug()<<"CommentMark:"<<multiLineCommentMark<<singleLineCommentMark;
-                    //判断是否包含单行或多行注释
-                    if (!multiLineCommentMark.isEmpty()) bHasCommnent = document()->findBlockByNumber(line - 1).text().trimmed().startsWith(multiLineCommentMark);
-                    if (!singleLineCommentMark.isEmpty()) bHasCommnent = document()->findBlockByNumber(line - 1).text().trimmed().startsWith(singleLineCommentMark);
-                } else {
-                    bHasCommnent = false;
-                }
+                const bool bHasCommnent = isFoldCommentBlock(document()->findBlockByNumber(line - 1));
+                //当前行是否包含未结束的折叠区域
+                const bool bHasRegion = foldRegionIndex().startsRegion(line - 1);
 
                 // 当前行line-1 判断下行line是否隐藏
-                if (document()->findBlockByNumber(line).isVisible() && document()->findBlockByNumber(line - 1).text().contains("{") && !bHasCommnent) {
+                if (document()->findBlockByNumber(line).isVisible() && bHasRegion && !bHasCommnent) {
                     getNeedControlLine(line - 1, false);
                     document()->adjustSize();
 
@@ -5726,7 +6228,7 @@ bool TextEdit::eventFilter(QObject *object, QEvent *event)
                     this->setLineWrapMode(curMode);
                     viewport()->update();
 
-                } else if (!document()->findBlockByNumber(line).isVisible() && document()->findBlockByNumber(line - 1).text().contains("{") && !bHasCommnent) {
+                } else if (!document()->findBlockByNumber(line).isVisible() && bHasRegion && !bHasCommnent) {
                     getNeedControlLine(line - 1, true);
                     document()->adjustSize();
 
@@ -7388,6 +7890,9 @@ void TextEdit::resizeEvent(QResizeEvent *e)
 
     // 显示区域变化时同时更新视图
     markAllKeywordInView();
+    if (m_markOperations.isEmpty() && m_hasHiddenSelections) {
+        renderAllSelections();
+    }
 
     // 当前处于文档页面尾部时，缩放后保持焦点在文档页面尾部
     if (e->oldSize().width() < e->size().width() && verticalScrollBar()->maximum() == verticalScrollBar()->value()) {
@@ -7931,22 +8436,14 @@ void TextEdit::removeComment()
 
 bool TextEdit::blockContainStrBrackets(int line)
 {
-    //获取行数文本块
-    QTextBlock curBlock = document()->findBlockByNumber(line);
-    QString text = curBlock.text();
-    //若存在字符串行，多个字符串中间的 '{' '}' 同样被忽略
-    QRegExp regExp("\".*\"");
-    if (text.contains(regExp)) {
-        QString curText = text.remove(regExp);
-        return curText.contains("{");
-    } else {
-        return text.contains("{");
-    }
+    //字符串中的 '{' '}' 由折叠区域索引忽略
+    return foldRegionIndex().hasRegionBegin(line);
 }
 
 /**
  * @brief 根据传入的起始行号 \a line ，查找在此行号下的折叠区域，查找后将返回查询过程中的折叠区域起始文本块
- *      \a beginBlock 和结束文本块 \a endBlock 。
+ *      \a beginBlock 和结束文本块 \a endBlock 。折叠区域由行内最后一个未闭合的左括弧起始，
+ *      匹配的右括弧所在文本块由折叠区域索引查询，不再逐字符扫描文档。
  * @param line          查找起始行号
  * @param beginBlock    起始文本块
  * @param endBlock      结束文本框
@@ -7957,6 +8454,7 @@ bool TextEdit::findFoldBlock(int line, QTextBlock &beginBlock, QTextBlock &endBl
 {
     //使用统一 折叠判断算法 根据左右"{""}"高亮算法
     QTextDocument *doc = document();
+    const FoldRegionIndex &index = foldRegionIndex();
     //获取行号对应文本块
     curBlock = doc->findBlockByNumber(line);
 
@@ -7965,61 +8463,37 @@ bool TextEdit::findFoldBlock(int line, QTextBlock &beginBlock, QTextBlock &endBl
     endBlock = curBlock.next();
 
     //如果是第一行不包括左括弧"{"
-    if (line == 0 && !curBlock.text().contains("{")) {
+    if (line == 0 && !index.hasRegionBegin(0)) {
         curBlock = curBlock.next();
     }
 
-    //获取当前块文本左括弧所在光标
-    int position = curBlock.position();
-    int offset = curBlock.text().lastIndexOf('{');
-    position += offset;
-
-    //获取当前文本块第一个字符光标
-    QChar begin = '{', end = '}';
-    QTextCursor cursor = textCursor();
-    cursor.setPosition(position, QTextCursor::MoveAnchor);
-    cursor.clearSelection();
+    //当前行不包含未闭合的左括弧，左右括弧在同一行
+    if (!index.startsRegion(curBlock.blockNumber())) {
+        endBlock = curBlock;
+        return true;
+    }
 
-    //左括弧光标 右括弧光标
-    QTextCursor bracketBeginCursor = cursor;
-    QTextCursor bracketEndCursor = cursor;
-    bracketBeginCursor.movePosition(QTextCursor::NextCharacter, QTextCursor::KeepAnchor);
-
-    //获取最后右括弧光标
-    int braceDepth = 0;
-    // 判断当前是否处于字符串内，字符串内的 { } 不进行统计
-    bool inCodeString = false;
-    QChar c;
-    while (!(c = doc->characterAt(position)).isNull()) {
-        // 判断是否处于字符串内，已在字符串内将不处理其它字符，只判断结束处理
-        if (inCodeString) {
-            // 判断 " 前是否存在转义字符，若不存在，则退出字符串
-            if ('"' == c
-                    && '\\' != doc->characterAt(position - 1)) {
-                inCodeString = false;
-            }
-        } else {
-            if (c == begin) {
-                braceDepth++;
-            } else if (c == end) {
-                braceDepth--;
-
-                if (0 == braceDepth) {
-                    bracketEndCursor = QTextCursor(doc);
-                    bracketEndCursor.setPosition(position);
-                    bracketEndCursor.movePosition(QTextCursor::NextCharacter, QTextCursor::KeepAnchor);
-                    endBlock = bracketEndCursor.block();
-                    break;
-                }
-            } else if ('"' == c) {
-                inCodeString = true;
-            }
-        }
+    //语法折叠时区域内的后续文本块可能尚未高亮
+    if (FoldRegionIndex::ESyntaxFolding == index.foldingMode()) {
+        highlightFoldRegion(curBlock);
+    }
 
-        position++;
+    //由索引查询最后一个未闭合左括弧匹配的右括弧所在文本块
+    const int matchLine = index.regionEnd(curBlock.blockNumber());
+    if (matchLine < 0) {
+        return false;
     }
 
-    return 0 == braceDepth;
+    endBlock = doc->findBlockByNumber(matchLine);
+    return true;
+}
+
+/**
+ * @brief 文档内容变更时更新代码折叠区域索引，仅重新统计变更的文本块
+ */
+void TextEdit::updateFoldRegionIndex(int from, int charsRemoved, int charsAdded)
+{
+    m_foldRegionIndex.contentsChange(document(), from, charsRemoved, charsAdded);
 }
 
 /**
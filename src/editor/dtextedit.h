@@ -10,8 +10,11 @@
 #include "codeflodarea.h"
 #include "../common/settings.h"
 #include "../common/utils.h"
+#include "../common/textsearchengine.h"
 #include "../widgets/ColorSelectWdg.h"
 #include "uncommentselection.h"
+#include "textmarkindex.h"
+#include "foldregionindex.h"
 //添加自定义撤销重做栈
 #include "inserttextundocommand.h"
 #include "deletetextundocommand.h"
@@ -197,7 +200,12 @@ public:
     void setFontSize(qreal fontSize);
     void updateFont();
 
-    void replaceAll(const QString &replaceText, const QString &withText);
+    //替换所有匹配项，返回替换的匹配项数量，只读时不替换
+    int replaceAll(const QString &replaceText, const QString &withText);
+    //按在文档当前内容中查找的结果 result 替换全部匹配项，返回替换的匹配项数量，只读时不替换。
+    //oldTexts 为各匹配项的文本，为空时均为 replaceText ；newTexts 为各匹配项的替换文本，为空时均为 withText
+    int replaceMatches(const SearchResult &result, const QString &replaceText, const QString &withText,
+                       const QStringList &oldTexts = QStringList(), const QStringList &newTexts = QStringList());
     void replaceNext(const QString &replaceText, const QString &withText);
     void replaceRest(const QString &replaceText, const QString &withText);
     void beforeReplace(const QString &strReplaceText);
@@ -214,6 +222,13 @@ public:
     bool updateKeywordSelectionsInView(QString keyword, QTextCharFormat charFormat, QList<QTextEdit::ExtraSelection> *listSelection);
     bool searchKeywordSeletion(QString keyword, QTextCursor cursor, bool findNext);
     void renderAllSelections();
+    // 全文查找引擎，查找完成后保存匹配项位置索引
+    TextSearchEngine *searchEngine() const;
+    // 当前查找高亮的匹配项序号及匹配项总数
+    QPair<int, int> findMatchPosition() const;
+    // 设置查找模式(正则表达式、全词匹配)，之后的查找、替换均按此模式匹配
+    void setSearchFlags(TextSearchEngine::SearchFlags flags);
+    TextSearchEngine::SearchFlags searchFlags() const;
 
     bool clearMarkOperationForCursor(QTextCursor cursor);
     bool clearMarksForTextCursor();
@@ -462,6 +477,15 @@ public:
      * 更新上次保存时的撤销回收栈的索引值
      */
     void updateSaveIndex();
+    /**
+     * @brief setSaveIndex 设置保存时的撤销回收栈索引值，用于后台保存完成时恢复保存时的状态
+     * @param index 撤销回收栈索引值，-1表示当前内容与保存的内容不一致
+     */
+    void setSaveIndex(int index);
+    /**
+     * @brief getUndoStack 取得撤销回收栈
+     */
+    QUndoStack *getUndoStack() const;
 
     static bool isComment(const QString &text, int index, const QString &commentType);
 
@@ -476,6 +500,8 @@ signals:
     void popupNotify(QString notify);
     void signal_readingPath();
     void signal_setTitleFocus();
+    // 全文查找结果或当前查找高亮的匹配项变更
+    void sigFindMatchChanged();
 public slots:
     /**
      * @author liumaochuan ut000616
@@ -486,6 +512,8 @@ public slots:
     void updateLeftAreaWidget();
     void handleScrollFinish();
     void setSyntaxDefinition(KSyntaxHighlighting::Definition def);
+    //语法高亮文本块后更新折叠区域标记
+    void updateSyntaxFoldRegions(int blockNumber, const QVector<int> &regions);
 
     void slot_translate();
 
@@ -581,7 +609,23 @@ private:
     //去除"*{*" "*}*" "*{*}*"跳过当做普通文本处理不折叠　梁卫东２０２０－０９－０１　１７：１６：４１
     bool blockContainStrBrackets(int line);
     bool setCursorKeywordSeletoin(int position, bool findNext);
+    //关键字全文查找结果是否可用
+    bool isSearchResultReady(const QString &keyword) const;
+    //关键字全文查找是否正在进行，进行中时查找结果为已完成的部分结果
+    bool isSearchResultPending(const QString &keyword) const;
+    //是否按正则表达式或全词匹配模式查找
+    bool isPatternSearch() const;
+    //按正则表达式或全词匹配模式从 position 开始查找，跳过长度为 0 的匹配项
+    QTextCursor findPatternCursor(const QRegularExpression &regex, int position, bool backward) const;
+    //按正则表达式或全词匹配模式替换 from 之后的所有匹配项，返回替换的匹配项数量
+    int replacePatternMatches(const QString &replaceText, const QString &withText, int from);
     void updateHighlightBrackets(const QChar &openChar, const QChar &closeChar);
+    //可见区域(向下延伸半屏)的文本位置范围
+    QPair<int, int> visibleTextRange();
+    //颜色标记的位置索引，标记列表变更后重建
+    const TextMarkIndex &wordMarkIndex();
+    //代码折叠区域索引，与文档文本块不对应时重建
+    const FoldRegionIndex &foldRegionIndex();
 
     bool getNeedControlLine(int line, bool isVisable);
     //触摸屏功能函数
@@ -604,12 +648,23 @@ private:
     // 计算颜色标记替换信息列表
     void calcMarkReplaceList(QList<TextEdit::MarkReplaceInfo> &replaceList, const QString &oldText,
                              const QString &replaceText, const QString &withText, int offset = 0) const;
+    // 计算颜色标记替换信息列表，各匹配项长度 lengths 及替换后长度 newLengths 可能不同
+    void calcMarkReplaceList(QList<TextEdit::MarkReplaceInfo> &replaceList, const QVector<int> &offsets,
+                             const QVector<int> &lengths, const QVector<int> &newLengths) const;
     // 查找行号line起始的折叠区域
     bool findFoldBlock(int line, QTextBlock &beginBlock, QTextBlock &endBlock, QTextBlock &curBlock);
+    // 语法折叠时高亮 block 起始的折叠区域内尚未高亮的文本块
+    void highlightFoldRegion(const QTextBlock &block);
+    // 括号折叠时文本块是否为注释行
+    bool isFoldCommentBlock(const QTextBlock &block);
 
 private slots:
     // 文档内容变更时触发
     void onTextContentChanged(int from, int charsRemoved, int charsAdded);
+    // 文档内容变更时更新代码折叠区域索引
+    void updateFoldRegionIndex(int from, int charsRemoved, int charsAdded);
+    // 全文查找结果(含部分结果)更新时重新构建可见区域的查找高亮
+    void onSearchResultChanged();
 
 public:
     int getFirstVisibleBlockId() const;
@@ -627,6 +682,7 @@ private:
     QPropertyAnimation *m_scrollAnimation {nullptr};
 
     QList<QTextEdit::ExtraSelection> m_findMatchSelections;///< “查找”的字符格式（所有查找的字符）
+    QString m_findMatchKeyword;///< 当前高亮所有匹配项的关键字，查找结果更新时按此关键字重新构建高亮
     QTextEdit::ExtraSelection m_beginBracketSelection;
     QTextEdit::ExtraSelection m_endBracketSelection;
     QTextEdit::ExtraSelection m_currentLineSelection;///< 光标所在当前行的样式
@@ -634,6 +690,9 @@ private:
     // 不再使用
     //QTextEdit::ExtraSelection m_wordUnderCursorSelection;
     QList<QPair<QTextEdit::ExtraSelection, qint64>> m_wordMarkSelections;///< 记录标记的列表（分行记录）
+    TextMarkIndex m_wordMarkIndex;      ///< 标记列表的位置索引，增删标记后需置为无效
+    bool m_hasHiddenSelections = false; ///< 上次渲染时是否存在可见区域外的装饰
+    FoldRegionIndex m_foldRegionIndex;  ///< 代码折叠区域索引，随文档内容变更增量更新
     QMap<int, QList<QTextEdit::ExtraSelection>> m_mapWordMarkSelections; ///< 记录标记的表（按标记动作记录）
     QList<QPair<TextEdit::MarkOperation, qint64>> m_markOperations;    ///记录所有标记操作(包括单个标记和全文标记)
     QMap<QString, QList<QPair<QTextEdit::ExtraSelection, qint64>>> m_mapKeywordMarkSelections; ///记录关键字对应的全文标记
@@ -650,7 +709,6 @@ private:
 
     int m_tabSpaceNumber = 4;
 
-    KSyntaxHighlighting::Repository m_repository;
     KSyntaxHighlighting::SyntaxHighlighter *m_highlighter = nullptr;
 
     DMenu *m_rightMenu;
@@ -851,6 +909,10 @@ private:
     //自定义撤销重做栈
     QUndoStack *m_pUndoStack = nullptr;
     int m_lastSaveIndex = 0;
+    //全文查找引擎
+    TextSearchEngine *m_pSearchEngine = nullptr;
+    //查找模式
+    TextSearchEngine::SearchFlags m_searchFlags = TextSearchEngine::ENoSearchFlags;
 
     //只读权限模式执行一次的判断变量  ut002764 2021.6.23
     bool m_Permission = false;
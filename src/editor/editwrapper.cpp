@@ -4,7 +4,15 @@
 
 #include "../widgets/window.h"
 #include "../encodes/detectcode.h"
+#include "../encodes/encodingdetector.h"
 #include "../common/fileloadthread.h"
+#include "../common/textfilewriter.h"
+#include "../common/filesavethread.h"
+#include "../common/backupjournal.h"
+#include "../common/backupworker.h"
+#include "../common/highlightrepository.h"
+#include "../common/piecetable.h"
+#include "largefileview.h"
 #include "../widgets/pathsettintwgt.h"
 #include "editwrapper.h"
 #include "../common/utils.h"
@@ -14,6 +22,7 @@
 #include <DSettingsOption>
 #include <DSettings>
 #include <unistd.h>
+#include <climits>
 #include <QCoreApplication>
 #include <QApplication>
 #include <QSaveFile>
@@ -86,9 +95,6 @@ EditWrapper::EditWrapper(Window *window, QWidget *parent)
       m_pWaringNotices(new WarningNotices(WarningNotices::ResidentType, this))
 
 {
-    // 更新单独添加的高亮格式文件
-    m_Repository.addCustomSearchPath(KF5_HIGHLIGHT_PATH);
-
     m_bQuit = false;
     m_pWaringNotices->hide();
     // Init layout and widgets.
@@ -107,6 +113,16 @@ EditWrapper::EditWrapper(Window *window, QWidget *parent)
     mainLayout->setSpacing(0);
     setLayout(mainLayout);
 
+    // 记录文档变更，用于增量备份
+    m_pBackupJournal = new BackupJournal(m_pTextEdit->document(), this);
+    connect(m_pTextEdit->document(), &QTextDocument::contentsChange, m_pBackupJournal, &BackupJournal::recordChange);
+    // 备份线程写入失败时，下次备份重新全量写入
+    connect(BackupWorker::instance(), &BackupWorker::sigBackupFinished, this, [this](const QString &basePath, bool success) {
+        if (!success && m_pBackupJournal->basePath() == basePath) {
+            m_pBackupJournal->invalidate();
+        }
+    });
+
     connect(m_pTextEdit, &TextEdit::cursorModeChanged, this, &EditWrapper::handleCursorModeChanged);
     connect(m_pWaringNotices, &WarningNotices::reloadBtnClicked, this, &EditWrapper::reloadModifyFile);
     connect(m_pWaringNotices, &WarningNotices::saveAsBtnClicked, m_pWindow, &Window::saveAsFile);
@@ -124,6 +140,14 @@ EditWrapper::EditWrapper(Window *window, QWidget *parent)
 
 EditWrapper::~EditWrapper()
 {
+    // 终止未完成的流式加载
+    if (m_pLoadThread) {
+        m_pLoadThread->cancel();
+    }
+    // 后台保存使用文档快照，等待写入完成，防止文件内容丢失
+    if (m_pSaveThread) {
+        m_pSaveThread->wait();
+    }
     if (m_pTextEdit != nullptr) {
         disconnect(m_pTextEdit);
         delete m_pTextEdit;
@@ -145,6 +169,9 @@ EditWrapper::~EditWrapper()
 void EditWrapper::setQuitFlag()
 {
     m_bQuit = true;
+    if (m_pLoadThread) {
+        m_pLoadThread->cancel();
+    }
 }
 
 bool EditWrapper::isQuit()
@@ -172,9 +199,14 @@ void EditWrapper::openFile(const QString &filepath, QString qstrTruePath, bool b
     }
 
     FileLoadThread *thread = new FileLoadThread(filepath);
+    m_pLoadThread = thread;
     // begin to load the file.
     connect(thread, &FileLoadThread::sigPreProcess, this, &EditWrapper::handleFilePreProcess);
     connect(thread, &FileLoadThread::sigLoadFinished, this, &EditWrapper::handleFileLoadFinished);
+    connect(thread, &FileLoadThread::sigStreamBegin, this, &EditWrapper::handleFileStreamBegin);
+    connect(thread, &FileLoadThread::sigStreamChunkReady, this, &EditWrapper::handleFileStreamChunkReady);
+    connect(thread, &FileLoadThread::sigStreamFinished, this, &EditWrapper::handleFileStreamFinished);
+    connect(thread, &FileLoadThread::sigPieceTableReady, this, &EditWrapper::handleFilePieceTableReady);
     connect(thread, &FileLoadThread::finished, thread, &FileLoadThread::deleteLater);
     thread->start();
 }
@@ -187,14 +219,22 @@ void EditWrapper::openFile(const QString &filepath, QString qstrTruePath, bool b
  */
 bool EditWrapper::readFile(QByteArray encode)
 {
+    // 只读视图仅支持 UTF-8 编码，重新读取时由加载线程判断是否继续使用只读视图
+    if (m_pLargeFileView) {
+        if (!encode.isEmpty() && encode != m_sCurEncode.toUtf8()) {
+            return false;
+        }
+        openFile(m_pTextEdit->getFilePath(), m_pTextEdit->getTruePath(), m_bIsTemFile);
+        return true;
+    }
+
     QFile file(m_pTextEdit->getTruePath());
     if (file.open(QIODevice::ReadOnly)) {
         QByteArray fileContent = file.readAll();
         QByteArray newEncode = encode;
         if (newEncode.isEmpty()) {
-            // 接口修改，补充文件头内容，最多读取1MB文件头数据
-            newEncode = DetectCode::GetFileEncodingFormat(
-                            m_pTextEdit->getFilePath(), fileContent.left(DATA_SIZE_1024 * DATA_SIZE_1024));
+            // 增量识别已读取的数据，最多使用1MB文件头数据
+            newEncode = EncodingDetector::detect(fileContent, DATA_SIZE_1024 * DATA_SIZE_1024);
             m_sFirstEncode = newEncode;
         }
 
@@ -217,10 +257,35 @@ bool EditWrapper::readFile(QByteArray encode)
  */
 bool EditWrapper::saveAsFile(const QString &newFilePath, const QByteArray &encodeName)
 {
+    // 等待未完成的后台保存，防止同时写入文件
+    waitForAsyncSave();
+
+    if (m_pLargeFileView) {
+        return saveLargeFile(newFilePath, encodeName);
+    }
+
     // WARNING: 对于超长文件，Qt在使用 QSaveFile 保存文件时，若当前环境不支持创建无名文件(UnnamedFile),
     // 会在相同路径创建临时文件，路径为保存文件名 + 唯一后缀，此临时文件名可能超过255长度限制，导致保存失败。
     // 因此，过长的文件名屏蔽使用QSaveFile。QTemporaryFile 创建文件名的代码地址：
     // link: https://github.com/qt/qtbase/blob/7191b8fe38788ac57e15e4124955c3cd8333d858/src/corelib/io/qtemporaryfile.cpp#L181
+    // 超大文档按文本块流式保存，过长的文件名由 TextFileWriter 同样处理
+    if (TextFileWriter::isStreamSaveRequired(m_pTextEdit->document())) {
+        bool openFailed = false;
+        bool ok = streamSaveFile(newFilePath, encodeName, openFailed);
+        if (openFailed) {
+            QWidget *curWidget = this->window()->getStackedWgt()->currentWidget();
+            if (curWidget) {
+                DMessageManager::instance()->sendMessage(curWidget, QIcon(":/images/warning.svg"),
+                                                         QString(tr("You do not have permission to save %1")).arg(newFilePath));
+            }
+            return false;
+        }
+
+        QFileInfo fi(filePath());
+        m_tModifiedDateTime = fi.lastModified();
+        return ok;
+    }
+
     const int limitFileNameLength = 245;
     QFileInfo fileNameInfo(newFilePath);
     bool disableSaveProtect = fileNameInfo.fileName().length() > limitFileNameLength;
@@ -306,6 +371,8 @@ bool EditWrapper::saveAsFile(const QString &newFilePath, const QByteArray &encod
 
 bool EditWrapper::saveAsFile()
 {
+    waitForAsyncSave();
+
     DFileDialog dialog(this, tr("Save"));
     dialog.setAcceptMode(QFileDialog::AcceptSave);
     dialog.addComboBox(QObject::tr("Encoding"),  QStringList() << m_sFirstEncode);
@@ -430,14 +497,21 @@ bool EditWrapper::reloadFileEncode(QByteArray encode)
  */
 void EditWrapper::reloadFileHighlight(QString definitionName)
 {
-    m_Definition = m_Repository.definitionForName(definitionName);
+    m_Definition = HighlightRepository::instance()->definitionForName(definitionName);
     if (m_Definition.isValid() && !m_Definition.filePath().isEmpty()) {
-        if (!m_pSyntaxHighlighter) m_pSyntaxHighlighter = new CSyntaxHighlighter(m_pTextEdit->document());
+        if (!m_pSyntaxHighlighter) {
+            m_pSyntaxHighlighter = new CSyntaxHighlighter(m_pTextEdit->document());
+            // 高亮文本块后更新代码折叠区域
+            connect(m_pSyntaxHighlighter, &CSyntaxHighlighter::sigBlockFoldingRegions, m_pTextEdit, &TextEdit::updateSyntaxFoldRegions);
+            // 空闲时分析高亮状态，以不准确状态高亮的文本块在分析到后重新高亮
+            m_pSyntaxHighlighter->setBackgroundHighlight(m_bBackgroundHighlight);
+            connect(m_pSyntaxHighlighter, &CSyntaxHighlighter::sigExactStatesReady, this, &EditWrapper::OnUpdateHighlighter);
+        }
         QString m_themePath = Settings::instance()->settings->option("advance.editor.theme")->value().toString();
         if (m_themePath.contains("dark")) {
-            m_pSyntaxHighlighter->setTheme(m_Repository.defaultTheme(KSyntaxHighlighting::Repository::DarkTheme));
+            m_pSyntaxHighlighter->setTheme(HighlightRepository::instance()->defaultTheme(KSyntaxHighlighting::Repository::DarkTheme));
         } else {
-            m_pSyntaxHighlighter->setTheme(m_Repository.defaultTheme(KSyntaxHighlighting::Repository::LightTheme));
+            m_pSyntaxHighlighter->setTheme(HighlightRepository::instance()->defaultTheme(KSyntaxHighlighting::Repository::LightTheme));
         }
         if (m_pSyntaxHighlighter) m_pSyntaxHighlighter->setDefinition(m_Definition);;
         m_pTextEdit->setSyntaxDefinition(m_Definition);
@@ -563,10 +637,55 @@ QString EditWrapper::getTextEncode()
  */
 bool EditWrapper::saveFile(QByteArray encode)
 {
+    // 等待未完成的后台保存，防止同时写入文件
+    waitForAsyncSave();
+
     QString qstrFilePath = m_pTextEdit->getTruePath();
     QFile file(qstrFilePath);
     hideWarningNotices();
 
+    // 只读视图的内容与打开的文件一致，编码未变更时无需重新写入
+    if (m_pLargeFileView) {
+        const QString saveEncode = encode.isEmpty() ? m_sCurEncode : QString(encode);
+        bool ok = true;
+        if (m_bIsTemFile || saveEncode != m_sFirstEncode) {
+            ok = saveLargeFile(qstrFilePath, saveEncode);
+        }
+        if (ok) {
+            m_sCurEncode = saveEncode;
+            m_sFirstEncode = saveEncode;
+            m_pBottomBar->setEncodeName(saveEncode);
+            m_bIsTemFile = false;
+            updateModifyStatus(false);
+        }
+        return ok;
+    }
+
+    // 超大文档按文本块流式保存，无需构造完整的文件数据
+    if (TextFileWriter::isStreamSaveRequired(m_pTextEdit->document())) {
+        bool openFailed = false;
+        bool ok = streamSaveFile(qstrFilePath, encode.isEmpty() ? m_sCurEncode : QString(encode), openFailed);
+        if (openFailed) {
+            DMessageManager::instance()->sendMessage(this->window()->getStackedWgt()->currentWidget(), QIcon(":/images/warning.svg")
+                                                     , QString(tr("You do not have permission to save %1")).arg(qstrFilePath));
+            return false;
+        }
+
+        if (!encode.isEmpty()) {
+            m_sCurEncode = encode;
+            // 更新底栏编码格式
+            m_pBottomBar->setEncodeName(encode);
+        }
+        m_sFirstEncode = m_sCurEncode;
+
+        QFileInfo fi(qstrFilePath);
+        m_tModifiedDateTime = fi.lastModified();
+
+        if (ok)  updateModifyStatus(false);
+        m_bIsTemFile = false;
+        return ok;
+    }
+
     if (file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
         QByteArray fileContent;
         getPlainTextContent(fileContent);
@@ -682,6 +801,177 @@ void EditWrapper::getPlainTextContent(QByteArray &plainTextContent)
     }
 }
 
+/**
+ * @brief 按文本块流式转换换行符及编码，并原子保存文档到文件 \a filePath ，用于超大文档，
+ *      峰值内存与数据块大小相关，写入失败时原文件内容不变
+ * @param filePath      保存的文件路径
+ * @param encode        文件编码
+ * @param openFailed    返回文件是否打开失败(无权限等)
+ * @return 是否保存成功
+ */
+bool EditWrapper::streamSaveFile(const QString &filePath, const QString &encode, bool &openFailed)
+{
+    const bool windowsEndline = BottomBar::EndlineFormat::Windows == m_pBottomBar->getEndlineFormat();
+    TextFileWriter writer(m_pTextEdit->document(), encode, windowsEndline);
+    bool ok = writer.save(filePath);
+    openFailed = TextFileWriter::OpenError == writer.error();
+    if (!ok) {
+        qWarning() << Q_FUNC_INFO << "Stream save file error, " << writer.errorString();
+    }
+    return ok;
+}
+
+/**
+ * @brief 将只读视图的片段表按编码 \a encode 原子保存到文件 \a filePath ，数据按片段流式写入，
+ *      不会将文件读入内存
+ * @return 是否保存成功
+ */
+bool EditWrapper::saveLargeFile(const QString &filePath, const QString &encode)
+{
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    bool openFailed = false;
+    bool ok = m_pLargeFileView->pieceTable()->saveToFile(filePath, encode, &openFailed);
+    QApplication::restoreOverrideCursor();
+
+    if (!ok) {
+        qWarning() << Q_FUNC_INFO << "Save large file error, " << filePath << encode;
+        QWidget *curWidget = this->window()->getStackedWgt()->currentWidget();
+        if (curWidget) {
+            const QString message = openFailed ? tr("You do not have permission to save %1") : tr("Failed to save %1");
+            DMessageManager::instance()->sendMessage(curWidget, QIcon(":/images/warning.svg"), message.arg(filePath));
+        }
+        return false;
+    }
+
+    m_tModifiedDateTime = QFileInfo(m_pTextEdit->getTruePath()).lastModified();
+    return true;
+}
+
+/**
+ * @brief 超大文档保存时编码转换及写入耗时较长，使用后台线程保存
+ */
+bool EditWrapper::isAsyncSaveRequired()
+{
+    return TextFileWriter::isStreamSaveRequired(m_pTextEdit->document());
+}
+
+/**
+ * @brief 在后台线程保存文件。界面线程仅取得文档内容快照，编码转换及写入在后台线程中执行，
+ *      保存期间可继续编辑，保存完成时根据撤销栈索引判断保存后的修改状态。
+ * @param temPath 保存前的文件路径(备份文件路径)，随 sigAsyncSaveFinished() 返回
+ * @return 是否开始保存，已有未完成的后台保存时记录重新保存请求，在当前保存完成后保存，返回 false
+ */
+bool EditWrapper::saveFileAsync(const QString &temPath)
+{
+    if (isAsyncSaving()) {
+        m_bAsyncResavePending = true;
+        return false;
+    }
+    hideWarningNotices();
+
+    const bool windowsEndline = BottomBar::EndlineFormat::Windows == m_pBottomBar->getEndlineFormat();
+    FileSaveThread *thread = new FileSaveThread(m_pTextEdit->getTruePath(), TextFileWriter::snapshot(m_pTextEdit->document()),
+                                                m_sCurEncode, windowsEndline);
+    m_pSaveThread = thread;
+    m_sAsyncSaveTemPath = temPath;
+
+    // 记录快照对应的撤销栈索引，保存期间撤销到快照之前的状态时，快照对应的撤销记录可能被替换
+    QUndoStack *undoStack = m_pTextEdit->getUndoStack();
+    m_nAsyncSaveIndex = undoStack->index();
+    m_nAsyncSaveMinIndex = m_nAsyncSaveIndex;
+    m_asyncSaveIndexConnection = connect(undoStack, &QUndoStack::indexChanged, this, [this](int index) {
+        m_nAsyncSaveMinIndex = qMin(m_nAsyncSaveMinIndex, index);
+    });
+
+    connect(thread, &FileSaveThread::sigSaveProgress, this, &EditWrapper::handleFileSaveProgress);
+    connect(thread, &FileSaveThread::sigSaveFinished, this, &EditWrapper::handleFileSaveFinished);
+    connect(thread, &FileSaveThread::finished, thread, &FileSaveThread::deleteLater);
+
+    m_pBottomBar->setProgressText(tr("Saving:"));
+    m_pBottomBar->setProgress(0);
+    thread->start();
+    return true;
+}
+
+bool EditWrapper::isAsyncSaving() const
+{
+    return !m_pSaveThread.isNull();
+}
+
+/**
+ * @brief 等待后台保存完成，并处理保存结果。等待期间不再执行排队的重新保存，由调用方写入文件
+ * @return 等待的后台保存是否成功，无后台保存时返回 true
+ */
+bool EditWrapper::waitForAsyncSave()
+{
+    if (m_pSaveThread) {
+        m_bAsyncResavePending = false;
+        m_pSaveThread->wait();
+        // 处理队列中的保存完成信号
+        QCoreApplication::sendPostedEvents(this, QEvent::MetaCall);
+        return m_bLastAsyncSaveSucceeded;
+    }
+    return true;
+}
+
+void EditWrapper::handleFileSaveProgress(int progress)
+{
+    // 进度达到100时进度条隐藏，在保存完成时处理
+    m_pBottomBar->setProgress(qMin(progress, 99));
+}
+
+/**
+ * @brief 后台保存完成，保存期间未修改文档时取消修改状态；
+ *      否则设置保存时的撤销栈索引，撤销到保存时的状态时可取消修改状态
+ * @param success       是否保存成功
+ * @param openFailed    文件是否打开失败
+ * @param errorString   错误信息
+ */
+void EditWrapper::handleFileSaveFinished(bool success, bool openFailed, const QString &errorString)
+{
+    QString filePath = m_pSaveThread ? m_pSaveThread->filePath() : m_pTextEdit->getTruePath();
+    m_pSaveThread = nullptr;
+    disconnect(m_asyncSaveIndexConnection);
+
+    m_pBottomBar->setProgress(100);
+    m_pBottomBar->setProgressText(tr("Loading:"));
+    m_bLastAsyncSaveSucceeded = success && !openFailed;
+
+    if (!m_bLastAsyncSaveSucceeded) {
+        // 保存失败时提示用户，避免误认为已保存而关闭标签页，仅文件打开失败时提示无权限
+        qWarning() << Q_FUNC_INFO << "Async save file error, " << errorString;
+        m_bAsyncResavePending = false;
+        const QString message = openFailed ? tr("You do not have permission to save %1") : tr("Failed to save %1");
+        DMessageManager::instance()->sendMessage(this->window()->getStackedWgt()->currentWidget(), QIcon(":/images/warning.svg")
+                                                 , message.arg(filePath));
+        emit sigAsyncSaveFinished(false, m_sAsyncSaveTemPath, filePath);
+        return;
+    }
+
+    m_sFirstEncode = m_sCurEncode;
+    QFileInfo fi(filePath);
+    m_tModifiedDateTime = fi.lastModified();
+    m_bIsTemFile = false;
+    // 撤销栈未低于快照索引时，快照对应的撤销记录未被替换
+    const bool snapshotValid = m_nAsyncSaveMinIndex >= m_nAsyncSaveIndex;
+    if (snapshotValid && m_pTextEdit->getUndoStack()->index() == m_nAsyncSaveIndex) {
+        updateModifyStatus(false);
+    } else {
+        m_pTextEdit->setSaveIndex(snapshotValid ? m_nAsyncSaveIndex : -1);
+        updateModifyStatus(true);
+    }
+
+    emit sigAsyncSaveFinished(true, m_sAsyncSaveTemPath, filePath);
+
+    // 保存期间再次请求保存，使用当前内容重新保存，备份文件已在保存完成时处理
+    if (m_bAsyncResavePending) {
+        m_bAsyncResavePending = false;
+        if (isModified()) {
+            saveFileAsync(filePath);
+        }
+    }
+}
+
 /**
  * @brief saveTemFile 保存备份文件
  * @param qstrDir　备份文件路径
@@ -689,6 +979,32 @@ void EditWrapper::getPlainTextContent(QByteArray &plainTextContent)
  */
 bool EditWrapper::saveTemFile(QString qstrDir)
 {
+    waitForAsyncSave();
+    // 等待备份线程中未完成的写入，全量写入后原有的增量备份日志不再适用
+    BackupWorker::instance()->waitForIdle();
+    m_pBackupJournal->discard(qstrDir);
+
+    // 只读视图的内容不变，备份文件即打开的文件时无需重复写入
+    if (m_pLargeFileView) {
+        return qstrDir == m_pTextEdit->getFilePath() || m_pLargeFileView->pieceTable()->saveToFile(qstrDir, m_sCurEncode);
+    }
+
+    // 超大文档按文本块流式保存
+    if (TextFileWriter::isStreamSaveRequired(m_pTextEdit->document())) {
+        bool openFailed = false;
+        bool ok = streamSaveFile(qstrDir, m_sCurEncode, openFailed);
+        if (openFailed) {
+            return false;
+        }
+        m_sFirstEncode = m_sCurEncode;
+
+        // update status.
+        if (ok) {
+            updateModifyStatus(isModified());
+        }
+        return ok;
+    }
+
     QFile file(qstrDir);
 
     if (file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
@@ -733,6 +1049,60 @@ bool EditWrapper::saveTemFile(QString qstrDir)
 }
 }
 
+/**
+ * @brief 增量保存备份文件。界面线程仅取得变更区域的文本(或全量备份时的文档快照)，
+ *      编码转换及文件写入由备份线程执行。备份文件已全量写入且日志有效时，仅将上次备份后的变更追加到日志；
+ *      首次备份、编码或换行符变更、日志过大时全量写入备份文件并重新开始记录。
+ * @param qstrDir 备份文件路径
+ * @return 是否添加了备份任务
+ */
+bool EditWrapper::saveTemFileIncremental(const QString &qstrDir)
+{
+    // 后台保存期间不等待，避免定时备份阻塞界面，下次备份时再写入
+    if (isAsyncSaving()) {
+        return false;
+    }
+    // 只读视图没有文档变更，按全量备份处理
+    if (m_pLargeFileView) {
+        return saveTemFile(qstrDir);
+    }
+
+    const bool windowsEndline = BottomBar::EndlineFormat::Windows == m_pBottomBar->getEndlineFormat();
+
+    BackupWorker::Task task;
+    task.basePath = qstrDir;
+    task.encode = m_sCurEncode;
+    task.windowsEndline = windowsEndline;
+    if (m_pBackupJournal->canAppend(qstrDir, m_sCurEncode, windowsEndline)) {
+        if (!m_pBackupJournal->hasPendingChanges()) {
+            return true;
+        }
+        task.type = BackupWorker::JournalAppend;
+        task.records = m_pBackupJournal->takeRecords();
+    } else {
+        task.type = BackupWorker::FullBackup;
+        task.snapshot = TextFileWriter::snapshot(m_pTextEdit->document());
+        m_pBackupJournal->checkpoint(qstrDir, m_sCurEncode, windowsEndline);
+    }
+    task.length = m_pBackupJournal->length();
+    BackupWorker::instance()->enqueue(task);
+
+    m_sFirstEncode = m_sCurEncode;
+    updateModifyStatus(isModified());
+    return true;
+}
+
+/**
+ * @brief 删除备份文件 \a qstrDir 。先取消备份线程中未执行的同一文件的任务，避免删除后被重新写入；
+ *      同时删除隐藏的增量备份日志，记录的变更不再适用，下次备份时全量写入
+ */
+void EditWrapper::removeTemFile(const QString &qstrDir)
+{
+    BackupWorker::instance()->cancel(qstrDir);
+    m_pBackupJournal->discard(qstrDir);
+    QFile::remove(qstrDir);
+}
+
 void EditWrapper::updatePath(const QString &file, QString qstrTruePath)
 {
     if (qstrTruePath.isEmpty()) {
@@ -770,6 +1140,9 @@ bool EditWrapper::isBackupFile()
 
 bool EditWrapper::isPlainTextEmpty()
 {
+    if (m_pLargeFileView) {
+        return 0 == m_pLargeFileView->pieceTable()->length();
+    }
     return m_pTextEdit->document()->isEmpty();
 }
 
@@ -786,6 +1159,8 @@ bool EditWrapper::isTemFile()
  */
 bool EditWrapper::saveDraftFile(QString &newFilePath)
 {
+    waitForAsyncSave();
+
     DFileDialog dialog(this, tr("Save"));
     dialog.setAcceptMode(QFileDialog::AcceptSave);
     dialog.setDirectory(QDir::homePath());
@@ -814,18 +1189,24 @@ bool EditWrapper::saveDraftFile(QString &newFilePath)
         if (newFilePath.isEmpty())
             return false;
 
-        QFile qfile(newFilePath);
+        if (m_pLargeFileView) {
+            if (!saveLargeFile(newFilePath, encode)) {
+                return false;
+            }
+        } else {
+            QFile qfile(newFilePath);
 
-        if (!qfile.open(QFile::WriteOnly)) {
-            return false;
-        }
+            if (!qfile.open(QFile::WriteOnly)) {
+                return false;
+            }
 
-        // 以新的编码保存内容到文件
-        QByteArray inputData = m_pTextEdit->toPlainText().toUtf8();
-        QByteArray outData;
-        DetectCode::ChangeFileEncodingFormat(inputData, outData, QString("UTF-8"), encode);
-        qfile.write(outData);
-        qfile.close();
+            // 以新的编码保存内容到文件
+            QByteArray inputData = m_pTextEdit->toPlainText().toUtf8();
+            QByteArray outData;
+            DetectCode::ChangeFileEncodingFormat(inputData, outData, QString("UTF-8"), encode);
+            qfile.write(outData);
+            qfile.close();
+        }
 
         //草稿文件保存 等同于重写打开
         m_sFirstEncode = m_sCurEncode;
@@ -860,18 +1241,21 @@ void EditWrapper::checkForReload()
             return;
         }
 
+        // 使用只读视图时提示显示在只读视图上
+        QWidget *messageParent = m_pLargeFileView ? static_cast<QWidget *>(m_pLargeFileView) : m_pTextEdit;
+
         QFileInfo finfo(m_pTextEdit->getTruePath());
 
         if (!finfo.exists()) {
             m_pWaringNotices->setMessage(tr("File removed on the disk. Save it now?"));
             m_pWaringNotices->setSaveAsBtn();
             m_pWaringNotices->show();
-            DMessageManager::instance()->sendMessage(m_pTextEdit, m_pWaringNotices);
+            DMessageManager::instance()->sendMessage(messageParent, m_pWaringNotices);
         } else if (!m_tModifiedDateTime.toString().isEmpty() && finfo.lastModified().toString() != m_tModifiedDateTime.toString()) {
             m_pWaringNotices->setMessage(tr("File has changed on disk. Reload?"));
             m_pWaringNotices->setReloadBtn();
             m_pWaringNotices->show();
-            DMessageManager::instance()->sendMessage(m_pTextEdit, m_pWaringNotices);
+            DMessageManager::instance()->sendMessage(messageParent, m_pWaringNotices);
         }
     });
 }
@@ -918,6 +1302,8 @@ void EditWrapper::handleCursorModeChanged(TextEdit::CursorMode mode)
  */
 void EditWrapper::handleFilePreProcess(const QByteArray &encode, const QByteArray &content)
 {
+    // 重新读取的文件不再使用只读视图
+    hideLargeFileView();
     // 重新加载处理
     reinitOnFileLoad(encode);
     // 已进行预处理标识
@@ -952,6 +1338,7 @@ void EditWrapper::handleFilePreProcess(const QByteArray &encode, const QByteArra
  */
 void EditWrapper::handleFileLoadFinished(const QByteArray &encode, const QByteArray &content, bool error)
 {
+    hideLargeFileView();
     // 判断是否预加载，若已预加载，则无需重新初始化
     if (!m_bHasPreProcess) {
         reinitOnFileLoad(encode);
@@ -992,6 +1379,228 @@ void EditWrapper::handleFileLoadFinished(const QByteArray &encode, const QByteAr
         m_pTextEdit->clear();
     }
 
+    finishFileLoad(error);
+}
+
+/**
+ * @brief 处理大文件流式加载开始，初始化界面状态，后续数据块将依次追加到文档末尾
+ * @param encode    文件编码
+ */
+void EditWrapper::handleFileStreamBegin(const QByteArray &encode)
+{
+    hideLargeFileView();
+    reinitOnFileLoad(encode);
+    m_bHasPreProcess = true;
+    m_bFileLoading = true;
+
+    if (m_pBottomBar != nullptr) {
+        m_pBottomBar->setChildEnabled(false);
+    }
+    if (m_pWindow != nullptr) {
+        m_pWindow->setPrintEnabled(false);
+    }
+
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    m_pTextEdit->clear();
+    m_pTextEdit->setReadOnly(true);
+    m_pTextEdit->setLeftAreaUpdateState(TextEdit::FileOpenBegin);
+
+    //备份显示修改状态
+    if (m_bIsTemFile) {
+        updateModifyStatus(true);
+    }
+
+    m_streamCursor = m_pTextEdit->textCursor();
+    m_streamCursor.movePosition(QTextCursor::End, QTextCursor::MoveAnchor);
+}
+
+/**
+ * @brief 处理流式加载的单个数据块，从加载线程的插入队列中取出已解码的文本并追加到文档末尾
+ * @param totalSize 文件总长度
+ */
+void EditWrapper::handleFileStreamChunkReady(qint64 totalSize)
+{
+    // 中途退出则通知加载线程停止
+    if (m_bQuit) {
+        if (m_pLoadThread) {
+            m_pLoadThread->cancel();
+        }
+        return;
+    }
+
+    FileLoadThread::StreamChunk chunk;
+    if (!m_pLoadThread || !m_pLoadThread->takeChunk(chunk)) {
+        return;
+    }
+
+    bool firstChunk = m_streamCursor.atStart();
+    m_streamCursor.insertText(chunk.text);
+
+    // 当前为首次读取
+    if (firstChunk) {
+        QTextCursor firstLineCursor = m_pTextEdit->textCursor();
+        firstLineCursor.movePosition(QTextCursor::Start, QTextCursor::MoveAnchor);
+        m_pTextEdit->setTextCursor(firstLineCursor);
+        //秒开界面语法高亮
+        OnUpdateHighlighter();
+        if (m_pBottomBar != nullptr) {
+            m_pBottomBar->setEndlineMenuText(BottomBar::getEndlineFormat(chunk.text.toUtf8()));
+        }
+    }
+
+    if (m_pBottomBar != nullptr && totalSize > 0) {
+        m_pBottomBar->setProgress(static_cast<int>(chunk.readSize * 100.0 / totalSize));
+    }
+}
+
+/**
+ * @brief 处理流式加载完成，恢复界面状态
+ * @param encode    文件编码
+ * @param error     是否读取失败
+ */
+void EditWrapper::handleFileStreamFinished(const QByteArray &encode, bool error)
+{
+    Q_UNUSED(encode)
+    // 插入队列中剩余的数据块
+    FileLoadThread::StreamChunk chunk;
+    while (!m_bQuit && !error && m_pLoadThread && m_pLoadThread->takeChunk(chunk)) {
+        m_streamCursor.insertText(chunk.text);
+    }
+    m_streamCursor = QTextCursor();
+
+    if (m_pWindow != nullptr) {
+        m_pWindow->setPrintEnabled(true);
+    }
+    if (m_pBottomBar != nullptr) {
+        m_pBottomBar->setChildEnabled(true);
+    }
+    // 加载时临时设置为只读，完成后按文件权限恢复
+    m_pTextEdit->setReadOnly(m_pTextEdit->getReadOnlyPermission());
+    m_pTextEdit->setLeftAreaUpdateState(TextEdit::FileOpenEnd);
+    QApplication::restoreOverrideCursor();
+    m_bFileLoading = false;
+
+    if (m_bQuit) {
+        return;
+    }
+
+    if (error) {
+        // 清除之前读取的数据
+        m_pTextEdit->clear();
+    }
+
+    finishFileLoad(error);
+}
+
+/**
+ * @brief 处理超大文件以片段表只读映射完成，文件数据不加载到文档，使用只读视图显示
+ * @param encode    文件编码
+ */
+void EditWrapper::handleFilePieceTableReady(const QByteArray &encode)
+{
+    PieceTable *table = m_pLoadThread ? m_pLoadThread->takePieceTable() : nullptr;
+    if (!table) {
+        return;
+    }
+    if (m_bQuit) {
+        delete table;
+        return;
+    }
+
+    reinitOnFileLoad(encode);
+    m_pTextEdit->clear();
+    showLargeFileView(table);
+
+    //备份显示修改状态
+    if (m_bIsTemFile) {
+        updateModifyStatus(true);
+    }
+
+    m_pBottomBar->setEncodeName(m_sCurEncode);
+    m_bFileLoaded = true;
+    emit sigFileLoadFinished();
+}
+
+/**
+ * @brief 使用只读视图显示片段表 \a table ，隐藏编辑器。编辑器保留文件路径等信息，
+ *      焦点代理到只读视图
+ */
+void EditWrapper::showLargeFileView(PieceTable *table)
+{
+    if (!m_pLargeFileView) {
+        m_pLargeFileView = new LargeFileView(this);
+        QVBoxLayout *mainLayout = qobject_cast<QVBoxLayout *>(layout());
+        if (mainLayout) {
+            mainLayout->insertWidget(0, m_pLargeFileView);
+        }
+
+        connect(m_pLargeFileView, &LargeFileView::sigCurrentLineChanged, this, [this](qint64 line) {
+            m_pBottomBar->updatePosition(static_cast<int>(qMin<qint64>(line + 1, INT_MAX)), 1);
+        });
+        m_pTextEdit->installEventFilter(this);
+    }
+
+    m_pLargeFileView->setFont(m_pTextEdit->font());
+    m_pLargeFileView->setTabSpaceNumber(Settings::instance()->settings->option("advance.editor.tabspacenumber")->value().toInt());
+    m_pLargeFileView->setTheme(Settings::instance()->settings->option("advance.editor.theme")->value().toString());
+    m_pLargeFileView->setPieceTable(table);
+
+    m_pLeftAreaTextEdit->hide();
+    m_pTextEdit->hide();
+    m_pTextEdit->setFocusProxy(m_pLargeFileView);
+    m_pLargeFileView->show();
+
+    // 只读视图不支持切换编码、换行符及高亮
+    m_pBottomBar->setChildEnabled(false);
+    m_pBottomBar->setCursorStatus(tr("R/O"));
+}
+
+/**
+ * @brief 移除只读视图并恢复编辑器显示，用于重新读取的文件不再满足只读视图条件时
+ */
+void EditWrapper::hideLargeFileView()
+{
+    if (!m_pLargeFileView) {
+        return;
+    }
+
+    m_pTextEdit->removeEventFilter(this);
+    m_pTextEdit->setFocusProxy(nullptr);
+    delete m_pLargeFileView;
+    m_pLargeFileView = nullptr;
+
+    m_pLeftAreaTextEdit->show();
+    m_pTextEdit->show();
+    m_pBottomBar->setChildEnabled(true);
+    handleCursorModeChanged(m_pTextEdit->getReadOnlyMode() ? TextEdit::Readonly : TextEdit::Insert);
+}
+
+bool EditWrapper::isLargeFileView() const
+{
+    return nullptr != m_pLargeFileView;
+}
+
+LargeFileView *EditWrapper::largeFileView() const
+{
+    return m_pLargeFileView;
+}
+
+bool EditWrapper::eventFilter(QObject *watched, QEvent *event)
+{
+    // 编辑器字体(字体、字号、缩放)变更时同步到只读视图
+    if (m_pLargeFileView && watched == m_pTextEdit && QEvent::FontChange == event->type()) {
+        m_pLargeFileView->setFont(m_pTextEdit->font());
+    }
+
+    return QWidget::eventFilter(watched, event);
+}
+
+/**
+ * @brief 文件数据加载完成后，恢复上次浏览的光标位置并刷新高亮、编码及错误提示
+ * @param error 是否读取失败
+ */
+void EditWrapper::finishFileLoad(bool error)
+{
     m_pTextEdit->setTextFinished();
 
     QStringList temFileList = Settings::instance()->settings->option("advance.editor.browsing_history_temfile")->value().toStringList();
@@ -1052,6 +1661,14 @@ void EditWrapper::handleFileLoadFinished(const QByteArray &encode, const QByteAr
         m_pWaringNotices->show();
         DMessageManager::instance()->sendMessage(m_pTextEdit, m_pWaringNotices);
     }
+
+    m_bFileLoaded = true;
+    emit sigFileLoadFinished();
+}
+
+bool EditWrapper::isFileLoaded() const
+{
+    return m_bFileLoaded;
 }
 
 
@@ -1070,14 +1687,17 @@ void EditWrapper::OnThemeChangeSlot(QString theme)
     //设置编辑器
     if (m_pSyntaxHighlighter) {
         if (QColor(backgroundColor).lightness() < 128) {
-            m_pSyntaxHighlighter->setTheme(m_Repository.defaultTheme(KSyntaxHighlighting::Repository::DarkTheme));
+            m_pSyntaxHighlighter->setTheme(HighlightRepository::instance()->defaultTheme(KSyntaxHighlighting::Repository::DarkTheme));
         } else {
-            m_pSyntaxHighlighter->setTheme(m_Repository.defaultTheme(KSyntaxHighlighting::Repository::LightTheme));
+            m_pSyntaxHighlighter->setTheme(HighlightRepository::instance()->defaultTheme(KSyntaxHighlighting::Repository::LightTheme));
         }
         m_pSyntaxHighlighter->rehighlight();
     }
 
     m_pTextEdit->setTheme(theme);
+    if (m_pLargeFileView) {
+        m_pLargeFileView->setTheme(theme);
+    }
 }
 
 void EditWrapper::UpdateBottomBarWordCnt(int cnt)
@@ -1105,8 +1725,9 @@ void EditWrapper::OnUpdateHighlighter()
             endBlock = m_pTextEdit->document()->lastBlock();
         }
 
-        // 判断当前文件是否支持高亮处理
-        if (m_pSyntaxHighlighter->definition().isValid()) {
+        // 判断当前文件是否支持高亮处理，起始文本块状态已由状态缓存取得时无需向上查找
+        if (m_pSyntaxHighlighter->definition().isValid()
+                && !m_pSyntaxHighlighter->hasExactState(beginBlock.blockNumber())) {
             // NOTE: 同样需要考虑极限条件下遍历全部文本的情况
             // 限制最多向上查找512个文本块
             static int s_MaxFindCount = 512;
@@ -1253,6 +1874,18 @@ void EditWrapper::setLineNumberShow(bool bIsShow, bool bIsFirstShow)
     m_pTextEdit->updateLeftAreaWidget();
 }
 
+/**
+ * @brief 设置是否在空闲时分析高亮状态 \a enable 。后台分析仅对当前标签页启用，
+ *      避免打开多个文件时各标签页同时占用主线程空闲时间。
+ */
+void EditWrapper::setBackgroundHighlight(bool enable)
+{
+    m_bBackgroundHighlight = enable;
+    if (m_pSyntaxHighlighter) {
+        m_pSyntaxHighlighter->setBackgroundHighlight(enable);
+    }
+}
+
 //显示空白符
 void EditWrapper::setShowBlankCharacter(bool ok)
 {
@@ -1472,14 +2105,21 @@ void EditWrapper::loadContent(const QByteArray &strContent)
  */
 void EditWrapper::reinitOnFileLoad(const QByteArray &encode)
 {
-    m_Definition = m_Repository.definitionForFileName(m_pTextEdit->getFilePath());
+    m_Definition = HighlightRepository::instance()->definitionForFileName(m_pTextEdit->getFilePath());
     if (m_Definition.isValid() && !m_Definition.filePath().isEmpty()) {
-        if (!m_pSyntaxHighlighter) m_pSyntaxHighlighter = new CSyntaxHighlighter(m_pTextEdit->document());
+        if (!m_pSyntaxHighlighter) {
+            m_pSyntaxHighlighter = new CSyntaxHighlighter(m_pTextEdit->document());
+            // 高亮文本块后更新代码折叠区域
+            connect(m_pSyntaxHighlighter, &CSyntaxHighlighter::sigBlockFoldingRegions, m_pTextEdit, &TextEdit::updateSyntaxFoldRegions);
+            // 空闲时分析高亮状态，以不准确状态高亮的文本块在分析到后重新高亮
+            m_pSyntaxHighlighter->setBackgroundHighlight(m_bBackgroundHighlight);
+            connect(m_pSyntaxHighlighter, &CSyntaxHighlighter::sigExactStatesReady, this, &EditWrapper::OnUpdateHighlighter);
+        }
         QString m_themePath = Settings::instance()->settings->option("advance.editor.theme")->value().toString();
         if (m_themePath.contains("dark")) {
-            m_pSyntaxHighlighter->setTheme(m_Repository.defaultTheme(KSyntaxHighlighting::Repository::DarkTheme));
+            m_pSyntaxHighlighter->setTheme(HighlightRepository::instance()->defaultTheme(KSyntaxHighlighting::Repository::DarkTheme));
         } else {
-            m_pSyntaxHighlighter->setTheme(m_Repository.defaultTheme(KSyntaxHighlighting::Repository::LightTheme));
+            m_pSyntaxHighlighter->setTheme(HighlightRepository::instance()->defaultTheme(KSyntaxHighlighting::Repository::LightTheme));
         }
 
         if (m_pSyntaxHighlighter) m_pSyntaxHighlighter->setDefinition(m_Definition);
@@ -17,6 +17,7 @@
 #include <DFloatingMessage>
 #include <QByteArray>
 #include <QTextCodec>
+#include <QPointer>
 #include <DDialog>
 #include <DMessageBox>
 #include <DFileDialog>
@@ -26,6 +27,11 @@
 #include <KSyntaxHighlighting/Theme>
 
 class Window;
+class FileLoadThread;
+class FileSaveThread;
+class BackupJournal;
+class PieceTable;
+class LargeFileView;
 class EditWrapper : public QWidget
 {
     Q_OBJECT
@@ -44,6 +50,12 @@ public:
     void setQuitFlag();
     bool isQuit();
     bool getFileLoading();
+    // 文件内容是否已加载完成
+    bool isFileLoaded() const;
+    // 是否使用超大文件只读视图显示文件
+    bool isLargeFileView() const;
+    // 超大文件只读视图，未使用时返回 nullptr
+    LargeFileView *largeFileView() const;
 
     /**
      * @brief openFile 打开文件
@@ -56,6 +68,15 @@ public:
     bool readFile(QByteArray encode = "");
     // 按编码 encode 保存文件
     bool saveFile(QByteArray encode = "");
+    // 超大文档是否使用后台线程保存
+    bool isAsyncSaveRequired();
+    // 在后台线程保存文件，temPath 为保存前的文件路径(备份文件路径)，保存完成后发送 sigAsyncSaveFinished()
+    // 正在保存时记录重新保存请求并返回 false
+    bool saveFileAsync(const QString &temPath);
+    // 是否正在后台保存文件
+    bool isAsyncSaving() const;
+    // 等待后台保存完成，返回等待的保存是否成功
+    bool waitForAsyncSave();
     /**
      * @brief getPlainTextContent 获取文本框里的文本内容
      * @param plainTextConteng 存放获取到的内容
@@ -78,6 +99,10 @@ public:
 
     // 保存备份文件
     bool saveTemFile(QString qstrDir);
+    // 增量保存备份文件，仅将上次备份后的变更追加到日志，必要时全量保存，文件由备份线程写入
+    bool saveTemFileIncremental(const QString &qstrDir);
+    // 删除备份文件及其增量备份日志，取消备份线程中未执行的同一文件的任务
+    void removeTemFile(const QString &qstrDir);
     //更新路径
     void updatePath(const QString &file, QString qstrTruePath = QString());
     //判断是否修改
@@ -107,6 +132,8 @@ public:
     TextEdit *textEditor();
     Window *window();
     void updateHighlighterAll();
+    // 设置是否在空闲时分析高亮状态，仅当前标签页启用
+    void setBackgroundHighlight(bool enable);
 
     //get and set m_tModifiedDateTime
     QDateTime getLastModifiedTime() const;
@@ -121,10 +148,16 @@ public:
 
 signals:
     void sigClearDoubleCharaterEncode();
+    // 后台保存完成
+    void sigAsyncSaveFinished(bool success, const QString &temPath, const QString &filePath);
+    // 文件内容加载完成
+    void sigFileLoadFinished();
 
 protected:
     // 处理文件加载事件
     virtual void customEvent(QEvent *e) override;
+    // 同步编辑器字体到超大文件只读视图
+    bool eventFilter(QObject *watched, QEvent *event) override;
 
 private:
     // 类似setPlainText(QString) 接口支持大文本加载 不卡顿 秒退出 梁卫东 2020年11月11日16:56:27
@@ -133,11 +166,30 @@ private:
     int GetCorrectUnicode1(const QByteArray &ba);
     // 文件加载时重新初始化部分设置
     void reinitOnFileLoad(const QByteArray &encode);
+    // 文件数据加载完成后恢复光标位置、高亮及提示信息
+    void finishFileLoad(bool error);
+    // 超大文档按文本块流式保存到文件
+    bool streamSaveFile(const QString &filePath, const QString &encode, bool &openFailed);
+    // 使用超大文件只读视图显示片段表 table ，取得所有权
+    void showLargeFileView(PieceTable *table);
+    // 移除超大文件只读视图，恢复编辑器显示
+    void hideLargeFileView();
+    // 按片段流式保存超大文件只读视图的内容
+    bool saveLargeFile(const QString &filePath, const QString &encode);
 
 public slots:
     // 处理文档预加载数据
     void handleFilePreProcess(const QByteArray &encode, const QByteArray &content);
     void handleFileLoadFinished(const QByteArray &encode, const QByteArray &content, bool error);
+    // 处理大文件流式加载
+    void handleFileStreamBegin(const QByteArray &encode);
+    void handleFileStreamChunkReady(qint64 totalSize);
+    void handleFileStreamFinished(const QByteArray &encode, bool error);
+    // 处理超大文件以片段表映射完成
+    void handleFilePieceTableReady(const QByteArray &encode);
+    // 处理后台保存文件
+    void handleFileSaveProgress(int progress);
+    void handleFileSaveFinished(bool success, bool openFailed, const QString &errorString);
     void OnThemeChangeSlot(QString theme);
     void UpdateBottomBarWordCnt(int cnt);
     void OnUpdateHighlighter();
@@ -166,18 +218,33 @@ private:
     bool m_bQuit = false;
     //文件是否加载
     bool m_bFileLoading = false;
+    //文件内容是否已加载完成
+    bool m_bFileLoaded = false;
     bool m_bIsTemFile = false;
     //撤销重做栈操作任务文件修改
     bool m_bUndoRedoOption = false;
     //语法高亮
-    KSyntaxHighlighting::Repository m_Repository;
     KSyntaxHighlighting::Definition m_Definition;
     //KSyntaxHighlighting::SyntaxHighlighter *m_pSyntaxHighlighter = nullptr;
     CSyntaxHighlighter *m_pSyntaxHighlighter = nullptr;
     bool m_bHighlighterAll = false;
+    bool m_bBackgroundHighlight = false;         // 是否在空闲时分析高亮状态
 
     bool m_bAsyncReadFileFinished = false;
     bool m_bHasPreProcess = false;               // 预处理标识
+    QPointer<FileLoadThread> m_pLoadThread;      // 文件加载线程
+    QTextCursor m_streamCursor;                  // 流式加载时的插入光标
+
+    QPointer<FileSaveThread> m_pSaveThread;      // 后台保存线程
+    QString m_sAsyncSaveTemPath;                 // 后台保存前的文件路径
+    int m_nAsyncSaveIndex = 0;                   // 后台保存快照对应的撤销栈索引
+    int m_nAsyncSaveMinIndex = 0;                // 后台保存期间撤销栈的最小索引
+    QMetaObject::Connection m_asyncSaveIndexConnection; // 后台保存期间跟踪撤销栈索引
+    bool m_bAsyncResavePending = false;          // 后台保存期间是否再次请求保存
+    bool m_bLastAsyncSaveSucceeded = true;       // 最近一次后台保存是否成功
+
+    BackupJournal *m_pBackupJournal = nullptr;   // 增量备份日志
+    LargeFileView *m_pLargeFileView = nullptr;   // 超大文件只读视图
 };
 
 #endif
@@ -0,0 +1,363 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "foldregionindex.h"
+
+#include <QTextDocument>
+#include <QTextBlock>
+
+namespace {
+
+// 计算缩进宽度时制表符的宽度
+const int s_TabWidth = 4;
+
+}
+
+void FoldRegionIndex::setFoldingMode(FoldingMode mode, const QTextDocument *document)
+{
+    m_mode = mode;
+    rebuild(document);
+}
+
+FoldRegionIndex::FoldingMode FoldRegionIndex::foldingMode() const
+{
+    return m_mode;
+}
+
+void FoldRegionIndex::rebuild(const QTextDocument *document)
+{
+    m_blocks.clear();
+    invalidateFrom(0);
+    if (ESyntaxFolding == m_mode) {
+        m_blocks.resize(document->blockCount());
+        return;
+    }
+
+    m_blocks.reserve(document->blockCount());
+    bool inString = false;
+    for (QTextBlock block = document->begin(); block.isValid(); block = block.next()) {
+        m_blocks.append(scanBlock(block.text(), inString));
+        inString = m_blocks.last().endsInString;
+    }
+}
+
+/**
+ * @brief 文档内容变更时，以变更前后的文本块数量差替换变更范围内的文本块信息并重新统计，
+ *      最后一个变更的文本块结束时的字符串状态改变时，继续统计后续文本块直至状态与变更前一致。
+ *      语法折叠时仅调整文本块数量，各块区域信息由重新高亮更新，高亮格式变更时同样会触发此函数。
+ */
+void FoldRegionIndex::contentsChange(const QTextDocument *document, int from, int charsRemoved, int charsAdded)
+{
+    Q_UNUSED(charsRemoved)
+
+    const int blockDelta = document->blockCount() - m_blocks.size();
+    const QTextBlock firstBlock = document->findBlock(from);
+    const QTextBlock lastBlock = document->findBlock(qMin(from + charsAdded, document->characterCount() - 1));
+    if (!firstBlock.isValid() || !lastBlock.isValid()) {
+        rebuild(document);
+        return;
+    }
+
+    const int first = firstBlock.blockNumber();
+    const int last = lastBlock.blockNumber();
+    const int oldLast = last - blockDelta;
+    // 变更范围与记录的文本块不对应(如整体替换文本时上报的范围超出文档)，重新统计
+    if (oldLast < first || oldLast >= m_blocks.size()) {
+        rebuild(document);
+        return;
+    }
+
+    if (ESyntaxFolding == m_mode) {
+        // 仅文本块数量变化影响区域推导，高亮格式变更不丢弃推导结果
+        if (0 != blockDelta) {
+            invalidateFrom(first + 1);
+        }
+        if (blockDelta > 0) {
+            m_blocks.insert(first + 1, blockDelta, BlockInfo());
+        } else if (blockDelta < 0) {
+            m_blocks.remove(first + 1, -blockDelta);
+        }
+        return;
+    }
+
+    invalidateFrom(first);
+    bool oldEndsInString = m_blocks.at(oldLast).endsInString;
+    m_blocks.remove(first, oldLast - first + 1);
+    m_blocks.insert(first, last - first + 1, BlockInfo());
+
+    bool inString = first > 0 && m_blocks.at(first - 1).endsInString;
+    int number = first;
+    for (QTextBlock block = firstBlock; block.isValid(); block = block.next(), ++number) {
+        if (number > last) {
+            oldEndsInString = m_blocks.at(number).endsInString;
+        }
+
+        m_blocks[number] = scanBlock(block.text(), inString);
+        inString = m_blocks.at(number).endsInString;
+        if (number >= last && inString == oldEndsInString) {
+            break;
+        }
+    }
+}
+
+void FoldRegionIndex::setBlockRegions(int blockNumber, const QVector<int> &regions)
+{
+    if (ESyntaxFolding != m_mode || blockNumber < 0 || blockNumber >= m_blocks.size()) {
+        return;
+    }
+
+    const BlockInfo info = regionInfo(regions);
+    BlockInfo &current = m_blocks[blockNumber];
+    if (info.openCount != current.openCount
+            || info.minDepth != current.minDepth
+            || info.endDepth != current.endDepth) {
+        current = info;
+        invalidateFrom(blockNumber);
+    }
+}
+
+bool FoldRegionIndex::isValid(const QTextDocument *document) const
+{
+    return m_blocks.size() == document->blockCount();
+}
+
+int FoldRegionIndex::blockCount() const
+{
+    return m_blocks.size();
+}
+
+FoldRegionIndex::BlockInfo FoldRegionIndex::blockInfo(int blockNumber) const
+{
+    if (blockNumber < 0 || blockNumber >= m_blocks.size()) {
+        return BlockInfo();
+    }
+    return m_blocks.at(blockNumber);
+}
+
+bool FoldRegionIndex::hasRegionBegin(int blockNumber) const
+{
+    if (blockNumber < 0 || blockNumber >= m_blocks.size()) {
+        return false;
+    }
+    if (EIndentationFolding == m_mode) {
+        return startsRegion(blockNumber);
+    }
+    return m_blocks.at(blockNumber).openCount > 0;
+}
+
+bool FoldRegionIndex::startsRegion(int blockNumber) const
+{
+    if (blockNumber < 0 || blockNumber >= m_blocks.size()) {
+        return false;
+    }
+
+    if (EIndentationFolding == m_mode) {
+        // 下一个非空白文本块缩进更大时为区域起始
+        const int indent = m_blocks.at(blockNumber).indent;
+        if (indent < 0) {
+            return false;
+        }
+        for (int i = blockNumber + 1; i < m_blocks.size(); ++i) {
+            if (m_blocks.at(i).indent >= 0) {
+                return m_blocks.at(i).indent > indent;
+            }
+        }
+        return false;
+    }
+
+    // 最后一次到达块内最小深度后，深度的每次增加均未在本行恢复
+    const BlockInfo &info = m_blocks.at(blockNumber);
+    return info.endDepth > info.minDepth;
+}
+
+int FoldRegionIndex::depthAtStart(int blockNumber) const
+{
+    if (blockNumber < 0 || blockNumber >= m_blocks.size()) {
+        return 0;
+    }
+    linkTo(blockNumber);
+    return m_startDepth.at(blockNumber);
+}
+
+int FoldRegionIndex::depthAtEnd(int blockNumber) const
+{
+    if (blockNumber < 0 || blockNumber >= m_blocks.size()) {
+        return 0;
+    }
+    linkTo(blockNumber);
+    return m_startDepth.at(blockNumber) + m_blocks.at(blockNumber).endDepth;
+}
+
+/**
+ * @brief 推导至文本块 \a blockNumber ，区域未在已推导的范围内结束时继续向后推导，
+ *      复杂度与区域长度相关，结果保留至区域内的文本块变更
+ */
+int FoldRegionIndex::regionEnd(int blockNumber) const
+{
+    if (blockNumber < 0 || blockNumber >= m_blocks.size()) {
+        return -1;
+    }
+    linkTo(blockNumber);
+    if (!isRegionEntry(blockNumber)) {
+        return -1;
+    }
+
+    while (m_matchBlock.at(blockNumber) < 0 && m_linkedCount < m_blocks.size()) {
+        linkTo(m_linkedCount);
+    }
+    return m_matchBlock.at(blockNumber);
+}
+
+int FoldRegionIndex::linkedCount() const
+{
+    return m_linkedCount;
+}
+
+/**
+ * @brief 统计文本 \a text 中字符串外的括号，字符串以 '"' 起止，转义的 '"' 不结束字符串。
+ *      字符串仅在行尾为续行符 '\\' 时延续到下一文本块。同时记录行首缩进宽度。
+ */
+FoldRegionIndex::BlockInfo FoldRegionIndex::scanBlock(const QString &text, bool inString)
+{
+    BlockInfo info;
+    int depth = 0;
+    const int length = text.length();
+    const QChar *data = text.constData();
+    for (int i = 0; i < length; ++i) {
+        const QChar c = data[i];
+        if (inString) {
+            if ('"' == c && (0 == i || '\\' != data[i - 1])) {
+                inString = false;
+            }
+        } else if ('{' == c) {
+            ++depth;
+            ++info.openCount;
+        } else if ('}' == c) {
+            --depth;
+            info.minDepth = qMin(info.minDepth, depth);
+        } else if ('"' == c) {
+            inString = true;
+        }
+    }
+
+    info.endDepth = depth;
+    info.endsInString = inString && length > 0 && '\\' == data[length - 1];
+
+    int indent = 0;
+    for (int i = 0; i < length; ++i) {
+        if (' ' == data[i]) {
+            ++indent;
+        } else if ('\t' == data[i]) {
+            indent += s_TabWidth - indent % s_TabWidth;
+        } else if (!data[i].isSpace()) {
+            info.indent = indent;
+            break;
+        }
+    }
+    return info;
+}
+
+FoldRegionIndex::BlockInfo FoldRegionIndex::regionInfo(const QVector<int> &regions)
+{
+    BlockInfo info;
+    int depth = 0;
+    for (int region : regions) {
+        if (region > 0) {
+            ++depth;
+            ++info.openCount;
+        } else if (region < 0) {
+            --depth;
+            info.minDepth = qMin(info.minDepth, depth);
+        }
+    }
+    info.endDepth = depth;
+    return info;
+}
+
+/**
+ * @brief 从已推导的位置顺序遍历至文本块 \a blockNumber ，未结束的区域按层级递增保存在栈中。
+ *      括号及语法折叠时，文本块内的最小深度不大于栈顶区域外层深度即为区域结束的文本块；
+ *      缩进折叠时，缩进不大于栈顶文本块的非空白文本块即为区域结束的文本块。
+ *      栈以各入栈文本块的下一个文本块链接，记录每个文本块推导后的栈顶，可从任意已推导的位置继续推导。
+ */
+void FoldRegionIndex::linkTo(int blockNumber) const
+{
+    if (blockNumber < m_linkedCount) {
+        return;
+    }
+
+    const int count = m_blocks.size();
+    if (m_startDepth.size() != count) {
+        m_startDepth.resize(count);
+        m_matchBlock.resize(count);
+        m_stackTop.resize(count);
+        m_stackBelow.resize(count);
+    }
+
+    int top = m_linkedCount > 0 ? m_stackTop.at(m_linkedCount - 1) : -1;
+    int depth = m_linkedCount > 0 ? m_startDepth.at(m_linkedCount - 1) + m_blocks.at(m_linkedCount - 1).endDepth : 0;
+    const int last = qMin(blockNumber, count - 1);
+    for (int i = m_linkedCount; i <= last; ++i) {
+        const BlockInfo &info = m_blocks.at(i);
+        m_startDepth[i] = depth;
+        m_matchBlock[i] = -1;
+        depth += info.endDepth;
+
+        // 缩进折叠时空白行不影响区域
+        if (EIndentationFolding != m_mode || info.indent >= 0) {
+            const int lowest = EIndentationFolding == m_mode ? info.indent : m_startDepth.at(i) + info.minDepth;
+            while (top >= 0 && entryLevel(top) >= lowest) {
+                m_matchBlock[top] = i;
+                top = m_stackBelow.at(top);
+            }
+
+            if (isRegionEntry(i)) {
+                m_stackBelow[i] = top;
+                top = i;
+            }
+        }
+        m_stackTop[i] = top;
+    }
+
+    m_linkedCount = qMax(m_linkedCount, last + 1);
+}
+
+/**
+ * @brief 丢弃文本块 \a blockNumber 及之后的推导结果。之前的文本块中，
+ *      区域在该位置仍未结束(位于该位置前的栈中)的结束信息失效，其余结果保留
+ */
+void FoldRegionIndex::invalidateFrom(int blockNumber)
+{
+    if (blockNumber >= m_linkedCount) {
+        return;
+    }
+
+    if (blockNumber <= 0) {
+        m_linkedCount = 0;
+        return;
+    }
+
+    for (int entry = m_stackTop.at(blockNumber - 1); entry >= 0; entry = m_stackBelow.at(entry)) {
+        m_matchBlock[entry] = -1;
+    }
+    m_linkedCount = blockNumber;
+}
+
+bool FoldRegionIndex::isRegionEntry(int blockNumber) const
+{
+    const BlockInfo &info = m_blocks.at(blockNumber);
+    if (EIndentationFolding == m_mode) {
+        return info.indent >= 0;
+    }
+    return info.endDepth > info.minDepth;
+}
+
+int FoldRegionIndex::entryLevel(int blockNumber) const
+{
+    const BlockInfo &info = m_blocks.at(blockNumber);
+    if (EIndentationFolding == m_mode) {
+        return info.indent;
+    }
+    return m_startDepth.at(blockNumber) + info.endDepth - 1;
+}
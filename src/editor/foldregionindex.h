@@ -0,0 +1,96 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef FOLDREGIONINDEX_H
+#define FOLDREGIONINDEX_H
+
+#include <QVector>
+#include <QString>
+
+class QTextDocument;
+
+/**
+ * @brief 代码折叠区域索引，逐文本块记录折叠区域的起止信息，支持三种折叠方式：
+ *      括号折叠统计字符串外的 '{' '}' ，用于无语法定义的文件；
+ *      语法折叠使用语法高亮(KSyntaxHighlighting)上报的折叠区域起止标记，文本块高亮后更新；
+ *      缩进折叠按文本块的缩进层级划分区域，用于 Python 、 YAML 等基于缩进的语法。
+ *      文档内容变更时仅重新统计变更的文本块，括号折叠时块结束的字符串状态变化则继续向后统计，直至与原状态一致。
+ *      各文本块起始时的深度及区域结束的文本块由各块信息顺序推导，仅在查询时推导至查询的文本块；
+ *      未结束的区域以链式栈保存，内容变更后从变更的文本块继续推导，变更位置之前的结果保留。
+ *      文本块的 QTextBlockUserData 由语法高亮使用，索引按文本块序号单独存储。
+ */
+class FoldRegionIndex
+{
+public:
+    // 折叠方式
+    enum FoldingMode {
+        EBraceFolding,          // 括号折叠
+        ESyntaxFolding,         // 语法高亮折叠区域
+        EIndentationFolding,    // 缩进折叠
+    };
+
+    // 单个文本块的折叠区域信息，深度均相对于块起始位置
+    struct BlockInfo {
+        int openCount = 0;          // 区域起始(左括号)数量
+        int minDepth = 0;           // 块内到达的最小深度
+        int endDepth = 0;           // 块结束时的深度
+        bool endsInString = false;  // 块结束时处于字符串内(行尾为续行符)
+        int indent = -1;            // 缩进宽度，空白行为 -1
+    };
+
+    // 设置折叠方式 mode 并重新统计文档 document
+    void setFoldingMode(FoldingMode mode, const QTextDocument *document);
+    FoldingMode foldingMode() const;
+
+    // 重新统计文档 document 的全部文本块，语法折叠时各块区域信息在重新高亮后更新
+    void rebuild(const QTextDocument *document);
+    // 文档内容变更，参数同 QTextDocument::contentsChange
+    void contentsChange(const QTextDocument *document, int from, int charsRemoved, int charsAdded);
+    // 语法折叠时更新文本块 blockNumber 的折叠区域标记 regions ，正数为区域起始，负数为区域结束，绝对值为区域标识加 1
+    void setBlockRegions(int blockNumber, const QVector<int> &regions);
+    // 索引是否与文档 document 的文本块对应
+    bool isValid(const QTextDocument *document) const;
+    int blockCount() const;
+    BlockInfo blockInfo(int blockNumber) const;
+
+    // 文本块 blockNumber 是否包含区域起始(字符串外的左括号)
+    bool hasRegionBegin(int blockNumber) const;
+    // 文本块 blockNumber 是否包含未在本行结束的区域，即是否显示折叠标志
+    bool startsRegion(int blockNumber) const;
+    // 文本块 blockNumber 起始及结束时的深度，用于括号及语法折叠
+    int depthAtStart(int blockNumber) const;
+    int depthAtEnd(int blockNumber) const;
+    // 文本块 blockNumber 中最后一个未结束区域的结束文本块序号，未找到返回 -1 。
+    // 缩进折叠时为区域后第一个缩进不大于起始行的非空白文本块
+    int regionEnd(int blockNumber) const;
+
+    // 统计文本 text 中的括号及缩进信息，inString 为起始时是否处于字符串内
+    static BlockInfo scanBlock(const QString &text, bool inString);
+    // 按折叠区域标记 regions 统计区域信息，区域按嵌套顺序起止，仅需统计深度
+    static BlockInfo regionInfo(const QVector<int> &regions);
+
+    // 已推导起始深度及区域结束信息的文本块数量
+    int linkedCount() const;
+
+private:
+    // 按各文本块信息计算起始深度及区域结束的文本块，推导至文本块 blockNumber
+    void linkTo(int blockNumber) const;
+    // 文本块 blockNumber 及之后的信息变更，丢弃该位置之后的推导结果
+    void invalidateFrom(int blockNumber);
+    // 文本块 blockNumber 是否作为未结束的区域入栈
+    bool isRegionEntry(int blockNumber) const;
+    // 入栈文本块 blockNumber 的区域层级(外层深度或缩进宽度)
+    int entryLevel(int blockNumber) const;
+
+private:
+    FoldingMode m_mode = EBraceFolding;     // 折叠方式
+    QVector<BlockInfo> m_blocks;            // 各文本块的折叠区域信息
+    mutable QVector<int> m_startDepth;      // 各文本块起始时的深度
+    mutable QVector<int> m_matchBlock;      // 各文本块区域结束的文本块
+    mutable QVector<int> m_stackTop;        // 各文本块推导后未结束区域栈的栈顶文本块，-1 为空栈
+    mutable QVector<int> m_stackBelow;      // 入栈文本块在栈中的下一个文本块
+    mutable int m_linkedCount = 0;          // 已推导的文本块数量
+};
+
+#endif // FOLDREGIONINDEX_H
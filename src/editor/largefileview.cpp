@@ -0,0 +1,464 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "largefileview.h"
+#include "../common/piecetable.h"
+#include "../common/utils.h"
+
+#include <QApplication>
+#include <QClipboard>
+#include <QContextMenuEvent>
+#include <QKeyEvent>
+#include <QMenu>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QScrollBar>
+#include <QDebug>
+
+#include <climits>
+
+LargeFileView::LargeFileView(QWidget *parent)
+    : QAbstractScrollArea(parent)
+{
+    setFocusPolicy(Qt::StrongFocus);
+    setFrameShape(QFrame::NoFrame);
+    viewport()->setCursor(Qt::IBeamCursor);
+}
+
+LargeFileView::~LargeFileView()
+{
+    delete m_pPieceTable;
+    m_pPieceTable = nullptr;
+}
+
+/**
+ * @brief 设置显示的片段表，取得所有权，之前的片段表将被释放
+ */
+void LargeFileView::setPieceTable(PieceTable *table)
+{
+    if (m_pPieceTable == table) {
+        return;
+    }
+
+    delete m_pPieceTable;
+    m_pPieceTable = table;
+    m_lineCount = m_pPieceTable ? m_pPieceTable->lineCount() : 0;
+    m_anchorLine = 0;
+    m_currentLine = 0;
+    m_cacheFirstLine = -1;
+    m_cacheLines.clear();
+    m_maxLineWidth = 0;
+
+    updateScrollBars();
+    verticalScrollBar()->setValue(0);
+    horizontalScrollBar()->setValue(0);
+    updateVisibleLines();
+    viewport()->update();
+    emit sigCurrentLineChanged(m_currentLine);
+}
+
+PieceTable *LargeFileView::pieceTable() const
+{
+    return m_pPieceTable;
+}
+
+/**
+ * @brief 按主题配置文件设置颜色，与 TextEdit::setTheme() 读取相同的配置项
+ */
+void LargeFileView::setTheme(const QString &path)
+{
+    QVariantMap jsonMap = Utils::getThemeMapFromPath(path);
+    QVariantMap editorColorsMap = jsonMap["editor-colors"].toMap();
+    QVariantMap normalMap = jsonMap["text-styles"].toMap()["Normal"].toMap();
+
+    m_backgroundColor = QColor(editorColorsMap["background-color"].toString());
+    m_currentLineColor = QColor(editorColorsMap["current-line"].toString());
+    m_currentLineNumberColor = QColor(editorColorsMap["current-line-number"].toString());
+    m_lineNumbersColor = QColor(editorColorsMap["line-numbers"].toString());
+    m_textColor = QColor(normalMap["text-color"].toString());
+    m_selectionColor = QColor(normalMap["selected-text-color"].toString());
+    m_selectionBgColor = QColor(normalMap["selected-bg-color"].toString());
+
+    viewport()->update();
+}
+
+void LargeFileView::setTabSpaceNumber(int number)
+{
+    if (number <= 0 || number == m_tabSpaceNumber) {
+        return;
+    }
+
+    m_tabSpaceNumber = number;
+    m_cacheFirstLine = -1;
+    m_maxLineWidth = 0;
+    updateVisibleLines();
+    viewport()->update();
+}
+
+qint64 LargeFileView::lineCount() const
+{
+    return m_lineCount;
+}
+
+qint64 LargeFileView::currentLine() const
+{
+    return m_currentLine;
+}
+
+void LargeFileView::jumpToLine(qint64 line)
+{
+    setCurrentLine(line, false);
+}
+
+/**
+ * @brief 复制选中的行到剪贴板，选中的数据超过 EMaxCopyBytes 时仅复制前 EMaxCopyBytes 的数据，
+ *      避免一次性将超大文件全部读入内存
+ */
+void LargeFileView::copySelection()
+{
+    if (!m_pPieceTable || 0 == m_lineCount) {
+        return;
+    }
+
+    qint64 first = qMin(m_anchorLine, m_currentLine);
+    qint64 last = qMax(m_anchorLine, m_currentLine);
+    qint64 start = m_pPieceTable->lineStart(first);
+    qint64 end = m_pPieceTable->lineStart(last + 1);
+
+    QByteArray data = m_pPieceTable->mid(start, qMin<qint64>(end - start, EMaxCopyBytes));
+    // 单行复制时不包含行尾换行符，与编辑器的行为保持一致
+    if (first == last) {
+        while (data.endsWith('\n') || data.endsWith('\r')) {
+            data.chop(1);
+        }
+    }
+    if (end - start > EMaxCopyBytes) {
+        qWarning() << "large file view copy truncated to" << data.size() << "bytes";
+    }
+
+    QApplication::clipboard()->setText(QString::fromUtf8(data));
+}
+
+void LargeFileView::selectAll()
+{
+    if (0 == m_lineCount) {
+        return;
+    }
+
+    m_anchorLine = 0;
+    setCurrentLine(m_lineCount - 1, true);
+}
+
+void LargeFileView::paintEvent(QPaintEvent *e)
+{
+    Q_UNUSED(e)
+    QPainter painter(viewport());
+    painter.fillRect(viewport()->rect(), m_backgroundColor.isValid() ? m_backgroundColor : palette().base().color());
+
+    if (!m_pPieceTable) {
+        return;
+    }
+
+    const int height = lineHeight();
+    const int ascent = fontMetrics().ascent();
+    const int numberWidth = lineNumberAreaWidth();
+    const int textLeft = numberWidth + ETextMargin - horizontalScrollBar()->value();
+    const QRect textRect(numberWidth, 0, viewport()->width() - numberWidth, viewport()->height());
+    const qint64 selectFirst = qMin(m_anchorLine, m_currentLine);
+    const qint64 selectLast = qMax(m_anchorLine, m_currentLine);
+    const bool hasSelection = m_anchorLine != m_currentLine;
+    const QColor textColor = m_textColor.isValid() ? m_textColor : palette().text().color();
+
+    for (int i = 0; i < m_cacheLines.size(); ++i) {
+        qint64 line = m_cacheFirstLine + i;
+        int y = i * height;
+        QRect lineRect(0, y, viewport()->width(), height);
+        bool selected = hasSelection && line >= selectFirst && line <= selectLast;
+
+        if (selected) {
+            painter.fillRect(lineRect, m_selectionBgColor.isValid() ? m_selectionBgColor : palette().highlight().color());
+        } else if (line == m_currentLine && m_currentLineColor.isValid()) {
+            painter.fillRect(lineRect, m_currentLineColor);
+        }
+
+        painter.setPen(line == m_currentLine ? m_currentLineNumberColor : m_lineNumbersColor);
+        painter.drawText(QRect(0, y, numberWidth, height), Qt::AlignRight | Qt::AlignVCenter, QString::number(line + 1));
+
+        painter.save();
+        painter.setClipRect(textRect);
+        painter.setPen(selected && m_selectionColor.isValid() ? m_selectionColor : textColor);
+        painter.drawText(textLeft, y + ascent, m_cacheLines.at(i));
+        painter.restore();
+    }
+}
+
+void LargeFileView::resizeEvent(QResizeEvent *e)
+{
+    QAbstractScrollArea::resizeEvent(e);
+    updateScrollBars();
+    updateVisibleLines();
+}
+
+void LargeFileView::changeEvent(QEvent *e)
+{
+    QAbstractScrollArea::changeEvent(e);
+    if (QEvent::FontChange == e->type()) {
+        m_cacheFirstLine = -1;
+        m_maxLineWidth = 0;
+        updateScrollBars();
+        updateVisibleLines();
+        viewport()->update();
+    }
+}
+
+void LargeFileView::keyPressEvent(QKeyEvent *e)
+{
+    if (e->matches(QKeySequence::Copy)) {
+        copySelection();
+        return;
+    }
+    if (e->matches(QKeySequence::SelectAll)) {
+        selectAll();
+        return;
+    }
+
+    bool keepAnchor = e->modifiers() & Qt::ShiftModifier;
+    bool ctrl = e->modifiers() & Qt::ControlModifier;
+    switch (e->key()) {
+    case Qt::Key_Up:
+        setCurrentLine(m_currentLine - 1, keepAnchor);
+        break;
+    case Qt::Key_Down:
+        setCurrentLine(m_currentLine + 1, keepAnchor);
+        break;
+    case Qt::Key_PageUp:
+        setCurrentLine(m_currentLine - qMax(1, pageLineCount() - 1), keepAnchor);
+        break;
+    case Qt::Key_PageDown:
+        setCurrentLine(m_currentLine + qMax(1, pageLineCount() - 1), keepAnchor);
+        break;
+    case Qt::Key_Home:
+        if (ctrl) {
+            setCurrentLine(0, keepAnchor);
+        } else {
+            horizontalScrollBar()->setValue(0);
+        }
+        break;
+    case Qt::Key_End:
+        if (ctrl) {
+            setCurrentLine(m_lineCount - 1, keepAnchor);
+        } else {
+            horizontalScrollBar()->setValue(horizontalScrollBar()->maximum());
+        }
+        break;
+    case Qt::Key_Left:
+        horizontalScrollBar()->triggerAction(QAbstractSlider::SliderSingleStepSub);
+        break;
+    case Qt::Key_Right:
+        horizontalScrollBar()->triggerAction(QAbstractSlider::SliderSingleStepAdd);
+        break;
+    default:
+        QAbstractScrollArea::keyPressEvent(e);
+        break;
+    }
+}
+
+void LargeFileView::mousePressEvent(QMouseEvent *e)
+{
+    if (Qt::LeftButton == e->button()) {
+        setCurrentLine(lineAt(e->pos()), e->modifiers() & Qt::ShiftModifier);
+    } else if (Qt::RightButton == e->button()) {
+        qint64 line = lineAt(e->pos());
+        // 右键点击选区外时移动当前行，点击选区内时保留选区用于复制
+        if (line < qMin(m_anchorLine, m_currentLine) || line > qMax(m_anchorLine, m_currentLine)) {
+            setCurrentLine(line, false);
+        }
+    }
+
+    QAbstractScrollArea::mousePressEvent(e);
+}
+
+void LargeFileView::mouseMoveEvent(QMouseEvent *e)
+{
+    if (e->buttons() & Qt::LeftButton) {
+        setCurrentLine(lineAt(e->pos()), true);
+    }
+
+    QAbstractScrollArea::mouseMoveEvent(e);
+}
+
+void LargeFileView::contextMenuEvent(QContextMenuEvent *e)
+{
+    QMenu menu(this);
+    menu.addAction(tr("Copy"), this, &LargeFileView::copySelection);
+    menu.addAction(tr("Select All"), this, &LargeFileView::selectAll);
+    menu.exec(e->globalPos());
+}
+
+void LargeFileView::scrollContentsBy(int dx, int dy)
+{
+    Q_UNUSED(dx)
+    if (0 != dy) {
+        updateVisibleLines();
+    }
+    viewport()->update();
+}
+
+/**
+ * @brief 更新滚动条范围，垂直滚动条的值为首个可见行，行数超过 INT_MAX 时末尾的行不可滚动到
+ */
+void LargeFileView::updateScrollBars()
+{
+    int pageLines = pageLineCount();
+    qint64 maxFirstLine = qMax<qint64>(0, m_lineCount - pageLines);
+    verticalScrollBar()->setRange(0, static_cast<int>(qMin<qint64>(maxFirstLine, INT_MAX)));
+    verticalScrollBar()->setPageStep(pageLines);
+    verticalScrollBar()->setSingleStep(1);
+
+    int textWidth = viewport()->width() - lineNumberAreaWidth() - ETextMargin;
+    horizontalScrollBar()->setRange(0, qMax(0, m_maxLineWidth - textWidth));
+    horizontalScrollBar()->setPageStep(qMax(1, textWidth));
+    horizontalScrollBar()->setSingleStep(fontMetrics().averageCharWidth());
+}
+
+/**
+ * @brief 读取可见区域的行文本并缓存，仅在首个可见行或可见行数变化时从片段表读取，
+ *      绘制时只使用缓存的文本
+ */
+void LargeFileView::updateVisibleLines()
+{
+    if (!m_pPieceTable) {
+        return;
+    }
+
+    qint64 first = firstVisibleLine();
+    int count = static_cast<int>(qMin<qint64>(pageLineCount() + 1, m_lineCount - first));
+    if (first == m_cacheFirstLine && count == m_cacheLines.size()) {
+        return;
+    }
+
+    m_cacheFirstLine = first;
+    m_cacheLines.clear();
+    m_cacheLines.reserve(count);
+
+    int maxWidth = m_maxLineWidth;
+    QFontMetrics metrics = fontMetrics();
+    for (int i = 0; i < count; ++i) {
+        QString text = lineText(first + i);
+        maxWidth = qMax(maxWidth, metrics.horizontalAdvance(text));
+        m_cacheLines.append(text);
+    }
+
+    // 水平滚动范围仅随已显示过的行增长，避免滚动时内容宽度来回跳变
+    if (maxWidth != m_maxLineWidth) {
+        m_maxLineWidth = maxWidth;
+        updateScrollBars();
+    }
+}
+
+/**
+ * @brief 读取行 line 的文本，超过 EMaxLineDisplayBytes 的部分不读取，
+ *      截断位置回退到完整的 UTF-8 字符边界
+ */
+QString LargeFileView::lineText(qint64 line) const
+{
+    qint64 start = m_pPieceTable->lineStart(line);
+    qint64 end = m_pPieceTable->lineStart(line + 1);
+    bool truncated = end - start > EMaxLineDisplayBytes;
+    QByteArray data = m_pPieceTable->mid(start, qMin<qint64>(end - start, EMaxLineDisplayBytes));
+
+    if (truncated) {
+        // 移除末尾不完整的多字节字符
+        int pos = data.size();
+        while (pos > 0 && (static_cast<uchar>(data.at(pos - 1)) & 0xC0) == 0x80) {
+            --pos;
+        }
+        if (pos > 0 && static_cast<uchar>(data.at(pos - 1)) >= 0xC0) {
+            data.truncate(pos - 1);
+        }
+    }
+
+    while (data.endsWith('\n') || data.endsWith('\r')) {
+        data.chop(1);
+    }
+
+    return expandTabs(QString::fromUtf8(data));
+}
+
+QString LargeFileView::expandTabs(const QString &text) const
+{
+    if (!text.contains(QLatin1Char('\t'))) {
+        return text;
+    }
+
+    QString result;
+    result.reserve(text.size() + m_tabSpaceNumber);
+    for (const QChar &ch : text) {
+        if (QLatin1Char('\t') == ch) {
+            result.append(QString(m_tabSpaceNumber - result.size() % m_tabSpaceNumber, QLatin1Char(' ')));
+        } else {
+            result.append(ch);
+        }
+    }
+
+    return result;
+}
+
+void LargeFileView::setCurrentLine(qint64 line, bool keepAnchor)
+{
+    if (0 == m_lineCount) {
+        return;
+    }
+
+    line = qBound<qint64>(0, line, m_lineCount - 1);
+    bool changed = line != m_currentLine;
+    m_currentLine = line;
+    if (!keepAnchor) {
+        m_anchorLine = line;
+    }
+
+    ensureLineVisible(line);
+    viewport()->update();
+
+    if (changed) {
+        emit sigCurrentLineChanged(m_currentLine);
+    }
+}
+
+void LargeFileView::ensureLineVisible(qint64 line)
+{
+    qint64 first = firstVisibleLine();
+    int pageLines = qMax(1, pageLineCount());
+    if (line < first) {
+        verticalScrollBar()->setValue(static_cast<int>(qMin<qint64>(line, INT_MAX)));
+    } else if (line >= first + pageLines) {
+        verticalScrollBar()->setValue(static_cast<int>(qMin<qint64>(line - pageLines + 1, INT_MAX)));
+    }
+}
+
+qint64 LargeFileView::lineAt(const QPoint &pos) const
+{
+    return firstVisibleLine() + qMax(0, pos.y()) / lineHeight();
+}
+
+qint64 LargeFileView::firstVisibleLine() const
+{
+    return verticalScrollBar()->value();
+}
+
+int LargeFileView::pageLineCount() const
+{
+    return qMax(1, viewport()->height() / lineHeight());
+}
+
+int LargeFileView::lineHeight() const
+{
+    return qMax(1, fontMetrics().height());
+}
+
+int LargeFileView::lineNumberAreaWidth() const
+{
+    int digits = QString::number(qMax<qint64>(1, m_lineCount)).size();
+    return ETextMargin * 2 + fontMetrics().horizontalAdvance(QLatin1Char('9')) * digits;
+}
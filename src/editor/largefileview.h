@@ -0,0 +1,105 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef LARGEFILEVIEW_H
+#define LARGEFILEVIEW_H
+
+#include <QAbstractScrollArea>
+#include <QStringList>
+#include <QColor>
+
+class PieceTable;
+
+/**
+ * @brief 超大文件的只读视图，文件数据由片段表(PieceTable)只读映射，不加载到 QTextDocument 。
+ *      仅读取并绘制可见区域的行，内存占用与可见行数相关，与文件大小无关。
+ *      以行为单位进行选择及复制，过长的行仅显示行首部分数据。
+ */
+class LargeFileView : public QAbstractScrollArea
+{
+    Q_OBJECT
+public:
+    enum ViewParam {
+        EMaxLineDisplayBytes = 16 * 1024,           // 单行最多显示的数据长度
+        EMaxCopyBytes = 64 * 1024 * 1024,           // 单次最多复制的数据长度
+        ETextMargin = 8,                            // 行号及文本的边距
+    };
+
+    explicit LargeFileView(QWidget *parent = nullptr);
+    ~LargeFileView() override;
+
+    // 设置显示的片段表，取得所有权
+    void setPieceTable(PieceTable *table);
+    PieceTable *pieceTable() const;
+
+    // 设置主题配置文件路径
+    void setTheme(const QString &path);
+    // 设置制表符对应的空格数
+    void setTabSpaceNumber(int number);
+
+    qint64 lineCount() const;
+    // 当前行(从0开始)
+    qint64 currentLine() const;
+    // 跳转到行 line (从0开始)并设置为当前行
+    void jumpToLine(qint64 line);
+    // 复制选中的行，超过 EMaxCopyBytes 的部分不复制
+    void copySelection();
+    void selectAll();
+
+signals:
+    // 当前行变更
+    void sigCurrentLineChanged(qint64 line);
+
+protected:
+    void paintEvent(QPaintEvent *e) override;
+    void resizeEvent(QResizeEvent *e) override;
+    void changeEvent(QEvent *e) override;
+    void keyPressEvent(QKeyEvent *e) override;
+    void mousePressEvent(QMouseEvent *e) override;
+    void mouseMoveEvent(QMouseEvent *e) override;
+    void contextMenuEvent(QContextMenuEvent *e) override;
+    void scrollContentsBy(int dx, int dy) override;
+
+private:
+    // 更新滚动条范围
+    void updateScrollBars();
+    // 读取可见的行，已读取时不重复读取
+    void updateVisibleLines();
+    // 读取行 line 用于显示的文本
+    QString lineText(qint64 line) const;
+    // 展开制表符
+    QString expandTabs(const QString &text) const;
+    // 设置当前行，keepAnchor 为 true 时保留选择起始行
+    void setCurrentLine(qint64 line, bool keepAnchor);
+    // 滚动到行 line 可见
+    void ensureLineVisible(qint64 line);
+    // 位置 pos 所在的行
+    qint64 lineAt(const QPoint &pos) const;
+    // 第一个可见的行
+    qint64 firstVisibleLine() const;
+    // 可见区域可显示的行数
+    int pageLineCount() const;
+    int lineHeight() const;
+    int lineNumberAreaWidth() const;
+
+private:
+    PieceTable *m_pPieceTable = nullptr;    // 显示的片段表
+    qint64 m_lineCount = 0;                 // 文档行数
+    qint64 m_anchorLine = 0;                // 选择起始行
+    qint64 m_currentLine = 0;               // 当前行
+    qint64 m_cacheFirstLine = -1;           // 已读取的首行
+    QStringList m_cacheLines;               // 已读取的可见行文本
+    int m_maxLineWidth = 0;                 // 已显示的最大行宽
+    int m_tabSpaceNumber = 4;               // 制表符对应的空格数
+
+    QColor m_backgroundColor;
+    QColor m_textColor;
+    QColor m_currentLineColor;
+    QColor m_lineNumbersColor;
+    QColor m_currentLineNumberColor;
+    QColor m_selectionColor;
+    QColor m_selectionBgColor;
+};
+
+#endif // LARGEFILEVIEW_H
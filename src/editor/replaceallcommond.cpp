@@ -3,14 +3,42 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 
 #include "replaceallcommond.h"
+#include "../common/textsearchkernel.h"
 
-
-
-ReplaceAllCommand::ReplaceAllCommand(QString &oldText, QString &newText, QTextCursor cursor, QUndoCommand *parent)
+/**
+ * @brief 按匹配位置替换文本，m_oldText / m_newText 仅保存匹配文本及替换文本
+ * @param offsets   匹配项在替换前文档中的位置，升序排列且互不重叠
+ * @param oldText   匹配文本
+ * @param newText   替换文本
+ * @param cursor    文档光标
+ * @param parent    父撤销项
+ */
+ReplaceAllCommand::ReplaceAllCommand(const QVector<int> &offsets, const QString &oldText, const QString &newText,
+                                     QTextCursor cursor, QUndoCommand *parent)
     : QUndoCommand(parent)
     , m_oldText(oldText)
     , m_newText(newText)
     , m_cursor(cursor)
+    , m_offsets(offsets)
+{
+
+}
+
+/**
+ * @brief 按匹配位置替换文本，各匹配项的文本及替换文本可能不同(如正则表达式替换)
+ * @param offsets   匹配项在替换前文档中的位置，升序排列且互不重叠
+ * @param oldTexts  各匹配项的文本
+ * @param newTexts  各匹配项的替换文本
+ * @param cursor    文档光标
+ * @param parent    父撤销项
+ */
+ReplaceAllCommand::ReplaceAllCommand(const QVector<int> &offsets, const QStringList &oldTexts, const QStringList &newTexts,
+                                     QTextCursor cursor, QUndoCommand *parent)
+    : QUndoCommand(parent)
+    , m_cursor(cursor)
+    , m_offsets(offsets)
+    , m_oldTexts(oldTexts)
+    , m_newTexts(newTexts)
 {
 
 }
@@ -22,18 +50,91 @@ ReplaceAllCommand::~ReplaceAllCommand()
 
 void ReplaceAllCommand::redo()
 {
-    m_cursor.setPosition(0);
-    m_cursor.movePosition(QTextCursor::End, QTextCursor::KeepAnchor);
-    m_cursor.deleteChar();
-
-    m_cursor.insertText(m_newText);
+    if (!m_oldTexts.isEmpty()) {
+        replaceTexts(m_oldTexts, m_newTexts, false);
+    } else {
+        replaceOffsets(m_oldText.size(), m_newText, 0);
+    }
 }
 
 void ReplaceAllCommand::undo()
 {
-    m_cursor.setPosition(0);
-    m_cursor.movePosition(QTextCursor::End, QTextCursor::KeepAnchor);
-    m_cursor.deleteChar();
+    if (!m_oldTexts.isEmpty()) {
+        replaceTexts(m_newTexts, m_oldTexts, true);
+    } else {
+        // 替换后各匹配项的位置依次偏移替换前后的文本长度差
+        replaceOffsets(m_newText.size(), m_oldText, m_newText.size() - m_oldText.size());
+    }
+}
+
+/**
+ * @brief 查找文本 \a text 中自 \a from 开始的 \a keyword 的位置，匹配后从匹配项末尾继续查找
+ * @return 升序排列的匹配位置
+ */
+QVector<int> ReplaceAllCommand::findOffsets(const QString &text, const QString &keyword, int from)
+{
+    QVector<int> offsets;
+    if (keyword.isEmpty()) {
+        return offsets;
+    }
+
+    int pos = TextSearchKernel::indexOf(text, keyword, from);
+    while (pos >= 0) {
+        offsets.append(pos);
+        pos = TextSearchKernel::indexOf(text, keyword, pos + keyword.size());
+    }
+    return offsets;
+}
+
+/**
+ * @brief 在同一编辑块中从后向前逐项替换，前面匹配项的位置不受已替换项的影响，文档仅在编辑块结束时统一更新布局
+ * @param length    各匹配项当前的文本长度
+ * @param text      替换文本
+ * @param step      第 i 个匹配项当前位置相对 m_offsets[i] 的偏移为 i * step
+ */
+void ReplaceAllCommand::replaceOffsets(int length, const QString &text, int step)
+{
+    if (m_cursor.isNull() || m_offsets.isEmpty()) {
+        return;
+    }
+
+    m_cursor.beginEditBlock();
+    for (int i = m_offsets.size() - 1; i >= 0; --i) {
+        int pos = m_offsets.at(i) + i * step;
+        m_cursor.setPosition(pos);
+        m_cursor.setPosition(pos + length, QTextCursor::KeepAnchor);
+        m_cursor.insertText(text);
+    }
+    m_cursor.endEditBlock();
+}
+
+/**
+ * @brief 在同一编辑块中从后向前逐项将 \a texts 替换为 \a replacements
+ * @param replaced  文档是否已替换，已替换时第 i 个匹配项的位置需累加之前各项替换前后的长度差
+ */
+void ReplaceAllCommand::replaceTexts(const QStringList &texts, const QStringList &replacements, bool replaced)
+{
+    if (m_cursor.isNull() || m_offsets.isEmpty()) {
+        return;
+    }
+
+    int shift = 0;
+    if (replaced) {
+        for (int i = 0; i < m_offsets.size(); ++i) {
+            shift += m_newTexts.at(i).size() - m_oldTexts.at(i).size();
+        }
+    }
+
+    m_cursor.beginEditBlock();
+    for (int i = m_offsets.size() - 1; i >= 0; --i) {
+        if (replaced) {
+            shift -= m_newTexts.at(i).size() - m_oldTexts.at(i).size();
+        }
 
-    m_cursor.insertText(m_oldText);
+        int pos = m_offsets.at(i) + shift;
+        m_cursor.setPosition(pos);
+        m_cursor.setPosition(pos + texts.at(i).size(), QTextCursor::KeepAnchor);
+        m_cursor.insertText(replacements.at(i));
+    }
+    m_cursor.endEditBlock();
 }
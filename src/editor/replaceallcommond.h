@@ -10,22 +10,45 @@
 #include <QTextDocument>
 #include <QPlainTextEdit>
 #include <QPointer>
+#include <QVector>
 #include "dtextedit.h"
 
-// 全部替换撤销-重做
+/**
+ * @brief 全部替换撤销-重做
+ *      按匹配位置替换时仅记录各匹配项在替换前文档中的位置及替换前后的文本，
+ *      撤销-重做在同一编辑块中逐项替换，内存占用与匹配数量相关，与文档大小无关。
+ *      正则表达式替换时各匹配项的文本及替换文本可能不同，分别记录各匹配项替换前后的文本。
+ */
 class ReplaceAllCommand: public QUndoCommand
 {
 public:
-    ReplaceAllCommand(QString &oldText, QString &newText, QTextCursor cursor, QUndoCommand *parent = nullptr);
+    // 将 offsets 位置的 oldText 替换为 newText ，offsets 为替换前文档中按升序排列的位置
+    ReplaceAllCommand(const QVector<int> &offsets, const QString &oldText, const QString &newText,
+                      QTextCursor cursor, QUndoCommand *parent = nullptr);
+    // 将 offsets 位置的 oldTexts 依次替换为 newTexts 中对应的文本
+    ReplaceAllCommand(const QVector<int> &offsets, const QStringList &oldTexts, const QStringList &newTexts,
+                      QTextCursor cursor, QUndoCommand *parent = nullptr);
     virtual ~ReplaceAllCommand();
 
     virtual void redo();
     virtual void undo();
 
+    // 查找文本 text 中自 from 开始不重叠的 keyword 的位置，与 QString::replace() 的匹配规则一致
+    static QVector<int> findOffsets(const QString &text, const QString &keyword, int from = 0);
+
+private:
+    // 将 offsets 位置(各位置向后偏移 step * 序号)长度为 length 的文本替换为 text
+    void replaceOffsets(int length, const QString &text, int step);
+    // 将 offsets 位置的 texts 依次替换为 replacements ，replaced 为 true 时各位置需累加之前匹配项的长度变化
+    void replaceTexts(const QStringList &texts, const QStringList &replacements, bool replaced);
+
 private:
     QString m_oldText;
     QString m_newText;
     QTextCursor m_cursor;
+    QVector<int> m_offsets;         // 匹配项在替换前文档中的位置
+    QStringList m_oldTexts;         // 各匹配项替换前的文本，为空时均为 m_oldText
+    QStringList m_newTexts;         // 各匹配项替换后的文本
 };
 
 #endif // REPLACEALLCOMMOND_H
@@ -3,6 +3,7 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 
 #include "showflodcodewidget.h"
+#include "../common/highlightrepository.h"
 #include <QFileInfo>
 #include <QDebug>
 #include <QPalette>
@@ -36,9 +37,6 @@ ShowFlodCodeWidget::ShowFlodCodeWidget(DWidget *parent)
     pSubLayout->addWidget(m_pContentEdit);
     this->setLayout(pSubLayout);
     m_highlighter = new KSyntaxHighlighting::SyntaxHighlighter(m_pContentEdit->document());
-
-    // 更新单独添加的高亮格式文件
-    m_repository.addCustomSearchPath(KF5_HIGHLIGHT_PATH);
 }
 
 ShowFlodCodeWidget::~ShowFlodCodeWidget()
@@ -58,13 +56,13 @@ void ShowFlodCodeWidget::initHighLight(QString filepath, bool bIsLight)
 {
     if (m_highlighter != nullptr) {
         if (!bIsLight) {
-            m_highlighter->setTheme(m_repository.defaultTheme(KSyntaxHighlighting::Repository::DarkTheme));
+            m_highlighter->setTheme(HighlightRepository::instance()->defaultTheme(KSyntaxHighlighting::Repository::DarkTheme));
         } else {
-            m_highlighter->setTheme(m_repository.defaultTheme(KSyntaxHighlighting::Repository::LightTheme));
+            m_highlighter->setTheme(HighlightRepository::instance()->defaultTheme(KSyntaxHighlighting::Repository::LightTheme));
         }
     }
    // m_highlighter->rehighlight();
-    const auto def = m_repository.definitionForFileName(QFileInfo(filepath).fileName());
+    const auto def = HighlightRepository::instance()->definitionForFileName(filepath);
     m_highlighter->setDefinition(def);
 }
 
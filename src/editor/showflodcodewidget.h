@@ -54,7 +54,6 @@ public:
 private:
     DPlainTextEdit *m_pContentEdit;
     int m_nTextWidth = 0;///< 代码预览框宽度
-    KSyntaxHighlighting::Repository m_repository;
     KSyntaxHighlighting::SyntaxHighlighter *m_highlighter;
 };
 
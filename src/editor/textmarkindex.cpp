@@ -0,0 +1,130 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "textmarkindex.h"
+
+#include <algorithm>
+
+namespace {
+
+inline int markStart(const TextMarkIndex::MarkList &marks, int index)
+{
+    return marks.at(index).first.cursor.selectionStart();
+}
+
+inline int markEnd(const TextMarkIndex::MarkList &marks, int index)
+{
+    return marks.at(index).first.cursor.selectionEnd();
+}
+
+}
+
+/**
+ * @brief 按标记列表 \a marks 重建索引，标记按起始位置排序，起始位置相同时保持列表顺序
+ */
+void TextMarkIndex::rebuild(const MarkList &marks)
+{
+    m_size = marks.size();
+    m_valid = true;
+    m_order.resize(m_size);
+    for (int i = 0; i < m_size; ++i) {
+        m_order[i] = i;
+    }
+
+    QVector<int> starts(m_size);
+    for (int i = 0; i < m_size; ++i) {
+        starts[i] = markStart(marks, i);
+    }
+    std::stable_sort(m_order.begin(), m_order.end(), [&starts](int a, int b) {
+        return starts.at(a) < starts.at(b);
+    });
+
+    m_maxEnd.fill(-1, m_size > 0 ? 4 * m_size : 0);
+    if (m_size > 0) {
+        build(marks, 1, 0, m_size);
+    }
+}
+
+void TextMarkIndex::invalidate()
+{
+    m_valid = false;
+}
+
+bool TextMarkIndex::isValid(const MarkList &marks) const
+{
+    return m_valid && m_size == marks.size();
+}
+
+/**
+ * @brief 查找与区间 [\a from, \a to] 相交的标记。先二分查找起始位置不大于 \a to 的标记范围，
+ *      再在线段树中仅访问最大结束位置不小于 \a from 的节点
+ */
+QVector<int> TextMarkIndex::intersecting(const MarkList &marks, int from, int to) const
+{
+    QVector<int> result;
+    const int limit = upperBound(marks, to);
+    if (limit > 0) {
+        collect(marks, 1, 0, m_size, limit, from, result);
+    }
+    return result;
+}
+
+QVector<int> TextMarkIndex::startingIn(const MarkList &marks, int from, int to) const
+{
+    QVector<int> result;
+    for (int i = upperBound(marks, from - 1); i < m_size && markStart(marks, m_order.at(i)) <= to; ++i) {
+        result.append(m_order.at(i));
+    }
+    return result;
+}
+
+int TextMarkIndex::upperBound(const MarkList &marks, int position) const
+{
+    int low = 0;
+    int high = m_size;
+    while (low < high) {
+        const int middle = low + (high - low) / 2;
+        if (markStart(marks, m_order.at(middle)) <= position) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+void TextMarkIndex::build(const MarkList &marks, int node, int begin, int end)
+{
+    if (end - begin == 1) {
+        m_maxEnd[node] = m_order.at(begin);
+        return;
+    }
+
+    const int middle = begin + (end - begin) / 2;
+    build(marks, 2 * node, begin, middle);
+    build(marks, 2 * node + 1, middle, end);
+    const int left = m_maxEnd.at(2 * node);
+    const int right = m_maxEnd.at(2 * node + 1);
+    m_maxEnd[node] = markEnd(marks, left) >= markEnd(marks, right) ? left : right;
+}
+
+/**
+ * @brief 收集排序序号 [\a begin, \a end) 与 [0, \a limit) 交集内结束位置不小于 \a from 的标记，
+ *      按排序序号由小到大访问，结果按起始位置升序排列
+ */
+void TextMarkIndex::collect(const MarkList &marks, int node, int begin, int end, int limit, int from, QVector<int> &result) const
+{
+    if (begin >= limit || markEnd(marks, m_maxEnd.at(node)) < from) {
+        return;
+    }
+
+    if (end - begin == 1) {
+        result.append(m_order.at(begin));
+        return;
+    }
+
+    const int middle = begin + (end - begin) / 2;
+    collect(marks, 2 * node, begin, middle, limit, from, result);
+    collect(marks, 2 * node + 1, middle, end, limit, from, result);
+}
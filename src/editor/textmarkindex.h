@@ -0,0 +1,50 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef TEXTMARKINDEX_H
+#define TEXTMARKINDEX_H
+
+#include <QList>
+#include <QPair>
+#include <QVector>
+#include <QTextEdit>
+
+/**
+ * @brief 颜色标记的位置索引，按标记起始位置排序并以线段树记录区间内的最大结束位置，
+ *      查询与指定区间相交的标记的复杂度为 O(log n + k) 。
+ *      索引仅记录标记在列表中的序号，位置实时取自标记的 QTextCursor 。文档编辑时 QTextDocument
+ *      对所有光标位置的调整是单调的，标记间起始位置的顺序及区间最大结束位置所属的标记均保持不变，
+ *      因此编辑文本无需更新索引，仅在标记列表增删时重建。
+ */
+class TextMarkIndex
+{
+public:
+    typedef QList<QPair<QTextEdit::ExtraSelection, qint64>> MarkList;
+
+    // 按标记列表 marks 重建索引
+    void rebuild(const MarkList &marks);
+    // 标记列表变更后置为无效，下次查询前重建
+    void invalidate();
+    // 索引是否与标记列表 marks 对应
+    bool isValid(const MarkList &marks) const;
+
+    // 与区间 [from, to] 相交(含端点相接)的标记在列表中的序号，按起始位置升序排列
+    QVector<int> intersecting(const MarkList &marks, int from, int to) const;
+    // 起始位置位于 [from, to] 的标记在列表中的序号，按起始位置升序排列
+    QVector<int> startingIn(const MarkList &marks, int from, int to) const;
+
+private:
+    // 起始位置大于 position 的第一个排序序号
+    int upperBound(const MarkList &marks, int position) const;
+    void build(const MarkList &marks, int node, int begin, int end);
+    void collect(const MarkList &marks, int node, int begin, int end, int limit, int from, QVector<int> &result) const;
+
+private:
+    QVector<int> m_order;       // 按起始位置排序的标记序号
+    QVector<int> m_maxEnd;      // 线段树，各节点为区间内结束位置最大的标记序号
+    int m_size = 0;             // 建立索引时的标记数量
+    bool m_valid = false;       // 索引是否有效
+};
+
+#endif // TEXTMARKINDEX_H
@@ -3,6 +3,8 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 
 #include "detectcode.h"
+#include "utf8scanner.h"
+#include "streamtranscoder.h"
 #include "../common/config.h"
 
 #include <QByteArray>
@@ -165,7 +167,7 @@ QByteArray DetectCode::GetFileEncodingFormat(QString filepath, QByteArray conten
     // uchardet识别编码 若识别率过低, 考虑是否非单字节编码格式。
     if (ucharDetectdRet.contains("unknown") || ucharDetectdRet.contains("ASCII") || ucharDetectdRet.contains("???") ||
         ucharDetectdRet.isEmpty() || chardetconfidence < gs_dMinConfidence) {
-        ucharDetectdRet = DetectCode::UchardetCode(filepath);
+        ucharDetectdRet = filepath.isEmpty() ? DetectCode::UchardetCodeFromData(content) : DetectCode::UchardetCode(filepath);
     }
 
     if (ucharDetectdRet.contains("ASCII")) {
@@ -173,7 +175,11 @@ QByteArray DetectCode::GetFileEncodingFormat(QString filepath, QByteArray conten
         detectRet = Config::instance()->defaultEncoding();
     } else {
         // icu识别编码
-        icuDetectTextEncoding(filepath, icuDetectRetList);
+        if (filepath.isEmpty()) {
+            icuDetectTextEncodingFromData(content, icuDetectRetList);
+        } else {
+            icuDetectTextEncoding(filepath, icuDetectRetList);
+        }
         detectRet = selectCoding(ucharDetectdRet, icuDetectRetList, chardetconfidence);
 
         if (detectRet.contains("ASCII") || detectRet.isEmpty()) {
@@ -220,6 +226,43 @@ QByteArray DetectCode::UchardetCode(QString filepath)
     delete[] buff;
     buff = nullptr;
 
+    return normalizeUchardetCharset(charset);
+}
+
+/**
+ * @brief 使用 uchardet 识别内存数据 \a content 的编码，处理方式同 UchardetCode() ，但不会重新读取文件
+ * @return 识别的编码
+ */
+QByteArray DetectCode::UchardetCodeFromData(const QByteArray &content)
+{
+    static const int s_bufferSize = 0x10000;
+    QByteArray charset;
+    uchardet_t handle = uchardet_new();
+
+    int offset = 0;
+    while (offset < content.size()) {
+        int len = qMin(s_bufferSize, content.size() - offset);
+        int retval = uchardet_handle_data(handle, content.constData() + offset, static_cast<size_t>(len));
+        offset += len;
+        if (retval != 0) {
+            continue;
+        }
+
+        break;
+    }
+
+    uchardet_data_end(handle);
+    charset = uchardet_get_charset(handle);
+    uchardet_delete(handle);
+
+    return normalizeUchardetCharset(charset);
+}
+
+/**
+ * @brief 调整 uchardet 识别的编码名称 \a charset ，转换为 iconv 支持的编码名称
+ */
+QByteArray DetectCode::normalizeUchardetCharset(QByteArray charset)
+{
     if (charset == "MAC-CENTRALEUROPE")
         charset = "MACCENTRALEUROPE";
     if (charset == "MAC-CYRILLIC")
@@ -266,6 +309,26 @@ void DetectCode::icuDetectTextEncoding(const QString &filePath, QByteArrayList &
     fclose(file);
 }
 
+/**
+ * @brief 使用 icu 库识别内存数据 \a content 的编码，处理方式同 icuDetectTextEncoding() ，但不会重新读取文件
+ * @param content       待识别的数据
+ * @param listDetectRet 编码识别结果
+ */
+void DetectCode::icuDetectTextEncodingFromData(const QByteArray &content, QByteArrayList &listDetectRet)
+{
+    static const int s_buffSize = 4096;
+    char *detected = nullptr;
+
+    int offset = 0;
+    while (offset < content.size() && offset <= 1 * 1024 * 1024) {
+        int len = qMin(s_buffSize, content.size() - offset);
+        if (detectTextEncoding(content.constData() + offset, static_cast<size_t>(len), &detected, listDetectRet)) {
+            break;
+        }
+        offset += len;
+    }
+}
+
 /**
  * @author guoshao
  * @brief  detectTextEncoding() icu库编码识别内层函数
@@ -670,6 +733,28 @@ bool checkUTF8ToGB18030Error(char *buf, size_t size, size_t &replaceLen, QByteAr
     }
 }
 
+/**
+ * @brief 编码 \a code 是否兼容 ASCII ，即 ASCII 字符在该编码下与 ASCII 编码一致
+ * @note 不包含 SHIFT_JIS (0x5C/0x7E 映射不同)及 UTF-16/UTF-32 等多字节单元编码
+ */
+static bool isAsciiCompatibleEncoding(const QString &code)
+{
+    static const QStringList sc_asciiCompatible{"UTF-8", "ASCII", "US-ASCII", "GB18030", "GBK", "GB2312",
+                                               "BIG5", "BIG5-HKSCS", "EUC-KR", "EUC-JP", "EUC-TW", "UHC"};
+    static const QStringList sc_asciiCompatiblePrefix{"ISO-8859-", "WINDOWS-125", "CP125", "KOI8-"};
+
+    const QString upperCode = code.toUpper();
+    if (sc_asciiCompatible.contains(upperCode)) {
+        return true;
+    }
+    for (const QString &prefix : sc_asciiCompatiblePrefix) {
+        if (upperCode.startsWith(prefix)) {
+            return true;
+        }
+    }
+    return false;
+}
+
 /**
  * @brief 将输入的字符序列 \a inputStr 从编码 \a fromCode 转换为编码 \a toCode, 并返回转换后的字符序列。
  * @return 字符编码转换是否成功
@@ -689,6 +774,13 @@ bool DetectCode::ChangeFileEncodingFormat(QByteArray &inputStr,
         return true;
     }
 
+    // 纯 ASCII 数据在兼容 ASCII 的编码间转换时内容不变，跳过 iconv 转换及 GB18030 替换处理
+    if (isAsciiCompatibleEncoding(fromCode) && isAsciiCompatibleEncoding(toCode)
+            && Utf8Scanner::isAscii(inputStr.constData(), inputStr.size())) {
+        outStr = inputStr;
+        return true;
+    }
+
 #ifndef DISABLE_TEXTCODEC
     // 使用QTextCodec对部分编码进行处理
     static QStringList codecList{"GB18030"};
@@ -697,132 +789,20 @@ bool DetectCode::ChangeFileEncodingFormat(QByteArray &inputStr,
     }
 #endif
 
-    iconv_t handle = iconv_open(toCode.toLocal8Bit().data(), fromCode.toLocal8Bit().data());
-    if (handle != reinterpret_cast<iconv_t>(-1)) {
-        MibEncoding fromMib = UnknownMib;
-        QTextCodec *fromCodec = QTextCodec::codecForName(fromCode.toUtf8());
-        if (fromCodec) {
-            fromMib = static_cast<MibEncoding>(fromCodec->mibEnum());
-        }
-        // 不使用上层修改的Iconv处理时，不检测转换的编码格式，跳过GB18030转换特殊处理
-        MibEncoding toMib = UnknownMib;
-
-        const bool enablePatchedIconv = Config::instance()->enablePatchedIconv();
-        if (enablePatchedIconv) {
-            QTextCodec *toCodec = QTextCodec::codecForName(toCode.toUtf8());
-            if (toCodec) {
-                toMib = static_cast<MibEncoding>(toCodec->mibEnum());
-            }
-
-            // 替换需手动修改 UTF-8 和 GB180303 编码转换的部分
-            if (GB18030 == fromMib && UTF_8 == toMib) {
-                for (auto itr = gs_ReplaceFromGB18030_2005Error.begin(); itr != gs_ReplaceFromGB18030_2005Error.end(); ++itr) {
-                    inputStr.replace(itr.key(), itr.value());
-                }
-            } else if (UTF_8 == fromMib && GB18030 == toMib) {
-                for (auto itr = gs_ReplaceToGB18030_2020Error.begin(); itr != gs_ReplaceToGB18030_2020Error.end(); ++itr) {
-                    inputStr.replace(itr.key(), itr.value());
-                }
-            }
-        }
-
-        char *inbuf = inputStr.data();
-        size_t inbytesleft = static_cast<size_t>(inputStr.size());
-        size_t outbytesleft = 4 * inbytesleft;
-        char *outbuf = new char[outbytesleft];
-        char *bufferHeader = outbuf;
-        size_t maxBufferSize = outbytesleft;
-
-        memset(outbuf, 0, outbytesleft);
-
-        int errorNum = 0;
+    // 使用流式转换，GB18030 PUA 区域等特殊处理在转换过程中完成，无需对整个输入数据做替换
+    StreamTranscoder transcoder(fromCode, toCode);
+    if (transcoder.isValid()) {
+        // 捕获可能出现的异常
         try {
-            size_t ret = 0;
-            do {
-                ret = iconv(handle, &inbuf, &inbytesleft, &outbuf, &outbytesleft);
-                if (static_cast<size_t>(-1) == ret) {
-                    // 记录错误信息
-                    errorNum = errno;
-
-                    // 遇到错误的输入，错误码 EILSEQ (84)，跳过当前位置并添加'?'
-                    if (EILSEQ == errorNum) {
-                        // 缓冲区不足跳出
-                        if (outbytesleft == 0) {
-                            break;
-                        }
-
-                        size_t replaceLen = 1;
-                        // 跳过错误字符，设置错误字符为'?'
-                        QByteArray appendChar = "?";
-
-                        switch (fromMib) {
-                            case UTF_8: {
-                                // 特殊处理，若为UTF-8 到 GB18030的转换，优先排查异常数据
-                                if (GB18030 == toMib) {
-                                    if (checkUTF8ToGB18030Error(inbuf, inbytesleft, replaceLen, appendChar)) {
-                                        break;
-                                    }
-                                }
-
-                                // 源编码为 UTF-8 时，可计算需跳过的字符数
-                                replaceLen = static_cast<size_t>(utf8MultiByteCount(inbuf, inbytesleft));
-                            } break;
-                            case GB18030:
-                                // 特殊处理，若为GB18030 到 UTF-8 的转换，优先排查异常数据
-                                if (UTF_8 == toMib) {
-                                    if (checkGB18030ToUtf8Error(inbuf, inbytesleft, replaceLen, appendChar)) {
-                                        break;
-                                    }
-                                }
-                                break;
-                            default:
-                                break;
-                        }
-
-                        // 替换错误字符为对应字符
-                        size_t appendSize = static_cast<size_t>(appendChar.size());
-                        if (outbytesleft < appendSize) {
-                            break;
-                        }
-
-                        outbytesleft -= appendSize;
-                        ::memcpy(outbuf, appendChar.data(), appendSize);
-                        outbuf += appendSize;
-
-                        if (inbytesleft <= replaceLen) {
-                            // 移动至末尾
-                            inbuf += inbytesleft;
-                            inbytesleft = 0;
-                            break;
-                        }
-
-                        inbuf += replaceLen;
-                        inbytesleft -= replaceLen;
-                    } else {
-                        break;
-                    }
-                }
-            } while (static_cast<size_t>(-1) == ret);
-
+            transcoder.convert(inputStr, outStr);
+            transcoder.finish(outStr);
         } catch (const std::exception &e) {
             qWarning() << qPrintable("iconv convert encoding catching exception") << qPrintable(e.what());
         }
 
-        if (errorNum) {
-            qWarning() << qPrintable("iconv() convert text encoding error, errocode:") << errorNum;
+        if (transcoder.errorCount() > 0) {
+            qWarning() << qPrintable("iconv() convert text encoding error, invalid sequence count:") << transcoder.errorCount();
         }
-        iconv_close(handle);
-
-        // 手动添加 UTF BOM 信息
-        outStr.append(gs_byteOrderMark.value(toCode));
-
-        // 计算 iconv() 实际转换的字节数
-        size_t realConvertSize = maxBufferSize - outbytesleft;
-        outStr += QByteArray(bufferHeader, static_cast<int>(realConvertSize));
-
-        delete[] bufferHeader;
-        bufferHeader = nullptr;
-
         return true;
 
     } else {
@@ -868,3 +848,74 @@ bool DetectCode::convertEncodingTextCodec(QByteArray &inputStr,
     outStr.append(gs_byteOrderMark.value(toCode));
     return true;
 }
+
+/**
+ * @brief iconv 转换遇到非法字符序列时，取得替换的字符 \a appendChar 及需跳过的字节数 \a replaceLen ，
+ *      默认跳过1字节并替换为'?'，GB18030 与 UTF-8 互转时优先处理 PUA 区域字符
+ */
+void DetectCode::replaceIllegalSequence(int fromMib, int toMib, char *buf, size_t size,
+                                        size_t &replaceLen, QByteArray &appendChar)
+{
+    replaceLen = 1;
+    appendChar = "?";
+
+    switch (fromMib) {
+        case UTF_8: {
+            // 特殊处理，若为UTF-8 到 GB18030的转换，优先排查异常数据
+            if (GB18030 == toMib) {
+                if (checkUTF8ToGB18030Error(buf, size, replaceLen, appendChar)) {
+                    break;
+                }
+            }
+
+            // 源编码为 UTF-8 时，可计算需跳过的字符数
+            replaceLen = static_cast<size_t>(utf8MultiByteCount(buf, size));
+        } break;
+        case GB18030:
+            // 特殊处理，若为GB18030 到 UTF-8 的转换，优先排查异常数据
+            if (UTF_8 == toMib) {
+                checkGB18030ToUtf8Error(buf, size, replaceLen, appendChar);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief GB18030 转换 UTF-8 时，0xFE51 等字符按 GB18030-2005 规范转换为 PUA 区域字符(\uE816 等)
+ * @param gbChar GB18030 双字节字符
+ * @return 转换后的 UTF-8 字符，无需修正时返回空
+ */
+QByteArray DetectCode::patchedGB18030ToUtf8(const char *gbChar)
+{
+    QByteArray replaceFlag = gs_ReplaceFromGB18030_2005Error.value(QByteArray::fromRawData(gbChar, 2));
+    if (replaceFlag.isEmpty()) {
+        return QByteArray();
+    }
+
+    return gs_ReplaceToUTF8_2005Error.key(replaceFlag);
+}
+
+/**
+ * @brief UTF-8 转换 GB18030 时，\u20087 等字符转换为 GB18030-2022 四字节编码(0x95329031 等)，而非 0xFE51
+ * @param utf8Char UTF-8 四字节字符
+ * @return 转换后的 GB18030 字符，无需修正时返回空
+ */
+QByteArray DetectCode::patchedUtf8ToGB18030(const char *utf8Char)
+{
+    QByteArray replaceFlag = gs_ReplaceToGB18030_2020Error.value(QByteArray::fromRawData(utf8Char, 4));
+    if (replaceFlag.isEmpty()) {
+        return QByteArray();
+    }
+
+    return gs_ReplaceFromUtf8_2020Error.key(replaceFlag);
+}
+
+/**
+ * @brief 取得编码 \a code 需手动添加的 BOM 头，仅 UTF-16/UTF-32 编码需要添加
+ */
+QByteArray DetectCode::byteOrderMark(const QString &code)
+{
+    return gs_byteOrderMark.value(code);
+}
@@ -45,14 +45,18 @@ public:
     static int ChartDet_DetectingTextCoding(const char *str, QString &encoding, float &confidence);
     // uchardet 识别文编编码
     static QByteArray UchardetCode(QString filepath);
+    // uchardet 识别内存数据编码，不重复读取文件
+    static QByteArray UchardetCodeFromData(const QByteArray &content);
     // icu库编码识别
     static void icuDetectTextEncoding(const QString &filePath, QByteArrayList &listDetectRet);
+    // icu库识别内存数据编码，不重复读取文件
+    static void icuDetectTextEncodingFromData(const QByteArray &content, QByteArrayList &listDetectRet);
 
     // icu库编码识别内层函数
     static bool detectTextEncoding(const char *data, size_t len, char **detected, QByteArrayList &listDetectRet);
     // 筛选识别出来的编码
     static QByteArray selectCoding(QByteArray ucharDetectdRet, QByteArrayList icuDetectRetList, float confidence);
-    // 获取文件编码方式
+    // 获取文件编码方式，文件路径为空时仅使用传入的数据识别
     static QByteArray GetFileEncodingFormat(QString filepath, QByteArray content = QByteArray(""));
     // 转换文本编码格式
     static bool ChangeFileEncodingFormat(QByteArray &inputStr,
@@ -65,6 +69,20 @@ public:
                                          const QString &fromCode,
                                          const QString &toCode = QString("UTF-8"));
 
+    // iconv 转换遇到非法字符序列时，取得替换的字符及需跳过的字节数，fromMib / toMib 见 QTextCodec::mibEnum()
+    static void replaceIllegalSequence(int fromMib, int toMib, char *buf, size_t size,
+                                       size_t &replaceLen, QByteArray &appendChar);
+    // GB18030-2022 转换修正，取得 GB18030 双字节字符 \a gbChar 按 2005 规范转换的 UTF-8 字符，无需修正时返回空
+    static QByteArray patchedGB18030ToUtf8(const char *gbChar);
+    // GB18030-2022 转换修正，取得 UTF-8 四字节字符 \a utf8Char 对应的 GB18030-2022 编码，无需修正时返回空
+    static QByteArray patchedUtf8ToGB18030(const char *utf8Char);
+    // 取得编码 \a code 需手动添加的 BOM 头
+    static QByteArray byteOrderMark(const QString &code);
+
+private:
+    // 调整 uchardet 识别的编码名称
+    static QByteArray normalizeUchardetCharset(QByteArray charset);
+
 private:
     static QMap<QString, QByteArray> sm_LangsMap;
 };
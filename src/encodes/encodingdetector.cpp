@@ -0,0 +1,314 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "encodingdetector.h"
+#include "detectcode.h"
+#include "utf8scanner.h"
+#include "../common/config.h"
+
+#include <QString>
+
+#include <cstring>
+
+enum DetectParam {
+    EMaxSampleSize = 1024 * 1024,       // 样本数据最大长度
+    EFirstCheckPoint = 16 * 1024,       // 首次 chardet 检查的样本长度，之后每次翻倍
+    EMinUtf8MultiByte = 64,             // 判定为 UTF-8 编码所需的最少多字节字符数量
+};
+
+// 识别率阈值，与 DetectCode 保持一致
+static const float gs_dMinConfidence = 0.9f;
+
+EncodingDetector::EncodingDetector()
+    : m_canceled(0)
+    , m_nextCheckPoint(EFirstCheckPoint)
+{
+}
+
+EncodingDetector::~EncodingDetector()
+{
+}
+
+/**
+ * @brief 追加待识别的数据 \a data ，数据无需按字符边界分割
+ * @return 是否已无需更多数据，返回 true 时可直接调用 finish() 取得结果
+ */
+bool EncodingDetector::feed(const char *data, qint64 len)
+{
+    if (m_done || isCanceled() || !data || len <= 0) {
+        return m_done || isCanceled();
+    }
+
+    // BOM 头标识的编码直接返回
+    if (!m_bomChecked && m_sample.size() + len >= 4) {
+        m_bomChecked = true;
+        QByteArray head = m_sample + QByteArray(data, static_cast<int>(qMin<qint64>(len, 4)));
+        m_result = detectByteOrderMark(head.constData(), head.size());
+        if (!m_result.isEmpty()) {
+            m_done = true;
+            return true;
+        }
+    }
+
+    qint64 appendLen = qMin<qint64>(len, EMaxSampleSize - m_sample.size());
+    updateUtf8State(data, appendLen);
+    m_sample.append(data, static_cast<int>(appendLen));
+
+    // 合法的 UTF-8 多字节数据足够多时，无需继续识别
+    if (m_validUtf8 && m_multiByteCount >= EMinUtf8MultiByte) {
+        m_result = "UTF-8";
+        m_done = true;
+    } else if (m_sample.size() >= EMaxSampleSize) {
+        m_done = true;
+    } else if (!m_allAscii && !m_validUtf8 && m_sample.size() >= m_nextCheckPoint) {
+        m_nextCheckPoint *= 2;
+        m_done = checkConfidence();
+    }
+
+    return m_done;
+}
+
+bool EncodingDetector::feed(const QByteArray &data)
+{
+    return feed(data.constData(), data.size());
+}
+
+/**
+ * @brief 结束识别并返回识别的编码，纯 ASCII 数据返回配置的默认编码
+ * @return 识别的编码(大写)，已取消时返回空
+ */
+QByteArray EncodingDetector::finish()
+{
+    if (isCanceled()) {
+        return QByteArray();
+    }
+    m_done = true;
+
+    // 数据不足4字节时在结束时判断 BOM 头
+    if (m_result.isEmpty() && !m_bomChecked) {
+        m_result = detectByteOrderMark(m_sample.constData(), m_sample.size());
+    }
+
+    if (m_result.isEmpty()) {
+        if (m_sample.isEmpty() || m_allAscii) {
+            // 使用配置的默认文件编码，默认为UTF-8
+            m_result = Config::instance()->defaultEncoding();
+        } else if (m_validUtf8) {
+            // 允许样本末尾存在被截断的 UTF-8 字符
+            m_result = "UTF-8";
+        } else {
+            // 使用已收集的样本进行完整识别，不再读取文件
+            m_result = DetectCode::GetFileEncodingFormat(QString(), m_sample);
+        }
+    }
+
+    return isCanceled() ? QByteArray() : m_result.toUpper();
+}
+
+/**
+ * @brief 重置识别状态，取消标识不会被重置
+ */
+void EncodingDetector::reset()
+{
+    m_result.clear();
+    m_sample.clear();
+    m_done = false;
+    m_bomChecked = false;
+    m_allAscii = true;
+    m_validUtf8 = true;
+    m_utf8Need = 0;
+    m_utf8Lower = 0x80;
+    m_utf8Upper = 0xBF;
+    m_multiByteCount = 0;
+    m_nextCheckPoint = EFirstCheckPoint;
+}
+
+void EncodingDetector::cancel()
+{
+    m_canceled.storeRelease(1);
+}
+
+bool EncodingDetector::isCanceled() const
+{
+    return m_canceled.loadAcquire();
+}
+
+bool EncodingDetector::isDone() const
+{
+    return m_done;
+}
+
+/**
+ * @brief 识别数据 \a content 的编码，按块追加数据，满足条件时提前结束
+ * @param content   待识别的数据
+ * @param maxLength 最多使用的数据长度
+ * @return 识别的编码
+ */
+QByteArray EncodingDetector::detect(const QByteArray &content, int maxLength)
+{
+    static const int s_feedStep = 64 * 1024;
+    EncodingDetector detector;
+
+    int length = qMin(content.size(), maxLength);
+    for (int offset = 0; offset < length; offset += s_feedStep) {
+        if (detector.feed(content.constData() + offset, qMin(s_feedStep, length - offset))) {
+            break;
+        }
+    }
+
+    return detector.finish();
+}
+
+/**
+ * @return 根据数据 \a data 头部的 BOM 信息返回对应的编码，不存在 BOM 时返回空
+ */
+QByteArray EncodingDetector::detectByteOrderMark(const char *data, qint64 len)
+{
+    const uchar *head = reinterpret_cast<const uchar *>(data);
+    if (len >= 3 && 0xEF == head[0] && 0xBB == head[1] && 0xBF == head[2]) {
+        return QByteArray("UTF-8");
+    }
+    if (len >= 4 && 0xFF == head[0] && 0xFE == head[1] && 0x00 == head[2] && 0x00 == head[3]) {
+        return QByteArray("UTF-32LE");
+    }
+    if (len >= 4 && 0x00 == head[0] && 0x00 == head[1] && 0xFE == head[2] && 0xFF == head[3]) {
+        return QByteArray("UTF-32BE");
+    }
+    // UTF-16LE 的 BOM 头与 UTF-32LE 前缀相同，需优先判断 UTF-32LE
+    if (len >= 2 && 0xFF == head[0] && 0xFE == head[1]) {
+        return QByteArray("UTF-16LE");
+    }
+    if (len >= 2 && 0xFE == head[0] && 0xFF == head[1]) {
+        return QByteArray("UTF-16BE");
+    }
+
+    return QByteArray();
+}
+
+/**
+ * @brief 按 UTF-8 编码规则校验数据 \a data ，记录是否全部为 ASCII 字符以及多字节字符数量，
+ *      跨数据块的多字节字符通过 m_utf8Need 延续校验
+ */
+void EncodingDetector::updateUtf8State(const char *data, qint64 len)
+{
+    if (!m_validUtf8) {
+        return;
+    }
+
+    // 包含空字符的数据可能为 UTF-16/UTF-32 编码，需完整识别
+    if (::memchr(data, 0, static_cast<size_t>(len))) {
+        m_allAscii = false;
+        m_validUtf8 = false;
+        return;
+    }
+
+    const uchar *cur = reinterpret_cast<const uchar *>(data);
+    const uchar *end = cur + len;
+    // 延续上一数据块末尾未完成的多字节字符
+    if (m_utf8Need > 0) {
+        const uchar *carryEnd = cur + qMin<qint64>(len, m_utf8Need);
+        scanUtf8Bytes(cur, carryEnd);
+        cur = carryEnd;
+        if (!m_validUtf8 || cur >= end) {
+            return;
+        }
+    }
+
+    // 剩余数据使用向量化实现校验
+    const char *rest = reinterpret_cast<const char *>(cur);
+    qint64 restLen = end - cur;
+    qint64 asciiLen = Utf8Scanner::asciiPrefixLength(rest, restLen);
+    if (asciiLen == restLen) {
+        return;
+    }
+
+    m_allAscii = false;
+    qint64 incompleteTail = 0;
+    if (!Utf8Scanner::isValidUtf8(rest + asciiLen, restLen - asciiLen, &incompleteTail)) {
+        m_validUtf8 = false;
+        return;
+    }
+    m_multiByteCount += Utf8Scanner::countLeadBytes(rest + asciiLen, restLen - asciiLen - incompleteTail);
+
+    // 记录末尾被截断字符的校验状态
+    scanUtf8Bytes(end - incompleteTail, end);
+}
+
+/**
+ * @brief 逐字节校验 UTF-8 数据 [\a cur, \a end) ，校验状态保存在 m_utf8Need 等成员中
+ */
+void EncodingDetector::scanUtf8Bytes(const uchar *cur, const uchar *end)
+{
+    for (; cur < end; ++cur) {
+        uchar ch = *cur;
+        if (m_utf8Need > 0) {
+            if (ch < m_utf8Lower || ch > m_utf8Upper) {
+                m_validUtf8 = false;
+                return;
+            }
+
+            m_utf8Lower = 0x80;
+            m_utf8Upper = 0xBF;
+            if (0 == --m_utf8Need) {
+                ++m_multiByteCount;
+            }
+            continue;
+        }
+
+        if (ch < 0x80) {
+            // 包含空字符的数据可能为 UTF-16/UTF-32 编码，需完整识别
+            if (0 == ch) {
+                m_allAscii = false;
+                m_validUtf8 = false;
+                return;
+            }
+            continue;
+        }
+
+        m_allAscii = false;
+        if (ch >= 0xC2 && ch <= 0xDF) {
+            m_utf8Need = 1;
+        } else if (ch >= 0xE0 && ch <= 0xEF) {
+            m_utf8Need = 2;
+            // 排除超长编码及代理区字符
+            if (0xE0 == ch) {
+                m_utf8Lower = 0xA0;
+            } else if (0xED == ch) {
+                m_utf8Upper = 0x9F;
+            }
+        } else if (ch >= 0xF0 && ch <= 0xF4) {
+            m_utf8Need = 3;
+            if (0xF0 == ch) {
+                m_utf8Lower = 0x90;
+            } else if (0xF4 == ch) {
+                m_utf8Upper = 0x8F;
+            }
+        } else {
+            m_validUtf8 = false;
+            return;
+        }
+    }
+}
+
+/**
+ * @brief 使用 chardet 识别当前样本数据，识别率达到阈值时记录识别结果，无需继续追加数据，
+ *      finish() 直接返回该结果，不再重复识别
+ * @return 识别率是否达到阈值
+ */
+bool EncodingDetector::checkConfidence()
+{
+    QString encoding;
+    float confidence = 0.0f;
+    DetectCode::ChartDet_DetectingTextCoding(m_sample.constData(), encoding, confidence);
+
+    if (confidence >= gs_dMinConfidence
+            && !encoding.isEmpty()
+            && !encoding.contains("ASCII", Qt::CaseInsensitive)
+            && !encoding.contains("unknown", Qt::CaseInsensitive)) {
+        m_result = encoding.toLatin1();
+        return true;
+    }
+
+    return false;
+}
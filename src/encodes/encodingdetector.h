@@ -0,0 +1,68 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef ENCODINGDETECTOR_H
+#define ENCODINGDETECTOR_H
+
+#include <QByteArray>
+#include <QAtomicInt>
+
+/**
+ * @brief 增量编码识别，从已读取的数据中逐块识别文本编码，不会重新读取文件。
+ *      BOM 头及纯 ASCII 数据直接返回结果；合法的 UTF-8 多字节数据达到一定数量后提前结束；
+ *      其它编码在样本数据达到检查点时使用 chardet 识别，识别率达到阈值后不再追加数据并直接使用该结果，
+ *      否则最终由 DetectCode::GetFileEncodingFormat() 对已收集的样本数据进行完整的识别。
+ *      cancel() 可在其它线程调用，用于关闭标签页等情况中止识别。
+ */
+class EncodingDetector
+{
+public:
+    EncodingDetector();
+    ~EncodingDetector();
+
+    // 追加待识别的数据，返回是否已无需更多数据
+    bool feed(const char *data, qint64 len);
+    bool feed(const QByteArray &data);
+    // 结束识别并返回识别的编码，已取消时返回空
+    QByteArray finish();
+    // 重置识别状态
+    void reset();
+
+    // 取消识别，线程安全
+    void cancel();
+    bool isCanceled() const;
+    // 是否已无需更多数据
+    bool isDone() const;
+
+    // 识别数据 content 的编码，最多使用 maxLength 长度的数据
+    static QByteArray detect(const QByteArray &content, int maxLength = 1024 * 1024);
+
+private:
+    // 识别 BOM 头
+    static QByteArray detectByteOrderMark(const char *data, qint64 len);
+    // 更新 UTF-8 及 ASCII 校验状态
+    void updateUtf8State(const char *data, qint64 len);
+    // 逐字节校验 UTF-8 数据，用于跨数据块的多字节字符
+    void scanUtf8Bytes(const uchar *cur, const uchar *end);
+    // 样本达到检查点时使用 chardet 判断识别率，达到阈值时记录识别结果
+    bool checkConfidence();
+
+private:
+    Q_DISABLE_COPY(EncodingDetector)
+
+    QAtomicInt m_canceled;              // 取消标识
+    QByteArray m_result;                // 已确定的编码
+    QByteArray m_sample;                // 样本数据
+    bool m_done = false;                // 是否已无需更多数据
+    bool m_bomChecked = false;          // 是否已判断 BOM 头
+    bool m_allAscii = true;             // 是否全部为 ASCII 字符
+    bool m_validUtf8 = true;            // 是否为合法的 UTF-8 数据
+    int m_utf8Need = 0;                 // 当前 UTF-8 字符还需要的后续字节数
+    uchar m_utf8Lower = 0x80;           // 下一后续字节的最小值
+    uchar m_utf8Upper = 0xBF;           // 下一后续字节的最大值
+    qint64 m_multiByteCount = 0;        // UTF-8 多字节字符数量
+    int m_nextCheckPoint = 0;           // 下次 chardet 检查的样本长度
+};
+
+#endif // ENCODINGDETECTOR_H
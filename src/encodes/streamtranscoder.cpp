@@ -0,0 +1,307 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "streamtranscoder.h"
+#include "detectcode.h"
+#include "../common/config.h"
+
+#include <QTextCodec>
+
+#include <cerrno>
+#include <cstring>
+
+enum TranscodeParam {
+    EOutputBufferSize = 64 * 1024,  // iconv 输出缓冲区长度
+    EMaxJoinLen = 16,               // 补全上一数据块末尾字符时，从当前数据块取得的最大长度
+    EPatchGB18030Len = 2,           // 需特殊处理的 GB18030 字符长度
+    EPatchUtf8Len = 4,              // 需特殊处理的 UTF-8 字符长度
+};
+
+// 见QTextCodec::mibEnum()
+static const int sc_utf8Mib = 106;
+static const int sc_gb18030Mib = 114;
+
+/**
+ * @brief 取得编码 \a code 的 MIB 值，未知编码返回0
+ */
+static int encodingMib(const QString &code)
+{
+    QTextCodec *codec = QTextCodec::codecForName(code.toUtf8());
+    return codec ? codec->mibEnum() : 0;
+}
+
+StreamTranscoder::StreamTranscoder(const QString &fromCode, const QString &toCode)
+    : m_handle(iconv_open(toCode.toLocal8Bit().data(), fromCode.toLocal8Bit().data()))
+    , m_toCode(toCode)
+{
+    if (!isValid()) {
+        return;
+    }
+
+    m_fromMib = encodingMib(fromCode);
+    // 不使用上层修改的Iconv处理时，不检测转换的编码格式，跳过GB18030转换特殊处理
+    if (Config::instance()->enablePatchedIconv()) {
+        m_toMib = encodingMib(toCode);
+
+        if (sc_gb18030Mib == m_fromMib && sc_utf8Mib == m_toMib) {
+            m_patchMode = FromGB18030Patch;
+        } else if (sc_utf8Mib == m_fromMib && sc_gb18030Mib == m_toMib) {
+            m_patchMode = ToGB18030Patch;
+        }
+    }
+
+    m_buffer.resize(EOutputBufferSize);
+}
+
+StreamTranscoder::~StreamTranscoder()
+{
+    if (isValid()) {
+        iconv_close(m_handle);
+    }
+}
+
+bool StreamTranscoder::isValid() const
+{
+    return m_handle != reinterpret_cast<iconv_t>(-1);
+}
+
+/**
+ * @brief 转换数据块 \a data ，结果追加到 \a out 。数据块无需按字符边界分割，
+ *      末尾不完整的字符保留到下一次调用 convert() 或 finish() 时处理
+ * @return 是否转换成功
+ */
+bool StreamTranscoder::convert(const char *data, qint64 len, QByteArray &out)
+{
+    if (!isValid()) {
+        return false;
+    }
+    if (!data || len <= 0) {
+        return true;
+    }
+
+    appendByteOrderMark(out);
+
+    // 先使用当前数据块头部数据补全上一数据块末尾的字符，避免拷贝整个数据块
+    if (!m_pending.isEmpty()) {
+        const qint64 pendingLen = m_pending.size();
+        const qint64 headLen = qMin<qint64>(len, EMaxJoinLen);
+        QByteArray head = m_pending + QByteArray::fromRawData(data, static_cast<int>(headLen));
+        m_pending.clear();
+
+        qint64 consumed = process(head.constData(), head.size(), out, false);
+        if (consumed < pendingLen) {
+            // 数据仍不足以补全字符
+            m_pending = head.mid(static_cast<int>(consumed));
+            if (headLen == len) {
+                return true;
+            }
+
+            m_pending.append(data + headLen, static_cast<int>(len - headLen));
+            QByteArray joined = m_pending;
+            m_pending.clear();
+            consumed = process(joined.constData(), joined.size(), out, false);
+            m_pending = joined.mid(static_cast<int>(consumed));
+            return true;
+        }
+
+        data += consumed - pendingLen;
+        len -= consumed - pendingLen;
+    }
+
+    qint64 consumed = process(data, len, out, false);
+    if (consumed < len) {
+        m_pending = QByteArray(data + consumed, static_cast<int>(len - consumed));
+    }
+    return true;
+}
+
+bool StreamTranscoder::convert(const QByteArray &data, QByteArray &out)
+{
+    return convert(data.constData(), data.size(), out);
+}
+
+/**
+ * @brief 结束转换，剩余的不完整字符替换为'?'，输出状态编码的复位序列后重置转换状态。
+ *      未输出任何数据(空文档)时同样添加 BOM 头
+ * @return 是否转换成功
+ */
+bool StreamTranscoder::finish(QByteArray &out)
+{
+    if (!isValid()) {
+        return false;
+    }
+
+    appendByteOrderMark(out);
+
+    if (!m_pending.isEmpty()) {
+        QByteArray pending = m_pending;
+        m_pending.clear();
+        process(pending.constData(), pending.size(), out, true);
+    }
+
+    // 有状态的编码(如 ISO-2022-JP)需输出复位序列
+    char *outbuf = m_buffer.data();
+    size_t outbytesleft = static_cast<size_t>(m_buffer.size());
+    if (static_cast<size_t>(-1) != iconv(m_handle, nullptr, nullptr, &outbuf, &outbytesleft)) {
+        out.append(m_buffer.constData(), m_buffer.size() - static_cast<int>(outbytesleft));
+    }
+
+    reset();
+    return true;
+}
+
+/**
+ * @brief 重置转换状态，丢弃未处理的数据，之后的转换重新添加 BOM 头
+ */
+void StreamTranscoder::reset()
+{
+    m_pending.clear();
+    m_bomWritten = false;
+    if (isValid()) {
+        iconv(m_handle, nullptr, nullptr, nullptr, nullptr);
+    }
+}
+
+qint64 StreamTranscoder::pendingSize() const
+{
+    return m_pending.size();
+}
+
+int StreamTranscoder::errorCount() const
+{
+    return m_errorCount;
+}
+
+/**
+ * @brief 转换数据 \a data ，GB18030 与 UTF-8 互转时查找可能需要特殊处理的字符(首字节 0xFE / 0xF0)，
+ *      其余数据分段交由 iconv 转换。
+ *      GB18030 的 0xFE 可能为多字节字符的后续字节，iconv 在该位置前报告不完整字符时，
+ *      说明其不在字符边界上，继续向后查找。
+ * @param flush 是否为最后的数据，为 true 时不完整的字符被替换
+ * @return 已处理的数据长度，剩余数据为末尾不完整的字符
+ */
+qint64 StreamTranscoder::process(const char *data, qint64 len, QByteArray &out, bool flush)
+{
+    if (NoPatch == m_patchMode) {
+        return iconvSegment(data, len, out, flush);
+    }
+
+    const int leadByte = FromGB18030Patch == m_patchMode ? 0xFE : 0xF0;
+    const qint64 patchLen = FromGB18030Patch == m_patchMode ? EPatchGB18030Len : EPatchUtf8Len;
+    qint64 convertPos = 0;
+    qint64 searchPos = 0;
+
+    while (true) {
+        const void *found = ::memchr(data + searchPos, leadByte, static_cast<size_t>(len - searchPos));
+        const qint64 candidate = found ? static_cast<const char *>(found) - data : len;
+
+        const bool lastSegment = candidate >= len;
+        qint64 pos = convertPos + iconvSegment(data + convertPos, candidate - convertPos, out, flush && lastSegment);
+        if (pos < candidate) {
+            if (lastSegment) {
+                return pos;
+            }
+
+            // 候选字节为多字节字符的一部分
+            convertPos = pos;
+            searchPos = candidate + 1;
+            continue;
+        }
+
+        if (lastSegment) {
+            return len;
+        }
+
+        if (len - candidate < patchLen) {
+            if (!flush) {
+                // 等待后续数据
+                return candidate;
+            }
+
+            convertPos = candidate;
+            searchPos = len;
+            continue;
+        }
+
+        QByteArray replaceChar = FromGB18030Patch == m_patchMode ? DetectCode::patchedGB18030ToUtf8(data + candidate)
+                                                                 : DetectCode::patchedUtf8ToGB18030(data + candidate);
+        if (replaceChar.isEmpty()) {
+            convertPos = candidate;
+            searchPos = candidate + 1;
+        } else {
+            out.append(replaceChar);
+            convertPos = candidate + patchLen;
+            searchPos = convertPos;
+        }
+    }
+}
+
+/**
+ * @brief 使用 iconv 转换数据 \a data ，输出通过固定长度的缓冲区追加到 \a out 。
+ *      非法字符按 DetectCode::replaceIllegalSequence() 替换
+ * @param flush 是否为最后的数据，为 true 时末尾不完整的字符替换为'?'
+ * @return 已处理的数据长度，未处理的数据为末尾不完整的字符
+ */
+qint64 StreamTranscoder::iconvSegment(const char *data, qint64 len, QByteArray &out, bool flush)
+{
+    char *inbuf = const_cast<char *>(data);
+    size_t inbytesleft = static_cast<size_t>(len);
+
+    while (inbytesleft > 0) {
+        char *outbuf = m_buffer.data();
+        size_t outbytesleft = static_cast<size_t>(m_buffer.size());
+
+        size_t ret = iconv(m_handle, &inbuf, &inbytesleft, &outbuf, &outbytesleft);
+        const int errorNum = errno;
+        const int outLen = m_buffer.size() - static_cast<int>(outbytesleft);
+        out.append(m_buffer.constData(), outLen);
+
+        if (static_cast<size_t>(-1) != ret) {
+            break;
+        }
+
+        if (E2BIG == errorNum) {
+            // 输出缓冲区已满，继续转换
+            if (0 == outLen) {
+                break;
+            }
+            continue;
+        }
+
+        if (EILSEQ == errorNum) {
+            // 遇到错误的输入，跳过当前位置并添加替换字符
+            size_t replaceLen = 1;
+            QByteArray appendChar;
+            DetectCode::replaceIllegalSequence(m_fromMib, m_toMib, inbuf, inbytesleft, replaceLen, appendChar);
+            replaceLen = qBound<size_t>(1, replaceLen, inbytesleft);
+
+            out.append(appendChar);
+            inbuf += replaceLen;
+            inbytesleft -= replaceLen;
+            ++m_errorCount;
+            continue;
+        }
+
+        if (EINVAL == errorNum && !flush) {
+            // 末尾字符不完整，等待后续数据
+            break;
+        }
+
+        // 最后的数据仍不完整或其它错误，替换剩余数据
+        out.append('?');
+        inbuf += inbytesleft;
+        inbytesleft = 0;
+        ++m_errorCount;
+    }
+
+    return inbuf - data;
+}
+
+void StreamTranscoder::appendByteOrderMark(QByteArray &out)
+{
+    if (!m_bomWritten) {
+        m_bomWritten = true;
+        out.append(DetectCode::byteOrderMark(m_toCode));
+    }
+}
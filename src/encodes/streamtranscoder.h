@@ -0,0 +1,70 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef STREAMTRANSCODER_H
+#define STREAMTRANSCODER_H
+
+#include <QString>
+#include <QByteArray>
+
+#include <iconv.h>
+
+/**
+ * @brief 流式编码转换，可分多次传入任意长度的数据块进行转换。
+ *      数据块末尾不完整的多字节字符保留到下一次转换，GB18030-2022 与 UTF-8 互转的特殊字符
+ *      在转换过程中直接替换，无需对整个输入数据预先处理；转换输出通过固定长度的缓冲区追加，
+ *      内存占用与数据块长度相关。
+ *      目标编码为 UTF-16/UTF-32 时，与 DetectCode::ChangeFileEncodingFormat() 一致，在首次输出前添加 BOM 头。
+ */
+class StreamTranscoder
+{
+public:
+    StreamTranscoder(const QString &fromCode, const QString &toCode);
+    ~StreamTranscoder();
+
+    // iconv 是否支持当前转换
+    bool isValid() const;
+    // 转换数据块 data ，结果追加到 out ，末尾不完整的字符保留到下一次转换
+    bool convert(const char *data, qint64 len, QByteArray &out);
+    bool convert(const QByteArray &data, QByteArray &out);
+    // 结束转换，剩余的不完整字符替换为'?'，并重置转换状态，未添加 BOM 头时在此添加
+    bool finish(QByteArray &out);
+    // 重置转换状态，丢弃剩余数据
+    void reset();
+
+    // 等待后续数据的不完整字符长度
+    qint64 pendingSize() const;
+    // 转换过程中被替换的非法字符数量
+    int errorCount() const;
+
+private:
+    // 转换数据，执行 GB18030 特殊字符替换，返回已处理的数据长度
+    qint64 process(const char *data, qint64 len, QByteArray &out, bool flush);
+    // 使用 iconv 转换数据，遇到不完整字符时返回已处理的数据长度
+    qint64 iconvSegment(const char *data, qint64 len, QByteArray &out, bool flush);
+    // 首次输出前添加 BOM 头
+    void appendByteOrderMark(QByteArray &out);
+
+private:
+    Q_DISABLE_COPY(StreamTranscoder)
+
+    // GB18030-2022 特殊字符处理方式
+    enum PatchMode {
+        NoPatch,            // 无需处理
+        FromGB18030Patch,   // GB18030 转换 UTF-8
+        ToGB18030Patch,     // UTF-8 转换 GB18030
+    };
+
+    iconv_t m_handle;                   // iconv 转换句柄
+    QString m_toCode;                   // 目标编码
+    int m_fromMib = 0;                  // 源编码 MIB
+    int m_toMib = 0;                    // 目标编码 MIB
+    PatchMode m_patchMode = NoPatch;    // 特殊字符处理方式
+    QByteArray m_pending;               // 上一数据块末尾不完整的字符
+    QByteArray m_buffer;                // iconv 输出缓冲区
+    bool m_bomWritten = false;          // 是否已添加 BOM 头
+    int m_errorCount = 0;               // 被替换的非法字符数量
+};
+
+#endif // STREAMTRANSCODER_H
@@ -0,0 +1,486 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "utf8scanner.h"
+
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define UTF8SCANNER_X86
+#include <immintrin.h>
+#endif
+
+namespace {
+
+#ifdef UTF8SCANNER_X86
+
+/*
+ * UTF-8 向量化校验，参考 Keiser & Lemire, "Validating UTF-8 In Less Than One Instruction Per Byte"。
+ * 通过前一字节的高、低4位及当前字节的高4位查表，三个表结果按位与后非零即存在编码错误；
+ * 3字节及4字节字符的第3、4字节是否必须为后续字节通过 prev2 / prev3 单独判断。
+ */
+enum Utf8ErrorFlag {
+    TOO_SHORT = 1 << 0,         // 11______ 0_______ 或 11______ 11______
+    TOO_LONG = 1 << 1,          // 0_______ 10______
+    OVERLONG_3 = 1 << 2,        // 11100000 100_____
+    TOO_LARGE = 1 << 3,         // 11110100 1001____ 等超出 U+10FFFF 的字符
+    SURROGATE = 1 << 4,         // 11101101 101_____
+    OVERLONG_2 = 1 << 5,        // 1100000_ 10______
+    TOO_LARGE_1000 = 1 << 6,    // 11110101 1000____ 等
+    OVERLONG_4 = 1 << 6,        // 11110000 1000____
+    TWO_CONTS = 1 << 7,         // 10______ 10______
+    CARRY = TOO_SHORT | TOO_LONG | TWO_CONTS,
+};
+
+#define U8(x) static_cast<char>(x)
+
+// 前一字节高4位查找表
+#define UTF8_BYTE_1_HIGH_TABLE \
+    U8(TOO_LONG), U8(TOO_LONG), U8(TOO_LONG), U8(TOO_LONG), \
+    U8(TOO_LONG), U8(TOO_LONG), U8(TOO_LONG), U8(TOO_LONG), \
+    U8(TWO_CONTS), U8(TWO_CONTS), U8(TWO_CONTS), U8(TWO_CONTS), \
+    U8(TOO_SHORT | OVERLONG_2), \
+    U8(TOO_SHORT), \
+    U8(TOO_SHORT | OVERLONG_3 | SURROGATE), \
+    U8(TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4)
+
+// 前一字节低4位查找表
+#define UTF8_BYTE_1_LOW_TABLE \
+    U8(CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4), \
+    U8(CARRY | OVERLONG_2), \
+    U8(CARRY), \
+    U8(CARRY), \
+    U8(CARRY | TOO_LARGE), \
+    U8(CARRY | TOO_LARGE | TOO_LARGE_1000), \
+    U8(CARRY | TOO_LARGE | TOO_LARGE_1000), \
+    U8(CARRY | TOO_LARGE | TOO_LARGE_1000), \
+    U8(CARRY | TOO_LARGE | TOO_LARGE_1000), \
+    U8(CARRY | TOO_LARGE | TOO_LARGE_1000), \
+    U8(CARRY | TOO_LARGE | TOO_LARGE_1000), \
+    U8(CARRY | TOO_LARGE | TOO_LARGE_1000), \
+    U8(CARRY | TOO_LARGE | TOO_LARGE_1000), \
+    U8(CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE), \
+    U8(CARRY | TOO_LARGE | TOO_LARGE_1000), \
+    U8(CARRY | TOO_LARGE | TOO_LARGE_1000)
+
+// 当前字节高4位查找表
+#define UTF8_BYTE_2_HIGH_TABLE \
+    U8(TOO_SHORT), U8(TOO_SHORT), U8(TOO_SHORT), U8(TOO_SHORT), \
+    U8(TOO_SHORT), U8(TOO_SHORT), U8(TOO_SHORT), U8(TOO_SHORT), \
+    U8(TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 | OVERLONG_4), \
+    U8(TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE), \
+    U8(TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE), \
+    U8(TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE), \
+    U8(TOO_SHORT), U8(TOO_SHORT), U8(TOO_SHORT), U8(TOO_SHORT)
+
+// 末尾字节为未完成字符首字节时的最大合法值(向量最后3个字节)
+#define UTF8_INCOMPLETE_MAX_TAIL U8(0xF0 - 1), U8(0xE0 - 1), U8(0xC0 - 1)
+
+enum SimdLevel {
+    LevelScalar = Utf8Scanner::Scalar,
+    LevelSse = Utf8Scanner::SSE,
+    LevelAvx2 = Utf8Scanner::AVX2,
+};
+
+/**
+ * @brief 运行时检测 CPU 支持的指令集
+ */
+int detectSimdLevel()
+{
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return LevelAvx2;
+    }
+    if (__builtin_cpu_supports("ssse3")) {
+        return LevelSse;
+    }
+    return LevelScalar;
+}
+
+int simdLevel()
+{
+    static const int s_level = detectSimdLevel();
+    return s_level;
+}
+
+__attribute__((target("sse2")))
+qint64 asciiPrefixSse2(const char *data, qint64 len)
+{
+    qint64 i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i input = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+        int mask = _mm_movemask_epi8(input);
+        if (mask) {
+            return i + __builtin_ctz(static_cast<unsigned>(mask));
+        }
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+qint64 asciiPrefixAvx2(const char *data, qint64 len)
+{
+    qint64 i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i input = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+        int mask = _mm256_movemask_epi8(input);
+        if (mask) {
+            return i + __builtin_ctz(static_cast<unsigned>(mask));
+        }
+    }
+    return i;
+}
+
+/**
+ * @brief SSE2 统计首字节数量，匹配的字节置 1 后用 _mm_sad_epu8 横向求和，
+ *      不依赖 POPCNT 指令(部分支持 SSSE3 的 CPU 不支持 POPCNT)
+ */
+__attribute__((target("sse2")))
+qint64 countLeadBytesSse2(const char *data, qint64 len, qint64 *checked)
+{
+    const __m128i lowBound = _mm_set1_epi8(U8(0xC0 - 1));
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi8(1);
+    __m128i sum = _mm_setzero_si128();
+    qint64 i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i input = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+        // 有符号比较：0xC0~0xFF 对应 -64~-1
+        __m128i lead = _mm_and_si128(_mm_cmpgt_epi8(input, lowBound), _mm_cmplt_epi8(input, zero));
+        // 两个64位累加值，每次最多增加8，不会溢出
+        sum = _mm_add_epi64(sum, _mm_sad_epu8(_mm_and_si128(lead, one), zero));
+    }
+    *checked = i;
+    quint64 lanes[2];
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(lanes), sum);
+    return static_cast<qint64>(lanes[0] + lanes[1]);
+}
+
+/**
+ * @brief SSSE3 校验 UTF-8 数据，仅处理完整的16字节数据块
+ * @param checked 返回已处理的数据长度，末尾被截断的字符不视为错误，由调用方继续处理
+ * @return 已处理的数据是否存在编码错误
+ */
+__attribute__((target("ssse3")))
+bool validateSsse3(const char *data, qint64 len, qint64 *checked)
+{
+    const __m128i byte1HighTable = _mm_setr_epi8(UTF8_BYTE_1_HIGH_TABLE);
+    const __m128i byte1LowTable = _mm_setr_epi8(UTF8_BYTE_1_LOW_TABLE);
+    const __m128i byte2HighTable = _mm_setr_epi8(UTF8_BYTE_2_HIGH_TABLE);
+    const __m128i incompleteMax = _mm_setr_epi8(U8(0xFF), U8(0xFF), U8(0xFF), U8(0xFF), U8(0xFF), U8(0xFF), U8(0xFF), U8(0xFF),
+                                                U8(0xFF), U8(0xFF), U8(0xFF), U8(0xFF), U8(0xFF), UTF8_INCOMPLETE_MAX_TAIL);
+    const __m128i low4 = _mm_set1_epi8(0x0F);
+    const __m128i thirdByte = _mm_set1_epi8(U8(0xE0 - 0x80));
+    const __m128i fourthByte = _mm_set1_epi8(U8(0xF0 - 0x80));
+    const __m128i highBit = _mm_set1_epi8(U8(0x80));
+
+    __m128i prev = _mm_setzero_si128();
+    __m128i prevIncomplete = _mm_setzero_si128();
+    __m128i error = _mm_setzero_si128();
+
+    qint64 i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i input = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+        if (0 == _mm_movemask_epi8(input)) {
+            // 纯 ASCII 数据块，仅需判断上一数据块末尾是否存在未完成的字符
+            error = _mm_or_si128(error, prevIncomplete);
+            prevIncomplete = _mm_setzero_si128();
+        } else {
+            __m128i prev1 = _mm_alignr_epi8(input, prev, 15);
+            __m128i byte1High = _mm_shuffle_epi8(byte1HighTable, _mm_and_si128(_mm_srli_epi16(prev1, 4), low4));
+            __m128i byte1Low = _mm_shuffle_epi8(byte1LowTable, _mm_and_si128(prev1, low4));
+            __m128i byte2High = _mm_shuffle_epi8(byte2HighTable, _mm_and_si128(_mm_srli_epi16(input, 4), low4));
+            __m128i special = _mm_and_si128(_mm_and_si128(byte1High, byte1Low), byte2High);
+
+            __m128i prev2 = _mm_alignr_epi8(input, prev, 14);
+            __m128i prev3 = _mm_alignr_epi8(input, prev, 13);
+            __m128i must23 = _mm_or_si128(_mm_subs_epu8(prev2, thirdByte), _mm_subs_epu8(prev3, fourthByte));
+            error = _mm_or_si128(error, _mm_xor_si128(_mm_and_si128(must23, highBit), special));
+            prevIncomplete = _mm_subs_epu8(input, incompleteMax);
+        }
+        prev = input;
+
+        // 每处理64KB数据检查一次错误，无效数据提前退出
+        if (0 == (i & 0xFFFF) && 0xFFFF != _mm_movemask_epi8(_mm_cmpeq_epi8(error, _mm_setzero_si128()))) {
+            *checked = i + 16;
+            return false;
+        }
+    }
+
+    *checked = i;
+    return 0xFFFF == _mm_movemask_epi8(_mm_cmpeq_epi8(error, _mm_setzero_si128()));
+}
+
+/**
+ * @brief AVX2 校验 UTF-8 数据，处理方式同 validateSsse3() ，每次处理32字节
+ */
+__attribute__((target("avx2")))
+bool validateAvx2(const char *data, qint64 len, qint64 *checked)
+{
+    const __m256i byte1HighTable = _mm256_setr_epi8(UTF8_BYTE_1_HIGH_TABLE, UTF8_BYTE_1_HIGH_TABLE);
+    const __m256i byte1LowTable = _mm256_setr_epi8(UTF8_BYTE_1_LOW_TABLE, UTF8_BYTE_1_LOW_TABLE);
+    const __m256i byte2HighTable = _mm256_setr_epi8(UTF8_BYTE_2_HIGH_TABLE, UTF8_BYTE_2_HIGH_TABLE);
+    const __m256i incompleteMax = _mm256_setr_epi8(U8(0xFF), U8(0xFF), U8(0xFF), U8(0xFF), U8(0xFF), U8(0xFF), U8(0xFF), U8(0xFF),
+                                                   U8(0xFF), U8(0xFF), U8(0xFF), U8(0xFF), U8(0xFF), U8(0xFF), U8(0xFF), U8(0xFF),
+                                                   U8(0xFF), U8(0xFF), U8(0xFF), U8(0xFF), U8(0xFF), U8(0xFF), U8(0xFF), U8(0xFF),
+                                                   U8(0xFF), U8(0xFF), U8(0xFF), U8(0xFF), U8(0xFF), UTF8_INCOMPLETE_MAX_TAIL);
+    const __m256i low4 = _mm256_set1_epi8(0x0F);
+    const __m256i thirdByte = _mm256_set1_epi8(U8(0xE0 - 0x80));
+    const __m256i fourthByte = _mm256_set1_epi8(U8(0xF0 - 0x80));
+    const __m256i highBit = _mm256_set1_epi8(U8(0x80));
+
+    __m256i prev = _mm256_setzero_si256();
+    __m256i prevIncomplete = _mm256_setzero_si256();
+    __m256i error = _mm256_setzero_si256();
+
+    qint64 i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i input = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+        if (0 == _mm256_movemask_epi8(input)) {
+            error = _mm256_or_si256(error, prevIncomplete);
+            prevIncomplete = _mm256_setzero_si256();
+        } else {
+            // AVX2 的 alignr 按128位分别处理，需拼接跨通道的数据
+            __m256i shifted = _mm256_permute2x128_si256(prev, input, 0x21);
+            __m256i prev1 = _mm256_alignr_epi8(input, shifted, 15);
+            __m256i byte1High = _mm256_shuffle_epi8(byte1HighTable, _mm256_and_si256(_mm256_srli_epi16(prev1, 4), low4));
+            __m256i byte1Low = _mm256_shuffle_epi8(byte1LowTable, _mm256_and_si256(prev1, low4));
+            __m256i byte2High = _mm256_shuffle_epi8(byte2HighTable, _mm256_and_si256(_mm256_srli_epi16(input, 4), low4));
+            __m256i special = _mm256_and_si256(_mm256_and_si256(byte1High, byte1Low), byte2High);
+
+            __m256i prev2 = _mm256_alignr_epi8(input, shifted, 14);
+            __m256i prev3 = _mm256_alignr_epi8(input, shifted, 13);
+            __m256i must23 = _mm256_or_si256(_mm256_subs_epu8(prev2, thirdByte), _mm256_subs_epu8(prev3, fourthByte));
+            error = _mm256_or_si256(error, _mm256_xor_si256(_mm256_and_si256(must23, highBit), special));
+            prevIncomplete = _mm256_subs_epu8(input, incompleteMax);
+        }
+        prev = input;
+
+        if (0 == (i & 0xFFFF) && !_mm256_testz_si256(error, error)) {
+            *checked = i + 32;
+            return false;
+        }
+    }
+
+    *checked = i;
+    return _mm256_testz_si256(error, error);
+}
+
+#undef U8
+
+#endif // UTF8SCANNER_X86
+
+// 按字处理时判断 ASCII 的掩码
+const quint64 s_nonAsciiMask = Q_UINT64_C(0x8080808080808080);
+
+} // namespace
+
+qint64 Utf8Scanner::asciiPrefixLength(const char *data, qint64 len)
+{
+    if (!data || len <= 0) {
+        return 0;
+    }
+
+    qint64 pos = 0;
+#ifdef UTF8SCANNER_X86
+    if (LevelAvx2 == simdLevel()) {
+        pos = asciiPrefixAvx2(data, len);
+    } else {
+        pos = asciiPrefixSse2(data, len);
+    }
+#endif
+    return pos + asciiPrefixLengthScalar(data + pos, len - pos);
+}
+
+bool Utf8Scanner::isAscii(const char *data, qint64 len)
+{
+    return asciiPrefixLength(data, len) == qMax<qint64>(0, len);
+}
+
+/**
+ * @brief 校验数据 \a data 是否为合法的 UTF-8 编码，不允许超长编码、代理区字符及超出 U+10FFFF 的字符
+ * @param data              待校验数据
+ * @param len               数据长度
+ * @param incompleteTail    不为空时允许末尾存在被截断的字符，返回截断部分的字节数
+ * @return 是否为合法的 UTF-8 数据
+ */
+bool Utf8Scanner::isValidUtf8(const char *data, qint64 len, qint64 *incompleteTail)
+{
+    if (incompleteTail) {
+        *incompleteTail = 0;
+    }
+    if (!data || len <= 0) {
+        return true;
+    }
+
+    // 跳过头部 ASCII 数据
+    qint64 asciiLen = asciiPrefixLength(data, len);
+    if (asciiLen == len) {
+        return true;
+    }
+    // ASCII 字符不影响后续字符的校验，直接从第一个非 ASCII 字符开始
+    data += asciiLen;
+    len -= asciiLen;
+
+#ifdef UTF8SCANNER_X86
+    qint64 checked = 0;
+    switch (simdLevel()) {
+    case LevelAvx2:
+        if (!validateAvx2(data, len, &checked)) {
+            return false;
+        }
+        return validateTail(data, len, checked, incompleteTail);
+    case LevelSse:
+        if (!validateSsse3(data, len, &checked)) {
+            return false;
+        }
+        return validateTail(data, len, checked, incompleteTail);
+    default:
+        break;
+    }
+#endif
+
+    return isValidUtf8Scalar(data, len, incompleteTail);
+}
+
+qint64 Utf8Scanner::countLeadBytes(const char *data, qint64 len)
+{
+    if (!data || len <= 0) {
+        return 0;
+    }
+
+    qint64 count = 0;
+    qint64 checked = 0;
+#ifdef UTF8SCANNER_X86
+    if (LevelScalar != simdLevel()) {
+        count = countLeadBytesSse2(data, len, &checked);
+    }
+#endif
+    return count + countLeadBytesScalar(data + checked, len - checked);
+}
+
+Utf8Scanner::Implementation Utf8Scanner::implementation()
+{
+#ifdef UTF8SCANNER_X86
+    return static_cast<Implementation>(simdLevel());
+#else
+    return Scalar;
+#endif
+}
+
+qint64 Utf8Scanner::asciiPrefixLengthScalar(const char *data, qint64 len)
+{
+    qint64 i = 0;
+    // 每次判断8字节
+    for (; i + 8 <= len; i += 8) {
+        quint64 word = 0;
+        ::memcpy(&word, data + i, sizeof(word));
+        if (word & s_nonAsciiMask) {
+            break;
+        }
+    }
+
+    for (; i < len; ++i) {
+        if (static_cast<uchar>(data[i]) >= 0x80) {
+            break;
+        }
+    }
+    return i;
+}
+
+bool Utf8Scanner::isValidUtf8Scalar(const char *data, qint64 len, qint64 *incompleteTail)
+{
+    const uchar *cur = reinterpret_cast<const uchar *>(data);
+    const uchar *end = cur + len;
+
+    while (cur < end) {
+        // 跳过 ASCII 数据
+        qint64 asciiLen = asciiPrefixLengthScalar(reinterpret_cast<const char *>(cur), end - cur);
+        cur += asciiLen;
+        if (cur >= end) {
+            break;
+        }
+
+        const uchar *charBegin = cur;
+        uchar ch = *cur++;
+        int need = 0;
+        uchar lower = 0x80;
+        uchar upper = 0xBF;
+        if (ch >= 0xC2 && ch <= 0xDF) {
+            need = 1;
+        } else if (ch >= 0xE0 && ch <= 0xEF) {
+            need = 2;
+            // 排除超长编码及代理区字符
+            if (0xE0 == ch) {
+                lower = 0xA0;
+            } else if (0xED == ch) {
+                upper = 0x9F;
+            }
+        } else if (ch >= 0xF0 && ch <= 0xF4) {
+            need = 3;
+            if (0xF0 == ch) {
+                lower = 0x90;
+            } else if (0xF4 == ch) {
+                upper = 0x8F;
+            }
+        } else {
+            return false;
+        }
+
+        for (; need > 0; --need, ++cur) {
+            if (cur >= end) {
+                // 末尾字符被截断
+                if (incompleteTail) {
+                    *incompleteTail = end - charBegin;
+                    return true;
+                }
+                return false;
+            }
+
+            if (*cur < lower || *cur > upper) {
+                return false;
+            }
+            lower = 0x80;
+            upper = 0xBF;
+        }
+    }
+
+    return true;
+}
+
+qint64 Utf8Scanner::countLeadBytesScalar(const char *data, qint64 len)
+{
+    qint64 count = 0;
+    for (qint64 i = 0; i < len; ++i) {
+        if (static_cast<uchar>(data[i]) >= 0xC0) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief 向量化校验已处理 \a checked 长度的数据后，从最后一个可能未完成的字符开始，
+ *      使用标量实现校验剩余数据
+ */
+bool Utf8Scanner::validateTail(const char *data, qint64 len, qint64 checked, qint64 *incompleteTail)
+{
+    qint64 tailBegin = checked;
+    for (qint64 back = 1; back <= 3 && checked - back >= 0; ++back) {
+        uchar ch = static_cast<uchar>(data[checked - back]);
+        if (0x80 == (ch & 0xC0)) {
+            continue;
+        }
+
+        if (ch >= 0xC0) {
+            qint64 charLen = ch >= 0xF0 ? 4 : (ch >= 0xE0 ? 3 : 2);
+            if (charLen > back) {
+                tailBegin = checked - back;
+            }
+        }
+        break;
+    }
+
+    return isValidUtf8Scalar(data + tailBegin, len - tailBegin, incompleteTail);
+}
@@ -0,0 +1,45 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef UTF8SCANNER_H
+#define UTF8SCANNER_H
+
+#include <QtGlobal>
+
+/**
+ * @brief UTF-8 数据校验及 ASCII 检测，x86 平台运行时选择 AVX2 / SSSE3 / SSE2 向量化实现，
+ *      其它平台使用按字(8字节)处理的标量实现。
+ *      用于在数据已为合法 UTF-8 或纯 ASCII 时跳过 iconv 转码及 GB18030 替换表处理。
+ */
+class Utf8Scanner
+{
+public:
+    enum Implementation {
+        Scalar,     // 标量实现
+        SSE,        // SSE2 检测 ASCII ，SSSE3 校验 UTF-8
+        AVX2,       // AVX2 实现
+    };
+
+    // 返回数据头部连续 ASCII 字符的长度
+    static qint64 asciiPrefixLength(const char *data, qint64 len);
+    // 数据是否全部为 ASCII 字符
+    static bool isAscii(const char *data, qint64 len);
+    // 校验 UTF-8 数据，incompleteTail 不为空时允许末尾存在被截断的字符，并返回截断部分的字节数
+    static bool isValidUtf8(const char *data, qint64 len, qint64 *incompleteTail = nullptr);
+    // 统计 UTF-8 多字节字符首字节(0xC0及以上)的数量
+    static qint64 countLeadBytes(const char *data, qint64 len);
+
+    // 当前平台使用的实现
+    static Implementation implementation();
+
+private:
+    // 标量实现
+    static qint64 asciiPrefixLengthScalar(const char *data, qint64 len);
+    static bool isValidUtf8Scalar(const char *data, qint64 len, qint64 *incompleteTail);
+    static qint64 countLeadBytesScalar(const char *data, qint64 len);
+    // 向量化校验完成后，处理末尾不足一个向量长度的数据
+    static bool validateTail(const char *data, qint64 len, qint64 checked, qint64 *incompleteTail);
+};
+
+#endif // UTF8SCANNER_H
@@ -3,6 +3,7 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 
 #include "startmanager.h"
+#include "common/backupjournal.h"
 //#include <settings.h>
 
 #include <DApplication>
@@ -125,6 +126,10 @@ void StartManager::autoBackupFile()
         return;
     }
 
+    // 统计界面线程耗时，备份文件由备份线程写入
+    PerformanceMonitor::autoBackupStart();
+    int backupCount = 0;
+
     //如果自动备份文件夹不存在，创建自动备份文件夹
     if (!QFileInfo(m_autoBackupDir).exists()) {
         QDir().mkpath(m_autoBackupDir);
@@ -197,14 +202,17 @@ void StartManager::autoBackupFile()
             }
 
             //保存备份文件
+            // 仅追加上次备份后的变更，避免每次备份都重新转换及写入整个文档
             if (Utils::isDraftFile(filePath)) {
-                wrapper->saveTemFile(filePath);
+                wrapper->saveTemFileIncremental(filePath);
+                backupCount++;
             } else {
                 if (wrapper->isModified()) {
                     QString name = fileInfo.absolutePath().replace("/", "_");
                     QString qstrFilePath = m_autoBackupDir + "/" + Utils::getStringMD5Hash(fileInfo.baseName()) + "." + name + "." + fileInfo.suffix();
                     jsonObject.insert("temFilePath", qstrFilePath);
-                    wrapper->saveTemFile(qstrFilePath);
+                    wrapper->saveTemFileIncremental(qstrFilePath);
+                    backupCount++;
                 }
             }
 
@@ -217,10 +225,14 @@ void StartManager::autoBackupFile()
         m_qlistTemFile.append(list);
     }
 
-    //将json串列表写入配置文件
-    Settings::instance()->settings->option("advance.editor.browsing_history_temfile")->setValue(m_qlistTemFile);
+    //将json串列表写入配置文件，备份信息未变化时不再重复写入
+    if (listBackupInfo != m_qlistTemFile) {
+        Settings::instance()->settings->option("advance.editor.browsing_history_temfile")->setValue(m_qlistTemFile);
+    }
     // 备份书签信息
     saveBookmark();
+
+    PerformanceMonitor::autoBackupFinish(backupCount);
 }
 
 int StartManager::recoverFile(Window *window)
@@ -309,6 +321,13 @@ int StartManager::recoverFile(Window *window)
                     }
                 }
 
+                //应用增量备份日志，恢复最后一次备份时的内容
+                if (!temFilePath.isEmpty()) {
+                    BackupJournal::replay(temFilePath);
+                } else if (Utils::isDraftFile(localPath)) {
+                    BackupJournal::replay(localPath);
+                }
+
                 //打开文件
                 if (!temFilePath.isEmpty()) {
                     if (Utils::fileExists(temFilePath)) {
@@ -781,6 +800,16 @@ StartManager::FileTabInfo StartManager::getFileTabInfo(QString file)
     return info;
 }
 
+Window *StartManager::windowForFile(const QString &file)
+{
+    FileTabInfo info = getFileTabInfo(file);
+    if (info.windowIndex < 0 || info.windowIndex >= m_windows.size()) {
+        return nullptr;
+    }
+
+    return m_windows.at(info.windowIndex);
+}
+
 QList<int> StartManager::analyzeBookmakeInfo(QString bookmarkInfo)
 {
     QList<int> bookmarkList;
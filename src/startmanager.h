@@ -68,6 +68,8 @@ public:
     void recordBookmark(const QString &localPath, const QList<int> &bookmark);
     // 查找文件对应的书签记录
     QList<int> findBookmark(const QString &localPath);
+    // 已打开文件 file 所在的窗口，未打开时返回 nullptr
+    Window *windowForFile(const QString &file);
 
 public slots:
     Q_SCRIPTABLE void openFilesInTab(QStringList files);
@@ -263,6 +263,11 @@ void BottomBar::setProgress(int progress)
     }
 }
 
+void BottomBar::setProgressText(const QString &text)
+{
+    m_progressLabel->setText(text);
+}
+
 DDropdownMenu *BottomBar::getEncodeMenu()
 {
     return m_pEncodeMenu;
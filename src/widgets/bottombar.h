@@ -43,6 +43,8 @@ public:
     void setChildrenFocus(bool ok,QWidget* preOrderWidget = nullptr);
     void setScaleLabelText(qreal fontSize);
     void setProgress(int progress);
+    // 设置进度条提示文本，默认为加载提示
+    void setProgressText(const QString &text);
 
     DDropdownMenu* getEncodeMenu();
     DDropdownMenu* getHighlightMenu();
@@ -0,0 +1,165 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "searchresultpanel.h"
+
+#include <QHBoxLayout>
+#include <QVBoxLayout>
+#include <QHeaderView>
+#include <DStyle>
+
+SearchResultPanel::SearchResultPanel(QWidget *parent)
+    : QWidget(parent)
+    , m_summaryLabel(new QLabel)
+    , m_undoReplaceButton(new QPushButton(tr("Undo Replace")))
+    , m_closeButton(new DIconButton(DStyle::SP_CloseButton))
+    , m_resultTree(new QTreeWidget)
+{
+    m_closeButton->setIconSize(QSize(24, 24));
+    m_closeButton->setFixedSize(24, 24);
+    m_closeButton->setEnabledCircle(true);
+    m_closeButton->setFlat(true);
+    m_undoReplaceButton->setToolTip(tr("Undo the last replacement in all tabs"));
+    m_undoReplaceButton->setVisible(false);
+
+    m_resultTree->setHeaderHidden(true);
+    m_resultTree->setUniformRowHeights(true);
+    m_resultTree->setTextElideMode(Qt::ElideRight);
+    m_resultTree->header()->setStretchLastSection(true);
+
+    QHBoxLayout *titleLayout = new QHBoxLayout;
+    titleLayout->setContentsMargins(10, 0, 6, 0);
+    titleLayout->addWidget(m_summaryLabel, 1);
+    titleLayout->addWidget(m_undoReplaceButton);
+    titleLayout->addWidget(m_closeButton);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->setContentsMargins(0, 4, 0, 0);
+    layout->setSpacing(4);
+    layout->addLayout(titleLayout);
+    layout->addWidget(m_resultTree);
+
+    connect(m_resultTree, &QTreeWidget::itemActivated, this, &SearchResultPanel::onItemActivated);
+    connect(m_undoReplaceButton, &QPushButton::clicked, this, &SearchResultPanel::sigUndoReplace);
+    connect(m_closeButton, &DIconButton::clicked, this, [this]() {
+        hide();
+        emit sigClosed();
+    });
+}
+
+void SearchResultPanel::startSearch(const QString &keyword)
+{
+    m_keyword = keyword;
+    m_matchCount = 0;
+    m_skippedCount = 0;
+    m_resultTree->clear();
+    updateSummary(false);
+}
+
+/**
+ * @brief 添加文件 \a fileName 的查找结果，各文件查找完成顺序不定，按文件序号插入分组保持标签页顺序
+ */
+void SearchResultPanel::addFileResult(const MultiDocumentSearch::FileResult &result, const QString &fileName)
+{
+    QTreeWidgetItem *fileItem = new QTreeWidgetItem;
+    fileItem->setText(0, QString("%1 (%2)").arg(fileName).arg(result.matchCount));
+    fileItem->setToolTip(0, result.filePath);
+    fileItem->setData(0, EFilePathRole, result.filePath);
+    fileItem->setData(0, EIndexRole, result.index);
+
+    const int count = qMin(result.matches.size(), static_cast<int>(EMaxFileMatches));
+    QList<QTreeWidgetItem *> matchItems;
+    matchItems.reserve(count + 1);
+    for (int i = 0; i < count; ++i) {
+        const MultiDocumentSearch::Match &match = result.matches.at(i);
+        QTreeWidgetItem *matchItem = new QTreeWidgetItem;
+        matchItem->setText(0, QString("%1:%2  %3").arg(match.line + 1).arg(match.column + 1).arg(match.preview.trimmed()));
+        matchItem->setData(0, EFilePathRole, result.filePath);
+        matchItem->setData(0, EIndexRole, match.offset);
+        matchItem->setData(0, ELengthRole, match.length);
+        matchItem->setData(0, ELineRole, match.line);
+        matchItem->setData(0, EColumnRole, match.column);
+        matchItems.append(matchItem);
+    }
+    if (result.matchCount > count) {
+        QTreeWidgetItem *moreItem = new QTreeWidgetItem;
+        moreItem->setText(0, tr("%1 more matches not shown").arg(result.matchCount - count));
+        moreItem->setFlags(Qt::NoItemFlags);
+        matchItems.append(moreItem);
+    }
+    fileItem->addChildren(matchItems);
+
+    int position = m_resultTree->topLevelItemCount();
+    while (position > 0 && m_resultTree->topLevelItem(position - 1)->data(0, EIndexRole).toInt() > result.index) {
+        --position;
+    }
+    m_resultTree->insertTopLevelItem(position, fileItem);
+    fileItem->setExpanded(true);
+
+    m_matchCount += result.matchCount;
+    updateSummary(false);
+}
+
+void SearchResultPanel::setFinished(int skippedCount)
+{
+    m_skippedCount = skippedCount;
+    updateSummary(true);
+}
+
+void SearchResultPanel::showMessage(const QString &message)
+{
+    m_matchCount = 0;
+    m_resultTree->clear();
+    m_summaryLabel->setText(message);
+}
+
+void SearchResultPanel::setUndoReplaceEnabled(bool enabled)
+{
+    m_undoReplaceButton->setVisible(enabled);
+}
+
+int SearchResultPanel::fileCount() const
+{
+    return m_resultTree->topLevelItemCount();
+}
+
+int SearchResultPanel::matchCount() const
+{
+    return m_matchCount;
+}
+
+QStringList SearchResultPanel::resultFiles() const
+{
+    QStringList files;
+    for (int i = 0; i < m_resultTree->topLevelItemCount(); ++i) {
+        files.append(m_resultTree->topLevelItem(i)->data(0, EFilePathRole).toString());
+    }
+    return files;
+}
+
+/**
+ * @brief 双击或回车激活匹配项时通知跳转，文件分组项仅展开或折叠
+ */
+void SearchResultPanel::onItemActivated(QTreeWidgetItem *item, int column)
+{
+    Q_UNUSED(column)
+    if (item == nullptr || item->parent() == nullptr || !item->data(0, ELengthRole).isValid()) {
+        return;
+    }
+
+    emit sigMatchActivated(item->data(0, EFilePathRole).toString(), item->data(0, EIndexRole).toInt(),
+                           item->data(0, ELengthRole).toInt(), item->data(0, ELineRole).toInt(),
+                           item->data(0, EColumnRole).toInt());
+}
+
+void SearchResultPanel::updateSummary(bool finished)
+{
+    QString summary = tr("%1 matches for \"%2\" in %3 files").arg(m_matchCount).arg(m_keyword).arg(fileCount());
+    if (!finished) {
+        summary.append(QString(" (%1)").arg(tr("Searching...")));
+    } else if (m_skippedCount > 0) {
+        summary.append(QString(" (%1)").arg(tr("%1 files skipped: unsupported encoding").arg(m_skippedCount)));
+    }
+    m_summaryLabel->setText(summary);
+}
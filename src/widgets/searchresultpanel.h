@@ -0,0 +1,79 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef SEARCHRESULTPANEL_H
+#define SEARCHRESULTPANEL_H
+
+#include "../common/multidocumentsearch.h"
+
+#include <QWidget>
+#include <QLabel>
+#include <QPushButton>
+#include <QTreeWidget>
+#include <DIconButton>
+
+DWIDGET_USE_NAMESPACE
+
+/**
+ * @brief 多文件查找结果面板，按文件分组显示匹配项所在行号及行预览文本，双击匹配项跳转到对应文件位置。
+ *      单个文件显示的匹配项数量有上限，超出部分仅统计数量，避免大量匹配项时界面卡顿。
+ */
+class SearchResultPanel : public QWidget
+{
+    Q_OBJECT
+public:
+    enum PanelParam {
+        EMaxFileMatches = 1000,     // 单个文件最多显示的匹配项数量
+    };
+
+    enum ItemRole {
+        EFilePathRole = Qt::UserRole,   // 文件路径
+        EIndexRole,                     // 文件分组为文件序号，匹配项为起始位置
+        ELengthRole,                    // 匹配项长度
+        ELineRole,                      // 匹配项所在行号
+        EColumnRole,                    // 匹配项所在列号
+    };
+
+    explicit SearchResultPanel(QWidget *parent = nullptr);
+
+    // 开始新的查找，清空之前的结果
+    void startSearch(const QString &keyword);
+    // 添加文件 fileName 的查找结果，文件分组按 result.index 排序
+    void addFileResult(const MultiDocumentSearch::FileResult &result, const QString &fileName);
+    // 查找完成，显示匹配项及文件数量，skippedCount 为编码不支持而未查找的文件数量
+    void setFinished(int skippedCount = 0);
+    // 清空查找结果，仅显示提示信息 message
+    void showMessage(const QString &message);
+    // 设置是否可撤销多文件替换
+    void setUndoReplaceEnabled(bool enabled);
+
+    int fileCount() const;
+    int matchCount() const;
+    // 存在匹配项的文件路径，按文件序号排列
+    QStringList resultFiles() const;
+
+signals:
+    // 双击匹配项，跳转到文件 filePath 中 [offset, offset + length) 的位置，该位置位于第 line 行第 column 列
+    void sigMatchActivated(const QString &filePath, int offset, int length, int line, int column);
+    // 撤销多文件替换
+    void sigUndoReplace();
+    void sigClosed();
+
+private slots:
+    void onItemActivated(QTreeWidgetItem *item, int column);
+
+private:
+    void updateSummary(bool finished);
+
+private:
+    QLabel *m_summaryLabel = nullptr;           // 查找关键字及结果统计
+    QPushButton *m_undoReplaceButton = nullptr; // 撤销多文件替换
+    DIconButton *m_closeButton = nullptr;
+    QTreeWidget *m_resultTree = nullptr;        // 按文件分组的查找结果
+    QString m_keyword;                          // 查找的关键字
+    int m_matchCount = 0;                       // 匹配项总数
+    int m_skippedCount = 0;                     // 未查找的文件数量
+};
+
+#endif // SEARCHRESULTPANEL_H
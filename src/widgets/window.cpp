@@ -4,6 +4,8 @@
 
 #include "window.h"
 #include "pathsettintwgt.h"
+#include "../common/backupworker.h"
+#include "../editor/largefileview.h"
 #include <DTitlebar>
 #include <DAnchors>
 #include <DThemeManager>
@@ -206,6 +208,10 @@ Window::Window(DMainWindow *parent)
       m_replaceBar(new ReplaceBar(this)),
       m_themePanel(new ThemePanel(this)),
       m_findBar(new FindBar(this)),
+      m_searchController(new SearchController(this)),
+      m_tabsSearch(new MultiDocumentSearch(this)),
+      m_searchResultPanel(new SearchResultPanel),
+      m_folderSearch(new FolderSearch(this)),
       m_menu(new DMenu),
       m_blankFileDir(QDir(Utils::cleanPath(QStandardPaths::standardLocations(QStandardPaths::DataLocation)).first()).filePath("blank-files")),
       m_backupDir(QDir(Utils::cleanPath(QStandardPaths::standardLocations(QStandardPaths::DataLocation)).first()).filePath("backup-files")),
@@ -248,6 +254,9 @@ Window::Window(DMainWindow *parent)
     m_centralLayout->setSpacing(0);
 
     m_centralLayout->addWidget(m_editorWidget);
+    m_searchResultPanel->setMaximumHeight(240);
+    m_searchResultPanel->hide();
+    m_centralLayout->addWidget(m_searchResultPanel);
     setWindowIcon(QIcon::fromTheme("deepin-editor"));
     setCentralWidget(m_centralWidget);
 
@@ -275,7 +284,7 @@ Window::Window(DMainWindow *parent)
     connect(m_findBar, &FindBar::findPrev, this, &Window::handleFindPrevSearchKeyword, Qt::QueuedConnection);
     connect(m_findBar, &FindBar::removeSearchKeyword, this, &Window::handleRemoveSearchKeyword, Qt::QueuedConnection);
     connect(m_findBar, &FindBar::updateSearchKeyword, this, [ = ](QString file, QString keyword) {
-        handleUpdateSearchKeyword(m_findBar, file, keyword);
+        m_searchController->setKeyword(m_findBar, file, keyword);
     });
     connect(m_findBar, &FindBar::sigFindbarClose, this, &Window::slotFindbarClose, Qt::QueuedConnection);
 
@@ -288,10 +297,28 @@ Window::Window(DMainWindow *parent)
     connect(m_replaceBar, &ReplaceBar::replaceRest, this, &Window::handleReplaceRest, Qt::QueuedConnection);
     connect(m_replaceBar, &ReplaceBar::replaceSkip, this, &Window::handleReplaceSkip, Qt::QueuedConnection);
     connect(m_replaceBar, &ReplaceBar::updateSearchKeyword, this, [ = ](QString file, QString keyword) {
-        handleUpdateSearchKeyword(m_replaceBar, file, keyword);
+        m_searchController->setKeyword(m_replaceBar, file, keyword);
     });
     connect(m_replaceBar, &ReplaceBar::sigReplacebarClose, this, &Window::slotReplacebarClose, Qt::QueuedConnection);
 
+    // 在所有标签页中查找、替换
+    connect(m_findBar, &FindBar::findInTabs, this, &Window::handleFindInTabs, Qt::QueuedConnection);
+    connect(m_replaceBar, &ReplaceBar::replaceInTabs, this, &Window::handleReplaceInTabs, Qt::QueuedConnection);
+    connect(m_tabsSearch, &MultiDocumentSearch::sigFileResult, this, &Window::handleTabsSearchResult);
+    connect(m_tabsSearch, &MultiDocumentSearch::sigFinished, this, &Window::handleTabsSearchFinished);
+    connect(m_searchResultPanel, &SearchResultPanel::sigMatchActivated, this, &Window::handleSearchResultActivated);
+    connect(m_searchResultPanel, &SearchResultPanel::sigUndoReplace, this, &Window::handleUndoReplaceInTabs);
+    connect(m_searchResultPanel, &SearchResultPanel::sigClosed, m_tabsSearch, &MultiDocumentSearch::cancel);
+    // 在文件夹中查找
+    connect(m_findBar, &FindBar::findInFolder, this, &Window::handleFindInFolder, Qt::QueuedConnection);
+    connect(m_folderSearch, &FolderSearch::sigFileResult, this, &Window::handleFolderSearchResult);
+    connect(m_folderSearch, &FolderSearch::sigFinished, this, &Window::handleFolderSearchFinished);
+    connect(m_searchResultPanel, &SearchResultPanel::sigClosed, m_folderSearch, &FolderSearch::cancel);
+
+    // 输入关键字时停顿后再查找，关键字变更时取消进行中的查找
+    connect(m_searchController, &SearchController::sigSearchRequested, this, &Window::handleUpdateSearchKeyword);
+    connect(m_searchController, &SearchController::sigKeywordChanged, this, &Window::handleSearchKeywordChanged);
+
     // Init jump line bar.
     //QTimer::singleShot(0, m_jumpLineBar, SLOT(hide()));
     m_jumpLineBar->hide();
@@ -711,6 +738,18 @@ void Window::addTabWithWrapper(EditWrapper *wrapper, const QString &filepath, co
     connect(wrapper->textEditor(), &TextEdit::clickFullscreenAction, this, &Window::toggleFullscreen, Qt::QueuedConnection);
     connect(wrapper->textEditor(), &TextEdit::popupNotify, this, &Window::showNotify, Qt::QueuedConnection);
     connect(wrapper->textEditor(), &TextEdit::signal_setTitleFocus, this, &Window::slot_setTitleFocus, Qt::QueuedConnection);
+    connect(wrapper->textEditor(), &TextEdit::sigFindMatchChanged, this, [ = ]() {
+        if (wrapper == currentWrapper()) {
+            updateFindMatchCount();
+        }
+    });
+    connect(wrapper, &EditWrapper::sigFileLoadFinished, this, [ = ]() {
+        const QString filePath = wrapper->filePath();
+        if (m_pendingLocations.contains(filePath)) {
+            const QVector<int> location = m_pendingLocations.take(filePath);
+            jumpToFileLocation(filePath, location.at(0), location.at(1), location.at(2));
+        }
+    });
 
     switch (Utils::getSystemVersion()) {
     case Utils::V23:
@@ -821,7 +860,7 @@ bool Window::closeTab(const QString &filePath)
             if (res == 1) {
                 removeWrapper(filePath, true);
                 m_tabbar->closeCurrentTab(filePath);
-                QFile(filePath).remove();
+                wrapper->removeTemFile(filePath);
                 return true;
             }
 
@@ -834,7 +873,7 @@ bool Window::closeTab(const QString &filePath)
                     removeWrapper(filePath, true);
                     // 保存临时文件后已更新tab页的文件路径，使用新的文件路径删除窗口
                     m_tabbar->closeCurrentTab(newFilePath);
-                    QFile(filePath).remove();
+                    wrapper->removeTemFile(filePath);
                 } else {
                     // 保存不成功时不关闭窗口
                     return false;
@@ -843,7 +882,7 @@ bool Window::closeTab(const QString &filePath)
         } else {
             removeWrapper(filePath, true);
             m_tabbar->closeCurrentTab(filePath);
-            QFile(filePath).remove();
+            wrapper->removeTemFile(filePath);
         }
     }
     // document has been modified or unsaved draft document.
@@ -870,15 +909,11 @@ bool Window::closeTab(const QString &filePath)
 
                 //删除备份文件
                 if (bIsBackupFile) {
-                    QFile(filePath).remove();
+                    wrapper->removeTemFile(filePath);
                 }
 
                 //删除自动备份文件
-                if (QFileInfo(m_autoBackupDir).exists()) {
-                    fileInfo.setFile(wrapper->textEditor()->getTruePath());
-                    QString name = fileInfo.absolutePath().replace("/", "_");
-                    QDir(m_autoBackupDir).remove(fileInfo.baseName() + "." + name + "." + fileInfo.suffix());
-                }
+                removeAutoBackupFile(wrapper, wrapper->textEditor()->getTruePath());
 
                 return true;
             }
@@ -889,7 +924,7 @@ bool Window::closeTab(const QString &filePath)
                     if (wrapper->saveFile()) {
                         removeWrapper(filePath, true);
                         m_tabbar->closeCurrentTab(filePath);
-                        QFile(filePath).remove();
+                        wrapper->removeTemFile(filePath);
                     } else {
                         saveAsFile();
                     }
@@ -908,11 +943,7 @@ bool Window::closeTab(const QString &filePath)
         }
 
         //删除自动备份文件
-        if (QFileInfo(m_autoBackupDir).exists()) {
-            fileInfo.setFile(wrapper->textEditor()->getTruePath());
-            QString name = fileInfo.absolutePath().replace("/", "_");
-            QDir(m_autoBackupDir).remove(fileInfo.baseName() + "." + name + "." + fileInfo.suffix());
-        }
+        removeAutoBackupFile(wrapper, wrapper->textEditor()->getTruePath());
     }
 
     return true;
@@ -929,6 +960,11 @@ EditWrapper *Window::createEditor()
 {
     EditWrapper *wrapper = new EditWrapper(this);
     connect(wrapper, &EditWrapper::sigClearDoubleCharaterEncode, this, &Window::slotClearDoubleCharaterEncode);
+    connect(wrapper, &EditWrapper::sigAsyncSaveFinished, this, [ = ](bool success, const QString & temPath, const QString & filePath) {
+        if (success) {
+            handleFileSaved(temPath, filePath);
+        }
+    });
     connect(wrapper->textEditor(), &TextEdit::signal_readingPath, this, &Window::slot_saveReadingPath, Qt::QueuedConnection);
     connect(wrapper->textEditor(), &TextEdit::signal_setTitleFocus, this, &Window::slot_setTitleFocus, Qt::QueuedConnection);
     connect(wrapper->textEditor(), &TextEdit::clickFindAction, this, &Window::popupFindBar, Qt::QueuedConnection);
@@ -936,6 +972,11 @@ EditWrapper *Window::createEditor()
     connect(wrapper->textEditor(), &TextEdit::clickJumpLineAction, this, &Window::popupJumpLineBar, Qt::QueuedConnection);
     connect(wrapper->textEditor(), &TextEdit::clickFullscreenAction, this, &Window::toggleFullscreen, Qt::QueuedConnection);
     connect(wrapper->textEditor(), &TextEdit::popupNotify, this, &Window::showNotify, Qt::QueuedConnection);
+    connect(wrapper->textEditor(), &TextEdit::sigFindMatchChanged, this, [ = ]() {
+        if (wrapper == currentWrapper()) {
+            updateFindMatchCount();
+        }
+    });
     connect(wrapper->textEditor(), &TextEdit::textChanged, this, [ = ]() {
         updateJumpLineBar(wrapper->textEditor());
     }, Qt::QueuedConnection);
@@ -1098,11 +1139,21 @@ void Window::openFile()
 }
 
 bool Window::saveFile()
+{
+    return SaveSucceeded == saveCurrentFile();
+}
+
+/**
+ * @brief 保存当前文件，超大文档在后台线程保存并返回 SavePending ，
+ *      后台保存期间再次保存时，在当前保存完成后使用最新内容重新保存
+ * @return 保存状态
+ */
+Window::SaveStatus Window::saveCurrentFile()
 {
     EditWrapper *wrapperEdit = currentWrapper();
 
     //大文本加载过程不允许保存
-    if (!wrapperEdit || wrapperEdit->getFileLoading()) return false;
+    if (!wrapperEdit || wrapperEdit->getFileLoading()) return SaveFailed;
 
     bool isDraftFile = wrapperEdit->isDraftFile();
     //bool isEmpty = wrapperEdit->isPlainTextEmpty();
@@ -1110,7 +1161,7 @@ bool Window::saveFile()
 
     // save blank file.
     if (isDraftFile) {
-        return saveAsFile();
+        return saveAsFile() ? SaveSucceeded : SaveFailed;
     }
 
     QFileInfo info(filePath);
@@ -1122,7 +1173,7 @@ bool Window::saveFile()
         if (!isWrite) {
             DMessageManager::instance()->sendMessage(m_editorWidget->currentWidget(), QIcon(":/images/warning.svg")
                                                      , QString(tr("You do not have permission to save %1")).arg(info.fileName()));
-            return false;
+            return SaveFailed;
         }
     }
 
@@ -1134,31 +1185,69 @@ bool Window::saveFile()
     } else {
         temPath = filePath;
     }
-    bool success = wrapperEdit->saveFile();
+    // 超大文档在后台线程保存，保存完成后由 sigAsyncSaveFinished 信号通知，
+    // 正在保存时由 saveFileAsync() 记录重新保存请求
+    if (wrapperEdit->isAsyncSaving() || wrapperEdit->isAsyncSaveRequired()) {
+        wrapperEdit->saveFileAsync(temPath);
+        return SavePending;
+    }
 
+    bool success = wrapperEdit->saveFile();
     if (success) {
-        updateSabeAsFileNameTemp(temPath, filePath);
-        if (currentWrapper()) {
-            currentWrapper()->hideWarningNotices();
-        }
-        showNotify(tr("Saved successfully"));
+        handleFileSaved(temPath, filePath);
+        return SaveSucceeded;
+    }
 
-        //删除备份文件
-        if (temPath != filePath) {
+    return SaveFailed;
+}
+
+/**
+ * @brief 文件保存成功后更新标签页信息并删除备份文件
+ * @param temPath   备份文件路径，非备份文件时与 \a filePath 相同
+ * @param filePath  文件实际路径
+ */
+void Window::handleFileSaved(const QString &temPath, const QString &filePath)
+{
+    updateSabeAsFileNameTemp(temPath, filePath);
+    if (currentWrapper()) {
+        currentWrapper()->hideWarningNotices();
+    }
+    showNotify(tr("Saved successfully"));
+
+    //删除备份文件
+    EditWrapper *savedWrapper = wrapper(filePath);
+    if (temPath != filePath) {
+        if (savedWrapper != nullptr) {
+            savedWrapper->removeTemFile(temPath);
+        } else {
             QFile(temPath).remove();
         }
+    }
 
-        //删除自动备份文件
-        if (QFileInfo(m_autoBackupDir).exists()) {
-            QFileInfo fileInfo(filePath);
-            QString name = fileInfo.absolutePath().replace("/", "_");
-            QDir(m_autoBackupDir).remove(fileInfo.baseName() + "." + name + "." + fileInfo.suffix());
-        }
+    //删除自动备份文件
+    removeAutoBackupFile(savedWrapper, filePath);
+}
 
-        return true;
+/**
+ * @brief 删除文件 \a filePath 的自动备份文件，路径与 StartManager 自动备份时一致。
+ *      同时删除隐藏的增量备份日志并取消备份线程中未执行的任务，避免删除后被重新写入
+ */
+void Window::removeAutoBackupFile(EditWrapper *wrapper, const QString &filePath)
+{
+    if (!QFileInfo(m_autoBackupDir).exists()) {
+        return;
     }
 
-    return false;
+    QFileInfo fileInfo(filePath);
+    QString name = fileInfo.absolutePath().replace("/", "_");
+    const QString backupPath = m_autoBackupDir + "/" + Utils::getStringMD5Hash(fileInfo.baseName()) + "." + name + "." + fileInfo.suffix();
+    if (wrapper != nullptr) {
+        wrapper->removeTemFile(backupPath);
+    } else {
+        BackupWorker::instance()->cancel(backupPath);
+        QFile::remove(BackupJournal::journalPath(backupPath));
+        QFile::remove(backupPath);
+    }
 }
 
 bool Window::saveAsFile()
@@ -1240,20 +1329,20 @@ QString Window::saveAsFileToDisk()
         }
 
         if (wrapper->filePath().contains(m_backupDir) || wrapper->filePath().contains(m_blankFileDir)) {
-            QFile(wrapper->filePath()).remove();
+            wrapper->removeTemFile(wrapper->filePath());
         }
 
         //删除自动备份文件
-        if (QFileInfo(m_autoBackupDir).exists()) {
-            QString truePath = wrapper->textEditor()->getTruePath();
-            fileInfo.setFile(truePath);
-            QString name = fileInfo.absolutePath().replace("/", "_");
-            QDir(m_autoBackupDir).remove(fileInfo.baseName() + "." + name + "." + fileInfo.suffix());
-        }
+        removeAutoBackupFile(wrapper, wrapper->textEditor()->getTruePath());
 
         /* 如果另存为的文件名+路径与当前tab项对应的文件名+路径是一致，则直接做保存操作即可 */
         if (!wrapper->filePath().compare(newFilePath)) {
-            if (saveFile()) {
+            SaveStatus status = saveCurrentFile();
+            // 另存为需要返回保存结果，等待后台保存完成
+            if (SavePending == status) {
+                status = wrapper->waitForAsyncSave() ? SaveSucceeded : SaveFailed;
+            }
+            if (SaveSucceeded == status) {
                 return newFilePath;
             }
         }
@@ -1494,6 +1583,7 @@ void Window::popupFindBar()
     wrapper->textEditor()->highlightKeywordInView(text);
     // set keywords
     m_keywordForSearchAll = m_keywordForSearch = text;
+    updateFindMatchCount();
 
     QTimer::singleShot(10, this, [ = ] { m_findBar->focus(); });
 }
@@ -1863,6 +1953,8 @@ void Window::popupPrintDialog()
 {
     //大文本加载过程不允许打印操作
     if (currentWrapper() && currentWrapper()->getFileLoading()) return;
+    // 超大文件只读视图的内容未加载到文档，不支持打印
+    if (currentWrapper() && currentWrapper()->isLargeFileView()) return;
 
     // 已有处理的打印事件，不继续进入
     if (m_bPrintProcessing) {
@@ -2713,8 +2805,11 @@ void Window::handleCurrentChanged(const int &index)
         m_jumpLineBar->hide();
     }
 
+    EditWrapper *pCurWrapper = currentWrapper();
     for (auto wrapper : m_wrappers.values()) {
         wrapper->textEditor()->removeKeywords();
+        // 仅当前标签页在空闲时分析高亮状态
+        wrapper->setBackgroundHighlight(wrapper == pCurWrapper);
     }
 
     if (currentWrapper()) {
@@ -2784,8 +2879,11 @@ void Window::handleFindPrevSearchKeyword(const QString &keyword)
 
 void Window::handleFindKeyword(const QString &keyword, bool state)
 {
+    // 先执行等待中的查找，保证高亮结果与当前关键字一致
+    m_searchController->flush();
     EditWrapper *wrapper = currentWrapper();
     m_keywordForSearch = keyword;
+    wrapper->textEditor()->setSearchFlags(m_findBar->searchFlags());
     wrapper->textEditor()->saveMarkStatus();
     wrapper->textEditor()->updateCursorKeywordSelection(m_keywordForSearch, state);
     if (QString::compare(m_keywordForSearch, m_keywordForSearchAll, Qt::CaseInsensitive) != 0) {
@@ -2800,6 +2898,7 @@ void Window::handleFindKeyword(const QString &keyword, bool state)
     wrapper->textEditor()->renderAllSelections();
     wrapper->textEditor()->restoreMarkStatus();
     wrapper->textEditor()->updateLeftAreaWidget();
+    updateFindMatchCount();
 
     // 变更查询字符串位置后(可能滚屏)，刷新当前界面的代码高亮效果
     wrapper->OnUpdateHighlighter();
@@ -2833,28 +2932,36 @@ void Window::slotReplacebarClose()
 
 void Window::handleReplaceAll(const QString &replaceText, const QString &withText)
 {
+    m_searchController->flush();
     EditWrapper *wrapper = currentWrapper();
+    wrapper->textEditor()->setSearchFlags(m_replaceBar->searchFlags());
     wrapper->textEditor()->replaceAll(replaceText, withText);
 }
 
 void Window::handleReplaceNext(const QString &file, const QString &replaceText, const QString &withText)
 {
+    m_searchController->flush();
     Q_UNUSED(file);
     m_keywordForSearch = replaceText;
     m_keywordForSearchAll = replaceText;
     EditWrapper *wrapper = currentWrapper();
+    wrapper->textEditor()->setSearchFlags(m_replaceBar->searchFlags());
     wrapper->textEditor()->replaceNext(replaceText, withText);
 }
 
 void Window::handleReplaceRest(const QString &replaceText, const QString &withText)
 {
+    m_searchController->flush();
     EditWrapper *wrapper = currentWrapper();
+    wrapper->textEditor()->setSearchFlags(m_replaceBar->searchFlags());
     wrapper->textEditor()->replaceRest(replaceText, withText);
 }
 
 void Window::handleReplaceSkip(QString file, QString keyword)
 {
     EditWrapper *wrapper = currentWrapper();
+    // 直接按当前关键字查找，丢弃等待中的查找
+    m_searchController->cancel();
     handleUpdateSearchKeyword(m_replaceBar, file, keyword);
     if (QString::compare(m_keywordForSearch, m_keywordForSearchAll, Qt::CaseInsensitive) != 0) {
         m_keywordForSearchAll.clear();
@@ -2876,9 +2983,30 @@ void Window::handleRemoveSearchKeyword()
     }
 }
 
+/**
+ * @brief 查找栏或替换栏输入的关键字变更，取消当前文件进行中的查找，停顿后按新关键字查找。
+ *      已完成的查找结果保留，新关键字为其扩展时仅需校验之前的匹配项位置。
+ */
+void Window::handleSearchKeywordChanged(const QString &file, const QString &keyword)
+{
+    Q_UNUSED(keyword)
+    if (m_wrappers.contains(file)) {
+        TextSearchEngine *engine = m_wrappers.value(file)->textEditor()->searchEngine();
+        if (engine->isRunning()) {
+            engine->clear();
+        }
+    }
+}
+
 void Window::handleUpdateSearchKeyword(QWidget *widget, const QString &file, const QString &keyword)
 {
     if (file == m_tabbar->currentPath() && m_wrappers.contains(file)) {
+        // 按查找栏或替换栏当前的查找模式(正则表达式、全词匹配)查找
+        if (auto *pFindBar = qobject_cast<FindBar *>(widget)) {
+            m_wrappers.value(file)->textEditor()->setSearchFlags(pFindBar->searchFlags());
+        } else if (auto *pReplaceBar = qobject_cast<ReplaceBar *>(widget)) {
+            m_wrappers.value(file)->textEditor()->setSearchFlags(pReplaceBar->searchFlags());
+        }
 
         // Update input widget warning status along with keyword match situation.
         bool findKeyword = m_wrappers.value(file)->textEditor()->highlightKeyword(keyword, m_wrappers.value(file)->textEditor()->getPosition());
@@ -2907,10 +3035,292 @@ void Window::handleUpdateSearchKeyword(QWidget *widget, const QString &file, con
     }
     EditWrapper *wrapper = currentWrapper();
     wrapper->textEditor()->updateLeftAreaWidget();
+    updateFindMatchCount();
     // 在设置查询字符串并跳转后，及时刷新代码高亮效果
     wrapper->OnUpdateHighlighter();
 }
 
+/**
+ * @brief 更新查找栏显示的当前匹配项序号及总数。总数来自后台全文查找结果，查找过程中按已完成的部分递增显示，
+ *      文档编辑后查找引擎仅更新变更区域的结果，无需在界面线程中重新统计。
+ */
+void Window::updateFindMatchCount()
+{
+    EditWrapper *wrapper = currentWrapper();
+    if (wrapper == nullptr || m_findBar->isHidden()) {
+        return;
+    }
+
+    TextSearchEngine *engine = wrapper->textEditor()->searchEngine();
+    if (engine->keyword().isEmpty() || engine->keyword() != m_keywordForSearch) {
+        m_findBar->clearMatchCount();
+        return;
+    }
+
+    const QPair<int, int> position = wrapper->textEditor()->findMatchPosition();
+    m_findBar->setMatchCount(position.first, position.second, engine->isRunning());
+    // 查找进行中时视为存在匹配项，查找完成后按结果更新提示
+    if (!engine->isRunning()) {
+        m_findBar->setMismatchAlert(0 == position.second);
+    }
+}
+
+/**
+ * @brief 在所有打开的标签页中查找关键字 \a keyword ，结果按文件分组显示在查找结果面板中
+ */
+void Window::handleFindInTabs(const QString &keyword)
+{
+    m_searchController->flush();
+    if (keyword.isEmpty()) {
+        return;
+    }
+
+    m_tabsReplacePending = false;
+    startTabsSearch(keyword, m_findBar->searchFlags());
+}
+
+/**
+ * @brief 在所有打开的标签页中将 \a replaceText 替换为 \a withText 。先并行查找各标签页的文本快照，
+ *      查找完成后仅替换存在匹配项的文档，各文档的替换记录在自身的撤销栈中，可通过结果面板统一撤销。
+ */
+void Window::handleReplaceInTabs(const QString &replaceText, const QString &withText)
+{
+    m_searchController->flush();
+    if (replaceText.isEmpty()) {
+        return;
+    }
+
+    m_tabsReplacePending = true;
+    m_tabsReplaceWithText = withText;
+    startTabsSearch(replaceText, m_replaceBar->searchFlags());
+}
+
+void Window::startTabsSearch(const QString &keyword, TextSearchEngine::SearchFlags flags)
+{
+    m_folderSearch->cancel();
+    m_folderSearchActive = false;
+
+    m_tabsReplaceRevisions.clear();
+    m_tabsReplaceResults.clear();
+    QVector<MultiDocumentSearch::Document> documents;
+    for (int i = 0; i < m_tabbar->count(); ++i) {
+        const QString filePath = m_tabbar->fileAt(i);
+        EditWrapper *wrapper = m_wrappers.value(filePath);
+        // 超大文件只读视图的内容未加载到文档，不参与查找替换
+        if (wrapper != nullptr && !wrapper->isLargeFileView()) {
+            TextEdit *textEdit = wrapper->textEditor();
+            documents.append({filePath, textEdit->toPlainText()});
+            // 文档未启用 QTextDocument 自身的撤销，版本号随每次编辑递增，版本号不变即内容与快照一致
+            if (m_tabsReplacePending) {
+                m_tabsReplaceRevisions.insert(filePath, qMakePair(QPointer<TextEdit>(textEdit), textEdit->document()->revision()));
+            }
+        }
+    }
+
+    m_searchResultPanel->startSearch(keyword);
+    m_searchResultPanel->show();
+    if (m_tabsReplacePending) {
+        m_tabsSearch->startReplace(documents, keyword, flags, m_tabsReplaceWithText);
+    } else {
+        m_tabsSearch->start(documents, keyword, flags);
+    }
+    if (documents.isEmpty()) {
+        handleTabsSearchFinished();
+    }
+}
+
+void Window::handleTabsSearchResult(const MultiDocumentSearch::FileResult &result)
+{
+    const int index = m_tabbar->indexOf(result.filePath);
+    const QString fileName = index >= 0 ? m_tabbar->textAt(index) : QFileInfo(result.filePath).fileName();
+    m_searchResultPanel->addFileResult(result, fileName);
+    if (m_tabsReplacePending) {
+        m_tabsReplaceResults.insert(result.filePath, result);
+    }
+}
+
+/**
+ * @brief 多文件查找完成，等待替换时对存在匹配项的文档执行替换。查找后未被编辑的文档直接按后台查找的结果替换，
+ *      查找期间被编辑的文档按当前内容重新查找后替换
+ */
+void Window::handleTabsSearchFinished()
+{
+    if (!m_tabsReplacePending) {
+        m_searchResultPanel->setFinished();
+        return;
+    }
+
+    m_tabsReplacePending = false;
+    const QString replaceText = m_tabsSearch->keyword();
+    const TextSearchEngine::SearchFlags flags = m_tabsSearch->searchFlags();
+    // 只读的标签页不替换，仅统计实际替换的匹配项
+    int replacedCount = 0;
+
+    m_tabsReplaceHistory.clear();
+    for (const QString &filePath : m_searchResultPanel->resultFiles()) {
+        EditWrapper *wrapper = m_wrappers.value(filePath);
+        if (wrapper == nullptr) {
+            continue;
+        }
+
+        TextEdit *textEdit = wrapper->textEditor();
+        const int undoIndex = textEdit->getUndoStack()->index();
+        const QPair<QPointer<TextEdit>, int> revision = m_tabsReplaceRevisions.value(filePath);
+        if (revision.first == textEdit && revision.second == textEdit->document()->revision()
+                && m_tabsReplaceResults.contains(filePath)) {
+            const MultiDocumentSearch::FileResult &result = m_tabsReplaceResults[filePath];
+            replacedCount += textEdit->replaceMatches(result.searchResult, replaceText, m_tabsReplaceWithText,
+                                                      result.oldTexts, result.newTexts);
+        } else {
+            // 查找期间文档被编辑，按当前内容重新查找，完成后恢复标签页查找栏的查找模式
+            const TextSearchEngine::SearchFlags editFlags = textEdit->searchFlags();
+            textEdit->setSearchFlags(flags);
+            replacedCount += textEdit->replaceAll(replaceText, m_tabsReplaceWithText);
+            textEdit->setSearchFlags(editFlags);
+        }
+        if (textEdit->getUndoStack()->index() != undoIndex) {
+            m_tabsReplaceHistory.append(qMakePair(QPointer<TextEdit>(textEdit), textEdit->getUndoStack()->index()));
+        }
+    }
+
+    m_tabsReplaceRevisions.clear();
+    m_tabsReplaceResults.clear();
+    m_searchResultPanel->showMessage(tr("Replaced %1 matches in %2 files").arg(replacedCount).arg(m_tabsReplaceHistory.size()));
+    m_searchResultPanel->setUndoReplaceEnabled(!m_tabsReplaceHistory.isEmpty());
+}
+
+/**
+ * @brief 跳转到查找结果中的匹配项。标签页查找结果基于查找时的文本快照，之后文档被编辑时位置可能偏移；
+ *      文件夹查找结果中的文件可能尚未打开，打开后按行号及列号定位
+ */
+void Window::handleSearchResultActivated(const QString &filePath, int offset, int length, int line, int column)
+{
+    if (m_folderSearchActive) {
+        StartManager::instance()->openFilesInTab(QStringList(filePath));
+        Window *window = StartManager::instance()->windowForFile(filePath);
+        if (window != nullptr) {
+            window->jumpToFileLocation(filePath, line, column, length);
+        }
+        return;
+    }
+
+    if (!m_wrappers.contains(filePath)) {
+        return;
+    }
+
+    activeTab(m_tabbar->indexOf(filePath));
+    TextEdit *textEdit = m_wrappers.value(filePath)->textEditor();
+    const int maxPosition = textEdit->document()->characterCount() - 1;
+    QTextCursor cursor(textEdit->document());
+    cursor.setPosition(qMin(offset, maxPosition));
+    cursor.setPosition(qMin(offset + length, maxPosition), QTextCursor::KeepAnchor);
+    textEdit->setTextCursor(cursor);
+    textEdit->centerCursor();
+    textEdit->setFocus();
+}
+
+/**
+ * @brief 撤销上次多文件替换，替换后已再次编辑的文档不撤销
+ */
+void Window::handleUndoReplaceInTabs()
+{
+    int undoCount = 0;
+    for (const QPair<QPointer<TextEdit>, int> &record : m_tabsReplaceHistory) {
+        if (record.first && record.first->getUndoStack()->index() == record.second) {
+            record.first->getUndoStack()->undo();
+            ++undoCount;
+        }
+    }
+
+    m_tabsReplaceHistory.clear();
+    m_searchResultPanel->setUndoReplaceEnabled(false);
+    m_searchResultPanel->showMessage(tr("Replacement undone in %1 files").arg(undoCount));
+}
+
+/**
+ * @brief 在文件夹的所有文件中查找关键字 \a keyword ，文件夹默认为当前文件所在目录或上次查找的目录。
+ *      文件在后台映射查找，不打开标签页，结果按相对路径分组显示在查找结果面板中
+ */
+void Window::handleFindInFolder(const QString &keyword)
+{
+    m_searchController->flush();
+    if (keyword.isEmpty()) {
+        return;
+    }
+
+    QString directory = m_folderSearch->folder();
+    if (directory.isEmpty() || !QDir(directory).exists()) {
+        directory = getCurrentOpenFilePath();
+    }
+    if (directory.isEmpty() || !QDir(directory).exists()) {
+        directory = QDir::homePath();
+    }
+
+    const QString folder = QFileDialog::getExistingDirectory(this, tr("Find in Folder"), directory);
+    if (folder.isEmpty()) {
+        return;
+    }
+
+    m_tabsSearch->cancel();
+    m_tabsReplacePending = false;
+    m_tabsReplaceRevisions.clear();
+    m_tabsReplaceResults.clear();
+    m_folderSearchActive = true;
+    m_searchResultPanel->startSearch(keyword);
+    m_searchResultPanel->setUndoReplaceEnabled(false);
+    m_searchResultPanel->show();
+    m_folderSearch->start(folder, keyword, m_findBar->searchFlags());
+}
+
+void Window::handleFolderSearchResult(const MultiDocumentSearch::FileResult &result)
+{
+    m_searchResultPanel->addFileResult(result, QDir(m_folderSearch->folder()).relativeFilePath(result.filePath));
+}
+
+void Window::handleFolderSearchFinished()
+{
+    m_searchResultPanel->setFinished(m_folderSearch->skippedCount());
+}
+
+/**
+ * @brief 跳转到文件 \a filePath 第 \a line 行第 \a column 列并选中 \a length 个字符，
+ *      行号或列号超出文档范围时定位到最后一行或行尾
+ */
+void Window::jumpToFileLocation(const QString &filePath, int line, int column, int length)
+{
+    EditWrapper *wrapper = m_wrappers.value(filePath);
+    if (wrapper == nullptr) {
+        return;
+    }
+
+    activeTab(m_tabbar->indexOf(filePath));
+    if (!wrapper->isFileLoaded()) {
+        m_pendingLocations.insert(filePath, {line, column, length});
+        return;
+    }
+
+    if (LargeFileView *view = wrapper->largeFileView()) {
+        view->jumpToLine(line);
+        view->setFocus();
+        return;
+    }
+
+    TextEdit *textEdit = wrapper->textEditor();
+    QTextBlock block = textEdit->document()->findBlockByNumber(line);
+    if (!block.isValid()) {
+        block = textEdit->document()->lastBlock();
+    }
+
+    const int maxPosition = textEdit->document()->characterCount() - 1;
+    const int position = block.position() + qBound(0, column, block.length() - 1);
+    QTextCursor cursor(textEdit->document());
+    cursor.setPosition(qMin(position, maxPosition));
+    cursor.setPosition(qMin(position + length, maxPosition), QTextCursor::KeepAnchor);
+    textEdit->setTextCursor(cursor);
+    textEdit->centerCursor();
+    textEdit->setFocus();
+}
+
 void Window::loadTheme(const QString &path)
 {
     QFileInfo fileInfo(path);
@@ -20,7 +20,12 @@
 #include "../common/dbusinterface.h"
 #include "../common/iflytekaiassistantthread.h"
 #include "../common/CSyntaxHighlighter.h"
+#include "../common/searchcontroller.h"
+#include "../common/multidocumentsearch.h"
+#include "../common/foldersearch.h"
+#include "searchresultpanel.h"
 #include <DMainWindow>
+#include <QPointer>
 #include <DStackedWidget>
 #include <qprintpreviewdialog.h>
 #include <dprintpreviewdialog.h>
@@ -86,8 +91,21 @@ public:
     void focusActiveEditor();
     void removeWrapper(const QString &filePath, bool isDelete = false);
 
+    // 保存状态
+    enum SaveStatus {
+        SaveFailed,         // 保存失败
+        SaveSucceeded,      // 保存完成
+        SavePending,        // 后台保存中，结果由 EditWrapper::sigAsyncSaveFinished 通知
+    };
+
     void openFile();
+    // 保存当前文件，仅在保存完成且成功时返回 true ，后台保存时返回 false
     bool saveFile();
+    SaveStatus saveCurrentFile();
+    // 文件保存成功后更新标签页信息并删除备份文件
+    void handleFileSaved(const QString &temPath, const QString &filePath);
+    // 删除文件 filePath 的自动备份文件及增量备份日志
+    void removeAutoBackupFile(EditWrapper *wrapper, const QString &filePath);
     bool saveAsFile();
     QString saveAsFileToDisk();
     QString saveBlankFileToDisk();
@@ -183,7 +201,23 @@ public Q_SLOTS:
     void handleReplaceSkip(QString file, QString keyword);
 
     void handleRemoveSearchKeyword();
+    void handleSearchKeywordChanged(const QString &file, const QString &keyword);
     void handleUpdateSearchKeyword(QWidget *widget, const QString &file, const QString &keyword);
+    // 更新查找栏的匹配项序号及总数
+    void updateFindMatchCount();
+    // 在所有打开的标签页中查找、替换
+    void handleFindInTabs(const QString &keyword);
+    void handleReplaceInTabs(const QString &replaceText, const QString &withText);
+    void handleTabsSearchResult(const MultiDocumentSearch::FileResult &result);
+    void handleTabsSearchFinished();
+    void handleSearchResultActivated(const QString &filePath, int offset, int length, int line, int column);
+    void handleUndoReplaceInTabs();
+    // 在文件夹的所有文件中查找
+    void handleFindInFolder(const QString &keyword);
+    void handleFolderSearchResult(const MultiDocumentSearch::FileResult &result);
+    void handleFolderSearchFinished();
+    // 跳转到文件 filePath 第 line 行第 column 列并选中 length 个字符，文件未加载完成时在加载完成后跳转
+    void jumpToFileLocation(const QString &filePath, int line, int column, int length);
 
     void loadTheme(const QString &path);
 
@@ -220,6 +254,8 @@ public Q_SLOTS:
 
 private:
     void handleFocusWindowChanged(QWindow *w);
+    // 复制所有标签页的文本快照，在后台并行查找
+    void startTabsSearch(const QString &keyword, TextSearchEngine::SearchFlags flags);
     void updateThemePanelGeomerty();
     void checkTabbarForReload();
     void clearPrintTextDocument();
@@ -265,6 +301,17 @@ private:
     ReplaceBar *m_replaceBar {nullptr};
     ThemePanel *m_themePanel {nullptr};
     FindBar *m_findBar {nullptr};
+    SearchController *m_searchController {nullptr};   // 输入关键字时延迟查找
+    MultiDocumentSearch *m_tabsSearch {nullptr};        // 在所有标签页中查找
+    SearchResultPanel *m_searchResultPanel {nullptr};   // 多文件查找结果面板
+    QString m_tabsReplaceWithText;                      // 多文件替换的替换文本
+    bool m_tabsReplacePending = false;                  // 多文件查找完成后执行替换
+    QList<QPair<QPointer<TextEdit>, int>> m_tabsReplaceHistory; // 多文件替换后各文档的撤销栈位置
+    QMap<QString, QPair<QPointer<TextEdit>, int>> m_tabsReplaceRevisions; // 多文件替换时各文档快照的版本号
+    QMap<QString, MultiDocumentSearch::FileResult> m_tabsReplaceResults;  // 多文件替换时各文档的查找结果
+    FolderSearch *m_folderSearch {nullptr};             // 在文件夹中查找
+    bool m_folderSearchActive = false;                  // 查找结果面板显示的是否为文件夹查找结果
+    QMap<QString, QVector<int>> m_pendingLocations;     // 等待加载完成后跳转的文件位置(行号、列号、选中长度)
     Settings *m_settings {nullptr};
 
     QMap<QString, EditWrapper *> m_wrappers;
@@ -0,0 +1,251 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "ut_backupjournal.h"
+#include "../../src/common/backupjournal.h"
+
+#include <QFile>
+#include <QTextCodec>
+#include <QTextCursor>
+#include <QTextCharFormat>
+#include <QTextDocument>
+
+// 全量写入基准文件
+static void writeBaseFile(const QString &filePath, const QByteArray &data)
+{
+    QFile file(filePath);
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    file.write(data);
+    file.close();
+}
+
+static QByteArray readFile(const QString &filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QByteArray();
+    }
+    return file.readAll();
+}
+
+// 在位置 pos 删除 removed 个字符并插入 text
+static void editDocument(QTextDocument *document, int pos, int removed, const QString &text)
+{
+    QTextCursor cursor(document);
+    cursor.setPosition(pos);
+    cursor.setPosition(pos + removed, QTextCursor::KeepAnchor);
+    cursor.insertText(text);
+}
+
+// 与备份线程相同的方式追加变更区域，失败时停止记录(同 EditWrapper 处理备份完成通知)
+static bool appendJournal(BackupJournal &journal)
+{
+    if (!journal.isValid()) {
+        return false;
+    }
+    if (!BackupJournal::appendRecords(journal.basePath(), journal.takeRecords(), journal.length())) {
+        journal.invalidate();
+        return false;
+    }
+    return true;
+}
+
+test_backupjournal::test_backupjournal()
+{
+}
+
+void test_backupjournal::SetUp()
+{
+    m_basePath = "/tmp/ut_backupjournal_base.txt";
+}
+
+void test_backupjournal::TearDown()
+{
+    QFile::remove(BackupJournal::journalPath(m_basePath));
+    QFile::remove(m_basePath);
+}
+
+//static QString journalPath(const QString &basePath);
+TEST_F(test_backupjournal, journalPath)
+{
+    EXPECT_EQ(BackupJournal::journalPath("/tmp/dir/file.txt"), QString("/tmp/dir/.file.txt.journal"));
+}
+
+//static bool replay(const QString &basePath);
+TEST_F(test_backupjournal, appendAndReplay)
+{
+    QTextDocument document;
+    document.setPlainText(QString("first line\nsecond line\nthird line"));
+    writeBaseFile(m_basePath, document.toPlainText().toUtf8());
+
+    BackupJournal journal(&document);
+    connect(&document, &QTextDocument::contentsChange, &journal, &BackupJournal::recordChange);
+    journal.checkpoint(m_basePath, "UTF-8", false);
+    EXPECT_TRUE(BackupJournal::writeHeader(m_basePath, "UTF-8", false, journal.length()));
+    EXPECT_TRUE(journal.isValid());
+    EXPECT_FALSE(journal.hasPendingChanges());
+
+    // 多次追加，相邻的变更合并为同一区域
+    editDocument(&document, 0, 5, QString("1st"));
+    editDocument(&document, 3, 0, QString("!"));
+    editDocument(&document, document.characterCount() - 1, 0, QString("\nfourth line"));
+    EXPECT_TRUE(journal.hasPendingChanges());
+    EXPECT_TRUE(journal.canAppend(m_basePath, "UTF-8", false));
+    EXPECT_TRUE(appendJournal(journal));
+    EXPECT_FALSE(journal.hasPendingChanges());
+
+    editDocument(&document, 5, 6, QString("中文"));
+    EXPECT_TRUE(appendJournal(journal));
+
+    // 基准文件内容不变，恢复时应用日志
+    EXPECT_TRUE(BackupJournal::replay(m_basePath));
+    EXPECT_EQ(readFile(m_basePath), document.toPlainText().toUtf8());
+    EXPECT_FALSE(QFile::exists(BackupJournal::journalPath(m_basePath)));
+}
+
+//static bool replay(const QString &basePath);
+TEST_F(test_backupjournal, replay_WindowsEndlineGB18030)
+{
+    QTextCodec *codec = QTextCodec::codecForName("GB18030");
+    ASSERT_NE(codec, nullptr);
+
+    QTextDocument document;
+    document.setPlainText(QString("第一行\n第二行"));
+    QString baseText = document.toPlainText();
+    baseText.replace("\n", "\r\n");
+    writeBaseFile(m_basePath, codec->fromUnicode(baseText));
+
+    BackupJournal journal(&document);
+    connect(&document, &QTextDocument::contentsChange, &journal, &BackupJournal::recordChange);
+    journal.checkpoint(m_basePath, "GB18030", true);
+    EXPECT_TRUE(BackupJournal::writeHeader(m_basePath, "GB18030", true, journal.length()));
+    EXPECT_FALSE(journal.canAppend(m_basePath, "UTF-8", true));
+
+    editDocument(&document, 4, 0, QString("插入\n"));
+    EXPECT_TRUE(appendJournal(journal));
+
+    EXPECT_TRUE(BackupJournal::replay(m_basePath));
+    QString expected = document.toPlainText();
+    expected.replace("\n", "\r\n");
+    EXPECT_EQ(readFile(m_basePath), codec->fromUnicode(expected));
+}
+
+//static bool replay(const QString &basePath);
+TEST_F(test_backupjournal, replay_UncommittedRecord)
+{
+    QTextDocument document;
+    document.setPlainText(QString("text"));
+    writeBaseFile(m_basePath, QByteArray("text"));
+
+    BackupJournal journal(&document);
+    connect(&document, &QTextDocument::contentsChange, &journal, &BackupJournal::recordChange);
+    journal.checkpoint(m_basePath, "UTF-8", false);
+    EXPECT_TRUE(BackupJournal::writeHeader(m_basePath, "UTF-8", false, journal.length()));
+    editDocument(&document, 4, 0, QString(" appended"));
+    EXPECT_TRUE(appendJournal(journal));
+
+    // 模拟追加过程中断，末尾的记录不完整
+    QFile journalFile(BackupJournal::journalPath(m_basePath));
+    ASSERT_TRUE(journalFile.open(QIODevice::WriteOnly | QIODevice::Append));
+    journalFile.write(QByteArray("\x01\x00\x00", 3));
+    journalFile.close();
+
+    EXPECT_TRUE(BackupJournal::replay(m_basePath));
+    EXPECT_EQ(readFile(m_basePath), QByteArray("text appended"));
+}
+
+//static bool replay(const QString &basePath);
+TEST_F(test_backupjournal, replay_BaseFileChanged)
+{
+    QTextDocument document;
+    document.setPlainText(QString("text"));
+    writeBaseFile(m_basePath, QByteArray("text"));
+
+    BackupJournal journal(&document);
+    connect(&document, &QTextDocument::contentsChange, &journal, &BackupJournal::recordChange);
+    journal.checkpoint(m_basePath, "UTF-8", false);
+    EXPECT_TRUE(BackupJournal::writeHeader(m_basePath, "UTF-8", false, journal.length()));
+    editDocument(&document, 0, 0, QString("new "));
+    EXPECT_TRUE(appendJournal(journal));
+
+    // 基准文件被其它方式修改，不再追加日志，恢复时丢弃日志
+    writeBaseFile(m_basePath, QByteArray("other"));
+    editDocument(&document, 0, 0, QString("more "));
+    EXPECT_FALSE(appendJournal(journal));
+    EXPECT_FALSE(journal.isValid());
+    EXPECT_FALSE(BackupJournal::replay(m_basePath));
+    EXPECT_EQ(readFile(m_basePath), QByteArray("other"));
+    EXPECT_FALSE(QFile::exists(BackupJournal::journalPath(m_basePath)));
+}
+
+//QVector<Record> takeRecords();
+TEST_F(test_backupjournal, takeRecords)
+{
+    QTextDocument document;
+    document.setPlainText(QString("aaaa\nbbbb\ncccc"));
+
+    BackupJournal journal(&document);
+    connect(&document, &QTextDocument::contentsChange, &journal, &BackupJournal::recordChange);
+    journal.checkpoint(m_basePath, "UTF-8", false);
+
+    // 不相邻的变更生成两条记录，位置为当前文档中的位置
+    editDocument(&document, 1, 2, QString("X"));
+    editDocument(&document, 10, 0, QString("YY"));
+    QVector<BackupJournal::Record> records = journal.takeRecords();
+    ASSERT_EQ(records.size(), 2);
+    EXPECT_EQ(records.at(0).start, 1);
+    EXPECT_EQ(records.at(0).baseLength, 2);
+    EXPECT_EQ(records.at(0).text, QString("X"));
+    EXPECT_EQ(records.at(1).start, 10);
+    EXPECT_EQ(records.at(1).baseLength, 0);
+    EXPECT_EQ(records.at(1).text, QString("YY"));
+    EXPECT_FALSE(journal.hasPendingChanges());
+    EXPECT_EQ(journal.length(), document.characterCount() - 1);
+}
+
+//void recordChange(int from, int charsRemoved, int charsAdded);
+TEST_F(test_backupjournal, recordChange_FormatOnly)
+{
+    QTextDocument document;
+    document.setPlainText(QString("aaaa\nbbbb\ncccc"));
+
+    BackupJournal journal(&document);
+    connect(&document, &QTextDocument::contentsChange, &journal, &BackupJournal::recordChange);
+    journal.checkpoint(m_basePath, "UTF-8", false);
+
+    // 仅变更格式，文本未修改
+    QTextCursor cursor(&document);
+    cursor.setPosition(5);
+    cursor.setPosition(9, QTextCursor::KeepAnchor);
+    QTextCharFormat format;
+    format.setFontWeight(QFont::Bold);
+    cursor.mergeCharFormat(format);
+    EXPECT_FALSE(journal.hasPendingChanges());
+
+    // 长度不变的文本替换仍需记录
+    editDocument(&document, 5, 4, QString("BBBB"));
+    QVector<BackupJournal::Record> records = journal.takeRecords();
+    ASSERT_EQ(records.size(), 1);
+    EXPECT_EQ(records.at(0).start, 5);
+    EXPECT_EQ(records.at(0).text, QString("BBBB"));
+}
+
+//void recordChange(int from, int charsRemoved, int charsAdded);
+TEST_F(test_backupjournal, recordChange_Invalidate)
+{
+    QTextDocument document;
+    document.setPlainText(QString("text"));
+    writeBaseFile(m_basePath, QByteArray("text"));
+
+    BackupJournal journal(&document);
+    connect(&document, &QTextDocument::contentsChange, &journal, &BackupJournal::recordChange);
+    journal.checkpoint(m_basePath, "UTF-8", false);
+    EXPECT_TRUE(BackupJournal::writeHeader(m_basePath, "UTF-8", false, journal.length()));
+
+    // 与文档长度不一致的变更信息，停止记录
+    journal.recordChange(0, 100, 0);
+    EXPECT_FALSE(journal.isValid());
+    EXPECT_FALSE(journal.canAppend(m_basePath, "UTF-8", false));
+    EXPECT_FALSE(appendJournal(journal));
+}
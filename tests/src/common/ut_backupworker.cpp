@@ -0,0 +1,117 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "ut_backupworker.h"
+#include "../../src/common/backupworker.h"
+
+#include <QFile>
+
+static QByteArray readFile(const QString &filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QByteArray();
+    }
+    return file.readAll();
+}
+
+test_backupworker::test_backupworker()
+{
+}
+
+void test_backupworker::SetUp()
+{
+    m_basePath = "/tmp/ut_backupworker_base.txt";
+}
+
+void test_backupworker::TearDown()
+{
+    BackupWorker::instance()->waitForIdle();
+    QFile::remove(BackupJournal::journalPath(m_basePath));
+    QFile::remove(m_basePath);
+}
+
+//void enqueue(const Task &task);
+TEST_F(test_backupworker, enqueue_FullBackupAndAppend)
+{
+    BackupWorker::Task fullTask;
+    fullTask.type = BackupWorker::FullBackup;
+    fullTask.basePath = m_basePath;
+    fullTask.encode = "UTF-8";
+    fullTask.snapshot = {"line1", "line2"};
+    fullTask.length = 11;
+    BackupWorker::instance()->enqueue(fullTask);
+
+    BackupJournal::Record record;
+    record.start = 5;
+    record.baseLength = 0;
+    record.text = QString(" appended");
+    BackupWorker::Task appendTask;
+    appendTask.type = BackupWorker::JournalAppend;
+    appendTask.basePath = m_basePath;
+    appendTask.encode = "UTF-8";
+    appendTask.records.append(record);
+    appendTask.length = fullTask.length + record.text.length();
+    BackupWorker::instance()->enqueue(appendTask);
+
+    BackupWorker::instance()->waitForIdle();
+    EXPECT_EQ(BackupWorker::instance()->pendingCount(), 0);
+    EXPECT_EQ(readFile(m_basePath), QByteArray("line1\nline2"));
+    EXPECT_TRUE(QFile::exists(BackupJournal::journalPath(m_basePath)));
+
+    EXPECT_TRUE(BackupJournal::replay(m_basePath));
+    EXPECT_EQ(readFile(m_basePath), QByteArray("line1 appended\nline2"));
+}
+
+//void enqueue(const Task &task);
+TEST_F(test_backupworker, enqueue_Coalesce)
+{
+    BackupWorker worker;
+    BackupWorker::Task appendTask;
+    appendTask.type = BackupWorker::JournalAppend;
+    appendTask.basePath = m_basePath;
+    appendTask.records.append(BackupJournal::Record{0, 0, QString("a")});
+    appendTask.length = 1;
+
+    // 线程未启动，任务保留在队列中，连续的日志追加合并
+    worker.enqueue(appendTask);
+    appendTask.length = 2;
+    worker.enqueue(appendTask);
+    EXPECT_EQ(worker.pendingCount(), 1);
+    EXPECT_EQ(worker.m_tasks.first().records.size(), 2);
+    EXPECT_EQ(worker.m_tasks.first().length, 2);
+
+    // 全量备份替换同一文件未执行的任务
+    BackupWorker::Task fullTask;
+    fullTask.basePath = m_basePath;
+    worker.enqueue(fullTask);
+    EXPECT_EQ(worker.pendingCount(), 1);
+    EXPECT_EQ(worker.m_tasks.first().type, BackupWorker::FullBackup);
+
+    worker.m_tasks.clear();
+}
+
+//void cancel(const QString &basePath);
+TEST_F(test_backupworker, cancel)
+{
+    BackupWorker worker;
+    BackupWorker::Task fullTask;
+    fullTask.basePath = m_basePath;
+    worker.enqueue(fullTask);
+    BackupWorker::Task appendTask;
+    appendTask.type = BackupWorker::JournalAppend;
+    appendTask.basePath = m_basePath;
+    worker.enqueue(appendTask);
+    BackupWorker::Task otherTask;
+    otherTask.basePath = m_basePath + ".other";
+    worker.enqueue(otherTask);
+    EXPECT_EQ(worker.pendingCount(), 3);
+
+    // 仅取消同一备份文件未执行的任务
+    worker.cancel(m_basePath);
+    EXPECT_EQ(worker.pendingCount(), 1);
+    EXPECT_EQ(worker.m_tasks.first().basePath, otherTask.basePath);
+
+    worker.m_tasks.clear();
+}
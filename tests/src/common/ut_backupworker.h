@@ -0,0 +1,22 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef UT_BACKUPWORKER_H
+#define UT_BACKUPWORKER_H
+
+#include "gtest/gtest.h"
+#include <QObject>
+
+class test_backupworker : public QObject
+    , public ::testing::Test
+{
+public:
+    test_backupworker();
+    virtual void SetUp() override;
+    virtual void TearDown() override;
+
+    QString m_basePath;
+};
+
+#endif // UT_BACKUPWORKER_H
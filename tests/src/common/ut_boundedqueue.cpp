@@ -0,0 +1,93 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "ut_boundedqueue.h"
+#include "../../src/common/boundedqueue.h"
+
+#include <QtConcurrent>
+
+test_boundedqueue::test_boundedqueue()
+{
+}
+
+void test_boundedqueue::SetUp()
+{
+}
+
+void test_boundedqueue::TearDown()
+{
+}
+
+//bool push(const T &item);
+//bool pop(T &item);
+TEST_F(test_boundedqueue, pushAndPop)
+{
+    BoundedQueue<int> queue(2);
+    EXPECT_TRUE(queue.push(1));
+    EXPECT_TRUE(queue.push(2));
+    EXPECT_EQ(queue.size(), 2);
+
+    int value = 0;
+    EXPECT_TRUE(queue.pop(value));
+    EXPECT_EQ(value, 1);
+    EXPECT_TRUE(queue.tryPop(value));
+    EXPECT_EQ(value, 2);
+    EXPECT_FALSE(queue.tryPop(value));
+}
+
+//void close();
+TEST_F(test_boundedqueue, close)
+{
+    BoundedQueue<int> queue(2);
+    queue.push(1);
+    queue.close();
+
+    EXPECT_TRUE(queue.isClosed());
+    EXPECT_FALSE(queue.push(2));
+
+    // 关闭后仍可取出剩余数据
+    int value = 0;
+    EXPECT_TRUE(queue.pop(value));
+    EXPECT_EQ(value, 1);
+    EXPECT_FALSE(queue.pop(value));
+}
+
+//void abort();
+TEST_F(test_boundedqueue, abort)
+{
+    BoundedQueue<int> queue(2);
+    queue.push(1);
+    queue.abort();
+
+    int value = 0;
+    EXPECT_FALSE(queue.pop(value));
+    EXPECT_EQ(queue.size(), 0);
+}
+
+TEST_F(test_boundedqueue, producerConsumer)
+{
+    BoundedQueue<int> queue(1);
+    const int count = 100;
+
+    // 队列容量为1，生产者需等待消费者取出数据后才能继续追加
+    QFuture<void> producer = QtConcurrent::run([&queue, count]() {
+        for (int i = 0; i < count; ++i) {
+            queue.push(i);
+        }
+        queue.close();
+    });
+
+    int value = 0;
+    int sum = 0;
+    int popCount = 0;
+    while (queue.pop(value)) {
+        sum += value;
+        ++popCount;
+    }
+
+    producer.waitForFinished();
+
+    EXPECT_EQ(popCount, count);
+    EXPECT_EQ(sum, count * (count - 1) / 2);
+}
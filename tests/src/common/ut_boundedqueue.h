@@ -0,0 +1,20 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef UT_BOUNDEDQUEUE_H
+#define UT_BOUNDEDQUEUE_H
+
+#include "gtest/gtest.h"
+#include <QObject>
+
+class test_boundedqueue : public QObject
+    , public ::testing::Test
+{
+public:
+    test_boundedqueue();
+    virtual void SetUp() override;
+    virtual void TearDown() override;
+};
+
+#endif // UT_BOUNDEDQUEUE_H
@@ -101,3 +101,70 @@ TEST_F(test_fileloadthread, readError)
     thread->deleteLater();
     tmpFile.remove();
 }
+
+//static qint64 findChunkBoundary(const uchar *data, qint64 len, bool isUtf8);
+TEST_F(test_fileloadthread, findChunkBoundary)
+{
+    QByteArray lineData("first line\nsecond");
+    EXPECT_EQ(FileLoadThread::findChunkBoundary(reinterpret_cast<const uchar *>(lineData.constData()), lineData.size(), true), 11);
+
+    // 无换行符时回退到完整的 UTF-8 字符边界
+    QByteArray utf8Data = QString("测试").toUtf8();
+    utf8Data.chop(1);
+    EXPECT_EQ(FileLoadThread::findChunkBoundary(reinterpret_cast<const uchar *>(utf8Data.constData()), utf8Data.size(), true), 3);
+    EXPECT_EQ(FileLoadThread::findChunkBoundary(reinterpret_cast<const uchar *>(utf8Data.constData()), utf8Data.size(), false), utf8Data.size());
+}
+
+//void cancel();
+TEST_F(test_fileloadthread, cancel)
+{
+    FileLoadThread *thread = new FileLoadThread("aa");
+    thread->cancel();
+
+    EXPECT_TRUE(thread->m_bCancel.loadAcquire());
+    EXPECT_TRUE(thread->m_rawQueue.isClosed());
+    EXPECT_TRUE(thread->m_textQueue.isClosed());
+    thread->deleteLater();
+}
+
+//bool takeChunk(StreamChunk &chunk);
+TEST_F(test_fileloadthread, takeChunk)
+{
+    FileLoadThread *thread = new FileLoadThread("aa");
+    FileLoadThread::StreamChunk chunk;
+    EXPECT_FALSE(thread->takeChunk(chunk));
+
+    chunk.text = "test";
+    chunk.readSize = 4;
+    thread->m_textQueue.push(chunk);
+
+    FileLoadThread::StreamChunk outChunk;
+    EXPECT_TRUE(thread->takeChunk(outChunk));
+    EXPECT_EQ(outChunk.text, QString("test"));
+    EXPECT_EQ(outChunk.readSize, 4);
+    thread->deleteLater();
+}
+
+//bool decodeStage(const QString &textEncode, qint64 totalSize);
+TEST_F(test_fileloadthread, decodeStage)
+{
+    FileLoadThread *thread = new FileLoadThread("aa");
+    FileLoadThread::StreamChunk chunk;
+    // 多字节字符跨数据块分割
+    QByteArray data = QString("测试").toUtf8();
+    chunk.data = data.left(4);
+    thread->m_rawQueue.push(chunk);
+    chunk.data = data.mid(4);
+    thread->m_rawQueue.push(chunk);
+    thread->m_rawQueue.close();
+
+    EXPECT_TRUE(thread->decodeStage("UTF-8", data.size()));
+
+    QString text;
+    FileLoadThread::StreamChunk outChunk;
+    while (thread->takeChunk(outChunk)) {
+        text += outChunk.text;
+    }
+    EXPECT_EQ(text, QString("测试"));
+    thread->deleteLater();
+}
@@ -0,0 +1,64 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "ut_filesavethread.h"
+#include "../../src/common/filesavethread.h"
+
+#include <QFile>
+#include <QSignalSpy>
+
+test_filesavethread::test_filesavethread()
+{
+}
+
+void test_filesavethread::SetUp()
+{
+}
+
+void test_filesavethread::TearDown()
+{
+}
+
+//FileSaveThread(const QString &filePath, const TextFileWriter::BlockSnapshot &snapshot, const QString &encode, bool windowsEndline, QObject *parent = nullptr);
+TEST_F(test_filesavethread, FileSaveThread)
+{
+    FileSaveThread thread("/tmp/ut_filesavethread.txt", {"text"}, "UTF-8", false);
+    EXPECT_EQ(thread.filePath(), QString("/tmp/ut_filesavethread.txt"));
+    EXPECT_EQ(thread.encode(), QString("UTF-8"));
+}
+
+//void run();
+TEST_F(test_filesavethread, run)
+{
+    QString filePath("/tmp/ut_filesavethread_run.txt");
+    FileSaveThread thread(filePath, {"line1", "line2"}, "UTF-8", true);
+    QSignalSpy finishedSpy(&thread, &FileSaveThread::sigSaveFinished);
+    QSignalSpy progressSpy(&thread, &FileSaveThread::sigSaveProgress);
+
+    thread.start();
+    EXPECT_TRUE(thread.wait(10000));
+    ASSERT_EQ(finishedSpy.count(), 1);
+    EXPECT_TRUE(finishedSpy.at(0).at(0).toBool());
+    EXPECT_FALSE(finishedSpy.at(0).at(1).toBool());
+    ASSERT_GE(progressSpy.count(), 1);
+    EXPECT_EQ(progressSpy.last().at(0).toInt(), 100);
+
+    QFile file(filePath);
+    ASSERT_TRUE(file.open(QIODevice::ReadOnly));
+    EXPECT_EQ(file.readAll(), QByteArray("line1\r\nline2"));
+    file.close();
+    file.remove();
+}
+
+//void run();
+TEST_F(test_filesavethread, run_OpenFailed)
+{
+    FileSaveThread thread("/tmp/ut_filesavethread_not_exist_dir/save.txt", {"text"}, "UTF-8", false);
+    QSignalSpy finishedSpy(&thread, &FileSaveThread::sigSaveFinished);
+
+    thread.run();
+    ASSERT_EQ(finishedSpy.count(), 1);
+    EXPECT_FALSE(finishedSpy.at(0).at(0).toBool());
+    EXPECT_TRUE(finishedSpy.at(0).at(1).toBool());
+}
@@ -0,0 +1,136 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "ut_foldersearch.h"
+#include "../../src/common/foldersearch.h"
+
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QDir>
+#include <QFile>
+#include <QTextCodec>
+
+namespace {
+
+void writeFile(const QString &filePath, const QByteArray &content)
+{
+    QDir().mkpath(QFileInfo(filePath).absolutePath());
+    QFile file(filePath);
+    if (file.open(QIODevice::WriteOnly)) {
+        file.write(content);
+    }
+}
+
+}
+
+test_foldersearch::test_foldersearch()
+{
+}
+
+void test_foldersearch::SetUp()
+{
+}
+
+void test_foldersearch::TearDown()
+{
+}
+
+//static FileResult searchFile(const QString &filePath, const QString &keyword, TextSearchEngine::SearchFlags flags, const QAtomicInt *canceled);
+TEST_F(test_foldersearch, searchFile)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+
+    const QString textFile = dir.filePath("text.txt");
+    writeFile(textFile, QByteArray("\xEF\xBB\xBF\xE4\xB8\xAD\xE6\x96\x87 key\nnone\nKEY key"));
+    MultiDocumentSearch::FileResult result = FolderSearch::searchFile(textFile, "key", TextSearchEngine::ENoSearchFlags);
+    EXPECT_EQ(result.filePath, textFile);
+    EXPECT_EQ(result.matchCount, 2);
+    ASSERT_EQ(result.matches.size(), 2);
+    // 跳过 BOM ，列号按字符计算
+    EXPECT_EQ(result.matches.at(0).line, 0);
+    EXPECT_EQ(result.matches.at(0).column, 3);
+    EXPECT_EQ(result.matches.at(1).line, 2);
+    EXPECT_EQ(result.matches.at(1).column, 4);
+
+    result = FolderSearch::searchFile(textFile, "key", TextSearchEngine::ECaseInsensitive);
+    EXPECT_EQ(result.matchCount, 3);
+    result = FolderSearch::searchFile(textFile, "absent", TextSearchEngine::ENoSearchFlags);
+    EXPECT_TRUE(result.matches.isEmpty());
+
+    // 包含 NUL 字节的二进制文件不查找
+    const QString binaryFile = dir.filePath("binary.txt");
+    writeFile(binaryFile, QByteArray("key\0key", 7));
+    EXPECT_TRUE(FolderSearch::searchFile(binaryFile, "key", TextSearchEngine::ENoSearchFlags).matches.isEmpty());
+}
+
+//static FileResult searchFile(..., bool *skipped);
+TEST_F(test_foldersearch, searchFileEncoding)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    const QString text = QString("第一行\n中文关键字 关键字");
+
+    // 非 UTF-8 文件识别编码后转换查找，列号按字符计算
+    const QString gbFile = dir.filePath("gb18030.txt");
+    writeFile(gbFile, QTextCodec::codecForName("GB18030")->fromUnicode(text.repeated(20)));
+    bool skipped = true;
+    MultiDocumentSearch::FileResult result = FolderSearch::searchFile(gbFile, "关键字", TextSearchEngine::ENoSearchFlags,
+                                                                      nullptr, &skipped);
+    EXPECT_FALSE(skipped);
+    EXPECT_EQ(result.matchCount, 40);
+    ASSERT_FALSE(result.matches.isEmpty());
+    EXPECT_EQ(result.matches.at(0).line, 1);
+    EXPECT_EQ(result.matches.at(0).column, 2);
+
+    // UTF-16 文件包含 NUL 字节，按 BOM 头识别
+    const QString utf16File = dir.filePath("utf16.txt");
+    QByteArray utf16Data = QByteArray::fromHex("FFFE");
+    utf16Data.append(reinterpret_cast<const char *>(text.utf16()), text.size() * 2);
+    writeFile(utf16File, utf16Data);
+    result = FolderSearch::searchFile(utf16File, "关键字", TextSearchEngine::ENoSearchFlags, nullptr, &skipped);
+    EXPECT_FALSE(skipped);
+    EXPECT_EQ(result.matchCount, 2);
+    ASSERT_EQ(result.matches.size(), 2);
+    EXPECT_EQ(result.matches.at(1).line, 1);
+    EXPECT_EQ(result.matches.at(1).column, 6);
+}
+
+//void start(const QString &folder, const QString &keyword, TextSearchEngine::SearchFlags flags);
+TEST_F(test_foldersearch, start)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    for (int i = 0; i < 30; ++i) {
+        writeFile(dir.filePath(QString("sub%1/file%2.txt").arg(i % 3).arg(i)), i % 2 ? QByteArray("port=80\nhost") : QByteArray("host"));
+    }
+    // 隐藏目录及超过大小限制的文件不查找
+    writeFile(dir.filePath(".hidden/file.txt"), QByteArray("port=80"));
+    writeFile(dir.filePath("large.txt"), QByteArray("port=80\n") + QByteArray(4096, 'x'));
+
+    FolderSearch search;
+    search.setMaxFileSize(1024);
+    QSignalSpy resultSpy(&search, &FolderSearch::sigFileResult);
+    QSignalSpy finishedSpy(&search, &FolderSearch::sigFinished);
+    search.start(dir.path(), "port", TextSearchEngine::ENoSearchFlags);
+    EXPECT_TRUE(search.isRunning());
+    ASSERT_TRUE(finishedSpy.wait(10000));
+
+    EXPECT_FALSE(search.isRunning());
+    EXPECT_EQ(search.scannedCount(), 30);
+    EXPECT_EQ(search.matchedFileCount(), 15);
+    EXPECT_EQ(resultSpy.count(), 15);
+    for (const QList<QVariant> &arguments : resultSpy) {
+        const MultiDocumentSearch::FileResult result = arguments.first().value<MultiDocumentSearch::FileResult>();
+        EXPECT_TRUE(result.filePath.startsWith(dir.path()));
+        EXPECT_FALSE(result.filePath.contains(".hidden"));
+        EXPECT_EQ(result.matchCount, 1);
+    }
+
+    // 取消后不再通知
+    search.start(dir.path(), "host", TextSearchEngine::ENoSearchFlags);
+    search.cancel();
+    EXPECT_FALSE(finishedSpy.wait(200));
+    EXPECT_EQ(finishedSpy.count(), 1);
+}
@@ -0,0 +1,20 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef UT_FOLDERSEARCH_H
+#define UT_FOLDERSEARCH_H
+
+#include "gtest/gtest.h"
+#include <QObject>
+
+class test_foldersearch : public QObject
+    , public ::testing::Test
+{
+public:
+    test_foldersearch();
+    virtual void SetUp() override;
+    virtual void TearDown() override;
+};
+
+#endif // UT_FOLDERSEARCH_H
@@ -0,0 +1,103 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "ut_highlightrepository.h"
+#include "../../src/common/highlightrepository.h"
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QDebug>
+
+test_highlightrepository::test_highlightrepository()
+{
+}
+
+void test_highlightrepository::SetUp()
+{
+}
+
+void test_highlightrepository::TearDown()
+{
+}
+
+//static HighlightRepository *instance();
+TEST_F(test_highlightrepository, instance)
+{
+    HighlightRepository *repository = HighlightRepository::instance();
+    EXPECT_EQ(repository, HighlightRepository::instance());
+    EXPECT_EQ(&repository->repository(), &HighlightRepository::instance()->repository());
+    EXPECT_TRUE(repository->isLoaded());
+    EXPECT_FALSE(repository->definitions().isEmpty());
+}
+
+//KSyntaxHighlighting::Definition definitionForFileName(const QString &fileName);
+TEST_F(test_highlightrepository, definitionForFileName)
+{
+    HighlightRepository *repository = HighlightRepository::instance();
+    const KSyntaxHighlighting::Definition def = repository->definitionForFileName("/tmp/a/main.cpp");
+    EXPECT_TRUE(def.isValid());
+    EXPECT_TRUE(repository->m_fileNameDefinitions.contains("main.cpp"));
+    // 仅按文件名匹配，不同路径共用缓存结果
+    EXPECT_EQ(repository->definitionForFileName("/tmp/b/main.cpp"), def);
+    EXPECT_EQ(repository->definitionForName(def.name()), def);
+
+    EXPECT_FALSE(repository->definitionForFileName("/tmp/a/unknown.suffix_no_def").isValid());
+    EXPECT_TRUE(repository->m_fileNameDefinitions.contains("unknown.suffix_no_def"));
+}
+
+// 当前进程常驻内存(KB)，读取失败时返回 0
+static qint64 residentMemoryKB()
+{
+    QFile file("/proc/self/status");
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return 0;
+    }
+
+    const QList<QByteArray> lines = file.readAll().split('\n');
+    for (const QByteArray &line : lines) {
+        if (line.startsWith("VmRSS:")) {
+            return line.mid(6).trimmed().split(' ').first().toLongLong();
+        }
+    }
+    return 0;
+}
+
+// 新建标签页时取得语法定义及主题的耗时及内存，各标签页独立创建仓库与共享仓库对比。
+// 共享仓库使用新建的实例，计时及内存统计包含首次创建仓库的开销
+TEST_F(test_highlightrepository, startupBenchmark)
+{
+    const int tabCount = 10;
+    QElapsedTimer timer;
+
+    qint64 memoryKB = residentMemoryKB();
+    HighlightRepository *shared = new HighlightRepository;
+    timer.start();
+    for (int i = 0; i < tabCount; ++i) {
+        shared->definitionForFileName("main.cpp");
+        shared->defaultTheme(KSyntaxHighlighting::Repository::LightTheme);
+    }
+    const qint64 sharedNsecs = timer.nsecsElapsed();
+    const qint64 sharedKB = residentMemoryKB() - memoryKB;
+
+    QList<KSyntaxHighlighting::Repository *> repositories;
+    memoryKB = residentMemoryKB();
+    timer.restart();
+    for (int i = 0; i < tabCount; ++i) {
+        KSyntaxHighlighting::Repository *repository = new KSyntaxHighlighting::Repository;
+        repository->addCustomSearchPath(KF5_HIGHLIGHT_PATH);
+        repository->definitionForFileName("main.cpp");
+        repository->defaultTheme(KSyntaxHighlighting::Repository::LightTheme);
+        // 各标签页的仓库在标签页关闭前一直存在
+        repositories.append(repository);
+    }
+    const qint64 separateNsecs = timer.nsecsElapsed();
+    const qint64 separateKB = residentMemoryKB() - memoryKB;
+    qDeleteAll(repositories);
+    delete shared;
+
+    qInfo() << "highlight repository for" << tabCount << "tabs: separate"
+            << separateNsecs / 1000000.0 << "ms," << separateKB / tabCount << "KB per tab; shared"
+            << sharedNsecs / 1000000.0 << "ms," << sharedKB / tabCount << "KB per tab";
+    EXPECT_LT(sharedNsecs, separateNsecs);
+}
@@ -0,0 +1,181 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "ut_highlightstatecache.h"
+#include "../../src/common/highlightstatecache.h"
+#include "../../src/common/performancemonitor.h"
+#include "../../src/common/highlightrepository.h"
+
+#include <QTextDocument>
+#include <QTextCursor>
+#include <QTextBlock>
+#include <QMap>
+
+namespace {
+
+// 第 0 行开始的多行注释在最后一行结束
+QString commentCode(int lineCount)
+{
+    QStringList lines;
+    lines << "/* begin";
+    for (int i = 1; i < lineCount - 1; ++i) {
+        lines << QString("int a%1 = %1;").arg(i);
+    }
+    lines << "end */";
+    return lines.join('\n');
+}
+
+// 从文档开头分析得到的文本块 blockNumber 起始状态
+KSyntaxHighlighting::State referenceState(HighlightStateCache &cache, QTextDocument &document, int blockNumber)
+{
+    KSyntaxHighlighting::State state;
+    QTextBlock block = document.begin();
+    for (int i = 0; i < blockNumber && block.isValid(); ++i, block = block.next()) {
+        state = cache.highlightLine(block.text(), state);
+    }
+    return state;
+}
+
+// 分析至文档末尾
+void analyzeAll(HighlightStateCache &cache, QTextDocument &document)
+{
+    while (cache.frontierBlock() < document.blockCount()) {
+        cache.analyzeSlice();
+    }
+}
+
+}
+
+test_highlightstatecache::test_highlightstatecache()
+{
+}
+
+void test_highlightstatecache::SetUp()
+{
+}
+
+void test_highlightstatecache::TearDown()
+{
+}
+
+//bool stateForBlock(int blockNumber, KSyntaxHighlighting::State &state);
+TEST_F(test_highlightstatecache, stateForBlock)
+{
+    QTextDocument document(commentCode(600));
+    HighlightStateCache cache(&document);
+    KSyntaxHighlighting::State state;
+    EXPECT_FALSE(cache.stateForBlock(0, state));
+
+    cache.setDefinition(HighlightRepository::instance()->definitionForName("C++"));
+    ASSERT_TRUE(cache.definition().isValid());
+    EXPECT_TRUE(cache.hasState(0));
+    EXPECT_FALSE(cache.hasState(1));
+    EXPECT_FALSE(cache.stateForBlock(300, state));
+
+    analyzeAll(cache, document);
+    EXPECT_EQ(cache.frontierBlock(), 600);
+
+    // 记录的状态与从文档开头分析一致
+    EXPECT_TRUE(cache.stateForBlock(300, state));
+    EXPECT_TRUE(state == referenceState(cache, document, 300));
+    EXPECT_FALSE(state == KSyntaxHighlighting::State());
+    EXPECT_TRUE(cache.stateForBlock(100, state));
+    EXPECT_TRUE(state == referenceState(cache, document, 100));
+}
+
+//void setBlockEndState(int blockNumber, const KSyntaxHighlighting::State &state);
+TEST_F(test_highlightstatecache, setBlockEndState)
+{
+    QTextDocument document(commentCode(10));
+    HighlightStateCache cache(&document);
+    cache.setDefinition(HighlightRepository::instance()->definitionForName("C++"));
+    ASSERT_TRUE(cache.definition().isValid());
+
+    // 顺序高亮推进已知范围
+    KSyntaxHighlighting::State state;
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_TRUE(cache.stateForBlock(i, state));
+        state = cache.highlightLine(document.findBlockByNumber(i).text(), state);
+        cache.setBlockEndState(i, state);
+    }
+    EXPECT_EQ(cache.frontierBlock(), 3);
+    EXPECT_TRUE(cache.stateForBlock(3, state));
+    EXPECT_TRUE(state == referenceState(cache, document, 3));
+
+    // 已知范围外的文本块不记录
+    cache.setBlockEndState(5, state);
+    EXPECT_EQ(cache.frontierBlock(), 3);
+}
+
+//void contentsChange(int from, int charsRemoved, int charsAdded);
+TEST_F(test_highlightstatecache, contentsChange)
+{
+    QTextDocument document(commentCode(1000));
+    HighlightStateCache cache(&document);
+    QObject::connect(&document, &QTextDocument::contentsChange, [&cache](int from, int charsRemoved, int charsAdded) {
+        cache.contentsChange(from, charsRemoved, charsAdded);
+    });
+    cache.setDefinition(HighlightRepository::instance()->definitionForName("C++"));
+    ASSERT_TRUE(cache.definition().isValid());
+    analyzeAll(cache, document);
+
+    // 结束状态不变时仅重新分析变更的文本块
+    QTextCursor cursor(document.findBlockByNumber(300));
+    cursor.insertText("x");
+    EXPECT_EQ(PerformanceMonitor::lastRelexedBlocks(), 1);
+    EXPECT_EQ(cache.frontierBlock(), 1000);
+
+    cursor.movePosition(QTextCursor::EndOfBlock);
+    cursor.insertText("\nint b;");
+    EXPECT_EQ(PerformanceMonitor::lastRelexedBlocks(), 2);
+    EXPECT_EQ(cache.frontierBlock(), 1001);
+    KSyntaxHighlighting::State state;
+    EXPECT_TRUE(cache.stateForBlock(500, state));
+    EXPECT_TRUE(state == referenceState(cache, document, 500));
+
+    // 结束状态持续变化时最多同步分析 ERelexLimit 个文本块，之后由空闲分析继续
+    cursor.setPosition(document.findBlockByNumber(100).position());
+    cursor.insertText("*/");
+    EXPECT_EQ(PerformanceMonitor::lastRelexedBlocks(), int(HighlightStateCache::ERelexLimit));
+    EXPECT_EQ(cache.frontierBlock(), 100 + HighlightStateCache::ERelexLimit);
+    EXPECT_TRUE(cache.stateForBlock(300, state));
+    EXPECT_TRUE(state == referenceState(cache, document, 300));
+    EXPECT_FALSE(cache.hasState(400));
+
+    analyzeAll(cache, document);
+    EXPECT_EQ(cache.frontierBlock(), 1001);
+    EXPECT_TRUE(cache.stateForBlock(900, state));
+    EXPECT_TRUE(state == referenceState(cache, document, 900));
+}
+
+//void analyzeTo(int blockNumber);
+TEST_F(test_highlightstatecache, analyzeTo)
+{
+    QTextDocument document("int main() {\n    if (a) {\n    }\n}\nint b;");
+    HighlightStateCache cache(&document);
+    cache.setDefinition(HighlightRepository::instance()->definitionForName("C++"));
+    ASSERT_TRUE(cache.definition().isValid());
+
+    QMap<int, QVector<int>> regions;
+    QObject::connect(&cache, &HighlightStateCache::sigBlockFoldingRegions, [&regions](int blockNumber, const QVector<int> &blockRegions) {
+        regions[blockNumber] = blockRegions;
+    });
+
+    // 同步分析并上报折叠区域
+    cache.analyzeTo(3);
+    EXPECT_EQ(cache.frontierBlock(), 4);
+    EXPECT_EQ(regions.size(), 4);
+    ASSERT_EQ(regions.value(0).size(), 1);
+    EXPECT_GT(regions.value(0).first(), 0);
+    ASSERT_EQ(regions.value(3).size(), 1);
+    EXPECT_EQ(regions.value(3).first(), -regions.value(0).first());
+
+    // 已分析的文本块不重复分析
+    regions.clear();
+    cache.analyzeTo(2);
+    EXPECT_TRUE(regions.isEmpty());
+    cache.analyzeTo(100);
+    EXPECT_EQ(cache.frontierBlock(), 5);
+    EXPECT_EQ(regions.keys(), QList<int>({4}));
+}
@@ -0,0 +1,115 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "ut_multidocumentsearch.h"
+#include "../../src/common/multidocumentsearch.h"
+
+#include <QSignalSpy>
+
+test_multidocumentsearch::test_multidocumentsearch()
+{
+}
+
+void test_multidocumentsearch::SetUp()
+{
+}
+
+void test_multidocumentsearch::TearDown()
+{
+}
+
+//static QVector<Match> createMatches(const QString &text, const SearchResult &result);
+TEST_F(test_multidocumentsearch, createMatches)
+{
+    const QString text("key=1\n  other key=2 key=3\n\nkey");
+    const SearchResult result(TextSearchEngine::findAll(text, "key"), 3);
+    const QVector<MultiDocumentSearch::Match> matches = MultiDocumentSearch::createMatches(text, result);
+
+    ASSERT_EQ(matches.size(), 4);
+    EXPECT_EQ(matches.at(0).line, 0);
+    EXPECT_EQ(matches.at(0).column, 0);
+    EXPECT_EQ(matches.at(0).preview, QString("key=1"));
+    EXPECT_EQ(matches.at(1).line, 1);
+    EXPECT_EQ(matches.at(1).column, 8);
+    EXPECT_EQ(matches.at(1).preview, QString("  other key=2 key=3"));
+    EXPECT_EQ(matches.at(2).line, 1);
+    EXPECT_EQ(matches.at(2).column, 14);
+    EXPECT_EQ(matches.at(3).line, 3);
+    EXPECT_EQ(matches.at(3).offset, text.length() - 3);
+    EXPECT_EQ(matches.at(3).preview, QString("key"));
+
+    // 过长的行截取匹配项附近的文本
+    const QString longLine = QString("x").repeated(1000) + "key" + QString("y").repeated(1000);
+    const QVector<MultiDocumentSearch::Match> longMatches =
+        MultiDocumentSearch::createMatches(longLine, SearchResult(QVector<int>({1000}), 3));
+    ASSERT_EQ(longMatches.size(), 1);
+    EXPECT_EQ(longMatches.first().preview.length(), static_cast<int>(MultiDocumentSearch::EPreviewLength));
+    EXPECT_EQ(longMatches.first().preview.mid(longMatches.first().previewOffset, 3), QString("key"));
+}
+
+//static FileResult searchDocument(const Document &document, const QString &keyword, TextSearchEngine::SearchFlags flags, const QAtomicInt *canceled);
+TEST_F(test_multidocumentsearch, searchDocument)
+{
+    // 匹配项过多时仅记录前 EMaxFileMatches 个，总数不受限制
+    const MultiDocumentSearch::Document document = {QString("/tmp/many.txt"), QString("key\n").repeated(3000)};
+    const MultiDocumentSearch::FileResult result = MultiDocumentSearch::searchDocument(document, "key", TextSearchEngine::ENoSearchFlags);
+    EXPECT_EQ(result.filePath, document.filePath);
+    EXPECT_EQ(result.matchCount, 3000);
+    ASSERT_EQ(result.matches.size(), static_cast<int>(MultiDocumentSearch::EMaxFileMatches));
+    EXPECT_EQ(result.matches.last().line, MultiDocumentSearch::EMaxFileMatches - 1);
+}
+
+//static FileResult replaceDocument(const Document &document, const QString &keyword, TextSearchEngine::SearchFlags flags, const QString &withText, const QAtomicInt *canceled);
+TEST_F(test_multidocumentsearch, replaceDocument)
+{
+    // 替换时记录全部匹配项，不受 EMaxFileMatches 限制
+    const MultiDocumentSearch::Document document = {QString("/tmp/many.txt"), QString("key\n").repeated(3000)};
+    MultiDocumentSearch::FileResult result = MultiDocumentSearch::replaceDocument(document, "key", TextSearchEngine::ENoSearchFlags, "value");
+    EXPECT_EQ(result.matchCount, 3000);
+    EXPECT_EQ(result.matches.size(), static_cast<int>(MultiDocumentSearch::EMaxFileMatches));
+    EXPECT_EQ(result.searchResult.count(), 3000);
+    EXPECT_TRUE(result.oldTexts.isEmpty());
+    EXPECT_TRUE(result.newTexts.isEmpty());
+
+    // 正则表达式模式记录各匹配项的文本及替换文本
+    const MultiDocumentSearch::Document config = {QString("/tmp/config.conf"), QString("port=80\nPort=8080")};
+    result = MultiDocumentSearch::replaceDocument(config, "port=(\\d+)",
+                                                  TextSearchEngine::ERegularExpression | TextSearchEngine::ECaseInsensitive, "p:\\1");
+    ASSERT_EQ(result.searchResult.count(), 2);
+    EXPECT_EQ(result.oldTexts, QStringList({"port=80", "Port=8080"}));
+    EXPECT_EQ(result.newTexts, QStringList({"p:80", "p:8080"}));
+}
+
+//void start(const QVector<Document> &documents, const QString &keyword, TextSearchEngine::SearchFlags flags);
+TEST_F(test_multidocumentsearch, start)
+{
+    QVector<MultiDocumentSearch::Document> documents;
+    for (int i = 0; i < 40; ++i) {
+        documents.append({QString("/tmp/config%1.conf").arg(i), i % 2 ? QString("port=%1\nhost=local").arg(i) : QString("host=local")});
+    }
+
+    MultiDocumentSearch search;
+    QSignalSpy resultSpy(&search, &MultiDocumentSearch::sigFileResult);
+    QSignalSpy finishedSpy(&search, &MultiDocumentSearch::sigFinished);
+    search.start(documents, "port=\\d+", TextSearchEngine::ERegularExpression);
+    ASSERT_TRUE(finishedSpy.wait(10000));
+
+    // 仅通知存在匹配项的文档
+    EXPECT_EQ(search.finishedCount(), 40);
+    EXPECT_EQ(search.matchCount(), 20);
+    EXPECT_EQ(resultSpy.count(), 20);
+    for (const QList<QVariant> &arguments : resultSpy) {
+        const MultiDocumentSearch::FileResult result = arguments.first().value<MultiDocumentSearch::FileResult>();
+        EXPECT_EQ(result.index % 2, 1);
+        EXPECT_EQ(result.filePath, documents.at(result.index).filePath);
+        ASSERT_EQ(result.matches.size(), 1);
+        EXPECT_EQ(result.matches.first().length, QString("port=%1").arg(result.index).length());
+    }
+
+    // 取消后不再通知
+    search.start(documents, "host", TextSearchEngine::ENoSearchFlags);
+    search.cancel();
+    EXPECT_FALSE(finishedSpy.wait(200));
+    EXPECT_EQ(finishedSpy.count(), 1);
+}
@@ -74,3 +74,38 @@ TEST_F(test_performanceMonitor, openFileFinish)
     EXPECT_NE(p.openFileFinishMs,0);
     
 }
+
+//static void autoBackupFinish(int iBackupCount);
+TEST_F(test_performanceMonitor, autoBackupFinish)
+{
+    PerformanceMonitor::autoBackupStart();
+    PerformanceMonitor::autoBackupFinish(0);
+
+    EXPECT_GE(PerformanceMonitor::lastAutoBackupNsecs(), 0);
+    EXPECT_TRUE(PerformanceMonitor::autoBackupTimer.isValid());
+}
+
+//static void extraSelectionsRendered(int renderedCount, int totalCount);
+TEST_F(test_performanceMonitor, extraSelectionsRendered)
+{
+    PerformanceMonitor::extraSelectionsRendered(30, 5000);
+    EXPECT_EQ(PerformanceMonitor::lastRenderedSelections(), 30);
+    EXPECT_EQ(PerformanceMonitor::lastTotalSelections(), 5000);
+    EXPECT_GE(PerformanceMonitor::maxRenderedSelections(), 30);
+
+    PerformanceMonitor::extraSelectionsRendered(10, 10);
+    EXPECT_EQ(PerformanceMonitor::lastRenderedSelections(), 10);
+    EXPECT_GE(PerformanceMonitor::maxRenderedSelections(), 30);
+}
+
+//static void highlightBlocksRelexed(int count);
+TEST_F(test_performanceMonitor, highlightBlocksRelexed)
+{
+    PerformanceMonitor::highlightBlocksRelexed(300);
+    EXPECT_EQ(PerformanceMonitor::lastRelexedBlocks(), 300);
+    EXPECT_GE(PerformanceMonitor::maxRelexedBlocks(), 300);
+
+    PerformanceMonitor::highlightBlocksRelexed(1);
+    EXPECT_EQ(PerformanceMonitor::lastRelexedBlocks(), 1);
+    EXPECT_GE(PerformanceMonitor::maxRelexedBlocks(), 300);
+}
@@ -0,0 +1,147 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "ut_piecetable.h"
+#include "../../src/common/piecetable.h"
+
+#include <QFile>
+#include <QBuffer>
+#include <QTextCodec>
+
+test_piecetable::test_piecetable()
+{
+}
+
+void test_piecetable::SetUp()
+{
+}
+
+void test_piecetable::TearDown()
+{
+}
+
+//void setData(const QByteArray &data);
+TEST_F(test_piecetable, setData)
+{
+    PieceTable table;
+    table.setData("line1\nline2\nline3");
+
+    EXPECT_EQ(table.length(), 17);
+    EXPECT_EQ(table.lineCount(), 3);
+    EXPECT_EQ(table.pieceCount(), 1);
+    EXPECT_EQ(table.mid(0, table.length()), QByteArray("line1\nline2\nline3"));
+}
+
+//void insert(qint64 pos, const QByteArray &data);
+TEST_F(test_piecetable, insert)
+{
+    PieceTable table;
+    table.setData("hello world");
+    table.insert(5, ",");
+    table.insert(6, " new");
+    table.insert(table.length(), "\nend");
+
+    EXPECT_EQ(table.mid(0, table.length()), QByteArray("hello, new world\nend"));
+    EXPECT_EQ(table.lineCount(), 2);
+    // 连续输入合并为同一片段
+    EXPECT_EQ(table.pieceCount(), 4);
+}
+
+//void remove(qint64 pos, qint64 len);
+TEST_F(test_piecetable, remove)
+{
+    PieceTable table;
+    table.setData("line1\nline2\nline3");
+    table.insert(6, "new\n");
+    table.remove(3, 8);
+
+    EXPECT_EQ(table.mid(0, table.length()), QByteArray("linline2\nline3"));
+    EXPECT_EQ(table.lineCount(), 2);
+
+    table.remove(0, table.length());
+    EXPECT_EQ(table.length(), 0);
+    EXPECT_EQ(table.pieceCount(), 0);
+}
+
+//qint64 lineStart(qint64 line) const;
+//QByteArray lines(qint64 firstLine, qint64 count) const;
+TEST_F(test_piecetable, lines)
+{
+    // 构造跨越多个索引块的数据
+    QByteArray data;
+    for (int i = 0; i < 20000; ++i) {
+        data.append(QByteArray::number(i)).append('\n');
+    }
+
+    PieceTable table;
+    table.setData(data);
+    table.insert(table.lineStart(10000), "inserted\n");
+
+    EXPECT_EQ(table.lineCount(), 20002);
+    EXPECT_EQ(table.lines(9999, 3), QByteArray("9999\ninserted\n10000\n"));
+    EXPECT_EQ(table.lines(19999, 1), QByteArray("19998\n"));
+    EXPECT_EQ(table.lineStart(30000), table.length());
+}
+
+//bool writeTo(QIODevice *device) const;
+TEST_F(test_piecetable, writeTo)
+{
+    PieceTable table;
+    table.setData("abc");
+    table.insert(1, "123");
+
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    EXPECT_TRUE(table.writeTo(&buffer));
+    EXPECT_EQ(buffer.data(), QByteArray("a123bc"));
+}
+
+//bool openFile(const QString &filePath);
+//bool saveToFile(const QString &filePath) const;
+TEST_F(test_piecetable, openFile)
+{
+    QString filePath("/tmp/test_piecetable.txt");
+    QFile file(filePath);
+    if (file.open(QFile::WriteOnly)) {
+        file.write("local\ntest data");
+        file.close();
+    }
+
+    PieceTable table;
+    ASSERT_TRUE(table.openFile(filePath));
+    EXPECT_EQ(table.lineCount(), 2);
+
+    table.insert(6, "new ");
+    EXPECT_TRUE(table.saveToFile(filePath));
+    table.clear();
+
+    if (file.open(QFile::ReadOnly)) {
+        EXPECT_EQ(file.readAll(), QByteArray("local\nnew test data"));
+        file.close();
+    }
+    file.remove();
+}
+
+//bool saveToFile(const QString &filePath, const QString &encode, bool *openFailed) const;
+TEST_F(test_piecetable, saveToFile_Encode)
+{
+    QString filePath("/tmp/test_piecetable_encode.txt");
+    PieceTable table;
+    table.setData(QString("中文\n测试").toUtf8());
+
+    bool openFailed = true;
+    EXPECT_TRUE(table.saveToFile(filePath, "GB18030", &openFailed));
+    EXPECT_FALSE(openFailed);
+
+    QFile file(filePath);
+    if (file.open(QFile::ReadOnly)) {
+        QTextCodec *codec = QTextCodec::codecForName("GB18030");
+        EXPECT_EQ(file.readAll(), codec->fromUnicode(QString("中文\n测试")));
+        file.close();
+    }
+    file.remove();
+
+    EXPECT_FALSE(table.saveToFile("/tmp/test_piecetable_not_exist_dir/save.txt", "UTF-8", &openFailed));
+    EXPECT_TRUE(openFailed);
+}
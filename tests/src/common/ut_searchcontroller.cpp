@@ -0,0 +1,78 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "ut_searchcontroller.h"
+#include "../../src/common/searchcontroller.h"
+
+#include <QSignalSpy>
+
+test_searchcontroller::test_searchcontroller()
+{
+}
+
+void test_searchcontroller::SetUp()
+{
+}
+
+void test_searchcontroller::TearDown()
+{
+}
+
+//void setKeyword(QWidget *widget, const QString &file, const QString &keyword);
+TEST_F(test_searchcontroller, setKeyword)
+{
+    QWidget widget;
+    SearchController controller;
+    controller.setInterval(50);
+    QSignalSpy changedSpy(&controller, &SearchController::sigKeywordChanged);
+    QSignalSpy searchSpy(&controller, &SearchController::sigSearchRequested);
+
+    // 连续输入仅在停顿后查找一次，使用最后输入的关键字
+    controller.setKeyword(&widget, "file", "a");
+    controller.setKeyword(&widget, "file", "ab");
+    controller.setKeyword(&widget, "file", "abc");
+    EXPECT_EQ(changedSpy.count(), 3);
+    EXPECT_EQ(searchSpy.count(), 0);
+    EXPECT_TRUE(controller.isPending());
+    EXPECT_EQ(controller.pendingKeyword(), QString("abc"));
+
+    ASSERT_TRUE(searchSpy.wait(1000));
+    EXPECT_EQ(searchSpy.count(), 1);
+    EXPECT_EQ(searchSpy.first().at(1).toString(), QString("file"));
+    EXPECT_EQ(searchSpy.first().at(2).toString(), QString("abc"));
+    EXPECT_FALSE(controller.isPending());
+
+    // 关键字未变更(如切换查找模式)时同样查找，但不通知关键字变更
+    controller.setKeyword(&widget, "file", "abc");
+    EXPECT_EQ(changedSpy.count(), 3);
+    ASSERT_TRUE(searchSpy.wait(1000));
+
+    // 清空关键字时立即查找
+    controller.setKeyword(&widget, "file", "");
+    EXPECT_EQ(searchSpy.count(), 3);
+    EXPECT_FALSE(controller.isPending());
+}
+
+//void flush();
+TEST_F(test_searchcontroller, flush)
+{
+    QWidget widget;
+    SearchController controller;
+    QSignalSpy searchSpy(&controller, &SearchController::sigSearchRequested);
+
+    controller.flush();
+    EXPECT_EQ(searchSpy.count(), 0);
+
+    controller.setKeyword(&widget, "file", "abc");
+    controller.flush();
+    EXPECT_EQ(searchSpy.count(), 1);
+    EXPECT_FALSE(searchSpy.wait(controller.interval() * 2));
+
+    // 丢弃等待中的查找
+    controller.setKeyword(&widget, "file", "abcd");
+    controller.cancel();
+    EXPECT_FALSE(controller.isPending());
+    EXPECT_FALSE(searchSpy.wait(controller.interval() * 2));
+    EXPECT_EQ(searchSpy.count(), 1);
+}
@@ -0,0 +1,20 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef UT_SEARCHCONTROLLER_H
+#define UT_SEARCHCONTROLLER_H
+
+#include "gtest/gtest.h"
+#include <QObject>
+
+class test_searchcontroller : public QObject
+    , public ::testing::Test
+{
+public:
+    test_searchcontroller();
+    virtual void SetUp() override;
+    virtual void TearDown() override;
+};
+
+#endif // UT_SEARCHCONTROLLER_H
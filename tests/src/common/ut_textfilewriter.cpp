@@ -0,0 +1,151 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "ut_textfilewriter.h"
+#include "../../src/common/textfilewriter.h"
+
+#include <QBuffer>
+#include <QFile>
+#include <QTextCodec>
+#include <QTextDocument>
+
+test_textfilewriter::test_textfilewriter()
+{
+}
+
+void test_textfilewriter::SetUp()
+{
+}
+
+void test_textfilewriter::TearDown()
+{
+}
+
+//bool write(QIODevice *device);
+TEST_F(test_textfilewriter, write_Utf8)
+{
+    QTextDocument document;
+    document.setPlainText(QString("第一行\nsecond line\n\nlast line"));
+
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    TextFileWriter writer(&document, "UTF-8", false);
+    EXPECT_TRUE(writer.write(&buffer));
+    EXPECT_EQ(writer.error(), TextFileWriter::NoError);
+    EXPECT_EQ(buffer.data(), document.toPlainText().toUtf8());
+}
+
+//bool write(QIODevice *device);
+TEST_F(test_textfilewriter, write_WindowsEndline)
+{
+    QTextDocument document;
+    document.setPlainText(QString("line1\nline2\n"));
+
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    TextFileWriter writer(&document, "UTF-8", true);
+    EXPECT_TRUE(writer.write(&buffer));
+    EXPECT_EQ(buffer.data(), QByteArray("line1\r\nline2\r\n"));
+}
+
+//bool write(QIODevice *device);
+TEST_F(test_textfilewriter, write_MultiChunkGB18030)
+{
+    // 超过单个数据块长度，按多个数据块转换写入
+    QString text;
+    while (text.size() < TextFileWriter::EChunkSize * 2) {
+        text.append(QString("中文测试文本 GB18030 encode line %1\n").arg(text.size()));
+    }
+    QTextDocument document;
+    document.setPlainText(text);
+
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    TextFileWriter writer(&document, "GB18030", false);
+    EXPECT_TRUE(writer.write(&buffer));
+
+    QTextCodec *codec = QTextCodec::codecForName("GB18030");
+    ASSERT_NE(codec, nullptr);
+    EXPECT_EQ(buffer.data(), codec->fromUnicode(document.toPlainText()));
+}
+
+//bool write(QIODevice *device);
+TEST_F(test_textfilewriter, write_UnsupportedEncode)
+{
+    QTextDocument document;
+    document.setPlainText(QString("text"));
+
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    TextFileWriter writer(&document, "NOT-EXIST-ENCODING", false);
+    EXPECT_FALSE(writer.write(&buffer));
+    EXPECT_EQ(writer.error(), TextFileWriter::EncodeError);
+    EXPECT_TRUE(buffer.data().isEmpty());
+}
+
+//bool write(QIODevice *device);
+TEST_F(test_textfilewriter, write_Snapshot)
+{
+    // 使用文本块快照写入，超过单个数据块长度时分多次回调进度
+    QTextDocument document;
+    QString text;
+    while (text.size() < TextFileWriter::EChunkSize * 2) {
+        text.append(QString("snapshot \U00020087 line %1\n").arg(text.size()));
+    }
+    document.setPlainText(text);
+    TextFileWriter::BlockSnapshot blocks = TextFileWriter::snapshot(&document);
+    EXPECT_EQ(blocks.size(), document.blockCount());
+
+    qint64 lastWritten = 0;
+    qint64 lastTotal = 0;
+    int callCount = 0;
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    TextFileWriter writer(blocks, "UTF-8", true);
+    writer.setProgressCallback([&](qint64 written, qint64 total) {
+        EXPECT_GE(written, lastWritten);
+        lastWritten = written;
+        lastTotal = total;
+        ++callCount;
+    });
+    EXPECT_TRUE(writer.write(&buffer));
+    EXPECT_GT(callCount, 1);
+    EXPECT_EQ(lastWritten, lastTotal);
+    EXPECT_EQ(lastTotal, text.size());
+
+    QString expected = text;
+    expected.replace("\n", "\r\n");
+    EXPECT_EQ(buffer.data(), expected.toUtf8());
+}
+
+//bool save(const QString &filePath);
+TEST_F(test_textfilewriter, save)
+{
+    QString filePath("/tmp/ut_textfilewriter_save.txt");
+    QTextDocument document;
+    document.setPlainText(QString("save\ntext"));
+
+    TextFileWriter writer(&document, "UTF-8", false);
+    EXPECT_TRUE(writer.save(filePath));
+
+    QFile file(filePath);
+    ASSERT_TRUE(file.open(QIODevice::ReadOnly));
+    EXPECT_EQ(file.readAll(), QByteArray("save\ntext"));
+    file.close();
+    file.remove();
+
+    // 目录不存在，打开文件失败
+    TextFileWriter errorWriter(&document, "UTF-8", false);
+    EXPECT_FALSE(errorWriter.save(QString("/tmp/ut_textfilewriter_not_exist_dir/save.txt")));
+    EXPECT_EQ(errorWriter.error(), TextFileWriter::OpenError);
+}
+
+//static bool isStreamSaveRequired(QTextDocument *document);
+TEST_F(test_textfilewriter, isStreamSaveRequired)
+{
+    QTextDocument document;
+    document.setPlainText(QString("text"));
+    EXPECT_FALSE(TextFileWriter::isStreamSaveRequired(&document));
+    EXPECT_FALSE(TextFileWriter::isStreamSaveRequired(nullptr));
+}
@@ -0,0 +1,417 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "ut_textsearchengine.h"
+#include "../../src/common/textsearchengine.h"
+
+#include <QElapsedTimer>
+#include <QSignalSpy>
+#include <QTextCursor>
+#include <QTextDocument>
+#include <QRegularExpression>
+#include <QDebug>
+
+// 逐个查找互不重叠的匹配项，作为对照结果
+static QVector<int> findSequential(const QString &text, const QString &keyword, Qt::CaseSensitivity cs = Qt::CaseSensitive)
+{
+    QVector<int> offsets;
+    int pos = text.indexOf(keyword, 0, cs);
+    while (pos >= 0) {
+        offsets.append(pos);
+        pos = text.indexOf(keyword, pos + keyword.length(), cs);
+    }
+    return offsets;
+}
+
+// 逐行匹配正则表达式，返回长度不为 0 的匹配项位置及长度，作为对照结果
+static QVector<QPair<int, int>> findRegex(const QString &text, const QString &pattern)
+{
+    QVector<QPair<int, int>> matches;
+    QRegularExpression regex(pattern);
+    int lineStart = 0;
+    for (const QString &line : text.split(QLatin1Char('\n'))) {
+        QRegularExpressionMatchIterator itr = regex.globalMatch(line);
+        while (itr.hasNext()) {
+            QRegularExpressionMatch match = itr.next();
+            if (match.capturedLength() > 0) {
+                matches.append(qMakePair(lineStart + match.capturedStart(), match.capturedLength()));
+            }
+        }
+        lineStart += line.length() + 1;
+    }
+    return matches;
+}
+
+// 查找结果的匹配项位置及长度
+static QVector<QPair<int, int>> resultMatches(const SearchResult &result)
+{
+    QVector<QPair<int, int>> matches;
+    for (int i = 0; i < result.count(); ++i) {
+        matches.append(qMakePair(result.offsetAt(i), result.lengthAt(i)));
+    }
+    return matches;
+}
+
+// 在位置 pos 删除 removed 个字符并插入 text
+static void editDocument(QTextDocument *document, int pos, int removed, const QString &text)
+{
+    QTextCursor cursor(document);
+    cursor.setPosition(pos);
+    cursor.setPosition(pos + removed, QTextCursor::KeepAnchor);
+    cursor.insertText(text);
+}
+
+// 等待后台查找完成
+static bool waitForResult(TextSearchEngine *engine)
+{
+    QSignalSpy spy(engine, &TextSearchEngine::sigResultChanged);
+    return engine->isValid() || spy.wait(10000);
+}
+
+test_textsearchengine::test_textsearchengine()
+{
+}
+
+void test_textsearchengine::SetUp()
+{
+}
+
+void test_textsearchengine::TearDown()
+{
+}
+
+//static QVector<int> findAll(const QString &text, const QString &keyword, Qt::CaseSensitivity cs, const QAtomicInt *canceled, int chunkSize);
+TEST_F(test_textsearchengine, findAll)
+{
+    QString text("abc\nabcabc\n abc");
+    EXPECT_EQ(TextSearchEngine::findAll(text, "abc"), findSequential(text, "abc"));
+    EXPECT_EQ(TextSearchEngine::findAll(text, "c\na"), QVector<int>({2}));
+    EXPECT_EQ(TextSearchEngine::findAll(text, "ABC", Qt::CaseInsensitive).size(), 4);
+    EXPECT_TRUE(TextSearchEngine::findAll(text, "ABC").isEmpty());
+    EXPECT_TRUE(TextSearchEngine::findAll(text, QString()).isEmpty());
+    EXPECT_TRUE(TextSearchEngine::findAll(QString("ab"), "abc").isEmpty());
+}
+
+TEST_F(test_textsearchengine, findAll_ChunkBoundary)
+{
+    // 匹配项跨越分块边界
+    QString text = QString("x").repeated(97) + "needle" + QString("y").repeated(50) + "needle";
+    for (int chunkSize : {1, 7, 50, 99, 100, 1000}) {
+        EXPECT_EQ(TextSearchEngine::findAll(text, "needle", Qt::CaseSensitive, nullptr, chunkSize), QVector<int>({97, 153}));
+    }
+
+    // 可重叠的关键字按从前向后的顺序取互不重叠的匹配项，与 QTextDocument::find() 一致
+    QString repeated = QString("a").repeated(1001);
+    for (int chunkSize : {1, 3, 64, 333}) {
+        EXPECT_EQ(TextSearchEngine::findAll(repeated, "aa", Qt::CaseSensitive, nullptr, chunkSize), findSequential(repeated, "aa"));
+        EXPECT_EQ(TextSearchEngine::findAll(repeated, "aaa", Qt::CaseSensitive, nullptr, chunkSize), findSequential(repeated, "aaa"));
+    }
+
+    QString pattern = QString("abababcab").repeated(300);
+    for (int chunkSize : {2, 5, 128}) {
+        EXPECT_EQ(TextSearchEngine::findAll(pattern, "abab", Qt::CaseSensitive, nullptr, chunkSize), findSequential(pattern, "abab"));
+        EXPECT_EQ(TextSearchEngine::findAll(pattern, "ABAB", Qt::CaseInsensitive, nullptr, chunkSize), findSequential(pattern, "ABAB", Qt::CaseInsensitive));
+    }
+}
+
+TEST_F(test_textsearchengine, findAll_Canceled)
+{
+    QAtomicInt canceled(1);
+    QString text = QString("abc").repeated(1000);
+    EXPECT_TRUE(TextSearchEngine::findAll(text, "b", Qt::CaseSensitive, &canceled, 100).isEmpty());
+}
+
+//static SearchResult search(const QString &text, const QString &keyword, SearchFlags flags, const QAtomicInt *canceled, int chunkSize);
+TEST_F(test_textsearchengine, search_WholeWord)
+{
+    // 匹配项前后不能是字母或数字，与 QTextDocument::FindWholeWords 一致
+    QString text("foo food foo_bar\n(foo) 1foo Foo");
+    SearchResult result = TextSearchEngine::search(text, "foo", TextSearchEngine::EWholeWord);
+    EXPECT_EQ(result.offsets(), QVector<int>({0, 9, 18}));
+    EXPECT_EQ(result.lengthAt(1), 3);
+
+    result = TextSearchEngine::search(text, "FOO", TextSearchEngine::EWholeWord | TextSearchEngine::ECaseInsensitive);
+    EXPECT_EQ(result.offsets(), QVector<int>({0, 9, 18, 28}));
+
+    // 按行匹配，分块边界对齐到行首
+    QString lines = QString("a foo\nfoofoo foo\n").repeated(40);
+    for (int chunkSize : {1, 5, 64}) {
+        EXPECT_EQ(TextSearchEngine::search(lines, "foo", TextSearchEngine::EWholeWord, nullptr, chunkSize).offsets(),
+                  TextSearchEngine::search(lines, "foo", TextSearchEngine::EWholeWord).offsets());
+    }
+    EXPECT_EQ(TextSearchEngine::search(lines, "foo", TextSearchEngine::EWholeWord).count(), 80);
+    EXPECT_TRUE(TextSearchEngine::search(lines, "foo\nfoo", TextSearchEngine::EWholeWord).isEmpty());
+}
+
+TEST_F(test_textsearchengine, search_RegularExpression)
+{
+    QString text("id=12 id=345\nname id=6\n\nid=");
+    SearchResult result = TextSearchEngine::search(text, "id=(\\d+)", TextSearchEngine::ERegularExpression);
+    EXPECT_EQ(resultMatches(result), findRegex(text, "id=(\\d+)"));
+    EXPECT_EQ(result.offsets(), QVector<int>({0, 6, 18}));
+    EXPECT_EQ(result.lengthAt(1), 6);
+    EXPECT_EQ(result.matchLength(), 0);
+
+    // 忽略长度为 0 的匹配项，匹配项不跨行
+    EXPECT_TRUE(TextSearchEngine::search(text, "x*", TextSearchEngine::ERegularExpression).isEmpty());
+    EXPECT_TRUE(TextSearchEngine::search(text, "345\\sname", TextSearchEngine::ERegularExpression).isEmpty());
+    EXPECT_EQ(TextSearchEngine::search(text, "^id", TextSearchEngine::ERegularExpression).offsets(), QVector<int>({0, 24}));
+
+    // 全词匹配及忽略大小写
+    TextSearchEngine::SearchFlags flags = TextSearchEngine::ERegularExpression | TextSearchEngine::EWholeWord
+                                          | TextSearchEngine::ECaseInsensitive;
+    EXPECT_EQ(TextSearchEngine::search(QString("ID=1 xid=2 id=3x"), "id=\\d", flags).offsets(), QVector<int>({0}));
+
+    // 无效的表达式没有匹配项
+    EXPECT_FALSE(TextSearchEngine::regularExpression("(", TextSearchEngine::ERegularExpression).isValid());
+    EXPECT_TRUE(TextSearchEngine::search(text, "(", TextSearchEngine::ERegularExpression).isEmpty());
+
+    QString lines = QString("abc id=1 x\nid=22\n").repeated(50);
+    for (int chunkSize : {1, 7, 64, 1000}) {
+        result = TextSearchEngine::search(lines, "id=\\d+", TextSearchEngine::ERegularExpression, nullptr, chunkSize);
+        EXPECT_EQ(resultMatches(result), findRegex(lines, "id=\\d+"));
+    }
+}
+
+//static QStringList replacements(const QString &text, const SearchResult &result, int first, const QString &keyword, SearchFlags flags, const QString &withText);
+TEST_F(test_textsearchengine, replacements)
+{
+    QString text("id=12 id=345\nkey=6");
+    QString pattern("(\\w+)=(\\d+)");
+    SearchResult result = TextSearchEngine::search(text, pattern, TextSearchEngine::ERegularExpression);
+    ASSERT_EQ(result.count(), 3);
+
+    EXPECT_EQ(TextSearchEngine::replacements(text, result, 0, pattern, TextSearchEngine::ERegularExpression, "\\2:\\1"),
+              QStringList({"12:id", "345:id", "6:key"}));
+    // 不存在的捕获组引用保持原样
+    EXPECT_EQ(TextSearchEngine::replacements(text, result, 1, pattern, TextSearchEngine::ERegularExpression, "[\\0]\\3"),
+              QStringList({"[id=345]\\3", "[key=6]\\3"}));
+}
+
+//int nextIndex(int position) const;
+//int previousIndex(int position) const;
+//QPair<int, int> indexRange(int begin, int end) const;
+TEST_F(test_textsearchengine, searchResult)
+{
+    SearchResult result(QVector<int>({2, 10, 20, 30}), 3);
+    EXPECT_EQ(result.count(), 4);
+    EXPECT_EQ(result.matchLength(), 3);
+    EXPECT_EQ(result.indexOf(20), 2);
+    EXPECT_EQ(result.indexOf(21), -1);
+
+    EXPECT_EQ(result.nextIndex(0), 0);
+    EXPECT_EQ(result.nextIndex(10), 1);
+    EXPECT_EQ(result.nextIndex(11), 2);
+    EXPECT_EQ(result.nextIndex(31), -1);
+
+    EXPECT_EQ(result.previousIndex(2), -1);
+    EXPECT_EQ(result.previousIndex(10), 0);
+    EXPECT_EQ(result.previousIndex(100), 3);
+
+    EXPECT_EQ(result.indexRange(5, 20), qMakePair(1, 3));
+    EXPECT_EQ(result.indexRange(21, 29), qMakePair(3, 3));
+    EXPECT_TRUE(SearchResult().isEmpty());
+}
+
+//void start(const QString &keyword, Qt::CaseSensitivity cs);
+TEST_F(test_textsearchengine, start)
+{
+    QTextDocument document;
+    document.setPlainText(QString("find me\nfind\nme find"));
+
+    TextSearchEngine engine(&document);
+    engine.start("find");
+    EXPECT_TRUE(waitForResult(&engine));
+    EXPECT_EQ(engine.keyword(), QString("find"));
+    EXPECT_EQ(engine.result().offsets(), QVector<int>({0, 8, 16}));
+
+    engine.clear();
+    EXPECT_FALSE(engine.isValid());
+    EXPECT_TRUE(engine.keyword().isEmpty());
+}
+
+//void onContentsChange(int from, int charsRemoved, int charsAdded);
+TEST_F(test_textsearchengine, onContentsChange)
+{
+    QTextDocument document;
+    document.setPlainText(QString("foo bar foo\nbar foo"));
+
+    TextSearchEngine engine(&document);
+    engine.start("foo");
+    ASSERT_TRUE(waitForResult(&engine));
+
+    // 插入、删除、替换后与重新查找的结果一致
+    editDocument(&document, 0, 0, QString("foo "));
+    EXPECT_TRUE(engine.isValid());
+    EXPECT_EQ(engine.result().offsets(), findSequential(document.toPlainText(), "foo"));
+
+    editDocument(&document, 9, 3, QString());
+    EXPECT_EQ(engine.result().offsets(), findSequential(document.toPlainText(), "foo"));
+
+    editDocument(&document, 6, 2, QString("f\nfo"));
+    EXPECT_EQ(engine.result().offsets(), findSequential(document.toPlainText(), "foo"));
+
+    editDocument(&document, document.characterCount() - 1, 0, QString("fo"));
+    editDocument(&document, document.characterCount() - 1, 0, QString("o"));
+    EXPECT_EQ(engine.result().offsets(), findSequential(document.toPlainText(), "foo"));
+
+    // 可重叠的关键字
+    document.setPlainText(QString("aaaa baaa"));
+    engine.start("aa");
+    ASSERT_TRUE(waitForResult(&engine));
+    editDocument(&document, 0, 1, QString());
+    editDocument(&document, 4, 0, QString("a"));
+    ASSERT_TRUE(waitForResult(&engine));
+    EXPECT_EQ(engine.result().offsets(), findSequential(document.toPlainText(), "aa"));
+}
+
+//void start(const QString &keyword, SearchFlags flags);
+TEST_F(test_textsearchengine, start_RegularExpression)
+{
+    QTextDocument document;
+    document.setPlainText(QString("id=1 id=22\nname\nid=333"));
+
+    TextSearchEngine engine(&document);
+    engine.start("id=\\d+", TextSearchEngine::ERegularExpression);
+    ASSERT_TRUE(waitForResult(&engine));
+    EXPECT_EQ(engine.searchFlags(), TextSearchEngine::SearchFlags(TextSearchEngine::ERegularExpression));
+    EXPECT_EQ(resultMatches(engine.result()), findRegex(document.toPlainText(), "id=\\d+"));
+
+    // 编辑后仅重新查找变更涉及的行，与重新查找的结果一致
+    editDocument(&document, 6, 0, QString("9"));
+    EXPECT_TRUE(engine.isValid());
+    EXPECT_EQ(resultMatches(engine.result()), findRegex(document.toPlainText(), "id=\\d+"));
+
+    editDocument(&document, 11, 1, QString(" id=4"));
+    EXPECT_EQ(resultMatches(engine.result()), findRegex(document.toPlainText(), "id=\\d+"));
+
+    editDocument(&document, 2, 3, QString("\nid=5\n"));
+    EXPECT_EQ(resultMatches(engine.result()), findRegex(document.toPlainText(), "id=\\d+"));
+
+    // 全词匹配
+    engine.start("id", TextSearchEngine::EWholeWord);
+    ASSERT_TRUE(waitForResult(&engine));
+    editDocument(&document, 0, 0, QString("x"));
+    editDocument(&document, document.characterCount() - 1, 0, QString(" id"));
+    EXPECT_EQ(engine.result().offsets(),
+              TextSearchEngine::search(document.toPlainText(), "id", TextSearchEngine::EWholeWord).offsets());
+}
+
+TEST_F(test_textsearchengine, start_PartialResult)
+{
+    // 超过分块长度的文档分块查找，按顺序完成的分块结果先行通知
+    const int lineCount = TextSearchEngine::EChunkSize * 3 / 10;
+    QTextDocument document;
+    document.setPlainText(QString("line id=1\n").repeated(lineCount));
+
+    TextSearchEngine engine(&document);
+    QSignalSpy partialSpy(&engine, &TextSearchEngine::sigPartialResult);
+    engine.start("id=\\d", TextSearchEngine::ERegularExpression);
+    ASSERT_TRUE(waitForResult(&engine));
+    EXPECT_GE(partialSpy.count(), 1);
+    EXPECT_EQ(engine.result().count(), lineCount);
+    EXPECT_EQ(engine.result().offsetAt(lineCount - 1), (lineCount - 1) * 10 + 5);
+}
+
+TEST_F(test_textsearchengine, onContentsChange_Running)
+{
+    // 查找期间的编辑记录为变更区域，查找完成后平移结果并仅重新查找变更区域，无需重新查找全文
+    const int lineCount = TextSearchEngine::EChunkSize * 3 / 10;
+    QTextDocument document;
+    document.setPlainText(QString("line foo\n").repeated(lineCount));
+
+    TextSearchEngine engine(&document);
+    QSignalSpy invalidatedSpy(&engine, &TextSearchEngine::sigInvalidated);
+    engine.start("foo");
+    editDocument(&document, 5, 0, QString("foo "));
+    editDocument(&document, 20, 3, QString());
+    // 高亮格式变更等不改变长度的变更
+    editDocument(&document, 40, 3, QString("foo"));
+    editDocument(&document, 0, 0, QString("x"));
+    ASSERT_TRUE(waitForResult(&engine));
+    EXPECT_EQ(invalidatedSpy.count(), 0);
+    EXPECT_EQ(engine.result().offsets(), findSequential(document.toPlainText(), "foo"));
+
+    // 正则表达式按行更新
+    engine.start("fo+", TextSearchEngine::ERegularExpression);
+    editDocument(&document, 12, 0, QString("foooo\n"));
+    ASSERT_TRUE(waitForResult(&engine));
+    EXPECT_EQ(resultMatches(engine.result()), findRegex(document.toPlainText(), "fo+"));
+
+    // 变更区域过大时延迟重新查找全文，期间视为查找中
+    engine.start("foo");
+    editDocument(&document, 0, TextSearchEngine::EMaxPendingChange + 1, QString());
+    ASSERT_TRUE(waitForResult(&engine));
+    EXPECT_EQ(engine.result().offsets(), findSequential(document.toPlainText(), "foo"));
+}
+
+TEST_F(test_textsearchengine, start_Refine)
+{
+    QTextDocument document;
+    document.setPlainText(QString("ab abc abd Abc abcabc\nxabcab ABCA"));
+    const QString text = document.toPlainText();
+
+    TextSearchEngine engine(&document);
+    engine.start("ab");
+    ASSERT_TRUE(waitForResult(&engine));
+
+    // 关键字扩展时仅校验之前的匹配项位置，结果与重新查找一致
+    EXPECT_TRUE(engine.canRefine("abc", TextSearchEngine::ENoSearchFlags));
+    EXPECT_FALSE(engine.canRefine("xab", TextSearchEngine::ENoSearchFlags));
+    EXPECT_FALSE(engine.canRefine("abc", TextSearchEngine::EWholeWord));
+    engine.start("abc");
+    ASSERT_TRUE(waitForResult(&engine));
+    EXPECT_EQ(engine.result().offsets(), findSequential(text, "abc"));
+
+    // 新关键字存在相同的前后缀时仍可复用，之前的关键字存在时则不能
+    EXPECT_TRUE(engine.canRefine("abca", TextSearchEngine::ENoSearchFlags));
+    engine.start("abca");
+    ASSERT_TRUE(waitForResult(&engine));
+    EXPECT_EQ(engine.result().offsets(), findSequential(text, "abca"));
+    EXPECT_FALSE(engine.canRefine("abcab", TextSearchEngine::ENoSearchFlags));
+
+    // 忽略大小写
+    engine.start("AB", TextSearchEngine::ECaseInsensitive);
+    ASSERT_TRUE(waitForResult(&engine));
+    EXPECT_TRUE(engine.canRefine("aBc", TextSearchEngine::ECaseInsensitive));
+    engine.start("aBc", TextSearchEngine::ECaseInsensitive);
+    ASSERT_TRUE(waitForResult(&engine));
+    EXPECT_EQ(engine.result().offsets(), findSequential(text, "aBc", Qt::CaseInsensitive));
+
+    // 文档变更后维护的结果同样可复用
+    editDocument(&document, 0, 0, QString("abcd "));
+    EXPECT_TRUE(engine.canRefine("abcd", TextSearchEngine::ECaseInsensitive));
+    engine.start("abcd", TextSearchEngine::ECaseInsensitive);
+    ASSERT_TRUE(waitForResult(&engine));
+    EXPECT_EQ(engine.result().offsets(), findSequential(document.toPlainText(), "abcd", Qt::CaseInsensitive));
+}
+
+// 性能测试，默认不执行，通过 --gtest_also_run_disabled_tests --gtest_filter=*Benchmark* 运行
+TEST_F(test_textsearchengine, DISABLED_Benchmark_FindAll)
+{
+    QString line("2023-01-01 12:00:00 [INFO] request handled, status=200 cost=12ms\n");
+    QString text = line.repeated(100 * 1024 * 1024 / line.size() / 2);
+    QElapsedTimer timer;
+
+    timer.start();
+    QVector<int> sequential = findSequential(text, "status");
+    qint64 sequentialTime = timer.nsecsElapsed();
+
+    timer.restart();
+    QVector<int> parallel = TextSearchEngine::findAll(text, "status");
+    qint64 parallelTime = timer.nsecsElapsed();
+
+    SearchResult result(parallel, 6);
+    timer.restart();
+    int index = 0;
+    for (int i = 0; i < 100000; ++i) {
+        index += result.nextIndex(i * 997) >= 0 ? 1 : 0;
+    }
+    qint64 lookupTime = timer.nsecsElapsed();
+
+    EXPECT_EQ(parallel, sequential);
+    qInfo() << "FindAll" << text.size() << "chars," << parallel.size() << "matches,"
+            << "sequential(ms):" << sequentialTime / 1000000.0 << "parallel(ms):" << parallelTime / 1000000.0
+            << "100000 lookups(ms):" << lookupTime / 1000000.0 << index;
+}
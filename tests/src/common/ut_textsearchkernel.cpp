@@ -0,0 +1,191 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "ut_textsearchkernel.h"
+#include "../../src/common/textsearchkernel.h"
+
+#include <QElapsedTimer>
+#include <QTextCursor>
+#include <QTextDocument>
+#include <QDebug>
+
+namespace textsearchkerneltest {
+
+// 校验各个起始位置的查找结果与 QString::indexOf() 一致，覆盖向量化实现的数据块边界及末尾数据处理
+void checkAllOffsets(const QString &text, const QString &keyword, Qt::CaseSensitivity cs)
+{
+    for (int from = 0; from <= text.length(); ++from) {
+        EXPECT_EQ(TextSearchKernel::indexOf(text, keyword, from, cs), text.indexOf(keyword, from, cs))
+                << from << keyword.toStdString() << cs;
+    }
+}
+
+// 性能测试数据长度，可通过环境变量 TEXTSEARCH_BENCH_MB 设置(10MB~1GB)
+int benchmarkSizeMB()
+{
+    int size = qEnvironmentVariableIntValue("TEXTSEARCH_BENCH_MB");
+    return size > 0 ? qBound(10, size, 1024) : 10;
+}
+
+// 模拟日志文件内容
+QString benchmarkLog()
+{
+    const QStringList lines = {
+        "2023-03-01 08:15:02.113 [INFO ] [http-nio-8080-exec-7] c.d.e.RequestFilter : GET /api/v1/files status=200 cost=12ms\n",
+        "2023-03-01 08:15:02.287 [DEBUG] [scheduler-2] c.d.e.BackupTask : backup finished, 3 files, 120KB\n",
+        "2023-03-01 08:15:03.004 [WARN ] [http-nio-8080-exec-1] c.d.e.RequestFilter : slow request POST /api/v1/upload cost=1532ms\n",
+        "2023-03-01 08:15:03.551 [INFO ] [main] c.d.e.Application : 服务已启动, pid=2873\n",
+    };
+    const int size = benchmarkSizeMB() * 1024 * 1024 / 2;
+    QString text;
+    text.reserve(size + 256);
+    for (int i = 0; text.size() < size; ++i) {
+        text.append(lines.at(i % lines.size()));
+    }
+    // 文本末尾添加仅出现一次的内容
+    text.append("2023-03-01 23:59:59.999 [ERROR] [main] c.d.e.Application : OutOfMemoryError\n");
+    return text;
+}
+
+// 统计匹配数量及耗时(ms)
+template <typename Func>
+int countMatches(const QString &keyword, Func indexOf, double *elapsed)
+{
+    QElapsedTimer timer;
+    timer.start();
+    int count = 0;
+    int pos = indexOf(0);
+    while (pos >= 0) {
+        ++count;
+        pos = indexOf(pos + keyword.length());
+    }
+    *elapsed = timer.nsecsElapsed() / 1000000.0;
+    return count;
+}
+
+}
+
+using namespace textsearchkerneltest;
+
+test_textsearchkernel::test_textsearchkernel()
+{
+}
+
+//static int indexOf(const QString &text, const QString &keyword, int from, Qt::CaseSensitivity cs);
+TEST_F(test_textsearchkernel, indexOf)
+{
+    QString text("abc\nabcabc\n abc");
+    EXPECT_EQ(TextSearchKernel::indexOf(text, "abc"), 0);
+    EXPECT_EQ(TextSearchKernel::indexOf(text, "abc", 1), 4);
+    EXPECT_EQ(TextSearchKernel::indexOf(text, "c\na", 0), 2);
+    EXPECT_EQ(TextSearchKernel::indexOf(text, "abc", -3), 12);
+    EXPECT_EQ(TextSearchKernel::indexOf(text, "ABC"), -1);
+    EXPECT_EQ(TextSearchKernel::indexOf(text, "ABC", 0, Qt::CaseInsensitive), 0);
+    EXPECT_EQ(TextSearchKernel::indexOf(text, "abcd"), -1);
+    EXPECT_EQ(TextSearchKernel::indexOf(text, QString(), 3), 3);
+    EXPECT_EQ(TextSearchKernel::indexOf(QString(), "a"), -1);
+}
+
+TEST_F(test_textsearchkernel, indexOf_AllOffsets)
+{
+    // 匹配项位于向量边界、末尾不足一个向量长度的部分
+    QString text = QString("0123456789").repeated(7) + "needle" + QString("x").repeated(17) + "needle";
+    checkAllOffsets(text, "needle", Qt::CaseSensitive);
+    checkAllOffsets(text, "n", Qt::CaseSensitive);
+    checkAllOffsets(text, "NeEdLe", Qt::CaseInsensitive);
+    checkAllOffsets(text, "xn", Qt::CaseSensitive);
+
+    // 首尾字符相同的候选位置需逐个校验
+    QString repeated = QString("ab").repeated(50) + "abc";
+    checkAllOffsets(repeated, "abc", Qt::CaseSensitive);
+    checkAllOffsets(repeated, "ABAB", Qt::CaseInsensitive);
+}
+
+TEST_F(test_textsearchkernel, indexOf_Horspool)
+{
+    QString keyword = QString("0123456789abcdef").repeated(3);
+    ASSERT_GE(keyword.length(), TextSearchKernel::EHorspoolMinLength);
+    QString text = QString("0123456789abcdef").repeated(10) + "-" + keyword;
+    checkAllOffsets(text, keyword, Qt::CaseSensitive);
+    checkAllOffsets(text, keyword.toUpper(), Qt::CaseInsensitive);
+    checkAllOffsets(text, keyword + "-", Qt::CaseSensitive);
+}
+
+TEST_F(test_textsearchkernel, indexOf_CaseFolding)
+{
+    // 折叠后相同的非 ASCII 字符(开尔文符号、长 s)及非拉丁字母
+    QString text = QString("xx\u212Aelvin \u017Fign ΑβΣς Ångström");
+    checkAllOffsets(text, "kelvin", Qt::CaseInsensitive);
+    checkAllOffsets(text, "SIGN", Qt::CaseInsensitive);
+    checkAllOffsets(text, QString("αΒσΣ"), Qt::CaseInsensitive);
+    checkAllOffsets(text, QString("åNGSTRÖM"), Qt::CaseInsensitive);
+    checkAllOffsets(text, QString("åNGSTRÖM"), Qt::CaseSensitive);
+
+    // 代理对字符
+    QString surrogate = QString("a\U00010400b\U00010428c");
+    checkAllOffsets(surrogate, QString("\U00010428"), Qt::CaseInsensitive);
+    checkAllOffsets(surrogate, QString("\U00010428c"), Qt::CaseSensitive);
+}
+
+TEST_F(test_textsearchkernel, indexOfScalar)
+{
+    QString text("find the Needle in the haystack");
+    QString keyword("needle");
+    const ushort *source = reinterpret_cast<const ushort *>(text.constData());
+    const ushort *pattern = reinterpret_cast<const ushort *>(keyword.constData());
+    EXPECT_EQ(TextSearchKernel::indexOfScalar(source, text.length(), pattern, keyword.length(), 0, nullptr), -1);
+    EXPECT_EQ(TextSearchKernel::indexOfHorspool(source, text.length(), pattern, keyword.length(), 0, nullptr), -1);
+
+    keyword = "Needle";
+    pattern = reinterpret_cast<const ushort *>(keyword.constData());
+    EXPECT_EQ(TextSearchKernel::indexOfScalar(source, text.length(), pattern, keyword.length(), 0, nullptr), 9);
+    EXPECT_EQ(TextSearchKernel::indexOfHorspool(source, text.length(), pattern, keyword.length(), 0, nullptr), 9);
+    EXPECT_EQ(TextSearchKernel::indexOfHorspool(source, text.length(), pattern, keyword.length(), 10, nullptr), -1);
+}
+
+// 性能测试，默认不执行，通过 --gtest_also_run_disabled_tests --gtest_filter=*Benchmark* 运行
+TEST_F(test_textsearchkernel, DISABLED_Benchmark_Search)
+{
+    const QString text = benchmarkLog();
+    QTextDocument document;
+    document.setPlainText(text);
+
+    const QStringList keywords = {"status=200", "BackupTask", "OutOfMemoryError", "/api/v1/upload cost=1532ms",
+                                  "c.d.e.RequestFilter : slow request POST /api/v1/upload"};
+    for (const QString &keyword : keywords) {
+        for (Qt::CaseSensitivity cs : {Qt::CaseSensitive, Qt::CaseInsensitive}) {
+            double kernelTime = 0;
+            double indexOfTime = 0;
+            double documentTime = 0;
+
+            int kernelCount = countMatches(keyword, [&](int from) {
+                return TextSearchKernel::indexOf(text, keyword, from, cs);
+            }, &kernelTime);
+            int indexOfCount = countMatches(keyword, [&](int from) {
+                return text.indexOf(keyword, from, cs);
+            }, &indexOfTime);
+
+            QTextDocument::FindFlags flags;
+            if (Qt::CaseSensitive == cs) {
+                flags |= QTextDocument::FindCaseSensitively;
+            }
+            QElapsedTimer timer;
+            timer.start();
+            int documentCount = 0;
+            QTextCursor cursor = document.find(keyword, 0, flags);
+            while (!cursor.isNull()) {
+                ++documentCount;
+                cursor = document.find(keyword, cursor, flags);
+            }
+            documentTime = timer.nsecsElapsed() / 1000000.0;
+
+            EXPECT_EQ(kernelCount, indexOfCount);
+            EXPECT_EQ(kernelCount, documentCount);
+            qInfo() << "Search" << text.size() * 2 / (1024 * 1024) << "MB, implementation:" << TextSearchKernel::implementation()
+                    << "keyword:" << keyword << "case sensitive:" << (Qt::CaseSensitive == cs) << "matches:" << kernelCount
+                    << "kernel(ms):" << kernelTime << "QString::indexOf(ms):" << indexOfTime
+                    << "QTextDocument::find(ms):" << documentTime;
+        }
+    }
+}
@@ -0,0 +1,18 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef UT_TEXTSEARCHKERNEL_H
+#define UT_TEXTSEARCHKERNEL_H
+
+#include "gtest/gtest.h"
+#include <QObject>
+
+class test_textsearchkernel : public QObject
+    , public ::testing::Test
+{
+public:
+    test_textsearchkernel();
+};
+
+#endif // UT_TEXTSEARCHKERNEL_H
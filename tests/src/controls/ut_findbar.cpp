@@ -6,6 +6,7 @@
 #include "../../src/controls/findbar.h"
 #include <QFocusEvent>
 #include <QEvent>
+#include <QLocale>
 
 test_findbar::test_findbar()
 {
@@ -131,6 +132,22 @@ TEST_F(test_findbar, handleContentChanged)
     
 }
 
+//void setMatchCount(int current, int total, bool counting);
+TEST_F(test_findbar, setMatchCount)
+{
+    FindBar *findBar = new FindBar();
+    findBar->setMatchCount(37, 12455, false);
+    EXPECT_EQ(findBar->m_matchCountLabel->text(), QString("37 of %1").arg(QLocale().toString(12455)));
+
+    // 统计过程中总数后添加 "+"
+    findBar->setMatchCount(0, 100, true);
+    EXPECT_EQ(findBar->m_matchCountLabel->text(), QString("100+ results"));
+
+    findBar->clearMatchCount();
+    EXPECT_TRUE(findBar->m_matchCountLabel->text().isEmpty());
+    findBar->deleteLater();
+}
+
 //void slot_ifClearSearchWord();
 //TEST_F(test_findbar, slot_ifClearSearchWord)
 //{
@@ -6,6 +6,7 @@
 #include "qfile.h"
 #include <KSyntaxHighlighting/SyntaxHighlighter>
 #include "DSettingsOption"
+#include "../../src/common/highlightstatecache.h"
 
 namespace editwrapperstub {
 
@@ -1454,3 +1455,23 @@ TEST(UT_Editwrapper_reloadFileHighlight, reloadFileHighlight_SingleLineText_Succ
     wra->deleteLater();
     window->deleteLater();
 }
+
+TEST(UT_Editwrapper_setBackgroundHighlight, setBackgroundHighlight_BeforeAndAfterHighlighter)
+{
+    Window* window = new Window();
+    EditWrapper* wra = new EditWrapper(window);
+    wra->m_pTextEdit->setPlainText("import time");
+
+    // 创建高亮器前设置，创建时沿用
+    wra->setBackgroundHighlight(true);
+    wra->reloadFileHighlight("Python");
+    ASSERT_NE(wra->m_pSyntaxHighlighter, nullptr);
+    EXPECT_TRUE(wra->m_pSyntaxHighlighter->stateCache()->isBackgroundEnabled());
+
+    wra->setBackgroundHighlight(false);
+    EXPECT_FALSE(wra->m_bBackgroundHighlight);
+    EXPECT_FALSE(wra->m_pSyntaxHighlighter->stateCache()->isBackgroundEnabled());
+
+    wra->deleteLater();
+    window->deleteLater();
+}
@@ -0,0 +1,249 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "ut_foldregionindex.h"
+#include "../../src/editor/foldregionindex.h"
+
+#include <QTextDocument>
+#include <QTextCursor>
+#include <QTextBlock>
+
+namespace {
+
+const QString s_code = QString("int main() {\n"
+                               "    if (a) {\n"
+                               "        s = \"{\";\n"
+                               "    }\n"
+                               "}\n"
+                               "{ }");
+
+// 增量更新的索引与重新统计的结果一致
+bool sameAsRebuild(const FoldRegionIndex &index, const QTextDocument *document)
+{
+    FoldRegionIndex rebuilt;
+    rebuilt.rebuild(document);
+    if (!index.isValid(document) || index.blockCount() != rebuilt.blockCount()) {
+        return false;
+    }
+
+    for (int i = 0; i < rebuilt.blockCount(); ++i) {
+        if (index.hasRegionBegin(i) != rebuilt.hasRegionBegin(i)
+                || index.startsRegion(i) != rebuilt.startsRegion(i)
+                || index.depthAtStart(i) != rebuilt.depthAtStart(i)
+                || index.depthAtEnd(i) != rebuilt.depthAtEnd(i)
+                || index.regionEnd(i) != rebuilt.regionEnd(i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}
+
+test_foldregionindex::test_foldregionindex()
+{
+}
+
+void test_foldregionindex::SetUp()
+{
+}
+
+void test_foldregionindex::TearDown()
+{
+}
+
+//static BlockInfo scanBlock(const QString &text, bool inString);
+TEST_F(test_foldregionindex, scanBlock)
+{
+    FoldRegionIndex::BlockInfo info = FoldRegionIndex::scanBlock("} { {", false);
+    EXPECT_EQ(info.openCount, 2);
+    EXPECT_EQ(info.minDepth, -1);
+    EXPECT_EQ(info.endDepth, 1);
+    EXPECT_FALSE(info.endsInString);
+
+    // 字符串内及转义引号后的括号不统计
+    info = FoldRegionIndex::scanBlock("s = \"{ \\\" }\";", false);
+    EXPECT_EQ(info.openCount, 0);
+    EXPECT_EQ(info.endDepth, 0);
+
+    // 行尾续行符使字符串延续到下一行，否则字符串在行尾结束
+    info = FoldRegionIndex::scanBlock("s = \"{\\", false);
+    EXPECT_EQ(info.openCount, 0);
+    EXPECT_TRUE(info.endsInString);
+    info = FoldRegionIndex::scanBlock("}\" {", true);
+    EXPECT_EQ(info.minDepth, 0);
+    EXPECT_EQ(info.endDepth, 1);
+    info = FoldRegionIndex::scanBlock("s = \"{", false);
+    EXPECT_FALSE(info.endsInString);
+}
+
+//int regionEnd(int blockNumber) const;
+TEST_F(test_foldregionindex, regionEnd)
+{
+    QTextDocument document(s_code);
+    FoldRegionIndex index;
+    EXPECT_FALSE(index.isValid(&document));
+    index.rebuild(&document);
+    EXPECT_TRUE(index.isValid(&document));
+
+    EXPECT_EQ(index.regionEnd(0), 4);
+    EXPECT_EQ(index.regionEnd(1), 3);
+    EXPECT_EQ(index.regionEnd(2), -1);
+    EXPECT_EQ(index.regionEnd(5), -1);
+    EXPECT_EQ(index.regionEnd(6), -1);
+
+    EXPECT_TRUE(index.startsRegion(0));
+    EXPECT_FALSE(index.hasRegionBegin(2));
+    EXPECT_TRUE(index.hasRegionBegin(5));
+    EXPECT_FALSE(index.startsRegion(5));
+    EXPECT_EQ(index.depthAtStart(2), 2);
+    EXPECT_EQ(index.depthAtEnd(3), 1);
+    EXPECT_EQ(index.depthAtEnd(5), 0);
+}
+
+//void contentsChange(const QTextDocument *document, int from, int charsRemoved, int charsAdded);
+TEST_F(test_foldregionindex, contentsChange)
+{
+    QTextDocument document(s_code);
+    FoldRegionIndex index;
+    index.rebuild(&document);
+    QObject::connect(&document, &QTextDocument::contentsChange, [&index, &document](int from, int charsRemoved, int charsAdded) {
+        index.contentsChange(&document, from, charsRemoved, charsAdded);
+    });
+
+    // 插入多行文本
+    QTextCursor cursor(document.findBlockByNumber(2));
+    cursor.movePosition(QTextCursor::EndOfBlock);
+    cursor.insertText("\n        while (b) {\n        }");
+    EXPECT_TRUE(sameAsRebuild(index, &document));
+    EXPECT_EQ(index.regionEnd(3), 4);
+    EXPECT_EQ(index.regionEnd(0), 6);
+
+    // 删除跨行文本
+    cursor.setPosition(document.findBlockByNumber(3).position());
+    cursor.setPosition(document.findBlockByNumber(5).position(), QTextCursor::KeepAnchor);
+    cursor.removeSelectedText();
+    EXPECT_TRUE(sameAsRebuild(index, &document));
+    EXPECT_EQ(index.regionEnd(1), 3);
+
+    // 续行字符串改变后续文本块的字符串状态
+    cursor.setPosition(document.findBlockByNumber(2).position());
+    cursor.movePosition(QTextCursor::EndOfBlock, QTextCursor::KeepAnchor);
+    cursor.insertText("        s = \"a\\");
+    EXPECT_TRUE(sameAsRebuild(index, &document));
+    EXPECT_EQ(index.regionEnd(1), 4);
+    EXPECT_EQ(index.regionEnd(0), -1);
+
+    // 撤销后恢复
+    document.undo();
+    EXPECT_TRUE(sameAsRebuild(index, &document));
+    EXPECT_EQ(index.regionEnd(1), 3);
+
+    // 整体替换文本
+    document.setPlainText("{\n}");
+    EXPECT_TRUE(sameAsRebuild(index, &document));
+    EXPECT_EQ(index.regionEnd(0), 1);
+}
+
+//int linkedCount() const;
+TEST_F(test_foldregionindex, incrementalLink)
+{
+    QString code;
+    for (int i = 0; i < 100; ++i) {
+        code += QString("void f%1() {\n    if (a) {\n    }\n}\n").arg(i);
+    }
+    QTextDocument document(code);
+    FoldRegionIndex index;
+    index.rebuild(&document);
+    QObject::connect(&document, &QTextDocument::contentsChange, [&index, &document](int from, int charsRemoved, int charsAdded) {
+        index.contentsChange(&document, from, charsRemoved, charsAdded);
+    });
+
+    // 查询仅推导至所需的文本块
+    EXPECT_EQ(index.linkedCount(), 0);
+    EXPECT_EQ(index.regionEnd(4), 7);
+    EXPECT_EQ(index.linkedCount(), 8);
+    EXPECT_EQ(index.depthAtEnd(399), 0);
+    EXPECT_EQ(index.linkedCount(), 400);
+
+    // 文档末尾的编辑保留之前的推导结果
+    QTextCursor cursor(document.findBlockByNumber(397));
+    cursor.movePosition(QTextCursor::EndOfBlock);
+    cursor.insertText("\n    while (b) {\n    }");
+    EXPECT_EQ(index.linkedCount(), 397);
+    EXPECT_EQ(index.regionEnd(396), 401);
+    EXPECT_EQ(index.regionEnd(397), 400);
+    EXPECT_EQ(index.regionEnd(398), 399);
+    EXPECT_TRUE(sameAsRebuild(index, &document));
+
+    // 区域内的编辑使包含该位置的区域重新查找结束位置
+    cursor.setPosition(document.findBlockByNumber(398).position());
+    cursor.movePosition(QTextCursor::EndOfBlock, QTextCursor::KeepAnchor);
+    cursor.insertText("    }");
+    EXPECT_EQ(index.linkedCount(), 398);
+    EXPECT_EQ(index.regionEnd(397), 398);
+    EXPECT_EQ(index.regionEnd(396), 399);
+    EXPECT_TRUE(sameAsRebuild(index, &document));
+}
+
+//void setFoldingMode(FoldingMode mode, const QTextDocument *document);
+TEST_F(test_foldregionindex, indentationFolding)
+{
+    QTextDocument document(QString("def f():\n"
+                                   "    if a:\n"
+                                   "        pass\n"
+                                   "\n"
+                                   "    return 1\n"
+                                   "x = {"));
+    FoldRegionIndex index;
+    index.setFoldingMode(FoldRegionIndex::EIndentationFolding, &document);
+    EXPECT_EQ(index.foldingMode(), FoldRegionIndex::EIndentationFolding);
+
+    EXPECT_TRUE(index.startsRegion(0));
+    EXPECT_TRUE(index.startsRegion(1));
+    EXPECT_FALSE(index.startsRegion(2));
+    EXPECT_FALSE(index.startsRegion(3));
+    EXPECT_FALSE(index.startsRegion(5));
+    EXPECT_TRUE(index.hasRegionBegin(1));
+    EXPECT_FALSE(index.hasRegionBegin(5));
+    EXPECT_EQ(index.regionEnd(0), 5);
+    EXPECT_EQ(index.regionEnd(1), 4);
+    EXPECT_EQ(index.blockInfo(3).indent, -1);
+}
+
+//void setBlockRegions(int blockNumber, const QVector<int> &regions);
+TEST_F(test_foldregionindex, syntaxFolding)
+{
+    QTextDocument document(QString("<a>\n<b>\n</b>\n</a>"));
+    FoldRegionIndex index;
+    index.setBlockRegions(0, QVector<int>({1}));
+    index.setFoldingMode(FoldRegionIndex::ESyntaxFolding, &document);
+    EXPECT_TRUE(index.isValid(&document));
+    EXPECT_FALSE(index.startsRegion(0));
+
+    index.setBlockRegions(0, QVector<int>({1}));
+    index.setBlockRegions(1, QVector<int>({2}));
+    index.setBlockRegions(2, QVector<int>({-2}));
+    index.setBlockRegions(3, QVector<int>({-1}));
+    EXPECT_TRUE(index.startsRegion(0));
+    EXPECT_EQ(index.regionEnd(0), 3);
+    EXPECT_EQ(index.regionEnd(1), 2);
+
+    // 同一文本块内起止的区域不显示折叠标志
+    index.setBlockRegions(2, QVector<int>({-2, 2, -2}));
+    EXPECT_FALSE(index.startsRegion(2));
+    EXPECT_EQ(index.regionEnd(1), 2);
+
+    // 内容变更仅调整文本块数量，区域标记保留至重新高亮
+    QObject::connect(&document, &QTextDocument::contentsChange, [&index, &document](int from, int charsRemoved, int charsAdded) {
+        index.contentsChange(&document, from, charsRemoved, charsAdded);
+    });
+    QTextCursor cursor(document.findBlockByNumber(1));
+    cursor.movePosition(QTextCursor::EndOfBlock);
+    cursor.insertText("\ntext");
+    EXPECT_TRUE(index.isValid(&document));
+    EXPECT_TRUE(index.startsRegion(1));
+    EXPECT_EQ(index.regionEnd(1), 3);
+    EXPECT_EQ(index.regionEnd(0), 4);
+}
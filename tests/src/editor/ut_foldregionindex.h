@@ -0,0 +1,20 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef UT_FOLDREGIONINDEX_H
+#define UT_FOLDREGIONINDEX_H
+
+#include "gtest/gtest.h"
+#include <QObject>
+
+class test_foldregionindex : public QObject
+    , public ::testing::Test
+{
+public:
+    test_foldregionindex();
+    virtual void SetUp() override;
+    virtual void TearDown() override;
+};
+
+#endif // UT_FOLDREGIONINDEX_H
@@ -0,0 +1,109 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "ut_largefileview.h"
+#include "../../src/editor/largefileview.h"
+#include "../../src/common/piecetable.h"
+
+#include <QApplication>
+#include <QClipboard>
+#include <QSignalSpy>
+
+test_largefileview::test_largefileview()
+{
+}
+
+void test_largefileview::SetUp()
+{
+}
+
+void test_largefileview::TearDown()
+{
+}
+
+//void setPieceTable(PieceTable *table);
+TEST_F(test_largefileview, setPieceTable)
+{
+    LargeFileView view;
+    view.resize(400, 300);
+
+    PieceTable *table = new PieceTable;
+    table->setData("line1\n\tline2\r\nline3");
+    view.setPieceTable(table);
+
+    EXPECT_EQ(view.pieceTable(), table);
+    EXPECT_EQ(view.lineCount(), 3);
+    EXPECT_EQ(view.currentLine(), 0);
+    ASSERT_FALSE(view.m_cacheLines.isEmpty());
+    EXPECT_EQ(view.m_cacheLines.first(), QString("line1"));
+    // 制表符展开，移除行尾换行符
+    EXPECT_EQ(view.lineText(1), QString("    line2"));
+
+    view.setPieceTable(nullptr);
+    EXPECT_EQ(view.lineCount(), 0);
+}
+
+//QString lineText(qint64 line) const;
+TEST_F(test_largefileview, lineText_Truncate)
+{
+    LargeFileView view;
+    PieceTable *table = new PieceTable;
+    // 多字节字符跨越截断位置时，移除不完整的字符
+    QByteArray data(LargeFileView::EMaxLineDisplayBytes - 1, 'a');
+    data.append(QString("中文").toUtf8());
+    table->setData(data);
+    view.setPieceTable(table);
+
+    QString text = view.lineText(0);
+    EXPECT_EQ(text.size(), LargeFileView::EMaxLineDisplayBytes - 1);
+    EXPECT_FALSE(text.contains(QChar::ReplacementCharacter));
+}
+
+//void jumpToLine(qint64 line);
+TEST_F(test_largefileview, jumpToLine)
+{
+    LargeFileView view;
+    view.resize(400, 300);
+
+    QByteArray data;
+    for (int i = 0; i < 1000; ++i) {
+        data.append(QByteArray::number(i)).append('\n');
+    }
+    PieceTable *table = new PieceTable;
+    table->setData(data);
+    view.setPieceTable(table);
+
+    QSignalSpy spy(&view, &LargeFileView::sigCurrentLineChanged);
+    view.jumpToLine(500);
+    EXPECT_EQ(view.currentLine(), 500);
+    EXPECT_EQ(spy.count(), 1);
+    EXPECT_LE(view.firstVisibleLine(), 500);
+    EXPECT_GT(view.firstVisibleLine() + view.pageLineCount(), 500);
+    EXPECT_EQ(view.m_cacheFirstLine, view.firstVisibleLine());
+
+    // 越界时跳转到最后一行
+    view.jumpToLine(5000);
+    EXPECT_EQ(view.currentLine(), 1000);
+}
+
+//void copySelection();
+TEST_F(test_largefileview, copySelection)
+{
+    LargeFileView view;
+    PieceTable *table = new PieceTable;
+    table->setData("line1\nline2\nline3");
+    view.setPieceTable(table);
+
+    view.jumpToLine(1);
+    view.copySelection();
+    EXPECT_EQ(QApplication::clipboard()->text(), QString("line2"));
+
+    view.setCurrentLine(2, true);
+    view.copySelection();
+    EXPECT_EQ(QApplication::clipboard()->text(), QString("line2\nline3"));
+
+    view.selectAll();
+    view.copySelection();
+    EXPECT_EQ(QApplication::clipboard()->text(), QString("line1\nline2\nline3"));
+}
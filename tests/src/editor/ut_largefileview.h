@@ -0,0 +1,20 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef UT_LARGEFILEVIEW_H
+#define UT_LARGEFILEVIEW_H
+
+#include "gtest/gtest.h"
+#include <QObject>
+
+class test_largefileview : public QObject
+    , public ::testing::Test
+{
+public:
+    test_largefileview();
+    virtual void SetUp() override;
+    virtual void TearDown() override;
+};
+
+#endif // UT_LARGEFILEVIEW_H
@@ -14,7 +14,7 @@ TEST_F(test_replaceallcommond, ReplaceAllCommand)
 {
     QString text = "test";
     QTextCursor cursor;
-    ReplaceAllCommand* com = new ReplaceAllCommand(text,text,cursor);
+    ReplaceAllCommand* com = new ReplaceAllCommand(QVector<int>({0}), text, text, cursor);
     ASSERT_TRUE(!text.compare(com->m_newText));
 
     delete com;
@@ -23,11 +23,11 @@ TEST_F(test_replaceallcommond, ReplaceAllCommand)
 
 TEST_F(test_replaceallcommond, redo)
 {
-    QString text = "test";
-    QTextCursor cursor;
-    ReplaceAllCommand* com = new ReplaceAllCommand(text,text,cursor);
+    QTextDocument document("test test");
+    QTextCursor cursor(&document);
+    ReplaceAllCommand* com = new ReplaceAllCommand(QVector<int>({0, 5}), "test", "ok", cursor);
     com->redo();
-    ASSERT_TRUE(com->m_cursor.position() != 0);
+    ASSERT_EQ(document.toPlainText(), QString("ok ok"));
 
     delete com;
     com=nullptr;
@@ -35,14 +35,74 @@ TEST_F(test_replaceallcommond, redo)
 
 TEST_F(test_replaceallcommond, undo)
 {
-    QString text = "test";
-    QTextCursor cursor;
-    ReplaceAllCommand* com = new ReplaceAllCommand(text,text,cursor);
+    QTextDocument document("ok ok");
+    QTextCursor cursor(&document);
+    ReplaceAllCommand* com = new ReplaceAllCommand(QVector<int>({0, 5}), "test", "ok", cursor);
     com->undo();
-    ASSERT_TRUE(com->m_cursor.position() != 0);
+    ASSERT_EQ(document.toPlainText(), QString("test test"));
+
+    // 空光标不替换
+    ReplaceAllCommand nullCom(QVector<int>({0}), "test", "ok", QTextCursor());
+    nullCom.undo();
 
     delete com;
     com=nullptr;
+}
+
+//static QVector<int> findOffsets(const QString &text, const QString &keyword, int from = 0);
+TEST_F(test_replaceallcommond, findOffsets)
+{
+    QVector<int> offsets = ReplaceAllCommand::findOffsets("aaa ab aa", "aa");
+    ASSERT_EQ(offsets, QVector<int>({0, 7}));
 
-    
+    offsets = ReplaceAllCommand::findOffsets("aaa ab aa", "aa", 1);
+    ASSERT_EQ(offsets, QVector<int>({1, 7}));
+
+    ASSERT_TRUE(ReplaceAllCommand::findOffsets("text", "").isEmpty());
+}
+
+TEST_F(test_replaceallcommond, redoUndo_Offsets)
+{
+    QTextDocument document;
+    QString oldText("one two one\none three one");
+    document.setPlainText(oldText);
+
+    QVector<int> offsets = ReplaceAllCommand::findOffsets(oldText, "one");
+    QTextCursor cursor(&document);
+    ReplaceAllCommand *com = new ReplaceAllCommand(offsets, "one", "1\n", cursor);
+
+    QString newText = oldText;
+    newText.replace("one", "1\n");
+    com->redo();
+    ASSERT_EQ(document.toPlainText(), newText);
+
+    com->undo();
+    ASSERT_EQ(document.toPlainText(), oldText);
+
+    // 撤销项仅保存匹配位置及替换文本
+    ASSERT_EQ(com->m_offsets.size(), 4);
+    ASSERT_EQ(com->m_oldText, QString("one"));
+
+    delete com;
+    com = nullptr;
+}
+
+TEST_F(test_replaceallcommond, redoUndo_Texts)
+{
+    QTextDocument document;
+    QString oldText("ab abbb\nabb");
+    document.setPlainText(oldText);
+
+    // 各匹配项文本及替换文本长度均不同
+    QTextCursor cursor(&document);
+    ReplaceAllCommand *com = new ReplaceAllCommand(QVector<int>({0, 3, 8}), QStringList({"ab", "abbb", "abb"}),
+                                                   QStringList({"x", "", "y\nz"}), cursor);
+    com->redo();
+    ASSERT_EQ(document.toPlainText(), QString("x \ny\nz"));
+
+    com->undo();
+    ASSERT_EQ(document.toPlainText(), oldText);
+
+    delete com;
+    com = nullptr;
 }
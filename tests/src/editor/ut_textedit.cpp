@@ -6,6 +6,7 @@
 #include "stub.h"
 #include "../../src/widgets/window.h"
 #include <QUndoStack>
+#include <QSignalSpy>
 #include "QDBusReply"
 #include "QDBusConnection"
 
@@ -1822,6 +1823,88 @@ TEST(UT_test_textedit_replaceAll, UT_test_textedit_replaceAll_003)
     pWindow->deleteLater();
 }
 
+//replaceAll 004
+TEST(UT_test_textedit_replaceAll, UT_test_textedit_replaceAll_004)
+{
+    Window *pWindow = new Window();
+    pWindow->addBlankTab(QString());
+    QString strMsg("id=12 id=345\nwidth=6 id=7");
+    QTextCursor textCursor = pWindow->currentWrapper()->textEditor()->textCursor();
+    pWindow->currentWrapper()->textEditor()->insertTextEx(textCursor, strMsg);
+
+    // 正则表达式替换，替换文本引用捕获组
+    pWindow->currentWrapper()->textEditor()->setSearchFlags(TextSearchEngine::ERegularExpression);
+    pWindow->currentWrapper()->textEditor()->replaceAll(QString("(\\w+)=(\\d+)"), QString("\\2:\\1"));
+    ASSERT_EQ(pWindow->currentWrapper()->textEditor()->toPlainText(), QString("12:id 345:id\n6:width 7:id"));
+
+    pWindow->currentWrapper()->textEditor()->m_pUndoStack->undo();
+    ASSERT_EQ(pWindow->currentWrapper()->textEditor()->toPlainText(), strMsg);
+
+    // 全词匹配替换，width 中的 id 不替换
+    pWindow->currentWrapper()->textEditor()->setSearchFlags(TextSearchEngine::EWholeWord);
+    pWindow->currentWrapper()->textEditor()->replaceAll(QString("id"), QString("key"));
+    ASSERT_EQ(pWindow->currentWrapper()->textEditor()->toPlainText(), QString("key=12 key=345\nwidth=6 key=7"));
+    pWindow->deleteLater();
+}
+
+//QPair<int, int> findMatchPosition() const;
+TEST(UT_test_textedit_findMatchPosition, UT_test_textedit_findMatchPosition)
+{
+    Window *pWindow = new Window();
+    pWindow->addBlankTab(QString());
+    QString strMsg("foo bar foo\nbar foo");
+    QTextCursor textCursor = pWindow->currentWrapper()->textEditor()->textCursor();
+    pWindow->currentWrapper()->textEditor()->insertTextEx(textCursor, strMsg);
+
+    TextEdit *pEdit = pWindow->currentWrapper()->textEditor();
+    QSignalSpy spy(pEdit->searchEngine(), &TextSearchEngine::sigResultChanged);
+    pEdit->searchEngine()->start(QString("foo"));
+    ASSERT_TRUE(spy.wait(10000));
+    ASSERT_TRUE(pEdit->isSearchResultReady(QString("foo")));
+
+    // 查找高亮位于第 2 个匹配项
+    QTextCursor cursor(pEdit->document());
+    cursor.setPosition(8);
+    cursor.setPosition(11, QTextCursor::KeepAnchor);
+    pEdit->m_findHighlightSelection.cursor = cursor;
+    EXPECT_EQ(pEdit->findMatchPosition(), qMakePair(2, 3));
+
+    // 编辑后查找结果增量更新，高亮光标随文档变更移动
+    QTextCursor insertCursor(pEdit->document());
+    insertCursor.insertText(QString("foo "));
+    EXPECT_EQ(pEdit->findMatchPosition(), qMakePair(3, 4));
+    pWindow->deleteLater();
+}
+
+//int replaceMatches(const SearchResult &result, const QString &replaceText, const QString &withText, const QStringList &oldTexts, const QStringList &newTexts);
+TEST(UT_test_textedit_replaceMatches, UT_test_textedit_replaceMatches_001)
+{
+    Window *pWindow = new Window();
+    pWindow->addBlankTab(QString());
+    TextEdit *pEdit = pWindow->currentWrapper()->textEditor();
+    QTextCursor textCursor = pEdit->textCursor();
+    pEdit->insertTextEx(textCursor, QString("port=80\nPORT=8080"));
+
+    // 按后台查找的结果直接替换，撤销后恢复原文本
+    const QString text = pEdit->toPlainText();
+    const SearchResult result = TextSearchEngine::search(text, QString("port=(\\d+)"),
+                                                         TextSearchEngine::ERegularExpression | TextSearchEngine::ECaseInsensitive);
+    const QStringList newTexts = TextSearchEngine::replacements(text, result, 0, QString("port=(\\d+)"),
+                                                                TextSearchEngine::ERegularExpression | TextSearchEngine::ECaseInsensitive,
+                                                                QString("p:\\1"));
+    const QStringList oldTexts = {QString("port=80"), QString("PORT=8080")};
+    EXPECT_EQ(pEdit->replaceMatches(result, QString("port=(\\d+)"), QString("p:\\1"), oldTexts, newTexts), 2);
+    EXPECT_EQ(pEdit->toPlainText(), QString("p:80\np:8080"));
+    pEdit->getUndoStack()->undo();
+    EXPECT_EQ(pEdit->toPlainText(), text);
+
+    // 只读时不替换
+    pEdit->m_readOnlyMode = true;
+    EXPECT_EQ(pEdit->replaceMatches(result, QString("port=(\\d+)"), QString("p:\\1"), oldTexts, newTexts), 0);
+    EXPECT_EQ(pEdit->toPlainText(), text);
+    pWindow->deleteLater();
+}
+
 //replaceNext 001
 TEST(UT_test_textedit_replaceNext, UT_test_textedit_replaceNext_001)
 {
@@ -2342,6 +2425,40 @@ TEST(UT_test_textedit_renderAllSelections, UT_test_textedit_renderAllSelections_
     pWindow->deleteLater();
 }
 
+// 仅可见区域内的装饰生成扩展选区
+TEST(UT_test_textedit_renderAllSelections, UT_test_textedit_renderAllSelections_002)
+{
+    TextEdit *edit = new TextEdit;
+    EditWrapper *wra = new EditWrapper;
+    edit->m_wrapper = wra;
+    edit->resize(400, 300);
+    edit->setPlainText(QString("mark line\n").repeated(5000));
+
+    QTextCursor cursor(edit->document());
+    for (int i = 0; i < 5000; ++i) {
+        QTextEdit::ExtraSelection selection;
+        selection.cursor = cursor;
+        selection.cursor.movePosition(QTextCursor::EndOfBlock, QTextCursor::KeepAnchor);
+        selection.format.setBackground(QColor("red"));
+        edit->m_wordMarkSelections.append(qMakePair(selection, qint64(i)));
+        cursor.movePosition(QTextCursor::NextBlock);
+    }
+    edit->m_wordMarkIndex.invalidate();
+    edit->renderAllSelections();
+
+    const QPair<int, int> range = edit->visibleTextRange();
+    for (const QTextEdit::ExtraSelection &selection : edit->extraSelections()) {
+        EXPECT_GE(selection.cursor.selectionEnd(), range.first);
+        EXPECT_LE(selection.cursor.selectionStart(), range.second);
+    }
+    EXPECT_EQ(PerformanceMonitor::lastRenderedSelections(), edit->extraSelections().size());
+    EXPECT_GE(PerformanceMonitor::lastTotalSelections(), 5000);
+    EXPECT_EQ(edit->m_hasHiddenSelections, edit->extraSelections().size() < PerformanceMonitor::lastTotalSelections());
+
+    edit->deleteLater();
+    wra->deleteLater();
+}
+
 //clearMarkOperationForCursor
 TEST(UT_test_textedit_clearMarkOperationForCursor, UT_test_textedit_clearMarkOperationForCursor_001)
 {
@@ -0,0 +1,79 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "ut_textmarkindex.h"
+#include "../../src/editor/textmarkindex.h"
+
+#include <QTextDocument>
+
+namespace {
+
+void appendMark(QTextDocument *document, TextMarkIndex::MarkList &marks, int start, int end, qint64 timeStamp)
+{
+    QTextEdit::ExtraSelection selection;
+    selection.cursor = QTextCursor(document);
+    selection.cursor.setPosition(start);
+    selection.cursor.setPosition(end, QTextCursor::KeepAnchor);
+    marks.append(qMakePair(selection, timeStamp));
+}
+
+}
+
+test_textmarkindex::test_textmarkindex()
+{
+}
+
+void test_textmarkindex::SetUp()
+{
+}
+
+void test_textmarkindex::TearDown()
+{
+}
+
+//QVector<int> intersecting(const MarkList &marks, int from, int to) const;
+TEST_F(test_textmarkindex, intersecting)
+{
+    QTextDocument document(QString("0123456789").repeated(10));
+    TextMarkIndex::MarkList marks;
+    appendMark(&document, marks, 50, 60, 1);
+    appendMark(&document, marks, 0, 100, 2);
+    appendMark(&document, marks, 10, 20, 3);
+    appendMark(&document, marks, 30, 35, 4);
+
+    TextMarkIndex index;
+    EXPECT_FALSE(index.isValid(marks));
+    index.rebuild(marks);
+    EXPECT_TRUE(index.isValid(marks));
+
+    // 结果按起始位置升序排列，包含覆盖整个区间的长标记
+    EXPECT_EQ(index.intersecting(marks, 12, 32), QVector<int>({1, 2, 3}));
+    EXPECT_EQ(index.intersecting(marks, 20, 29), QVector<int>({1, 2}));
+    EXPECT_EQ(index.intersecting(marks, 61, 99), QVector<int>({1}));
+    EXPECT_EQ(index.startingIn(marks, 10, 50), QVector<int>({2, 3, 0}));
+
+    // 编辑文本后光标位置由文档调整，索引仍然有效
+    QTextCursor cursor(&document);
+    cursor.setPosition(0);
+    cursor.insertText("abcde");
+    cursor.setPosition(40);
+    cursor.setPosition(60, QTextCursor::KeepAnchor);
+    cursor.removeSelectedText();
+    EXPECT_EQ(index.intersecting(marks, 15, 15), QVector<int>({1, 2}));
+    EXPECT_EQ(index.intersecting(marks, 40, 40), QVector<int>({1, 3, 0}));
+    EXPECT_EQ(marks.at(0).first.cursor.selectionStart(), 40);
+    EXPECT_EQ(marks.at(0).first.cursor.selectionEnd(), 45);
+
+    // 标记列表变更后需重建
+    marks.removeFirst();
+    EXPECT_FALSE(index.isValid(marks));
+    index.rebuild(marks);
+    EXPECT_EQ(index.intersecting(marks, 40, 40), QVector<int>({0, 2}));
+    index.invalidate();
+    EXPECT_FALSE(index.isValid(marks));
+
+    TextMarkIndex::MarkList emptyMarks;
+    index.rebuild(emptyMarks);
+    EXPECT_TRUE(index.intersecting(emptyMarks, 0, 100).isEmpty());
+}
@@ -0,0 +1,137 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "ut_encodingdetector.h"
+#include "src/stub.h"
+#include "../../src/encodes/encodingdetector.h"
+#include "../../src/encodes/detectcode.h"
+#include "../../src/common/config.h"
+
+#include <QTextCodec>
+
+namespace encodingdetectorstub {
+
+bool g_getFileEncodingFormatCalled = false;
+QByteArray getFileEncodingFormat_stub(QString filepath, QByteArray content)
+{
+    Q_UNUSED(filepath)
+    Q_UNUSED(content)
+    g_getFileEncodingFormatCalled = true;
+    return QByteArray("GB18030");
+}
+
+int chartDetDetectingTextCoding_stub(const char *str, QString &encoding, float &confidence)
+{
+    Q_UNUSED(str)
+    encoding = "Big5";
+    confidence = 0.99f;
+    return 0;
+}
+
+}
+
+using namespace encodingdetectorstub;
+
+UT_EncodingDetector::UT_EncodingDetector()
+{
+}
+
+TEST_F(UT_EncodingDetector, detect_BOM_Pass)
+{
+    EXPECT_EQ(EncodingDetector::detect(QByteArray::fromHex("EFBBBF") + "text"), QByteArray("UTF-8"));
+    EXPECT_EQ(EncodingDetector::detect(QByteArray::fromHex("FFFE") + QByteArray("t\0e\0", 4)), QByteArray("UTF-16LE"));
+    EXPECT_EQ(EncodingDetector::detect(QByteArray::fromHex("FEFF")), QByteArray("UTF-16BE"));
+    EXPECT_EQ(EncodingDetector::detect(QByteArray::fromHex("FFFE0000")), QByteArray("UTF-32LE"));
+    EXPECT_EQ(EncodingDetector::detect(QByteArray::fromHex("0000FEFF")), QByteArray("UTF-32BE"));
+}
+
+TEST_F(UT_EncodingDetector, detect_ASCII_Pass)
+{
+    Stub stub;
+    stub.set(ADDR(DetectCode, GetFileEncodingFormat), getFileEncodingFormat_stub);
+    g_getFileEncodingFormatCalled = false;
+
+    QByteArray content(2 * 1024 * 1024, 'a');
+    EXPECT_EQ(EncodingDetector::detect(content), Config::instance()->defaultEncoding().toUpper());
+    // 纯 ASCII 数据无需完整识别
+    EXPECT_FALSE(g_getFileEncodingFormatCalled);
+}
+
+TEST_F(UT_EncodingDetector, detect_UTF8_Pass)
+{
+    Stub stub;
+    stub.set(ADDR(DetectCode, GetFileEncodingFormat), getFileEncodingFormat_stub);
+    g_getFileEncodingFormatCalled = false;
+
+    QByteArray content = QString("你好，我是中文测试文本").toUtf8();
+    while (content.size() > 8) {
+        // 手动破坏尾部字符编码
+        content.chop(1);
+        EXPECT_EQ(EncodingDetector::detect(content), QByteArray("UTF-8"));
+    }
+    EXPECT_FALSE(g_getFileEncodingFormatCalled);
+}
+
+TEST_F(UT_EncodingDetector, feed_EarlyExit_Pass)
+{
+    EncodingDetector detector;
+    QByteArray content = QString("中文测试").repeated(100).toUtf8();
+
+    // 合法的 UTF-8 多字节数据足够多时提前结束
+    EXPECT_TRUE(detector.feed(content));
+    EXPECT_TRUE(detector.isDone());
+    EXPECT_EQ(detector.finish(), QByteArray("UTF-8"));
+}
+
+TEST_F(UT_EncodingDetector, feed_SplitCharacter_Pass)
+{
+    EncodingDetector detector;
+    QByteArray content = QString("中").toUtf8();
+
+    // 多字节字符跨数据块分割
+    detector.feed(content.left(1));
+    detector.feed(content.mid(1));
+    EXPECT_EQ(detector.m_multiByteCount, 1);
+    EXPECT_TRUE(detector.m_validUtf8);
+}
+
+TEST_F(UT_EncodingDetector, detect_GB18030_Pass)
+{
+    Stub stub;
+    stub.set(ADDR(DetectCode, GetFileEncodingFormat), getFileEncodingFormat_stub);
+    g_getFileEncodingFormatCalled = false;
+
+    QTextCodec *codec = QTextCodec::codecForName("GB18030");
+    QByteArray content = codec->fromUnicode("你好，我是中文测试文本");
+    EXPECT_EQ(EncodingDetector::detect(content), QByteArray("GB18030"));
+    // 非 UTF-8 数据使用样本数据完整识别
+    EXPECT_TRUE(g_getFileEncodingFormatCalled);
+}
+
+TEST_F(UT_EncodingDetector, feed_ConfidenceEarlyExit_Pass)
+{
+    Stub stub;
+    stub.set(ADDR(DetectCode, GetFileEncodingFormat), getFileEncodingFormat_stub);
+    stub.set(ADDR(DetectCode, ChartDet_DetectingTextCoding), chartDetDetectingTextCoding_stub);
+    g_getFileEncodingFormatCalled = false;
+
+    QTextCodec *codec = QTextCodec::codecForName("Big5");
+    QByteArray content = codec->fromUnicode(QString("中文測試文本").repeated(4096));
+    // 识别率达到阈值时提前结束，结束识别时直接使用已识别的编码
+    EncodingDetector detector;
+    EXPECT_TRUE(detector.feed(content));
+    EXPECT_FALSE(detector.m_result.isEmpty());
+    EXPECT_EQ(detector.finish(), QByteArray("BIG5"));
+    EXPECT_FALSE(g_getFileEncodingFormatCalled);
+}
+
+TEST_F(UT_EncodingDetector, cancel_Pass)
+{
+    EncodingDetector detector;
+    detector.cancel();
+
+    EXPECT_TRUE(detector.isCanceled());
+    EXPECT_TRUE(detector.feed("text", 4));
+    EXPECT_TRUE(detector.finish().isEmpty());
+}
@@ -0,0 +1,18 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef UT_ENCODINGDETECTOR_H
+#define UT_ENCODINGDETECTOR_H
+
+#include "gtest/gtest.h"
+#include <QObject>
+
+class UT_EncodingDetector : public QObject
+    , public ::testing::Test
+{
+public:
+    UT_EncodingDetector();
+};
+
+#endif // UT_ENCODINGDETECTOR_H
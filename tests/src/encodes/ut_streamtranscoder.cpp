@@ -0,0 +1,150 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "ut_streamtranscoder.h"
+#include "src/stub.h"
+#include "../../src/encodes/streamtranscoder.h"
+#include "../../src/common/config.h"
+
+#include <QTextCodec>
+
+namespace streamtranscoderstub {
+
+bool enablePatchedIconv_stub()
+{
+    return true;
+}
+
+// 按 chunkSize 分块转换数据
+QByteArray convertByChunk(StreamTranscoder &transcoder, const QByteArray &data, int chunkSize)
+{
+    QByteArray out;
+    for (int pos = 0; pos < data.size(); pos += chunkSize) {
+        EXPECT_TRUE(transcoder.convert(data.mid(pos, chunkSize), out));
+    }
+    EXPECT_TRUE(transcoder.finish(out));
+    return out;
+}
+
+}
+
+using namespace streamtranscoderstub;
+
+UT_StreamTranscoder::UT_StreamTranscoder()
+{
+}
+
+// bool isValid() const;
+TEST_F(UT_StreamTranscoder, isValid)
+{
+    StreamTranscoder transcoder("GB18030", "UTF-8");
+    EXPECT_TRUE(transcoder.isValid());
+
+    QByteArray out;
+    StreamTranscoder invalidTranscoder("NOT-EXIST-ENCODING", "UTF-8");
+    EXPECT_FALSE(invalidTranscoder.isValid());
+    EXPECT_FALSE(invalidTranscoder.convert(QByteArray("text"), out));
+    EXPECT_FALSE(invalidTranscoder.finish(out));
+}
+
+// bool convert(const char *data, qint64 len, QByteArray &out);
+TEST_F(UT_StreamTranscoder, convert_GB18030ToUtf8_Chunked)
+{
+    const QString text = QString("中文测试文本，包含多字节字符。\nGB18030 编码 😀\n").repeated(50);
+    QTextCodec *codec = QTextCodec::codecForName("GB18030");
+    ASSERT_NE(codec, nullptr);
+    const QByteArray gbData = codec->fromUnicode(text);
+
+    // 任意长度分块，多字节字符被截断时保留到下一数据块
+    for (int chunkSize : {1, 3, 7, 64, gbData.size()}) {
+        StreamTranscoder transcoder("GB18030", "UTF-8");
+        EXPECT_EQ(convertByChunk(transcoder, gbData, chunkSize), text.toUtf8()) << chunkSize;
+        EXPECT_EQ(transcoder.errorCount(), 0);
+    }
+}
+
+// bool convert(const char *data, qint64 len, QByteArray &out);
+TEST_F(UT_StreamTranscoder, convert_Utf8ToUtf16_ByteOrderMark)
+{
+    const QByteArray utf8Data = QString("UTF-16 测试😀").toUtf8();
+    StreamTranscoder transcoder("UTF-8", "UTF-16LE");
+    QByteArray out = convertByChunk(transcoder, utf8Data, 5);
+
+    // BOM 头仅在首次输出前添加
+    EXPECT_TRUE(out.startsWith(QByteArray::fromHex("FFFE")));
+    EXPECT_EQ(QString::fromUtf16(reinterpret_cast<const ushort *>(out.constData() + 2), (out.size() - 2) / 2),
+              QString("UTF-16 测试😀"));
+}
+
+// bool finish(QByteArray &out);
+TEST_F(UT_StreamTranscoder, finish_EmptyByteOrderMark)
+{
+    // 空文档保存为 UTF-16/UTF-32 时同样写入 BOM 头
+    StreamTranscoder transcoder("UTF-8", "UTF-16LE");
+    QByteArray out;
+    EXPECT_TRUE(transcoder.convert(QByteArray(), out));
+    EXPECT_TRUE(out.isEmpty());
+    EXPECT_TRUE(transcoder.finish(out));
+    EXPECT_EQ(out, QByteArray::fromHex("FFFE"));
+
+    // 已输出 BOM 头时不重复添加
+    out.clear();
+    transcoder.convert(QByteArray("a"), out);
+    transcoder.finish(out);
+    EXPECT_EQ(out, QByteArray::fromHex("FFFE6100"));
+
+    StreamTranscoder utf8Transcoder("UTF-8", "UTF-8");
+    out.clear();
+    utf8Transcoder.finish(out);
+    EXPECT_TRUE(out.isEmpty());
+}
+
+// qint64 pendingSize() const;
+TEST_F(UT_StreamTranscoder, pendingSize)
+{
+    StreamTranscoder transcoder("UTF-8", "UTF-16LE");
+    QByteArray out;
+    QByteArray utf8Char = QString("中").toUtf8();
+
+    transcoder.convert(utf8Char.left(2), out);
+    EXPECT_EQ(transcoder.pendingSize(), 2);
+    transcoder.convert(utf8Char.mid(2), out);
+    EXPECT_EQ(transcoder.pendingSize(), 0);
+}
+
+// bool finish(QByteArray &out);
+TEST_F(UT_StreamTranscoder, finish_IncompleteTail)
+{
+    StreamTranscoder transcoder("UTF-8", "GB18030");
+    QByteArray out;
+    transcoder.convert(QByteArray("ab") + QString("中").toUtf8().left(2), out);
+    EXPECT_EQ(out, QByteArray("ab"));
+
+    // 末尾不完整的字符替换为'?'
+    transcoder.finish(out);
+    EXPECT_EQ(out, QByteArray("ab?"));
+    EXPECT_EQ(transcoder.pendingSize(), 0);
+    EXPECT_EQ(transcoder.errorCount(), 1);
+}
+
+// qint64 process(const char *data, qint64 len, QByteArray &out, bool flush);
+TEST_F(UT_StreamTranscoder, process_GB18030Patch)
+{
+    Stub stub;
+    stub.set(ADDR(Config, enablePatchedIconv), enablePatchedIconv_stub);
+
+    // 0xFE51 按 GB18030-2005 规范转换为 \uE816
+    StreamTranscoder fromTranscoder("GB18030", "UTF-8");
+    QByteArray gbData = QByteArray("a") + QByteArray::fromHex("FE51") + QByteArray("b");
+    EXPECT_EQ(convertByChunk(fromTranscoder, gbData, 2), QByteArray("a\uE816b"));
+
+    // 0xFE 为多字节字符的后续字节时不处理
+    StreamTranscoder trailTranscoder("GB18030", "UTF-8");
+    QByteArray trailData = QByteArray::fromHex("81FE") + QByteArray("Q");
+    EXPECT_TRUE(convertByChunk(trailTranscoder, trailData, 1).endsWith("Q"));
+
+    // \u20087 转换为 GB18030-2022 编码 0x95329031
+    StreamTranscoder toTranscoder("UTF-8", "GB18030");
+    EXPECT_EQ(convertByChunk(toTranscoder, QByteArray("\U00020087"), 1), QByteArray::fromHex("95329031"));
+}
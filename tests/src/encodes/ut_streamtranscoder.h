@@ -0,0 +1,18 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef UT_STREAMTRANSCODER_H
+#define UT_STREAMTRANSCODER_H
+
+#include "gtest/gtest.h"
+#include <QObject>
+
+class UT_StreamTranscoder : public QObject
+    , public ::testing::Test
+{
+public:
+    UT_StreamTranscoder();
+};
+
+#endif // UT_STREAMTRANSCODER_H
@@ -0,0 +1,195 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "ut_utf8scanner.h"
+#include "../../src/encodes/utf8scanner.h"
+#include "../../src/encodes/detectcode.h"
+
+#include <QElapsedTimer>
+#include <QDebug>
+
+namespace utf8scannertest {
+
+// 校验各个长度及偏移下的结果，覆盖向量化实现的数据块边界及末尾数据处理
+void checkAllOffsets(const QByteArray &unit, bool valid)
+{
+    for (int prefix = 0; prefix < 70; ++prefix) {
+        QByteArray data = QByteArray(prefix, 'a') + unit + QByteArray(70 - prefix, 'b');
+        EXPECT_EQ(Utf8Scanner::isValidUtf8(data.constData(), data.size()), valid) << prefix << unit.toHex().constData();
+        EXPECT_EQ(Utf8Scanner::isValidUtf8Scalar(data.constData(), data.size(), nullptr), valid);
+    }
+}
+
+// 性能测试数据长度，可通过环境变量 UTF8SCANNER_BENCH_MB 设置(10MB~1GB)
+int benchmarkSizeMB()
+{
+    int size = qEnvironmentVariableIntValue("UTF8SCANNER_BENCH_MB");
+    return size > 0 ? qBound(10, size, 1024) : 10;
+}
+
+QByteArray benchmarkData(bool ascii)
+{
+    QByteArray unit = ascii ? QByteArray("The quick brown fox jumps over the lazy dog.\n")
+                            : QString("中文文本 mixed with ASCII 😀\n").toUtf8();
+    const int size = benchmarkSizeMB() * 1024 * 1024;
+    QByteArray data;
+    data.reserve(size + unit.size());
+    while (data.size() < size) {
+        data.append(unit);
+    }
+    return data;
+}
+
+}
+
+using namespace utf8scannertest;
+
+UT_Utf8Scanner::UT_Utf8Scanner()
+{
+}
+
+// qint64 asciiPrefixLength(const char *data, qint64 len);
+TEST_F(UT_Utf8Scanner, asciiPrefixLength)
+{
+    EXPECT_EQ(Utf8Scanner::asciiPrefixLength(nullptr, 10), 0);
+    EXPECT_EQ(Utf8Scanner::asciiPrefixLength("abc", 0), 0);
+
+    for (int pos = 0; pos < 100; ++pos) {
+        QByteArray data(100, 'a');
+        data[pos] = static_cast<char>(0x80);
+        EXPECT_EQ(Utf8Scanner::asciiPrefixLength(data.constData(), data.size()), pos);
+        EXPECT_EQ(Utf8Scanner::asciiPrefixLengthScalar(data.constData(), data.size()), pos);
+    }
+}
+
+// bool isAscii(const char *data, qint64 len);
+TEST_F(UT_Utf8Scanner, isAscii)
+{
+    QByteArray data(1000, 'a');
+    EXPECT_TRUE(Utf8Scanner::isAscii(data.constData(), data.size()));
+    EXPECT_TRUE(Utf8Scanner::isAscii(data.constData(), 0));
+
+    data.append(QString("中").toUtf8());
+    EXPECT_FALSE(Utf8Scanner::isAscii(data.constData(), data.size()));
+}
+
+// bool isValidUtf8(const char *data, qint64 len, qint64 *incompleteTail = nullptr);
+TEST_F(UT_Utf8Scanner, isValidUtf8_Valid)
+{
+    checkAllOffsets(QByteArray::fromHex("C3A9"), true);
+    checkAllOffsets(QByteArray::fromHex("E4B8AD"), true);
+    checkAllOffsets(QByteArray::fromHex("F09F9880"), true);
+    checkAllOffsets(QByteArray::fromHex("EFBFBF"), true);
+    checkAllOffsets(QByteArray::fromHex("F48FBFBF"), true);
+    checkAllOffsets(QByteArray::fromHex("ED9FBF"), true);
+    checkAllOffsets(QString("你好，世界").toUtf8().repeated(10), true);
+}
+
+// bool isValidUtf8(const char *data, qint64 len, qint64 *incompleteTail = nullptr);
+TEST_F(UT_Utf8Scanner, isValidUtf8_Invalid)
+{
+    // 孤立的后续字节
+    checkAllOffsets(QByteArray::fromHex("80"), false);
+    // 超长编码
+    checkAllOffsets(QByteArray::fromHex("C0AF"), false);
+    checkAllOffsets(QByteArray::fromHex("E08080"), false);
+    checkAllOffsets(QByteArray::fromHex("F0808080"), false);
+    // 代理区字符
+    checkAllOffsets(QByteArray::fromHex("EDA080"), false);
+    // 超出 U+10FFFF
+    checkAllOffsets(QByteArray::fromHex("F4908080"), false);
+    checkAllOffsets(QByteArray::fromHex("F5808080"), false);
+    // 非法字节
+    checkAllOffsets(QByteArray::fromHex("FF"), false);
+    // 字符被截断
+    checkAllOffsets(QByteArray::fromHex("E4B8"), false);
+    checkAllOffsets(QByteArray::fromHex("F09F98"), false);
+}
+
+// bool isValidUtf8(const char *data, qint64 len, qint64 *incompleteTail = nullptr);
+TEST_F(UT_Utf8Scanner, isValidUtf8_IncompleteTail)
+{
+    QByteArray data = QString("中文").toUtf8().repeated(40) + QByteArray::fromHex("F09F98");
+    qint64 incompleteTail = 0;
+    EXPECT_FALSE(Utf8Scanner::isValidUtf8(data.constData(), data.size()));
+    EXPECT_TRUE(Utf8Scanner::isValidUtf8(data.constData(), data.size(), &incompleteTail));
+    EXPECT_EQ(incompleteTail, 3);
+
+    data.chop(3);
+    EXPECT_TRUE(Utf8Scanner::isValidUtf8(data.constData(), data.size(), &incompleteTail));
+    EXPECT_EQ(incompleteTail, 0);
+}
+
+// qint64 countLeadBytes(const char *data, qint64 len);
+TEST_F(UT_Utf8Scanner, countLeadBytes)
+{
+    QByteArray data = QString("a中b文😀").toUtf8().repeated(20);
+    EXPECT_EQ(Utf8Scanner::countLeadBytes(data.constData(), data.size()), 60);
+    EXPECT_EQ(Utf8Scanner::countLeadBytesScalar(data.constData(), data.size()), 60);
+}
+
+// static bool ChangeFileEncodingFormat(QByteArray &inputStr, QByteArray &outStr, const QString &fromCode, const QString &toCode);
+TEST_F(UT_Utf8Scanner, changeFileEncodingFormat_AsciiSkip)
+{
+    QByteArray input(1000, 'a');
+    QByteArray output;
+    EXPECT_TRUE(DetectCode::ChangeFileEncodingFormat(input, output, "UTF-8", "GB18030"));
+    EXPECT_EQ(output, input);
+
+    // UTF-16 与 ASCII 不兼容，仍需转换
+    EXPECT_TRUE(DetectCode::ChangeFileEncodingFormat(input, output, "UTF-8", "UTF-16LE"));
+    EXPECT_NE(output, input);
+}
+
+// 性能测试，默认不执行，通过 --gtest_also_run_disabled_tests --gtest_filter=*Benchmark* 运行
+TEST_F(UT_Utf8Scanner, DISABLED_Benchmark_Ascii)
+{
+    QByteArray data = benchmarkData(true);
+    QElapsedTimer timer;
+
+    timer.start();
+    bool ascii = Utf8Scanner::isAscii(data.constData(), data.size());
+    qint64 scanTime = timer.nsecsElapsed();
+
+    timer.restart();
+    qint64 scalarLen = Utf8Scanner::asciiPrefixLengthScalar(data.constData(), data.size());
+    qint64 scalarTime = timer.nsecsElapsed();
+
+    timer.restart();
+    QByteArray output;
+    // 通过 UTF-16 转换，避免 ASCII 数据直接跳过 iconv
+    DetectCode::ChangeFileEncodingFormat(data, output, "UTF-8", "UTF-16LE");
+    qint64 iconvTime = timer.nsecsElapsed();
+
+    EXPECT_TRUE(ascii);
+    EXPECT_EQ(scalarLen, data.size());
+    qInfo() << "ASCII" << data.size() / (1024 * 1024) << "MB, implementation:" << Utf8Scanner::implementation()
+            << "simd(ms):" << scanTime / 1000000.0 << "scalar(ms):" << scalarTime / 1000000.0
+            << "iconv(ms):" << iconvTime / 1000000.0;
+}
+
+TEST_F(UT_Utf8Scanner, DISABLED_Benchmark_Utf8)
+{
+    QByteArray data = benchmarkData(false);
+    QElapsedTimer timer;
+
+    timer.start();
+    bool valid = Utf8Scanner::isValidUtf8(data.constData(), data.size());
+    qint64 scanTime = timer.nsecsElapsed();
+
+    timer.restart();
+    bool scalarValid = Utf8Scanner::isValidUtf8Scalar(data.constData(), data.size(), nullptr);
+    qint64 scalarTime = timer.nsecsElapsed();
+
+    timer.restart();
+    QString text = QString::fromUtf8(data);
+    qint64 decodeTime = timer.nsecsElapsed();
+
+    EXPECT_TRUE(valid);
+    EXPECT_TRUE(scalarValid);
+    EXPECT_FALSE(text.isEmpty());
+    qInfo() << "UTF-8" << data.size() / (1024 * 1024) << "MB, implementation:" << Utf8Scanner::implementation()
+            << "simd(ms):" << scanTime / 1000000.0 << "scalar(ms):" << scalarTime / 1000000.0
+            << "QString::fromUtf8(ms):" << decodeTime / 1000000.0;
+}
@@ -0,0 +1,18 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef UT_UTF8SCANNER_H
+#define UT_UTF8SCANNER_H
+
+#include "gtest/gtest.h"
+#include <QObject>
+
+class UT_Utf8Scanner : public QObject
+    , public ::testing::Test
+{
+public:
+    UT_Utf8Scanner();
+};
+
+#endif // UT_UTF8SCANNER_H
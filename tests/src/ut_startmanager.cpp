@@ -234,6 +234,7 @@ TEST(UT_StartManager_autoBackupFile,autoBackupFile)
     Stub s2;
     s2.set(ADDR(StartManager,getFileTabInfo),getFileTabInfostub);
     s2.set(ADDR(EditWrapper,saveTemFile),returnstub);
+    s2.set(ADDR(EditWrapper,saveTemFileIncremental),returnstub);
 
     startManager->autoBackupFile();
     EXPECT_NE(startManager , nullptr);
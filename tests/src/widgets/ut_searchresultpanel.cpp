@@ -0,0 +1,64 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "ut_searchresultpanel.h"
+#include "../../src/widgets/searchresultpanel.h"
+
+#include <QSignalSpy>
+
+test_searchresultpanel::test_searchresultpanel()
+{
+}
+
+void test_searchresultpanel::SetUp()
+{
+}
+
+void test_searchresultpanel::TearDown()
+{
+}
+
+static MultiDocumentSearch::FileResult createResult(int index, const QString &filePath, const QString &text, const QString &keyword)
+{
+    MultiDocumentSearch::FileResult result;
+    result.index = index;
+    result.filePath = filePath;
+    result.matches = MultiDocumentSearch::createMatches(text, SearchResult(TextSearchEngine::findAll(text, keyword), keyword.length()));
+    result.matchCount = result.matches.size();
+    return result;
+}
+
+//void addFileResult(const MultiDocumentSearch::FileResult &result, const QString &fileName);
+TEST_F(test_searchresultpanel, addFileResult)
+{
+    SearchResultPanel panel;
+    panel.startSearch("key");
+
+    // 文件分组按文件序号排列，与查找完成的顺序无关
+    panel.addFileResult(createResult(2, "/tmp/c.conf", "key\nkey", "key"), "c.conf");
+    panel.addFileResult(createResult(0, "/tmp/a.conf", "a key", "key"), "a.conf");
+    panel.addFileResult(createResult(1, "/tmp/b.conf", "key", "key"), "b.conf");
+    panel.setFinished();
+
+    EXPECT_EQ(panel.fileCount(), 3);
+    EXPECT_EQ(panel.matchCount(), 4);
+    EXPECT_EQ(panel.resultFiles(), QStringList({"/tmp/a.conf", "/tmp/b.conf", "/tmp/c.conf"}));
+
+    // 激活匹配项时通知文件及位置
+    QSignalSpy spy(&panel, &SearchResultPanel::sigMatchActivated);
+    QTreeWidgetItem *fileItem = panel.m_resultTree->topLevelItem(2);
+    panel.onItemActivated(fileItem, 0);
+    EXPECT_EQ(spy.count(), 0);
+    panel.onItemActivated(fileItem->child(1), 0);
+    ASSERT_EQ(spy.count(), 1);
+    EXPECT_EQ(spy.first().at(0).toString(), QString("/tmp/c.conf"));
+    EXPECT_EQ(spy.first().at(1).toInt(), 4);
+    EXPECT_EQ(spy.first().at(2).toInt(), 3);
+    EXPECT_EQ(spy.first().at(3).toInt(), 1);
+    EXPECT_EQ(spy.first().at(4).toInt(), 0);
+
+    panel.showMessage("done");
+    EXPECT_EQ(panel.fileCount(), 0);
+    EXPECT_EQ(panel.matchCount(), 0);
+}